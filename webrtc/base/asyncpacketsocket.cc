@@ -26,4 +26,15 @@ AsyncPacketSocket::AsyncPacketSocket() {
 AsyncPacketSocket::~AsyncPacketSocket() {
 }
 
+int AsyncPacketSocket::SendToBatch(const Datagram* datagrams, size_t count,
+                                   const PacketOptions& options) {
+  size_t sent = 0;
+  for (; sent < count; ++sent) {
+    const Datagram& datagram = datagrams[sent];
+    if (SendTo(datagram.data, datagram.size, datagram.addr, options) < 0)
+      break;
+  }
+  return (sent == 0 && count != 0) ? -1 : static_cast<int>(sent);
+}
+
 };  // namespace rtc
@@ -87,6 +87,12 @@ class AsyncPacketSocket : public sigslot::has_slots<> {
   virtual int Send(const void *pv, size_t cb, const PacketOptions& options) = 0;
   virtual int SendTo(const void *pv, size_t cb, const SocketAddress& addr,
                      const PacketOptions& options) = 0;
+  // Sends a burst of packets, in order, using the same |options| for all.
+  // Returns the number of packets sent, or a negative value if none could be.
+  // Implementations that can send several packets with one system call should
+  // override the default, which calls SendTo() until it fails.
+  virtual int SendToBatch(const Datagram* datagrams, size_t count,
+                          const PacketOptions& options);
 
   // Close the socket.
   virtual int Close() = 0;
@@ -69,6 +69,11 @@ int AsyncUDPSocket::SendTo(const void *pv, size_t cb,
   return socket_->SendTo(pv, cb, addr);
 }
 
+int AsyncUDPSocket::SendToBatch(const Datagram* datagrams, size_t count,
+                                const rtc::PacketOptions& options) {
+  return socket_->SendToBatch(datagrams, count);
+}
+
 int AsyncUDPSocket::Close() {
   return socket_->Close();
 }
@@ -93,9 +98,29 @@ void AsyncUDPSocket::SetError(int error) {
   return socket_->SetError(error);
 }
 
+void AsyncUDPSocket::SetReceiveBatchSize(size_t max_packets,
+                                         size_t max_packet_size) {
+  ASSERT(max_packets > 0);
+  delete [] buf_;
+  if (max_packets <= 1) {
+    batch_.clear();
+    size_ = BUF_SIZE;
+  } else {
+    ASSERT(max_packet_size > 0);
+    batch_.resize(max_packets);
+    size_ = max_packets * max_packet_size;
+  }
+  buf_ = new char[size_];
+}
+
 void AsyncUDPSocket::OnReadEvent(AsyncSocket* socket) {
   ASSERT(socket_.get() == socket);
 
+  if (!batch_.empty()) {
+    ReadBatch();
+    return;
+  }
+
   SocketAddress remote_addr;
   int len = socket_->RecvFrom(buf_, size_, &remote_addr);
   if (len < 0) {
@@ -115,6 +140,36 @@ void AsyncUDPSocket::OnReadEvent(AsyncSocket* socket) {
                    CreatePacketTime(0));
 }
 
+void AsyncUDPSocket::ReadBatch() {
+  size_t packet_size = size_ / batch_.size();
+  for (size_t i = 0; i < batch_.size(); ++i) {
+    batch_[i].data = buf_ + i * packet_size;
+    batch_[i].size = packet_size;
+  }
+
+  int count = socket_->RecvFromBatch(&batch_[0], batch_.size());
+  if (count < 0) {
+    // See OnReadEvent().
+    SocketAddress local_addr = socket_->GetLocalAddress();
+    LOG(LS_INFO) << "AsyncUDPSocket[" << local_addr.ToSensitiveString() << "] "
+                 << "receive failed with error " << socket_->GetError();
+    return;
+  }
+
+  PacketTime packet_time = CreatePacketTime(0);
+  for (int i = 0; i < count; ++i) {
+    const Datagram& datagram = batch_[i];
+    if (datagram.truncated) {
+      LOG(LS_WARNING) << "Dropping datagram larger than " << packet_size
+                      << " bytes from "
+                      << datagram.addr.ToSensitiveString();
+      continue;
+    }
+    SignalReadPacket(this, datagram.data, datagram.size, datagram.addr,
+                     packet_time);
+  }
+}
+
 void AsyncUDPSocket::OnWriteEvent(AsyncSocket* socket) {
   SignalReadyToSend(this);
 }
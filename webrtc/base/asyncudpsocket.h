@@ -11,6 +11,8 @@
 #ifndef WEBRTC_BASE_ASYNCUDPSOCKET_H_
 #define WEBRTC_BASE_ASYNCUDPSOCKET_H_
 
+#include <vector>
+
 #include "webrtc/base/asyncpacketsocket.h"
 #include "webrtc/base/scoped_ptr.h"
 #include "webrtc/base/socketfactory.h"
@@ -42,6 +44,8 @@ class AsyncUDPSocket : public AsyncPacketSocket {
              size_t cb,
              const SocketAddress& addr,
              const rtc::PacketOptions& options) override;
+  int SendToBatch(const Datagram* datagrams, size_t count,
+                  const rtc::PacketOptions& options) override;
   int Close() override;
 
   State GetState() const override;
@@ -50,15 +54,26 @@ class AsyncUDPSocket : public AsyncPacketSocket {
   int GetError() const override;
   void SetError(int error) override;
 
+  // Makes every read event drain up to |max_packets| datagrams with a single
+  // RecvFromBatch() call, each into a buffer of |max_packet_size| bytes.
+  // Larger datagrams are dropped, so only use this when the packet sizes are
+  // bounded, e.g. RTP over a known MTU. The default, |max_packets| == 1, reads
+  // one datagram of up to 64 kB per read event.
+  void SetReceiveBatchSize(size_t max_packets, size_t max_packet_size);
+
  private:
   // Called when the underlying socket is ready to be read from.
   void OnReadEvent(AsyncSocket* socket);
   // Called when the underlying socket is ready to send.
   void OnWriteEvent(AsyncSocket* socket);
+  // Reads and delivers up to |batch_.size()| datagrams.
+  void ReadBatch();
 
   scoped_ptr<AsyncSocket> socket_;
   char* buf_;
   size_t size_;
+  // One entry per datagram slot in |buf_| when batching is enabled.
+  std::vector<Datagram> batch_;
 };
 
 }  // namespace rtc
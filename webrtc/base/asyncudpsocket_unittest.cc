@@ -9,11 +9,13 @@
  */
 
 #include <string>
+#include <vector>
 
 #include "webrtc/base/asyncudpsocket.h"
 #include "webrtc/base/gunit.h"
 #include "webrtc/base/physicalsocketserver.h"
 #include "webrtc/base/scoped_ptr.h"
+#include "webrtc/base/timeutils.h"
 #include "webrtc/base/virtualsocketserver.h"
 
 namespace rtc {
@@ -50,4 +52,106 @@ TEST_F(AsyncUdpSocketTest, OnWriteEvent) {
   EXPECT_TRUE(ready_to_send_);
 }
 
+// Sends and receives over real loopback sockets, so that the batched
+// PhysicalSocket paths are exercised where the platform has them.
+class AsyncUdpSocketBatchTest
+    : public testing::Test,
+      public sigslot::has_slots<> {
+ public:
+  AsyncUdpSocketBatchTest() : read_events_(0) {
+    SocketAddress loopback(IPAddress(INADDR_LOOPBACK), 0);
+    sender_.reset(AsyncUDPSocket::Create(&pss_, loopback));
+    receiver_.reset(AsyncUDPSocket::Create(&pss_, loopback));
+    receiver_->SignalReadPacket.connect(this,
+                                        &AsyncUdpSocketBatchTest::OnReadPacket);
+  }
+
+  void OnReadPacket(AsyncPacketSocket* socket, const char* data, size_t size,
+                    const SocketAddress& addr, const PacketTime& time) {
+    packets_.push_back(std::string(data, size));
+  }
+
+  // Sends |count| packets of |size| bytes to the receiver in one burst.
+  int SendBurst(size_t count, size_t size) {
+    payloads_.resize(count);
+    std::vector<Datagram> datagrams(count);
+    for (size_t i = 0; i < count; ++i) {
+      payloads_[i].assign(size, static_cast<char>('a' + i % 26));
+      datagrams[i].data = &payloads_[i][0];
+      datagrams[i].size = size;
+      datagrams[i].addr = receiver_->GetLocalAddress();
+    }
+    return sender_->SendToBatch(&datagrams[0], count, PacketOptions());
+  }
+
+  // Runs the socket server until |count| packets have been read.
+  bool WaitForPackets(size_t count) {
+    uint32 stop = TimeAfter(kTimeoutMs);
+    while (packets_.size() < count && TimeUntil(stop) > 0) {
+      pss_.Wait(0, true);
+      ++read_events_;
+    }
+    return packets_.size() == count;
+  }
+
+ protected:
+  static const int kTimeoutMs = 1000;
+
+  PhysicalSocketServer pss_;
+  scoped_ptr<AsyncUDPSocket> sender_;
+  scoped_ptr<AsyncUDPSocket> receiver_;
+  std::vector<std::string> payloads_;
+  std::vector<std::string> packets_;
+  int read_events_;
+};
+
+TEST_F(AsyncUdpSocketBatchTest, ReceivesBurstInOrder) {
+  receiver_->SetReceiveBatchSize(8, 1500);
+  ASSERT_EQ(20, SendBurst(20, 1200));
+  ASSERT_TRUE(WaitForPackets(20));
+  EXPECT_TRUE(payloads_ == packets_);
+}
+
+TEST_F(AsyncUdpSocketBatchTest, DropsOversizedPackets) {
+  receiver_->SetReceiveBatchSize(8, 100);
+  ASSERT_EQ(1, SendBurst(1, 200));
+  ASSERT_EQ(1, SendBurst(1, 100));
+  ASSERT_TRUE(WaitForPackets(1));
+  EXPECT_EQ(payloads_[0], packets_[0]);
+}
+
+TEST_F(AsyncUdpSocketBatchTest, UnbatchedReceive) {
+  ASSERT_EQ(3, SendBurst(3, 1200));
+  ASSERT_TRUE(WaitForPackets(3));
+  EXPECT_TRUE(payloads_ == packets_);
+}
+
+// Reports loopback packets per second, and CPU time per packet, with and
+// without batching. Run with --gtest_also_run_disabled_tests.
+TEST_F(AsyncUdpSocketBatchTest, DISABLED_LoopbackThroughput) {
+  const size_t kBatchSizes[] = { 1, 8, 32, 64 };
+  const size_t kBurst = 32;
+  const size_t kPackets = 200000;
+  receiver_->SetOption(Socket::OPT_RCVBUF, 4 * 1024 * 1024);
+  for (size_t i = 0; i < ARRAY_SIZE(kBatchSizes); ++i) {
+    receiver_->SetReceiveBatchSize(kBatchSizes[i], 1500);
+    packets_.clear();
+    read_events_ = 0;
+    uint64 start = TimeNanos();
+    clock_t start_cpu = clock();
+    for (size_t sent = 0; sent < kPackets; sent += kBurst) {
+      ASSERT_EQ(static_cast<int>(kBurst), SendBurst(kBurst, 1200));
+      ASSERT_TRUE(WaitForPackets(sent + kBurst));
+    }
+    double seconds = static_cast<double>(TimeNanos() - start) /
+        kNumNanosecsPerSec;
+    double cpu_seconds = static_cast<double>(clock() - start_cpu) /
+        CLOCKS_PER_SEC;
+    LOG(LS_INFO) << "Batch size " << kBatchSizes[i] << ": "
+                 << static_cast<int>(kPackets / seconds) << " packets/s, "
+                 << static_cast<int>(kPackets / cpu_seconds)
+                 << " packets/s per core, " << read_events_ << " waits";
+  }
+}
+
 }  // namespace rtc
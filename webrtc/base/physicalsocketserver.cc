@@ -66,6 +66,16 @@ typedef char* SockOptArg;
 
 namespace rtc {
 
+#if defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+// Maximum number of datagrams moved per recvmmsg()/sendmmsg() call.
+static const size_t kMaxBatchSize = 64;
+#endif
+
+#if defined(WEBRTC_USE_EPOLL)
+// Maximum number of events handled per epoll_wait() call.
+static const int kMaxEpollEvents = 128;
+#endif
+
 #if defined(WEBRTC_WIN)
 // Standard MTUs, from RFC 1191
 const uint16 PACKET_MAXIMUMS[] = {
@@ -213,12 +223,12 @@ class PhysicalSocket : public AsyncSocket, public sigslot::has_slots<> {
       state_ = CS_CONNECTED;
     } else if (IsBlockingError(GetError())) {
       state_ = CS_CONNECTING;
-      enabled_events_ |= DE_CONNECT;
+      EnableEvents(DE_CONNECT);
     } else {
       return SOCKET_ERROR;
     }
 
-    enabled_events_ |= DE_READ | DE_WRITE;
+    EnableEvents(DE_READ | DE_WRITE);
     return 0;
   }
 
@@ -280,7 +290,7 @@ class PhysicalSocket : public AsyncSocket, public sigslot::has_slots<> {
     // We have seen minidumps where this may be false.
     ASSERT(sent <= static_cast<int>(cb));
     if ((sent < 0) && IsBlockingError(GetError())) {
-      enabled_events_ |= DE_WRITE;
+      EnableEvents(DE_WRITE);
     }
     return sent;
   }
@@ -304,7 +314,7 @@ class PhysicalSocket : public AsyncSocket, public sigslot::has_slots<> {
     // We have seen minidumps where this may be false.
     ASSERT(sent <= static_cast<int>(length));
     if ((sent < 0) && IsBlockingError(GetError())) {
-      enabled_events_ |= DE_WRITE;
+      EnableEvents(DE_WRITE);
     }
     return sent;
   }
@@ -319,7 +329,7 @@ class PhysicalSocket : public AsyncSocket, public sigslot::has_slots<> {
       LOG(LS_WARNING) << "EOF from socket; deferring close event";
       // Must turn this back on so that the select() loop will notice the close
       // event.
-      enabled_events_ |= DE_READ;
+      EnableEvents(DE_READ);
       SetError(EWOULDBLOCK);
       return SOCKET_ERROR;
     }
@@ -327,7 +337,7 @@ class PhysicalSocket : public AsyncSocket, public sigslot::has_slots<> {
     int error = GetError();
     bool success = (received >= 0) || IsBlockingError(error);
     if (udp_ || success) {
-      enabled_events_ |= DE_READ;
+      EnableEvents(DE_READ);
     }
     if (!success) {
       LOG_F(LS_VERBOSE) << "Error = " << error;
@@ -347,7 +357,41 @@ class PhysicalSocket : public AsyncSocket, public sigslot::has_slots<> {
     int error = GetError();
     bool success = (received >= 0) || IsBlockingError(error);
     if (udp_ || success) {
-      enabled_events_ |= DE_READ;
+      EnableEvents(DE_READ);
+    }
+    if (!success) {
+      LOG_F(LS_VERBOSE) << "Error = " << error;
+    }
+    return received;
+  }
+
+#if defined(WEBRTC_LINUX) && !defined(WEBRTC_ANDROID)
+  int RecvFromBatch(Datagram* datagrams, size_t count) override {
+    count = std::min(count, kMaxBatchSize);
+    mmsghdr msgs[kMaxBatchSize];
+    iovec iovs[kMaxBatchSize];
+    sockaddr_storage addrs[kMaxBatchSize];
+    for (size_t i = 0; i < count; ++i) {
+      iovs[i].iov_base = datagrams[i].data;
+      iovs[i].iov_len = datagrams[i].size;
+      memset(&msgs[i], 0, sizeof(msgs[i]));
+      msgs[i].msg_hdr.msg_name = &addrs[i];
+      msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+      msgs[i].msg_hdr.msg_iov = &iovs[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    int received = ::recvmmsg(s_, msgs, static_cast<unsigned int>(count),
+                              MSG_DONTWAIT, NULL);
+    UpdateLastError();
+    for (int i = 0; i < received; ++i) {
+      datagrams[i].size = msgs[i].msg_len;
+      datagrams[i].truncated = (msgs[i].msg_hdr.msg_flags & MSG_TRUNC) != 0;
+      SocketAddressFromSockAddrStorage(addrs[i], &datagrams[i].addr);
+    }
+    int error = GetError();
+    bool success = (received >= 0) || IsBlockingError(error);
+    if (udp_ || success) {
+      EnableEvents(DE_READ);
     }
     if (!success) {
       LOG_F(LS_VERBOSE) << "Error = " << error;
@@ -355,12 +399,41 @@ class PhysicalSocket : public AsyncSocket, public sigslot::has_slots<> {
     return received;
   }
 
+  int SendToBatch(const Datagram* datagrams, size_t count) override {
+    count = std::min(count, kMaxBatchSize);
+    mmsghdr msgs[kMaxBatchSize];
+    iovec iovs[kMaxBatchSize];
+    sockaddr_storage addrs[kMaxBatchSize];
+    for (size_t i = 0; i < count; ++i) {
+      iovs[i].iov_base = datagrams[i].data;
+      iovs[i].iov_len = datagrams[i].size;
+      memset(&msgs[i], 0, sizeof(msgs[i]));
+      // A nil address sends to the connected peer.
+      if (!datagrams[i].addr.IsNil()) {
+        msgs[i].msg_hdr.msg_name = &addrs[i];
+        msgs[i].msg_hdr.msg_namelen = static_cast<socklen_t>(
+            datagrams[i].addr.ToSockAddrStorage(&addrs[i]));
+      }
+      msgs[i].msg_hdr.msg_iov = &iovs[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    // Suppress SIGPIPE. See Send() for explanation.
+    int sent = ::sendmmsg(s_, msgs, static_cast<unsigned int>(count),
+                          MSG_NOSIGNAL);
+    UpdateLastError();
+    if ((sent < 0) && IsBlockingError(GetError())) {
+      EnableEvents(DE_WRITE);
+    }
+    return sent;
+  }
+#endif
+
   int Listen(int backlog) override {
     int err = ::listen(s_, backlog);
     UpdateLastError();
     if (err == 0) {
       state_ = CS_CONNECTING;
-      enabled_events_ |= DE_ACCEPT;
+      EnableEvents(DE_ACCEPT);
 #ifdef _DEBUG
       dbg_addr_ = "Listening @ ";
       dbg_addr_.append(GetLocalAddress().ToString());
@@ -377,7 +450,7 @@ class PhysicalSocket : public AsyncSocket, public sigslot::has_slots<> {
     UpdateLastError();
     if (s == INVALID_SOCKET)
       return NULL;
-    enabled_events_ |= DE_ACCEPT;
+    EnableEvents(DE_ACCEPT);
     if (out_addr != NULL)
       SocketAddressFromSockAddrStorage(addr_storage, out_addr);
     return ss_->WrapSocket(s);
@@ -390,7 +463,7 @@ class PhysicalSocket : public AsyncSocket, public sigslot::has_slots<> {
     UpdateLastError();
     s_ = INVALID_SOCKET;
     state_ = CS_CLOSED;
-    enabled_events_ = 0;
+    SetEnabledEvents(0);
     if (resolver_) {
       resolver_->Destroy(false);
       resolver_ = NULL;
@@ -487,6 +560,20 @@ class PhysicalSocket : public AsyncSocket, public sigslot::has_slots<> {
     SetError(LAST_SYSTEM_ERROR);
   }
 
+  // All changes to |enabled_events_| go through here so that dispatchers can
+  // tell the socket server about them.
+  virtual void SetEnabledEvents(uint8 events) {
+    enabled_events_ = events;
+  }
+
+  void EnableEvents(uint8 events) {
+    SetEnabledEvents(enabled_events_ | events);
+  }
+
+  void DisableEvents(uint8 events) {
+    SetEnabledEvents(enabled_events_ & ~events);
+  }
+
   void MaybeRemapSendError() {
 #if defined(WEBRTC_MAC)
     // https://developer.apple.com/library/mac/documentation/Darwin/
@@ -858,6 +945,13 @@ class SocketDispatcher : public Dispatcher, public PhysicalSocket {
 
   uint32 GetRequestedEvents() override { return enabled_events_; }
 
+  void SetEnabledEvents(uint8 events) override {
+    if (events == enabled_events_)
+      return;
+    PhysicalSocket::SetEnabledEvents(events);
+    ss_->Update(this);
+  }
+
   void OnPreEvent(uint32 ff) override {
     if ((ff & DE_CONNECT) != 0)
       state_ = CS_CONNECTED;
@@ -869,24 +963,24 @@ class SocketDispatcher : public Dispatcher, public PhysicalSocket {
     // Make sure we deliver connect/accept first. Otherwise, consumers may see
     // something like a READ followed by a CONNECT, which would be odd.
     if ((ff & DE_CONNECT) != 0) {
-      enabled_events_ &= ~DE_CONNECT;
+      DisableEvents(DE_CONNECT);
       SignalConnectEvent(this);
     }
     if ((ff & DE_ACCEPT) != 0) {
-      enabled_events_ &= ~DE_ACCEPT;
+      DisableEvents(DE_ACCEPT);
       SignalReadEvent(this);
     }
     if ((ff & DE_READ) != 0) {
-      enabled_events_ &= ~DE_READ;
+      DisableEvents(DE_READ);
       SignalReadEvent(this);
     }
     if ((ff & DE_WRITE) != 0) {
-      enabled_events_ &= ~DE_WRITE;
+      DisableEvents(DE_WRITE);
       SignalWriteEvent(this);
     }
     if ((ff & DE_CLOSE) != 0) {
       // The socket is now dead to us, so stop checking it.
-      enabled_events_ = 0;
+      SetEnabledEvents(0);
       SignalCloseEvent(this, err);
     }
   }
@@ -902,7 +996,8 @@ class SocketDispatcher : public Dispatcher, public PhysicalSocket {
 
 class FileDispatcher: public Dispatcher, public AsyncFile {
  public:
-  FileDispatcher(int fd, PhysicalSocketServer *ss) : ss_(ss), fd_(fd) {
+  FileDispatcher(int fd, PhysicalSocketServer *ss)
+      : ss_(ss), fd_(fd), flags_(0) {
     set_readable(true);
 
     ss_->Add(this);
@@ -937,12 +1032,14 @@ class FileDispatcher: public Dispatcher, public AsyncFile {
 
   void set_readable(bool value) override {
     flags_ = value ? (flags_ | DE_READ) : (flags_ & ~DE_READ);
+    ss_->Update(this);
   }
 
   bool writable() override { return (flags_ & DE_WRITE) != 0; }
 
   void set_writable(bool value) override {
     flags_ = value ? (flags_ | DE_WRITE) : (flags_ & ~DE_WRITE);
+    ss_->Update(this);
   }
 
  private:
@@ -1165,6 +1262,16 @@ class Signaler : public EventDispatcher {
 
 PhysicalSocketServer::PhysicalSocketServer()
     : fWait_(false) {
+#if defined(WEBRTC_USE_EPOLL)
+  // Since Linux 2.6.8 the size argument is ignored, but it must be positive.
+  epoll_fd_ = epoll_create(FD_SETSIZE);
+  if (epoll_fd_ == -1) {
+    // Not an error: Wait() falls back to select().
+    LOG_E(LS_WARNING, EN, errno) << "epoll_create";
+  }
+  force_select_ = false;
+  epoll_events_.resize(kMaxEpollEvents);
+#endif
   signal_wakeup_ = new Signaler(this, &fWait_);
 #if defined(WEBRTC_WIN)
   socket_ev_ = WSACreateEvent();
@@ -1180,6 +1287,10 @@ PhysicalSocketServer::~PhysicalSocketServer() {
 #endif
   delete signal_wakeup_;
   ASSERT(dispatchers_.empty());
+#if defined(WEBRTC_USE_EPOLL)
+  if (epoll_fd_ != -1)
+    close(epoll_fd_);
+#endif
 }
 
 void PhysicalSocketServer::WakeUp() {
@@ -1233,6 +1344,13 @@ void PhysicalSocketServer::Add(Dispatcher *pdispatcher) {
   if (pos != dispatchers_.end())
     return;
   dispatchers_.push_back(pdispatcher);
+#if defined(WEBRTC_USE_EPOLL)
+  if (epoll_fd_ != -1) {
+    // Registered with the kernel on the next ApplyPendingEpollUpdates().
+    epoll_registrations_[pdispatcher] = 0;
+    epoll_pending_updates_.push_back(pdispatcher);
+  }
+#endif
 }
 
 void PhysicalSocketServer::Remove(Dispatcher *pdispatcher) {
@@ -1256,10 +1374,96 @@ void PhysicalSocketServer::Remove(Dispatcher *pdispatcher) {
       --**it;
     }
   }
+#if defined(WEBRTC_USE_EPOLL)
+  EpollRegistrationMap::iterator reg = epoll_registrations_.find(pdispatcher);
+  if (reg != epoll_registrations_.end()) {
+    // The descriptor is usually closed right after this, but it may have been
+    // dup()ed, so always unregister explicitly. Any entry still sitting in
+    // |epoll_pending_updates_| is skipped because it is no longer found in
+    // |epoll_registrations_|.
+    if (reg->second != 0) {
+      struct epoll_event event = {0};
+      if (epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, pdispatcher->GetDescriptor(),
+                    &event) == -1 && errno != EBADF && errno != ENOENT) {
+        LOG_E(LS_ERROR, EN, errno) << "epoll_ctl EPOLL_CTL_DEL";
+      }
+    }
+    epoll_registrations_.erase(reg);
+  }
+#endif
+}
+
+void PhysicalSocketServer::Update(Dispatcher* pdispatcher) {
+#if defined(WEBRTC_USE_EPOLL)
+  CritScope cs(&crit_);
+  if (epoll_registrations_.find(pdispatcher) == epoll_registrations_.end())
+    return;
+  epoll_pending_updates_.push_back(pdispatcher);
+#endif
 }
 
 #if defined(WEBRTC_POSIX)
+// Translates descriptor readiness into dispatcher events and delivers them.
+static void ProcessEvents(Dispatcher* pdispatcher,
+                          bool readable,
+                          bool writable) {
+  int fd = pdispatcher->GetDescriptor();
+  uint32 ff = 0;
+  int errcode = 0;
+
+  // Reap any error code, which can be signaled through reads or writes.
+  // TODO: Should we set errcode if getsockopt fails?
+  if (readable || writable) {
+    socklen_t len = sizeof(errcode);
+    ::getsockopt(fd, SOL_SOCKET, SO_ERROR, &errcode, &len);
+  }
+
+  // Check readable descriptors. If we're waiting on an accept, signal
+  // that. Otherwise we're waiting for data, check to see if we're
+  // readable or really closed.
+  // TODO: Only peek at TCP descriptors.
+  if (readable) {
+    if (pdispatcher->GetRequestedEvents() & DE_ACCEPT) {
+      ff |= DE_ACCEPT;
+    } else if (errcode || pdispatcher->IsDescriptorClosed()) {
+      ff |= DE_CLOSE;
+    } else {
+      ff |= DE_READ;
+    }
+  }
+
+  // Check writable descriptors. If we're waiting on a connect, detect
+  // success versus failure by the reaped error code.
+  if (writable) {
+    if (pdispatcher->GetRequestedEvents() & DE_CONNECT) {
+      if (!errcode) {
+        ff |= DE_CONNECT;
+      } else {
+        ff |= DE_CLOSE;
+      }
+    } else {
+      ff |= DE_WRITE;
+    }
+  }
+
+  // Tell the descriptor about the event.
+  if (ff != 0) {
+    pdispatcher->OnPreEvent(ff);
+    pdispatcher->OnEvent(ff, errcode);
+  }
+}
+
 bool PhysicalSocketServer::Wait(int cmsWait, bool process_io) {
+#if defined(WEBRTC_USE_EPOLL)
+  // When only the wakeup event is of interest there is nothing to gain from
+  // epoll, and select() lets us skip all other dispatchers.
+  if (epoll_fd_ != -1 && process_io && !force_select_)
+    return WaitEpoll(cmsWait);
+#endif
+  return WaitSelect(cmsWait, process_io);
+}
+
+bool PhysicalSocketServer::WaitSelect(int cmsWait, bool process_io) {
   // Calculate timing information
 
   struct timeval *ptvWait = NULL;
@@ -1345,51 +1549,13 @@ bool PhysicalSocketServer::Wait(int cmsWait, bool process_io) {
       for (size_t i = 0; i < dispatchers_.size(); ++i) {
         Dispatcher *pdispatcher = dispatchers_[i];
         int fd = pdispatcher->GetDescriptor();
-        uint32 ff = 0;
-        int errcode = 0;
-
-        // Reap any error code, which can be signaled through reads or writes.
-        // TODO: Should we set errcode if getsockopt fails?
-        if (FD_ISSET(fd, &fdsRead) || FD_ISSET(fd, &fdsWrite)) {
-          socklen_t len = sizeof(errcode);
-          ::getsockopt(fd, SOL_SOCKET, SO_ERROR, &errcode, &len);
-        }
-
-        // Check readable descriptors. If we're waiting on an accept, signal
-        // that. Otherwise we're waiting for data, check to see if we're
-        // readable or really closed.
-        // TODO: Only peek at TCP descriptors.
-        if (FD_ISSET(fd, &fdsRead)) {
+        bool readable = FD_ISSET(fd, &fdsRead);
+        if (readable)
           FD_CLR(fd, &fdsRead);
-          if (pdispatcher->GetRequestedEvents() & DE_ACCEPT) {
-            ff |= DE_ACCEPT;
-          } else if (errcode || pdispatcher->IsDescriptorClosed()) {
-            ff |= DE_CLOSE;
-          } else {
-            ff |= DE_READ;
-          }
-        }
-
-        // Check writable descriptors. If we're waiting on a connect, detect
-        // success versus failure by the reaped error code.
-        if (FD_ISSET(fd, &fdsWrite)) {
+        bool writable = FD_ISSET(fd, &fdsWrite);
+        if (writable)
           FD_CLR(fd, &fdsWrite);
-          if (pdispatcher->GetRequestedEvents() & DE_CONNECT) {
-            if (!errcode) {
-              ff |= DE_CONNECT;
-            } else {
-              ff |= DE_CLOSE;
-            }
-          } else {
-            ff |= DE_WRITE;
-          }
-        }
-
-        // Tell the descriptor about the event.
-        if (ff != 0) {
-          pdispatcher->OnPreEvent(ff);
-          pdispatcher->OnEvent(ff, errcode);
-        }
+        ProcessEvents(pdispatcher, readable, writable);
       }
     }
 
@@ -1417,6 +1583,120 @@ bool PhysicalSocketServer::Wait(int cmsWait, bool process_io) {
   return true;
 }
 
+#if defined(WEBRTC_USE_EPOLL)
+
+static uint32 GetEpollEvents(uint32 ff) {
+  uint32 events = 0;
+  if (ff & (DE_READ | DE_ACCEPT))
+    events |= EPOLLIN;
+  if (ff & (DE_WRITE | DE_CONNECT))
+    events |= EPOLLOUT;
+  return events;
+}
+
+void PhysicalSocketServer::ApplyPendingEpollUpdates() {
+  for (size_t i = 0; i < epoll_pending_updates_.size(); ++i) {
+    Dispatcher* pdispatcher = epoll_pending_updates_[i];
+    EpollRegistrationMap::iterator reg =
+        epoll_registrations_.find(pdispatcher);
+    if (reg == epoll_registrations_.end())
+      continue;  // Removed since it was queued.
+
+    uint32 events = GetEpollEvents(pdispatcher->GetRequestedEvents());
+    if (events == reg->second)
+      continue;
+
+    // Level-triggered on purpose: a dispatcher only re-enables DE_READ after
+    // a single Recv(), and consumers are not required to drain the descriptor,
+    // so an edge-triggered registration would lose the remaining data.
+    struct epoll_event event = {0};
+    event.events = events;
+    event.data.ptr = pdispatcher;
+    int op = EPOLL_CTL_MOD;
+    if (reg->second == 0) {
+      op = EPOLL_CTL_ADD;
+    } else if (events == 0) {
+      op = EPOLL_CTL_DEL;
+    }
+    if (epoll_ctl(epoll_fd_, op, pdispatcher->GetDescriptor(), &event) == -1) {
+      LOG_E(LS_ERROR, EN, errno) << "epoll_ctl " << op;
+      continue;
+    }
+    reg->second = events;
+  }
+  epoll_pending_updates_.clear();
+}
+
+bool PhysicalSocketServer::WaitEpoll(int cmsWait) {
+  uint32 msStop = 0;
+  if (cmsWait != kForever)
+    msStop = TimeAfter(cmsWait);
+
+  fWait_ = true;
+
+  while (fWait_) {
+    {
+      CritScope cr(&crit_);
+      ApplyPendingEpollUpdates();
+    }
+
+    // Wait then call handlers as appropriate
+    // < 0 means error
+    // 0 means timeout
+    // > 0 means count of descriptors ready
+    int n = epoll_wait(epoll_fd_, &epoll_events_[0],
+                       static_cast<int>(epoll_events_.size()), cmsWait);
+
+    if (n < 0) {
+      if (errno != EINTR) {
+        LOG_E(LS_ERROR, EN, errno) << "epoll_wait";
+        return false;
+      }
+      // Else ignore the error and keep going. If this EINTR was for one of the
+      // signals managed by this PhysicalSocketServer, the
+      // PosixSignalDeliveryDispatcher will be in the signaled state in the next
+      // iteration.
+    } else if (n == 0) {
+      // If timeout, return success
+      return true;
+    } else {
+      // We have signaled descriptors
+      CritScope cr(&crit_);
+      for (int i = 0; i < n; ++i) {
+        const struct epoll_event& event = epoll_events_[i];
+        Dispatcher* pdispatcher = static_cast<Dispatcher*>(event.data.ptr);
+        // An earlier handler in this batch may have removed the dispatcher.
+        if (epoll_registrations_.find(pdispatcher) ==
+            epoll_registrations_.end()) {
+          continue;
+        }
+
+        // Errors and hangups are reported regardless of the registered events;
+        // surface them through whichever direction the dispatcher waits on, as
+        // select() does.
+        bool readable = (event.events & EPOLLIN) != 0;
+        bool writable = (event.events & EPOLLOUT) != 0;
+        if (event.events & (EPOLLERR | EPOLLHUP)) {
+          uint32 ff = pdispatcher->GetRequestedEvents();
+          readable = readable || (ff & (DE_READ | DE_ACCEPT)) != 0;
+          writable = writable || (ff & (DE_WRITE | DE_CONNECT)) != 0;
+        }
+        ProcessEvents(pdispatcher, readable, writable);
+      }
+    }
+
+    // Recalc the time remaining to wait.
+    if (cmsWait != kForever) {
+      // A negative timeout would make epoll_wait() block forever.
+      cmsWait = std::max(TimeUntil(msStop), 0);
+    }
+  }
+
+  return true;
+}
+
+#endif  // WEBRTC_USE_EPOLL
+
 static void GlobalSignalHandler(int signum) {
   PosixSignalHandler::Instance()->OnPosixSignalReceived(signum);
 }
@@ -11,6 +11,13 @@
 #ifndef WEBRTC_BASE_PHYSICALSOCKETSERVER_H__
 #define WEBRTC_BASE_PHYSICALSOCKETSERVER_H__
 
+#if defined(WEBRTC_LINUX)
+// On Linux, use epoll instead of select() to wait for descriptors.
+#include <sys/epoll.h>
+#define WEBRTC_USE_EPOLL 1
+#endif
+
+#include <map>
 #include <vector>
 
 #include "webrtc/base/asyncfile.h"
@@ -76,6 +83,17 @@ class PhysicalSocketServer : public SocketServer {
 
   void Add(Dispatcher* dispatcher);
   void Remove(Dispatcher* dispatcher);
+  // Must be called by a dispatcher whenever the result of its
+  // GetRequestedEvents() changes, so that backends which keep registrations
+  // with the kernel (epoll) can pick up the change before the next wait.
+  void Update(Dispatcher* dispatcher);
+
+#if defined(WEBRTC_USE_EPOLL)
+  // Makes Wait() use select() even though epoll is available. Only intended
+  // for comparing the two backends; registrations are kept up to date either
+  // way, so this can be toggled at any time.
+  void set_force_select(bool force_select) { force_select_ = force_select; }
+#endif
 
 #if defined(WEBRTC_POSIX)
   AsyncFile* CreateFile(int fd);
@@ -103,7 +121,31 @@ class PhysicalSocketServer : public SocketServer {
 #if defined(WEBRTC_POSIX)
   static bool InstallSignal(int signum, void (*handler)(int));
 
+  bool WaitSelect(int cms, bool process_io);
+
   scoped_ptr<PosixSignalDispatcher> signal_dispatcher_;
+#endif
+#if defined(WEBRTC_USE_EPOLL)
+  typedef std::map<Dispatcher*, uint32> EpollRegistrationMap;
+
+  bool WaitEpoll(int cms);
+  // Brings the kernel registration of every dispatcher in
+  // |epoll_pending_updates_| in line with its requested events.
+  void ApplyPendingEpollUpdates();
+
+  int epoll_fd_;
+  bool force_select_;
+  std::vector<struct epoll_event> epoll_events_;
+  // Epoll events currently registered with |epoll_fd_|, per dispatcher. A
+  // dispatcher that requests no events is kept here with a value of 0 but is
+  // not registered with the kernel, so that level-triggered conditions such
+  // as EPOLLHUP cannot spin the loop.
+  EpollRegistrationMap epoll_registrations_;
+  // Dispatchers whose requested events may have changed since they were last
+  // synced with |epoll_fd_|. Updates are applied right before epoll_wait(), so
+  // that a read event which disables DE_READ and a RecvFrom() which enables it
+  // again cost no system calls.
+  std::vector<Dispatcher*> epoll_pending_updates_;
 #endif
   DispatcherList dispatchers_;
   IteratorList iterators_;
@@ -10,6 +10,9 @@
 
 #include <signal.h>
 #include <stdarg.h>
+#if defined(WEBRTC_POSIX)
+#include <sys/resource.h>
+#endif
 
 #include "webrtc/base/gunit.h"
 #include "webrtc/base/logging.h"
@@ -18,6 +21,7 @@
 #include "webrtc/base/socket_unittest.h"
 #include "webrtc/base/testutils.h"
 #include "webrtc/base/thread.h"
+#include "webrtc/base/timeutils.h"
 #include "webrtc/test/testsupport/gtest_disable.h"
 
 namespace rtc {
@@ -153,6 +157,167 @@ TEST_F(PhysicalSocketTest, TestGetSetOptionsIPv6) {
   SocketTest::TestGetSetOptionsIPv6();
 }
 
+#if defined(WEBRTC_USE_EPOLL)
+
+// Binds a number of UDP sockets to the loopback address and counts the
+// packets read from them.
+class UdpSocketSet : public sigslot::has_slots<> {
+ public:
+  UdpSocketSet(PhysicalSocketServer* ss, size_t count)
+      : ss_(ss), received_(0) {
+    for (size_t i = 0; i < count; ++i) {
+      AsyncSocket* socket = ss_->CreateAsyncSocket(AF_INET, SOCK_DGRAM);
+      if (!socket)
+        break;
+      if (socket->Bind(SocketAddress(IPAddress(INADDR_LOOPBACK), 0)) != 0) {
+        delete socket;
+        break;
+      }
+      socket->SignalReadEvent.connect(this, &UdpSocketSet::OnReadEvent);
+      sockets_.push_back(socket);
+    }
+  }
+
+  ~UdpSocketSet() {
+    for (size_t i = 0; i < sockets_.size(); ++i)
+      delete sockets_[i];
+  }
+
+  size_t size() const { return sockets_.size(); }
+  AsyncSocket* socket(size_t index) { return sockets_[index]; }
+  int received() const { return received_; }
+
+  // Sends one datagram to socket |index| and waits until it has been read.
+  bool SendAndReceive(Socket* sender, size_t index) {
+    int expected = received_ + 1;
+    const char kData[] = "x";
+    if (sender->SendTo(kData, sizeof(kData),
+                       sockets_[index]->GetLocalAddress()) < 0) {
+      return false;
+    }
+    uint32 stop = TimeAfter(kTimeoutMs);
+    while (received_ < expected && TimeUntil(stop) > 0)
+      ss_->Wait(TimeUntil(stop), true);
+    return received_ == expected;
+  }
+
+ private:
+  static const int kTimeoutMs = 1000;
+
+  void OnReadEvent(AsyncSocket* socket) {
+    char buffer[64];
+    while (socket->Recv(buffer, sizeof(buffer)) > 0)
+      ++received_;
+    // Make Wait() return as soon as the packet has been handled.
+    ss_->WakeUp();
+  }
+
+  PhysicalSocketServer* ss_;
+  std::vector<AsyncSocket*> sockets_;
+  int received_;
+};
+
+// Raises the descriptor limit as far as allowed and returns how many
+// descriptors can be used.
+static size_t RaiseDescriptorLimit() {
+  struct rlimit limit;
+  if (getrlimit(RLIMIT_NOFILE, &limit) != 0)
+    return 0;
+  if (limit.rlim_cur < limit.rlim_max) {
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+    getrlimit(RLIMIT_NOFILE, &limit);
+  }
+  return static_cast<size_t>(limit.rlim_cur);
+}
+
+// Descriptors beyond FD_SETSIZE cannot be waited on with select(), so this is
+// only possible with epoll.
+TEST(PhysicalSocketServerEpollTest, TestReadBeyondFdSetSize) {
+  const size_t kNumSockets = FD_SETSIZE + 100;
+  if (RaiseDescriptorLimit() < kNumSockets + 100) {
+    LOG(LS_WARNING) << "Descriptor limit too low, skipping test.";
+    return;
+  }
+  PhysicalSocketServer ss;
+  UdpSocketSet sockets(&ss, kNumSockets);
+  ASSERT_EQ(kNumSockets, sockets.size());
+  scoped_ptr<Socket> sender(ss.CreateSocket(AF_INET, SOCK_DGRAM));
+  ASSERT_TRUE(sender);
+  EXPECT_TRUE(sockets.SendAndReceive(sender.get(), kNumSockets - 1));
+  EXPECT_TRUE(sockets.SendAndReceive(sender.get(), 0));
+  // A socket that was read from must be reported again when new data arrives.
+  EXPECT_TRUE(sockets.SendAndReceive(sender.get(), kNumSockets - 1));
+  EXPECT_EQ(3, sockets.received());
+}
+
+// Removing one socket must not affect the registration of the others.
+TEST(PhysicalSocketServerEpollTest, TestReadAfterClose) {
+  PhysicalSocketServer ss;
+  UdpSocketSet sockets(&ss, 3);
+  ASSERT_EQ(3u, sockets.size());
+  scoped_ptr<Socket> sender(ss.CreateSocket(AF_INET, SOCK_DGRAM));
+  ASSERT_TRUE(sender);
+  EXPECT_TRUE(sockets.SendAndReceive(sender.get(), 1));
+  sockets.socket(1)->Close();
+  EXPECT_TRUE(sockets.SendAndReceive(sender.get(), 0));
+  EXPECT_TRUE(sockets.SendAndReceive(sender.get(), 2));
+}
+
+static double CpuTimeMicros() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_utime.tv_sec * 1e6 + usage.ru_utime.tv_usec +
+      usage.ru_stime.tv_sec * 1e6 + usage.ru_stime.tv_usec;
+}
+
+// Measures the time from sending a datagram to one of N idle sockets until it
+// has been dispatched, and the CPU used per wakeup, for select() and epoll.
+// Disabled by default since it needs a high descriptor limit and takes a
+// while; run with --gtest_also_run_disabled_tests.
+TEST(PhysicalSocketServerEpollTest, DISABLED_WakeupPerf) {
+  const size_t kSocketCounts[] = { 100, 1000, 10000 };
+  const int kWakeups = 2000;
+  size_t max_sockets = RaiseDescriptorLimit();
+  for (size_t i = 0; i < ARRAY_SIZE(kSocketCounts); ++i) {
+    size_t count = kSocketCounts[i];
+    if (count + 100 > max_sockets) {
+      LOG(LS_WARNING) << "Descriptor limit too low for " << count
+                      << " sockets.";
+      continue;
+    }
+    for (int use_select = 0; use_select < 2; ++use_select) {
+      if (use_select && count + 100 > FD_SETSIZE) {
+        LOG(LS_INFO) << count << " sockets, select: exceeds FD_SETSIZE";
+        continue;
+      }
+      PhysicalSocketServer ss;
+      ss.set_force_select(use_select != 0);
+      UdpSocketSet sockets(&ss, count);
+      ASSERT_EQ(count, sockets.size());
+      scoped_ptr<Socket> sender(ss.CreateSocket(AF_INET, SOCK_DGRAM));
+      ASSERT_TRUE(sender);
+
+      uint64 start = TimeNanos();
+      double start_cpu = CpuTimeMicros();
+      for (int j = 0; j < kWakeups; ++j) {
+        // Spread the wakeups over all sockets.
+        ASSERT_TRUE(sockets.SendAndReceive(sender.get(),
+                                           (j * 7919) % count));
+      }
+      double wall_us = (TimeNanos() - start) / 1000.0;
+      double cpu_us = CpuTimeMicros() - start_cpu;
+
+      LOG(LS_INFO) << count << " sockets, "
+                   << (use_select ? "select" : "epoll")
+                   << ": wakeup latency " << wall_us / kWakeups
+                   << " us, cpu " << cpu_us / kWakeups << " us per wakeup";
+    }
+  }
+}
+
+#endif  // WEBRTC_USE_EPOLL
+
 #if defined(WEBRTC_POSIX)
 
 class PosixSignalDeliveryTest : public testing::Test {
@@ -123,6 +123,22 @@ inline bool IsBlockingError(int e) {
   return (e == EWOULDBLOCK) || (e == EAGAIN) || (e == EINPROGRESS);
 }
 
+// One datagram in a batched Socket::RecvFromBatch() or SendToBatch() call.
+struct Datagram {
+  Datagram() : data(NULL), size(0), truncated(false) {}
+
+  // Buffer to receive into, or payload to send.
+  char* data;
+  // When receiving: the capacity of |data| on input and the number of bytes
+  // received on output. When sending: the length of the payload.
+  size_t size;
+  // Source address of a received datagram, or destination of a sent one. A
+  // nil destination sends to the connected peer.
+  SocketAddress addr;
+  // Set on receive when the datagram did not fit in |data|.
+  bool truncated;
+};
+
 // General interface for the socket implementations of various networks.  The
 // methods match those of normal UNIX sockets very closely.
 class Socket {
@@ -143,6 +159,38 @@ class Socket {
   virtual int SendTo(const void *pv, size_t cb, const SocketAddress& addr) = 0;
   virtual int Recv(void *pv, size_t cb) = 0;
   virtual int RecvFrom(void *pv, size_t cb, SocketAddress *paddr) = 0;
+  // Receives up to |count| datagrams. Returns the number of datagrams
+  // received, or SOCKET_ERROR if none could be. Implementations that can do
+  // this in a single system call should override the default, which calls
+  // RecvFrom() until it fails.
+  virtual int RecvFromBatch(Datagram* datagrams, size_t count) {
+    size_t received = 0;
+    for (; received < count; ++received) {
+      Datagram* datagram = &datagrams[received];
+      int len = RecvFrom(datagram->data, datagram->size, &datagram->addr);
+      if (len < 0)
+        break;
+      datagram->size = static_cast<size_t>(len);
+      datagram->truncated = false;
+    }
+    return (received == 0 && count != 0) ? SOCKET_ERROR :
+        static_cast<int>(received);
+  }
+  // Sends up to |count| datagrams, in order. Returns the number of datagrams
+  // sent, or SOCKET_ERROR if none could be. The default calls SendTo() until
+  // it fails.
+  virtual int SendToBatch(const Datagram* datagrams, size_t count) {
+    size_t sent = 0;
+    for (; sent < count; ++sent) {
+      const Datagram& datagram = datagrams[sent];
+      int len = datagram.addr.IsNil() ?
+          Send(datagram.data, datagram.size) :
+          SendTo(datagram.data, datagram.size, datagram.addr);
+      if (len < 0)
+        break;
+    }
+    return (sent == 0 && count != 0) ? SOCKET_ERROR : static_cast<int>(sent);
+  }
   virtual int Listen(int backlog) = 0;
   virtual Socket *Accept(SocketAddress *paddr) = 0;
   virtual int Close() = 0;
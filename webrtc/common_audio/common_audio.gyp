@@ -42,6 +42,7 @@
         'fft4g.h',
         'fir_filter.cc',
         'fir_filter.h',
+        'fir_filter_avx2.h',
         'fir_filter_neon.h',
         'fir_filter_sse.h',
         'include/audio_util.h',
@@ -134,7 +135,7 @@
           ],
         }],
         ['target_arch=="ia32" or target_arch=="x64"', {
-          'dependencies': ['common_audio_sse2',],
+          'dependencies': ['common_audio_avx2', 'common_audio_sse2',],
         }],
         ['target_arch=="arm"', {
           'sources': [
@@ -200,6 +201,9 @@
           'sources': [
             'fir_filter_sse.cc',
             'resampler/sinc_resampler_sse.cc',
+            'signal_processing/cross_correlation_sse2.c',
+            'signal_processing/downsample_fast_sse2.c',
+            'signal_processing/min_max_operations_sse2.c',
           ],
           'conditions': [
             ['os_posix==1', {
@@ -210,6 +214,34 @@
             }],
           ],
         },
+        {
+          'target_name': 'common_audio_avx2',
+          'type': 'static_library',
+          'sources': [
+            'fir_filter_avx2.cc',
+            'resampler/sinc_resampler_avx2.cc',
+            'signal_processing/cross_correlation_avx2.c',
+            'signal_processing/downsample_fast_avx2.c',
+            'signal_processing/min_max_operations_avx2.c',
+          ],
+          'conditions': [
+            ['os_posix==1 and OS!="mac"', {
+              'cflags': [ '-mavx2', '-mfma', ],
+            }],
+            ['OS=="mac"', {
+              'xcode_settings': {
+                'OTHER_CFLAGS': [ '-mavx2', '-mfma', ],
+              },
+            }],
+            ['OS=="win"', {
+              'msvs_settings': {
+                'VCCLCompilerTool': {
+                  'AdditionalOptions': [ '/arch:AVX2', ],
+                },
+              },
+            }],
+          ],
+        },
       ],  # targets
     }],
     ['target_arch=="arm" and arm_version>=7 or target_arch=="arm64"', {
@@ -14,6 +14,7 @@
 #include <string.h>
 
 #include "webrtc/base/scoped_ptr.h"
+#include "webrtc/common_audio/fir_filter_avx2.h"
 #include "webrtc/common_audio/fir_filter_neon.h"
 #include "webrtc/common_audio/fir_filter_sse.h"
 #include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
@@ -45,6 +46,11 @@ FIRFilter* FIRFilter::Create(const float* coefficients,
   FIRFilter* filter = NULL;
 // If we know the minimum architecture at compile time, avoid CPU detection.
 #if defined(WEBRTC_ARCH_X86_FAMILY)
+  // AVX2 is always detected at run time.
+  if (WebRtc_GetCPUInfo(kAVX2) && WebRtc_GetCPUInfo(kFMA3)) {
+    return new FIRFilterAVX2(coefficients, coefficients_length,
+                             max_input_length);
+  }
 #if defined(__SSE2__)
   filter =
       new FIRFilterSSE2(coefficients, coefficients_length, max_input_length);
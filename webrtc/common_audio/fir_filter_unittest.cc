@@ -10,10 +10,17 @@
 
 #include "webrtc/common_audio/fir_filter.h"
 
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "testing/gtest/include/gtest/gtest.h"
 #include "webrtc/base/scoped_ptr.h"
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+#include "webrtc/common_audio/fir_filter_avx2.h"
+#include "webrtc/common_audio/fir_filter_sse.h"
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
+#endif
 
 namespace webrtc {
 namespace {
@@ -207,4 +214,41 @@ TEST(FIRFilterTest, SameOutputWhenSwapedCoefficientsAndInput) {
   }
 }
 
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+// The AVX2 filter pads the coefficients to a multiple of eight rather than four
+// and fuses the multiplications and additions, so it is compared with the SSE2
+// filter within a tolerance, for filter and block lengths that are not
+// multiples of either.
+TEST(FIRFilterTest, AVX2MatchesSSE2) {
+  if (!WebRtc_GetCPUInfo(kAVX2) || !WebRtc_GetCPUInfo(kFMA3)) {
+    printf("Skipping test, AVX2 and FMA3 are not supported.\n");
+    return;
+  }
+  const size_t kLengths[] = {1, 5, 9, 31};
+  const size_t kMaxInputLength = 161;
+  srand(42);
+  for (size_t l = 0; l < sizeof(kLengths) / sizeof(kLengths[0]); ++l) {
+    float coefficients[31];
+    for (size_t i = 0; i < kLengths[l]; ++i)
+      coefficients[i] = static_cast<float>(rand()) / RAND_MAX - 0.5f;
+    FIRFilterSSE2 filter_sse2(coefficients, kLengths[l], kMaxInputLength);
+    FIRFilterAVX2 filter_avx2(coefficients, kLengths[l], kMaxInputLength);
+
+    float input[kMaxInputLength];
+    float output_sse2[kMaxInputLength];
+    float output_avx2[kMaxInputLength];
+    for (size_t length = 1; length <= kMaxInputLength; length += 20) {
+      for (size_t i = 0; i < length; ++i)
+        input[i] = static_cast<float>(rand()) / RAND_MAX * 2.f - 1.f;
+      filter_sse2.Filter(input, length, output_sse2);
+      filter_avx2.Filter(input, length, output_avx2);
+      for (size_t i = 0; i < length; ++i) {
+        EXPECT_NEAR(output_sse2[i], output_avx2[i], 1e-5f)
+            << "coefficients " << kLengths[l] << ", length " << length;
+      }
+    }
+  }
+}
+#endif
+
 }  // namespace webrtc
@@ -17,6 +17,7 @@
 #include "webrtc/common_audio/include/audio_util.h"
 #include "webrtc/common_audio/resampler/push_sinc_resampler.h"
 #include "webrtc/common_audio/resampler/sinusoidal_linear_chirp_source.h"
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
 #include "webrtc/system_wrappers/interface/tick_util.h"
 #include "webrtc/typedefs.h"
 
@@ -129,6 +130,47 @@ TEST_P(PushSincResamplerTest, DISABLED_BenchmarkFloat) {
   ResampleBenchmarkTest(false);
 }
 
+// Reports the cost per output sample of every conversion AudioBuffer can make,
+// between the supported stream rates and the processing rates, on 10 ms
+// float chunks.
+TEST(PushSincResamplerBenchmark, DISABLED_AudioBufferRates) {
+  const int kRates[] = {8000, 16000, 32000, 44100, 48000};
+  const int kNumRates = sizeof(kRates) / sizeof(*kRates);
+  const int kResampleIterations = 20000;
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  printf("AVX2 and FMA3 %s.\n",
+         WebRtc_GetCPUInfo(kAVX2) && WebRtc_GetCPUInfo(kFMA3) ?
+             "available" : "not available");
+#endif
+  for (int i = 0; i < kNumRates; ++i) {
+    for (int j = 0; j < kNumRates; ++j) {
+      if (i == j)
+        continue;
+      const int input_samples = kRates[i] / 100;
+      const int output_samples = kRates[j] / 100;
+      rtc::scoped_ptr<float[]> source(new float[input_samples]);
+      rtc::scoped_ptr<float[]> destination(new float[output_samples]);
+      for (int k = 0; k < input_samples; ++k)
+        source[k] = std::sin(0.1f * k);
+
+      PushSincResampler resampler(input_samples, output_samples);
+      TickTime start = TickTime::Now();
+      for (int k = 0; k < kResampleIterations; ++k) {
+        EXPECT_EQ(output_samples,
+                  resampler.Resample(source.get(), input_samples,
+                                     destination.get(), output_samples));
+      }
+      const double total_time_ns =
+          (TickTime::Now() - start).Microseconds() * 1000.0;
+      printf("%6d Hz -> %6d Hz: %.2f ns per output sample.\n", kRates[i],
+             kRates[j],
+             total_time_ns / (static_cast<double>(kResampleIterations) *
+                              output_samples));
+    }
+  }
+}
+
 // Tests resampling using a given input and output sample rate.
 void PushSincResamplerTest::ResampleTest(bool int_format) {
   // Make comparisons using one second of data.
@@ -162,6 +162,41 @@ TEST(SincResamplerTest, Convolve) {
 }
 #endif
 
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+// Convolve_AVX2() fuses the multiplications and additions, so it rounds
+// differently from both Convolve_C() and Convolve_SSE().
+TEST(SincResamplerTest, ConvolveAVX2) {
+  if (!WebRtc_GetCPUInfo(kAVX2) || !WebRtc_GetCPUInfo(kFMA3)) {
+    printf("Skipping test, AVX2 and FMA3 are not supported.\n");
+    return;
+  }
+
+  MockSource mock_source;
+  SincResampler resampler(kSampleRateRatio, SincResampler::kDefaultRequestSize,
+                          &mock_source);
+  static const double kEpsilon = 0.0000001;
+
+  // Aligned, and unaligned by one and two floats for the 32-byte loads.
+  for (int offset = 0; offset < 3; ++offset) {
+    const float* input = resampler.kernel_storage_.get() + offset;
+    const float* kernel = resampler.kernel_storage_.get();
+    double result = resampler.Convolve_C(input, kernel, kernel,
+                                         kKernelInterpolationFactor);
+    double result_avx2 = resampler.Convolve_AVX2(input, kernel, kernel,
+                                                 kKernelInterpolationFactor);
+    EXPECT_NEAR(result_avx2, result, kEpsilon) << "offset " << offset;
+
+    // Two different kernels, 16-byte aligned only, with an uneven
+    // interpolation factor.
+    const float* k1 = kernel + SincResampler::kKernelSize + 4;
+    const float* k2 = k1 + SincResampler::kKernelSize;
+    result = resampler.Convolve_C(input, k1, k2, 0.3);
+    result_avx2 = resampler.Convolve_AVX2(input, k1, k2, 0.3);
+    EXPECT_NEAR(result_avx2, result, kEpsilon) << "offset " << offset;
+  }
+}
+#endif
+
 // Benchmark for the various Convolve() methods.  Make sure to build with
 // branding=Chrome so that DCHECKs are compiled out when benchmarking.  Original
 // benchmarks were run with --convolve-iterations=50000000.
@@ -223,6 +258,22 @@ TEST(SincResamplerTest, ConvolveBenchmark) {
          total_time_c_us / total_time_optimized_aligned_us,
          total_time_optimized_unaligned_us / total_time_optimized_aligned_us);
 #endif
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (!WebRtc_GetCPUInfo(kAVX2) || !WebRtc_GetCPUInfo(kFMA3))
+    return;
+
+  start = TickTime::Now();
+  for (int j = 0; j < kConvolveIterations; ++j) {
+    resampler.Convolve_AVX2(
+        resampler.kernel_storage_.get() + 1, resampler.kernel_storage_.get(),
+        resampler.kernel_storage_.get(), kKernelInterpolationFactor);
+  }
+  double total_time_avx2_us = (TickTime::Now() - start).Microseconds();
+  printf("Convolve_AVX2 (unaligned) took %.2fms; which is %.2fx faster than "
+         "Convolve_C.\n", total_time_avx2_us / 1000,
+         total_time_c_us / total_time_avx2_us);
+#endif
 }
 
 #undef CONVOLVE_FUNC
@@ -338,6 +389,8 @@ static const double kResamplingRMSError = -14.58;
 
 // Thresholds chosen arbitrarily based on what each resampling reported during
 // testing.  All thresholds are in dbFS, http://en.wikipedia.org/wiki/DBFS.
+// Convolve_AVX2() sums in a different order than Convolve_SSE(), which moves
+// some of them in the last digit.
 INSTANTIATE_TEST_CASE_P(
     SincResamplerTest, SincResamplerTest, testing::Values(
         // To 44.1kHz
@@ -346,7 +399,7 @@ INSTANTIATE_TEST_CASE_P(
         std::tr1::make_tuple(16000, 44100, kResamplingRMSError, -62.54),
         std::tr1::make_tuple(22050, 44100, kResamplingRMSError, -73.53),
         std::tr1::make_tuple(32000, 44100, kResamplingRMSError, -63.32),
-        std::tr1::make_tuple(44100, 44100, kResamplingRMSError, -73.53),
+        std::tr1::make_tuple(44100, 44100, kResamplingRMSError, -73.52),
         std::tr1::make_tuple(48000, 44100, -15.01, -64.04),
         std::tr1::make_tuple(96000, 44100, -18.49, -25.51),
         std::tr1::make_tuple(192000, 44100, -20.50, -13.31),
@@ -0,0 +1,98 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/common_audio/signal_processing/include/signal_processing_library.h"
+
+#include <immintrin.h>
+
+// Returns the sum of all 32-bit elements in |sum_256| and |sum_128|.
+static inline int32_t HorizontalSumAVX2(__m256i sum_256, __m128i sum_128) {
+  sum_128 = _mm_add_epi32(sum_128, _mm256_castsi256_si128(sum_256));
+  sum_128 = _mm_add_epi32(sum_128, _mm256_extracti128_si256(sum_256, 1));
+  sum_128 = _mm_add_epi32(sum_128,
+                          _mm_shuffle_epi32(sum_128, _MM_SHUFFLE(1, 0, 3, 2)));
+  sum_128 = _mm_add_epi32(sum_128,
+                          _mm_shuffle_epi32(sum_128, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(sum_128);
+}
+
+// Same as DotProductWithScaleSSE2(), 16 samples at a time. Eight more samples
+// are done with 128-bit vectors before the scalar tail.
+static inline int32_t DotProductWithScaleAVX2(const int16_t* vector1,
+                                              const int16_t* vector2,
+                                              int length,
+                                              int scaling) {
+  int i = 0;
+  int32_t sum = 0;
+  __m256i sum_256 = _mm256_setzero_si256();
+  __m128i sum_128 = _mm_setzero_si128();
+
+  if (scaling == 0) {
+    for (; i + 16 <= length; i += 16) {
+      __m256i v1 = _mm256_loadu_si256((const __m256i*)&vector1[i]);
+      __m256i v2 = _mm256_loadu_si256((const __m256i*)&vector2[i]);
+      sum_256 = _mm256_add_epi32(sum_256, _mm256_madd_epi16(v1, v2));
+    }
+    if (i + 8 <= length) {
+      __m128i v1 = _mm_loadu_si128((const __m128i*)&vector1[i]);
+      __m128i v2 = _mm_loadu_si128((const __m128i*)&vector2[i]);
+      sum_128 = _mm_madd_epi16(v1, v2);
+      i += 8;
+    }
+  } else {
+    const __m128i shift = _mm_cvtsi32_si128(scaling);
+    for (; i + 16 <= length; i += 16) {
+      __m256i v1 = _mm256_loadu_si256((const __m256i*)&vector1[i]);
+      __m256i v2 = _mm256_loadu_si256((const __m256i*)&vector2[i]);
+      __m256i low = _mm256_mullo_epi16(v1, v2);
+      __m256i high = _mm256_mulhi_epi16(v1, v2);
+      __m256i product0 =
+          _mm256_sra_epi32(_mm256_unpacklo_epi16(low, high), shift);
+      __m256i product1 =
+          _mm256_sra_epi32(_mm256_unpackhi_epi16(low, high), shift);
+      sum_256 = _mm256_add_epi32(sum_256,
+                                 _mm256_add_epi32(product0, product1));
+    }
+    if (i + 8 <= length) {
+      __m128i v1 = _mm_loadu_si128((const __m128i*)&vector1[i]);
+      __m128i v2 = _mm_loadu_si128((const __m128i*)&vector2[i]);
+      __m128i low = _mm_mullo_epi16(v1, v2);
+      __m128i high = _mm_mulhi_epi16(v1, v2);
+      sum_128 = _mm_add_epi32(
+          _mm_sra_epi32(_mm_unpacklo_epi16(low, high), shift),
+          _mm_sra_epi32(_mm_unpackhi_epi16(low, high), shift));
+      i += 8;
+    }
+  }
+  sum = HorizontalSumAVX2(sum_256, sum_128);
+
+  for (; i < length; i++) {
+    sum += (vector1[i] * vector2[i]) >> scaling;
+  }
+  return sum;
+}
+
+/* AVX2 version of WebRtcSpl_CrossCorrelation() for x86 platforms. */
+void WebRtcSpl_CrossCorrelationAVX2(int32_t* cross_correlation,
+                                    const int16_t* seq1,
+                                    const int16_t* seq2,
+                                    int16_t dim_seq,
+                                    int16_t dim_cross_correlation,
+                                    int16_t right_shifts,
+                                    int16_t step_seq2) {
+  int i = 0;
+
+  for (i = 0; i < dim_cross_correlation; i++) {
+    cross_correlation[i] = DotProductWithScaleAVX2(seq1,
+                                                   seq2 + step_seq2 * i,
+                                                   dim_seq,
+                                                   right_shifts);
+  }
+}
@@ -0,0 +1,76 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/common_audio/signal_processing/include/signal_processing_library.h"
+
+#include <emmintrin.h>
+
+// Returns the sum of the four 32-bit elements in |sum|.
+static inline int32_t HorizontalSumSSE2(__m128i sum) {
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(sum);
+}
+
+// Bit-exact with the C version: every product is shifted before it is added,
+// and the 32-bit sums wrap around in the same way.
+static inline int32_t DotProductWithScaleSSE2(const int16_t* vector1,
+                                              const int16_t* vector2,
+                                              int length,
+                                              int scaling) {
+  int i = 0;
+  int32_t sum = 0;
+  __m128i sum_128 = _mm_setzero_si128();
+
+  if (scaling == 0) {
+    // _mm_madd_epi16() adds pairs of products, which is exact when nothing is
+    // shifted out.
+    for (; i + 8 <= length; i += 8) {
+      __m128i v1 = _mm_loadu_si128((const __m128i*)&vector1[i]);
+      __m128i v2 = _mm_loadu_si128((const __m128i*)&vector2[i]);
+      sum_128 = _mm_add_epi32(sum_128, _mm_madd_epi16(v1, v2));
+    }
+  } else {
+    const __m128i shift = _mm_cvtsi32_si128(scaling);
+    for (; i + 8 <= length; i += 8) {
+      __m128i v1 = _mm_loadu_si128((const __m128i*)&vector1[i]);
+      __m128i v2 = _mm_loadu_si128((const __m128i*)&vector2[i]);
+      __m128i low = _mm_mullo_epi16(v1, v2);
+      __m128i high = _mm_mulhi_epi16(v1, v2);
+      __m128i product0 = _mm_sra_epi32(_mm_unpacklo_epi16(low, high), shift);
+      __m128i product1 = _mm_sra_epi32(_mm_unpackhi_epi16(low, high), shift);
+      sum_128 = _mm_add_epi32(sum_128, _mm_add_epi32(product0, product1));
+    }
+  }
+  sum = HorizontalSumSSE2(sum_128);
+
+  for (; i < length; i++) {
+    sum += (vector1[i] * vector2[i]) >> scaling;
+  }
+  return sum;
+}
+
+/* SSE2 version of WebRtcSpl_CrossCorrelation() for x86 platforms. */
+void WebRtcSpl_CrossCorrelationSSE2(int32_t* cross_correlation,
+                                    const int16_t* seq1,
+                                    const int16_t* seq2,
+                                    int16_t dim_seq,
+                                    int16_t dim_cross_correlation,
+                                    int16_t right_shifts,
+                                    int16_t step_seq2) {
+  int i = 0;
+
+  for (i = 0; i < dim_cross_correlation; i++) {
+    cross_correlation[i] = DotProductWithScaleSSE2(seq1,
+                                                   seq2 + step_seq2 * i,
+                                                   dim_seq,
+                                                   right_shifts);
+  }
+}
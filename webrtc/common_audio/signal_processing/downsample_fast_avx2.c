@@ -0,0 +1,121 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/common_audio/signal_processing/include/signal_processing_library.h"
+
+#include <immintrin.h>
+
+// Filters longer than this are handled by the C version.
+#define MAX_COEFFICIENTS_LENGTH 32
+
+// Returns the partial sums of the filter outputs for |data_in[i]| in the low
+// lane and |data_in[i + offset]| in the high lane. |window| points to
+// |data_in[i - coefficients_length + 1]| and |reversed| holds the
+// coefficients in reverse order, zero padded to |num_blocks| * 8.
+static inline __m256i FilterWindowPairAVX2(const int16_t* window,
+                                           int offset,
+                                           const int16_t* reversed,
+                                           int num_blocks) {
+  __m256i sum = _mm256_setzero_si256();
+  int k = 0;
+  for (k = 0; k < num_blocks; k++) {
+    __m256i data = _mm256_inserti128_si256(
+        _mm256_castsi128_si256(
+            _mm_loadu_si128((const __m128i*)&window[8 * k])),
+        _mm_loadu_si128((const __m128i*)&window[offset + 8 * k]), 1);
+    __m256i coefficients = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128((const __m128i*)&reversed[8 * k]));
+    sum = _mm256_add_epi32(sum, _mm256_madd_epi16(data, coefficients));
+  }
+  return sum;
+}
+
+// AVX2 version of WebRtcSpl_DownsampleFast() for x86 platforms. Works like
+// the SSE2 version, but computes eight outputs at a time.
+int WebRtcSpl_DownsampleFastAVX2(const int16_t* data_in,
+                                 int data_in_length,
+                                 int16_t* data_out,
+                                 int data_out_length,
+                                 const int16_t* __restrict coefficients,
+                                 int coefficients_length,
+                                 int factor,
+                                 int delay) {
+  int16_t reversed[MAX_COEFFICIENTS_LENGTH];
+  const __m256i round = _mm256_set1_epi32(2048);  // 0.5 in Q12.
+  int i = 0;
+  int j = 0;
+  int n = 0;
+  int num_blocks = 0;
+  int window_length = 0;
+  int32_t out_s32 = 0;
+  int endpos = delay + factor * (data_out_length - 1) + 1;
+
+  // Return error if any of the running conditions doesn't meet.
+  if (data_out_length <= 0 || coefficients_length <= 0
+                           || data_in_length < endpos) {
+    return -1;
+  }
+  if (coefficients_length > MAX_COEFFICIENTS_LENGTH) {
+    return WebRtcSpl_DownsampleFastC(data_in, data_in_length, data_out,
+                                     data_out_length, coefficients,
+                                     coefficients_length, factor, delay);
+  }
+
+  num_blocks = (coefficients_length + 7) >> 3;
+  window_length = num_blocks * 8;
+  for (j = 0; j < window_length; j++) {
+    reversed[j] = j < coefficients_length ?
+        coefficients[coefficients_length - 1 - j] : 0;
+  }
+
+  // The zero padded coefficients make the windows read past |data_in[i]|, so
+  // the vector loop stops where the last window would pass the end of the
+  // input.
+  for (i = delay; n + 8 <= data_out_length &&
+       i + 7 * factor - coefficients_length + window_length < data_in_length;
+       i += 8 * factor, n += 8) {
+    const int16_t* window = &data_in[i - coefficients_length + 1];
+    const int offset = 4 * factor;
+    // Outputs n + k and n + k + 4 share one register.
+    __m256i sum0 = FilterWindowPairAVX2(window, offset, reversed, num_blocks);
+    __m256i sum1 = FilterWindowPairAVX2(window + factor, offset, reversed,
+                                        num_blocks);
+    __m256i sum2 = FilterWindowPairAVX2(window + 2 * factor, offset, reversed,
+                                        num_blocks);
+    __m256i sum3 = FilterWindowPairAVX2(window + 3 * factor, offset, reversed,
+                                        num_blocks);
+
+    // Add within each lane, so that element k of the low lane holds the sum
+    // for output n + k and element k of the high lane the one for n + k + 4.
+    __m256i out = _mm256_hadd_epi32(_mm256_hadd_epi32(sum0, sum1),
+                                    _mm256_hadd_epi32(sum2, sum3));
+    out = _mm256_srai_epi32(_mm256_add_epi32(out, round), 12);  // Q0.
+
+    // Saturate and store the output.
+    out = _mm256_permute4x64_epi64(_mm256_packs_epi32(out, out),
+                                   _MM_SHUFFLE(3, 1, 2, 0));
+    _mm_storeu_si128((__m128i*)&data_out[n], _mm256_castsi256_si128(out));
+  }
+
+  for (; n < data_out_length; i += factor, n++) {
+    out_s32 = 2048;  // Round value, 0.5 in Q12.
+
+    for (j = 0; j < coefficients_length; j++) {
+      out_s32 += coefficients[j] * data_in[i - j];  // Q12.
+    }
+
+    out_s32 >>= 12;  // Q0.
+
+    // Saturate and store the output.
+    data_out[n] = WebRtcSpl_SatW32ToW16(out_s32);
+  }
+
+  return 0;
+}
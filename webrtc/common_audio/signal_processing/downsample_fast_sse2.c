@@ -0,0 +1,112 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/common_audio/signal_processing/include/signal_processing_library.h"
+
+#include <emmintrin.h>
+
+// Filters longer than this are handled by the C version.
+#define MAX_COEFFICIENTS_LENGTH 32
+
+// Returns the partial sums of the filter output for |data_in[i]|, where
+// |window| points to |data_in[i - coefficients_length + 1]| and |reversed|
+// holds the coefficients in reverse order, zero padded to |num_blocks| * 8.
+static inline __m128i FilterWindowSSE2(const int16_t* window,
+                                       const int16_t* reversed,
+                                       int num_blocks) {
+  __m128i sum = _mm_setzero_si128();
+  int k = 0;
+  for (k = 0; k < num_blocks; k++) {
+    __m128i data = _mm_loadu_si128((const __m128i*)&window[8 * k]);
+    __m128i coefficients = _mm_loadu_si128((const __m128i*)&reversed[8 * k]);
+    sum = _mm_add_epi32(sum, _mm_madd_epi16(data, coefficients));
+  }
+  return sum;
+}
+
+// SSE2 version of WebRtcSpl_DownsampleFast() for x86 platforms. Four outputs
+// are computed at a time, each as a dot product between the input and the
+// reversed filter. The sums wrap and saturate exactly as in the C version.
+int WebRtcSpl_DownsampleFastSSE2(const int16_t* data_in,
+                                 int data_in_length,
+                                 int16_t* data_out,
+                                 int data_out_length,
+                                 const int16_t* __restrict coefficients,
+                                 int coefficients_length,
+                                 int factor,
+                                 int delay) {
+  int16_t reversed[MAX_COEFFICIENTS_LENGTH];
+  const __m128i round = _mm_set1_epi32(2048);  // 0.5 in Q12.
+  int i = 0;
+  int j = 0;
+  int n = 0;
+  int num_blocks = 0;
+  int window_length = 0;
+  int32_t out_s32 = 0;
+  int endpos = delay + factor * (data_out_length - 1) + 1;
+
+  // Return error if any of the running conditions doesn't meet.
+  if (data_out_length <= 0 || coefficients_length <= 0
+                           || data_in_length < endpos) {
+    return -1;
+  }
+  if (coefficients_length > MAX_COEFFICIENTS_LENGTH) {
+    return WebRtcSpl_DownsampleFastC(data_in, data_in_length, data_out,
+                                     data_out_length, coefficients,
+                                     coefficients_length, factor, delay);
+  }
+
+  num_blocks = (coefficients_length + 7) >> 3;
+  window_length = num_blocks * 8;
+  for (j = 0; j < window_length; j++) {
+    reversed[j] = j < coefficients_length ?
+        coefficients[coefficients_length - 1 - j] : 0;
+  }
+
+  // The zero padded coefficients make the windows read past |data_in[i]|, so
+  // the vector loop stops where the last window would pass the end of the
+  // input.
+  for (i = delay; n + 4 <= data_out_length &&
+       i + 3 * factor - coefficients_length + window_length < data_in_length;
+       i += 4 * factor, n += 4) {
+    const int16_t* window = &data_in[i - coefficients_length + 1];
+    __m128i sum0 = FilterWindowSSE2(window, reversed, num_blocks);
+    __m128i sum1 = FilterWindowSSE2(window + factor, reversed, num_blocks);
+    __m128i sum2 = FilterWindowSSE2(window + 2 * factor, reversed, num_blocks);
+    __m128i sum3 = FilterWindowSSE2(window + 3 * factor, reversed, num_blocks);
+
+    // Transpose and add, so that element k holds the sum for output n + k.
+    __m128i t0 = _mm_add_epi32(_mm_unpacklo_epi32(sum0, sum1),
+                               _mm_unpackhi_epi32(sum0, sum1));
+    __m128i t1 = _mm_add_epi32(_mm_unpacklo_epi32(sum2, sum3),
+                               _mm_unpackhi_epi32(sum2, sum3));
+    __m128i out = _mm_add_epi32(_mm_unpacklo_epi64(t0, t1),
+                                _mm_unpackhi_epi64(t0, t1));
+    out = _mm_srai_epi32(_mm_add_epi32(out, round), 12);  // Q0.
+
+    // Saturate and store the output.
+    _mm_storel_epi64((__m128i*)&data_out[n], _mm_packs_epi32(out, out));
+  }
+
+  for (; n < data_out_length; i += factor, n++) {
+    out_s32 = 2048;  // Round value, 0.5 in Q12.
+
+    for (j = 0; j < coefficients_length; j++) {
+      out_s32 += coefficients[j] * data_in[i - j];  // Q12.
+    }
+
+    out_s32 >>= 12;  // Q0.
+
+    // Saturate and store the output.
+    data_out[n] = WebRtcSpl_SatW32ToW16(out_s32);
+  }
+
+  return 0;
+}
@@ -0,0 +1,67 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <immintrin.h>
+#include <stdlib.h>
+
+#include "webrtc/common_audio/signal_processing/include/signal_processing_library.h"
+
+// Maximum absolute value of word16 vector. AVX2 version for x86 platforms.
+int16_t WebRtcSpl_MaxAbsValueW16AVX2(const int16_t* vector, int length) {
+  int i = 0, absolute = 0, maximum = 0;
+  __m256i max0 = _mm256_setzero_si256();
+  __m256i max1 = _mm256_setzero_si256();
+  __m128i max_128;
+
+  if (vector == NULL || length <= 0) {
+    return -1;
+  }
+
+  // Note _mm256_abs_epi16() doesn't change the value of -32768, so compare
+  // as unsigned to keep it.
+  for (; i + 32 <= length; i += 32) {
+    __m256i v0 = _mm256_loadu_si256((const __m256i*)&vector[i]);
+    __m256i v1 = _mm256_loadu_si256((const __m256i*)&vector[i + 16]);
+    max0 = _mm256_max_epu16(max0, _mm256_abs_epi16(v0));
+    max1 = _mm256_max_epu16(max1, _mm256_abs_epi16(v1));
+  }
+  if (i + 16 <= length) {
+    __m256i v0 = _mm256_loadu_si256((const __m256i*)&vector[i]);
+    max0 = _mm256_max_epu16(max0, _mm256_abs_epi16(v0));
+    i += 16;
+  }
+  max0 = _mm256_max_epu16(max0, max1);
+  max_128 = _mm_max_epu16(_mm256_castsi256_si128(max0),
+                          _mm256_extracti128_si256(max0, 1));
+  if (i + 8 <= length) {
+    __m128i v0 = _mm_loadu_si128((const __m128i*)&vector[i]);
+    max_128 = _mm_max_epu16(max_128, _mm_abs_epi16(v0));
+    i += 8;
+  }
+  // The horizontal minimum of the complement is the complement of the
+  // maximum.
+  max_128 = _mm_minpos_epu16(_mm_xor_si128(max_128, _mm_set1_epi16(-1)));
+  maximum = 0xFFFF & ~_mm_cvtsi128_si32(max_128);
+
+  for (; i < length; i++) {
+    absolute = abs((int)vector[i]);
+
+    if (absolute > maximum) {
+      maximum = absolute;
+    }
+  }
+
+  // Guard the case for abs(-32768).
+  if (maximum > WEBRTC_SPL_WORD16_MAX) {
+    maximum = WEBRTC_SPL_WORD16_MAX;
+  }
+
+  return (int16_t)maximum;
+}
@@ -0,0 +1,60 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <emmintrin.h>
+#include <stdlib.h>
+
+#include "webrtc/common_audio/signal_processing/include/signal_processing_library.h"
+
+// Maximum absolute value of word16 vector. SSE2 version for x86 platforms.
+int16_t WebRtcSpl_MaxAbsValueW16SSE2(const int16_t* vector, int length) {
+  int i = 0, absolute = 0, maximum = 0;
+  const __m128i zero = _mm_setzero_si128();
+  __m128i max0 = zero;
+  __m128i max1 = zero;
+
+  if (vector == NULL || length <= 0) {
+    return -1;
+  }
+
+  // The saturating negation turns -32768 into 32767, which is the value the C
+  // version returns for abs(-32768).
+  for (; i + 16 <= length; i += 16) {
+    __m128i v0 = _mm_loadu_si128((const __m128i*)&vector[i]);
+    __m128i v1 = _mm_loadu_si128((const __m128i*)&vector[i + 8]);
+    max0 = _mm_max_epi16(max0, _mm_max_epi16(v0, _mm_subs_epi16(zero, v0)));
+    max1 = _mm_max_epi16(max1, _mm_max_epi16(v1, _mm_subs_epi16(zero, v1)));
+  }
+  if (i + 8 <= length) {
+    __m128i v0 = _mm_loadu_si128((const __m128i*)&vector[i]);
+    max0 = _mm_max_epi16(max0, _mm_max_epi16(v0, _mm_subs_epi16(zero, v0)));
+    i += 8;
+  }
+  max0 = _mm_max_epi16(max0, max1);
+  max0 = _mm_max_epi16(max0, _mm_shuffle_epi32(max0, _MM_SHUFFLE(1, 0, 3, 2)));
+  max0 = _mm_max_epi16(max0, _mm_shuffle_epi32(max0, _MM_SHUFFLE(2, 3, 0, 1)));
+  max0 = _mm_max_epi16(max0, _mm_srli_epi32(max0, 16));
+  maximum = (int16_t)_mm_cvtsi128_si32(max0);
+
+  for (; i < length; i++) {
+    absolute = abs((int)vector[i]);
+
+    if (absolute > maximum) {
+      maximum = absolute;
+    }
+  }
+
+  // Guard the case for abs(-32768).
+  if (maximum > WEBRTC_SPL_WORD16_MAX) {
+    maximum = WEBRTC_SPL_WORD16_MAX;
+  }
+
+  return (int16_t)maximum;
+}
@@ -8,8 +8,15 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <stdio.h>
+#include <stdlib.h>
+
 #include "testing/gtest/include/gtest/gtest.h"
 #include "webrtc/common_audio/signal_processing/include/signal_processing_library.h"
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+#endif
 
 static const int kVector16Size = 9;
 static const int16_t vector16[kVector16Size] = {1, -15511, 4323, 1963,
@@ -473,11 +480,11 @@ TEST_F(SplTest, CrossCorrelationTest) {
                              kCrossCorrelationDimension, kShift, kStep);
 
   // WebRtcSpl_CrossCorrelationC() and WebRtcSpl_CrossCorrelationNeon()
-  // are not bit-exact.
+  // are not bit-exact. The x86 versions are.
   const int32_t kExpected[kCrossCorrelationDimension] =
       {-266947903, -15579555, -171282001};
   const int32_t* expected = kExpected;
-#if !defined(MIPS32_LE)
+#if !defined(MIPS32_LE) && !defined(WEBRTC_ARCH_X86_FAMILY)
   const int32_t kExpectedNeon[kCrossCorrelationDimension] =
       {-266947901, -15579553, -171281999};
   if (WebRtcSpl_CrossCorrelation != WebRtcSpl_CrossCorrelationC) {
@@ -608,3 +615,232 @@ TEST_F(SplTest, Resample48WithSaturationTest) {
     EXPECT_EQ(kRefValue16kHz2, out_vector_w16[i]);
   }
 }
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+namespace {
+
+typedef void (*CrossCorrelationFunction)(int32_t*, const int16_t*,
+                                         const int16_t*, int16_t, int16_t,
+                                         int16_t, int16_t);
+typedef int (*DownsampleFastFunction)(const int16_t*, int, int16_t*, int,
+                                      const int16_t*, int, int, int);
+typedef int16_t (*MaxAbsValueW16Function)(const int16_t*, int);
+
+struct X86Kernels {
+  const char* name;
+  CrossCorrelationFunction cross_correlation;
+  DownsampleFastFunction downsample_fast;
+  MaxAbsValueW16Function max_abs_value_w16;
+};
+
+const X86Kernels kX86Kernels[] = {
+  {"C", WebRtcSpl_CrossCorrelationC, WebRtcSpl_DownsampleFastC,
+   WebRtcSpl_MaxAbsValueW16C},
+  {"SSE2", WebRtcSpl_CrossCorrelationSSE2, WebRtcSpl_DownsampleFastSSE2,
+   WebRtcSpl_MaxAbsValueW16SSE2},
+  {"AVX2", WebRtcSpl_CrossCorrelationAVX2, WebRtcSpl_DownsampleFastAVX2,
+   WebRtcSpl_MaxAbsValueW16AVX2},
+};
+const int kNumX86Kernels = sizeof(kX86Kernels) / sizeof(kX86Kernels[0]);
+
+bool X86KernelsSupported(int index) {
+  if (index == 1)
+    return WebRtc_GetCPUInfo(kSSE2) != 0;
+  if (index == 2)
+    return WebRtc_GetCPUInfo(kAVX2) != 0;
+  return true;
+}
+
+// Fills |vector| with random samples, with runs of the extreme values mixed in
+// to exercise saturation and wrap around.
+void RandomVector(int16_t* vector, int length) {
+  for (int i = 0; i < length; ++i) {
+    switch (rand() % 8) {
+      case 0:
+        vector[i] = WEBRTC_SPL_WORD16_MIN;
+        break;
+      case 1:
+        vector[i] = WEBRTC_SPL_WORD16_MAX;
+        break;
+      default:
+        vector[i] = static_cast<int16_t>(rand() - RAND_MAX / 2);
+        break;
+    }
+  }
+}
+
+double NanosecondsPerCall(const webrtc::TickTime& start, int iterations) {
+  return static_cast<double>((webrtc::TickTime::Now() - start).Microseconds()) *
+      1000 / iterations;
+}
+
+}  // namespace
+
+// The SSE2 and AVX2 versions must be bit-exact with the C version for all
+// lengths, including those that leave a scalar tail.
+TEST_F(SplTest, X86CrossCorrelationMatchesC) {
+  const int kMaxLength = 130;
+  const int kDimCrossCorrelation = 10;
+  int16_t seq1[kMaxLength];
+  int16_t seq2[kMaxLength + 2 * kDimCrossCorrelation];
+  int32_t expected[kDimCrossCorrelation];
+  int32_t actual[kDimCrossCorrelation];
+  srand(42);
+  for (int length = 1; length <= kMaxLength; length += 3) {
+    RandomVector(seq1, length);
+    RandomVector(seq2, length + 2 * kDimCrossCorrelation);
+    for (int shift = 0; shift <= 6; shift += 6) {
+      for (int step = -1; step <= 1; step += 2) {
+        const int16_t* seq2_start =
+            step < 0 ? &seq2[kDimCrossCorrelation] : seq2;
+        WebRtcSpl_CrossCorrelationC(expected, seq1, seq2_start, length,
+                                    kDimCrossCorrelation, shift, step);
+        for (int k = 1; k < kNumX86Kernels; ++k) {
+          if (!X86KernelsSupported(k))
+            continue;
+          kX86Kernels[k].cross_correlation(actual, seq1, seq2_start, length,
+                                           kDimCrossCorrelation, shift, step);
+          for (int i = 0; i < kDimCrossCorrelation; ++i) {
+            EXPECT_EQ(expected[i], actual[i]) << kX86Kernels[k].name
+                << ", length " << length << ", shift " << shift
+                << ", step " << step;
+          }
+        }
+      }
+    }
+  }
+}
+
+// Covers the filter lengths and decimation factors NetEq uses, filters longer
+// than the vector versions handle, and output lengths that end in the scalar
+// tail.
+TEST_F(SplTest, X86DownsampleFastMatchesC) {
+  const int kCoefficientsLengths[] = {1, 3, 4, 5, 7, 9, 16, 17, 32, 33};
+  const int kFactors[] = {1, 2, 4, 8, 12};
+  const int kMaxOutputLength = 37;
+  const int kMaxInputLength = 12 * kMaxOutputLength + 37;
+  int16_t coefficients[33];
+  int16_t data_in[kMaxInputLength];
+  int16_t expected[kMaxOutputLength];
+  int16_t actual[kMaxOutputLength];
+  srand(42);
+  RandomVector(data_in, kMaxInputLength);
+  for (size_t c = 0; c < sizeof(kCoefficientsLengths) / sizeof(int); ++c) {
+    const int coefficients_length = kCoefficientsLengths[c];
+    for (int i = 0; i < coefficients_length; ++i)
+      coefficients[i] = static_cast<int16_t>(rand() % 8192 - 4096);
+    for (size_t f = 0; f < sizeof(kFactors) / sizeof(int); ++f) {
+      const int factor = kFactors[f];
+      for (int delay = 0; delay <= 4; delay += 4) {
+        for (int out_length = 1; out_length <= kMaxOutputLength;
+             out_length += 4) {
+          // Like NetEq, start the input |coefficients_length| - 1 samples
+          // into the buffer, so that every sample the filters read is valid.
+          const int16_t* input = &data_in[coefficients_length - 1];
+          const int input_length = delay + factor * (out_length - 1) + 1;
+          EXPECT_EQ(0, WebRtcSpl_DownsampleFastC(input, input_length, expected,
+                                                 out_length, coefficients,
+                                                 coefficients_length, factor,
+                                                 delay));
+          for (int k = 1; k < kNumX86Kernels; ++k) {
+            if (!X86KernelsSupported(k))
+              continue;
+            EXPECT_EQ(0, kX86Kernels[k].downsample_fast(input, input_length,
+                                                        actual, out_length,
+                                                        coefficients,
+                                                        coefficients_length,
+                                                        factor, delay));
+            for (int i = 0; i < out_length; ++i) {
+              EXPECT_EQ(expected[i], actual[i]) << kX86Kernels[k].name
+                  << ", coefficients " << coefficients_length << ", factor "
+                  << factor << ", delay " << delay << ", output " << i;
+            }
+            EXPECT_EQ(-1, kX86Kernels[k].downsample_fast(input,
+                                                         input_length - 1,
+                                                         actual, out_length,
+                                                         coefficients,
+                                                         coefficients_length,
+                                                         factor, delay));
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST_F(SplTest, X86MaxAbsValueW16MatchesC) {
+  const int kMaxLength = 100;
+  int16_t vector[kMaxLength];
+  srand(42);
+  for (int length = 1; length <= kMaxLength; ++length) {
+    for (int i = 0; i < length; ++i)
+      vector[i] = static_cast<int16_t>(rand() % 2001 - 1000);
+    // Then put each extreme value at a random position.
+    const int position = rand() % length;
+    for (int extreme = 0; extreme < 3; ++extreme) {
+      if (extreme == 1)
+        vector[position] = WEBRTC_SPL_WORD16_MAX;
+      if (extreme == 2)
+        vector[position] = WEBRTC_SPL_WORD16_MIN;
+      const int16_t expected = WebRtcSpl_MaxAbsValueW16C(vector, length);
+      for (int k = 1; k < kNumX86Kernels; ++k) {
+        if (!X86KernelsSupported(k))
+          continue;
+        EXPECT_EQ(expected, kX86Kernels[k].max_abs_value_w16(vector, length))
+            << kX86Kernels[k].name << ", length " << length;
+        EXPECT_EQ(-1, kX86Kernels[k].max_abs_value_w16(vector, 0));
+      }
+    }
+  }
+}
+
+// Reports the cost per call of each version, for the sizes NetEq's
+// DspHelper::DownsampleTo4kHz() and the time stretching correlation use.
+TEST_F(SplTest, DISABLED_X86KernelsBenchmark) {
+  const int kIterations = 200000;
+  const int kInputLength = 960;
+  int16_t data[kInputLength + 100];
+  int16_t output16[kInputLength];
+  int32_t output32[60];
+  static const int16_t kCoefficients[7] = {
+    284, 1213, 2466, 3087, 2466, 1213, 284};
+  srand(42);
+  RandomVector(data, kInputLength + 100);
+
+  for (int k = 0; k < kNumX86Kernels; ++k) {
+    if (!X86KernelsSupported(k)) {
+      printf("%s not supported.\n", kX86Kernels[k].name);
+      continue;
+    }
+    webrtc::TickTime start = webrtc::TickTime::Now();
+    for (int n = 0; n < kIterations; ++n) {
+      kX86Kernels[k].cross_correlation(output32, data, &data[50], 50, 60, 6,
+                                       -1);
+    }
+    const double cross_correlation_ns =
+        NanosecondsPerCall(start, kIterations);
+
+    start = webrtc::TickTime::Now();
+    for (int n = 0; n < kIterations; ++n) {
+      kX86Kernels[k].downsample_fast(&data[6], kInputLength - 6, output16,
+                                     kInputLength / 12, kCoefficients, 7, 12,
+                                     0);
+    }
+    const double downsample_fast_ns =
+        NanosecondsPerCall(start, kIterations);
+
+    int16_t max_abs = 0;
+    start = webrtc::TickTime::Now();
+    for (int n = 0; n < kIterations; ++n)
+      max_abs |= kX86Kernels[k].max_abs_value_w16(data, kInputLength);
+    const double max_abs_ns =
+        NanosecondsPerCall(start, kIterations);
+
+    printf("%-4s CrossCorrelation(50 x 60): %7.1f ns, "
+           "DownsampleFast(960 / 12, 7 taps): %7.1f ns, "
+           "MaxAbsValueW16(960): %7.1f ns (%d)\n",
+           kX86Kernels[k].name, cross_correlation_ns, downsample_fast_ns,
+           max_abs_ns, max_abs);
+  }
+}
+#endif  // WEBRTC_ARCH_X86_FAMILY
@@ -9,7 +9,7 @@
  */
 
 /* The global function contained in this file initializes SPL function
- * pointers, currently only for ARM platforms.
+ * pointers for ARM, MIPS and x86 platforms.
  *
  * Some code came from common/rtcd.c in the WebM project.
  */
@@ -86,6 +86,24 @@ static void InitPointersToMIPS() {
 }
 #endif
 
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+/* Initialize function pointers to the SSE2 or AVX2 versions where the CPU
+ * supports them, and to the generic C versions otherwise. */
+static void InitPointersToX86() {
+  InitPointersToC();
+  if (WebRtc_GetCPUInfo(kSSE2)) {
+    WebRtcSpl_MaxAbsValueW16 = WebRtcSpl_MaxAbsValueW16SSE2;
+    WebRtcSpl_CrossCorrelation = WebRtcSpl_CrossCorrelationSSE2;
+    WebRtcSpl_DownsampleFast = WebRtcSpl_DownsampleFastSSE2;
+  }
+  if (WebRtc_GetCPUInfo(kAVX2)) {
+    WebRtcSpl_MaxAbsValueW16 = WebRtcSpl_MaxAbsValueW16AVX2;
+    WebRtcSpl_CrossCorrelation = WebRtcSpl_CrossCorrelationAVX2;
+    WebRtcSpl_DownsampleFast = WebRtcSpl_DownsampleFastAVX2;
+  }
+}
+#endif
+
 static void InitFunctionPointers(void) {
 #if defined(WEBRTC_DETECT_ARM_NEON)
   if ((WebRtc_GetCPUFeaturesARM() & kCPUFeatureNEON) != 0) {
@@ -97,6 +115,8 @@ static void InitFunctionPointers(void) {
   InitPointersToNeon();
 #elif defined(MIPS32_LE)
   InitPointersToMIPS();
+#elif defined(WEBRTC_ARCH_X86_FAMILY)
+  InitPointersToX86();
 #else
   InitPointersToC();
 #endif  /* WEBRTC_DETECT_ARM_NEON */
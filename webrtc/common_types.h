@@ -294,6 +294,44 @@ class SendSideDelayObserver {
                                     uint32_t ssrc) = 0;
 };
 
+// Local times, in ms, at which a video frame passed the stages of the video
+// pipeline. The frame carries them along as it is captured, encoded and sent,
+// or received, decoded and rendered. Stages the frame has not passed are 0.
+struct FrameTiming {
+  FrameTiming()
+      : capture_ms(0),
+        deliver_ms(0),
+        encode_start_ms(0),
+        encode_finish_ms(0),
+        send_ms(0),
+        receive_ms(0),
+        decode_start_ms(0),
+        decode_finish_ms(0),
+        render_ms(0) {}
+
+  // Send side.
+  int64_t capture_ms;        // Handed to the capturer.
+  int64_t deliver_ms;        // Delivered to the encoders by the capture thread.
+  int64_t encode_start_ms;   // Passed to the encoder.
+  int64_t encode_finish_ms;  // Returned by the encoder.
+  int64_t send_ms;           // Handed to the RTP modules for packetization.
+
+  // Receive side.
+  int64_t receive_ms;        // Completed in the jitter buffer.
+  int64_t decode_start_ms;   // Passed to the decoder.
+  int64_t decode_finish_ms;  // Returned by the decoder.
+  int64_t render_ms;         // Handed to the renderer.
+};
+
+// Callback, used to notify an observer of the timing of every frame leaving
+// the send pipeline or the receive pipeline.
+class FrameTimingObserver {
+ public:
+  virtual ~FrameTimingObserver() {}
+  virtual void FrameTimingUpdated(const FrameTiming& timing,
+                                  uint32_t ssrc) = 0;
+};
+
 // ==================================================================
 // Voice specific types
 // ==================================================================
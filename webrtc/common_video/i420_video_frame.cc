@@ -67,6 +67,7 @@ int I420VideoFrame::CreateEmptyFrame(int width, int height,
   ntp_time_ms_ = 0;
   render_time_ms_ = 0;
   rotation_ = kVideoRotation_0;
+  timing_ = FrameTiming();
 
   // Check if it's safe to reuse allocation.
   if (video_frame_buffer_ &&
@@ -149,6 +150,7 @@ int I420VideoFrame::CopyFrame(const I420VideoFrame& videoFrame) {
   ntp_time_ms_ = videoFrame.ntp_time_ms_;
   render_time_ms_ = videoFrame.render_time_ms_;
   rotation_ = videoFrame.rotation_;
+  timing_ = videoFrame.timing_;
   return 0;
 }
 
@@ -158,6 +160,7 @@ void I420VideoFrame::ShallowCopy(const I420VideoFrame& videoFrame) {
   ntp_time_ms_ = videoFrame.ntp_time_ms_;
   render_time_ms_ = videoFrame.render_time_ms_;
   rotation_ = videoFrame.rotation_;
+  timing_ = videoFrame.timing_;
 }
 
 void I420VideoFrame::Reset() {
@@ -166,10 +169,29 @@ void I420VideoFrame::Reset() {
   ntp_time_ms_ = 0;
   render_time_ms_ = 0;
   rotation_ = kVideoRotation_0;
+  timing_ = FrameTiming();
 }
 
 uint8_t* I420VideoFrame::buffer(PlaneType type) {
-  return video_frame_buffer_ ? video_frame_buffer_->data(type) : nullptr;
+  if (!video_frame_buffer_)
+    return nullptr;
+  // Copy on write: frames that only read the pixel data share one buffer, and
+  // a frame gets its own copy of it the first time it asks for write access.
+  if (!video_frame_buffer_->HasOneRef() &&
+      !video_frame_buffer_->native_handle()) {
+    const VideoFrameBuffer* shared_buffer = video_frame_buffer_.get();
+    rtc::scoped_refptr<VideoFrameBuffer> own_buffer =
+        new rtc::RefCountedObject<I420Buffer>(
+            width(), height(), stride(kYPlane), stride(kUPlane),
+            stride(kVPlane));
+    for (int plane = kYPlane; plane < kNumOfPlanes; ++plane) {
+      const PlaneType plane_type = static_cast<PlaneType>(plane);
+      memcpy(own_buffer->data(plane_type), shared_buffer->data(plane_type),
+             allocated_size(plane_type));
+    }
+    video_frame_buffer_ = own_buffer;
+  }
+  return video_frame_buffer_->data(type);
 }
 
 const uint8_t* I420VideoFrame::buffer(PlaneType type) const {
@@ -184,6 +184,67 @@ TEST(TestI420VideoFrame, ShallowCopy) {
   EXPECT_NE(frame2.rotation(), frame1.rotation());
 }
 
+TEST(TestI420VideoFrame, CopiesSharedBufferOnWrite) {
+  I420VideoFrame frame1;
+  ASSERT_EQ(0, frame1.CreateEmptyFrame(15, 15, 16, 10, 10));
+  memset(frame1.buffer(kYPlane), 16, frame1.allocated_size(kYPlane));
+  memset(frame1.buffer(kUPlane), 8, frame1.allocated_size(kUPlane));
+  memset(frame1.buffer(kVPlane), 4, frame1.allocated_size(kVPlane));
+  const I420VideoFrame* const_frame1_ptr = &frame1;
+  const uint8_t* y = const_frame1_ptr->buffer(kYPlane);
+
+  I420VideoFrame frame2;
+  frame2.ShallowCopy(frame1);
+  uint8_t* y2 = frame2.buffer(kYPlane);
+  EXPECT_NE(y, y2);
+  EXPECT_TRUE(EqualFrames(frame1, frame2));
+  EXPECT_EQ(frame1.stride(kYPlane), frame2.stride(kYPlane));
+
+  // Only |frame2| sees the write.
+  y2[0] = 0;
+  EXPECT_EQ(16, const_frame1_ptr->buffer(kYPlane)[0]);
+  EXPECT_EQ(y, const_frame1_ptr->buffer(kYPlane));
+  // Both frames own their buffers now, so writing copies nothing.
+  EXPECT_EQ(y, frame1.buffer(kYPlane));
+  EXPECT_EQ(y2, frame2.buffer(kYPlane));
+}
+
+TEST(TestI420VideoFrame, ReadingSharedBufferDoesNotCopy) {
+  I420VideoFrame frame1;
+  ASSERT_EQ(0, frame1.CreateEmptyFrame(15, 15, 15, 8, 8));
+  I420VideoFrame frame2(frame1);
+  const I420VideoFrame* const_frame1_ptr = &frame1;
+  const I420VideoFrame* const_frame2_ptr = &frame2;
+  EXPECT_EQ(const_frame1_ptr->buffer(kYPlane),
+            const_frame2_ptr->buffer(kYPlane));
+  EXPECT_EQ(frame1.video_frame_buffer(), frame2.video_frame_buffer());
+}
+
+TEST(TestI420VideoFrame, CopiesTiming) {
+  I420VideoFrame frame1;
+  EXPECT_EQ(0, frame1.CreateEmptyFrame(16, 16, 16, 8, 8));
+  frame1.mutable_timing()->capture_ms = 1;
+  frame1.mutable_timing()->deliver_ms = 2;
+
+  I420VideoFrame frame2;
+  frame2.ShallowCopy(frame1);
+  EXPECT_EQ(1, frame2.timing().capture_ms);
+  EXPECT_EQ(2, frame2.timing().deliver_ms);
+
+  // Stamping a copy does not change the original.
+  frame2.mutable_timing()->deliver_ms = 3;
+  EXPECT_EQ(2, frame1.timing().deliver_ms);
+
+  I420VideoFrame frame3;
+  EXPECT_EQ(0, frame3.CopyFrame(frame2));
+  EXPECT_EQ(1, frame3.timing().capture_ms);
+  EXPECT_EQ(3, frame3.timing().deliver_ms);
+
+  frame3.Reset();
+  EXPECT_EQ(0, frame3.timing().capture_ms);
+  EXPECT_EQ(0, frame3.timing().deliver_ms);
+}
+
 TEST(TestI420VideoFrame, Reset) {
   I420VideoFrame frame;
   ASSERT_TRUE(frame.CreateEmptyFrame(5, 5, 5, 5, 5) == 0);
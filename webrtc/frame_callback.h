@@ -33,7 +33,9 @@ struct EncodedFrame {
 class I420FrameCallback {
  public:
   // This function is called with a I420 frame allowing the user to modify the
-  // frame content.
+  // frame content. The frame may share its buffer with other frames, and
+  // I420VideoFrame::buffer() copies it on non-const access. Callbacks that only
+  // read the pixel data should do so through a const reference.
   virtual void FrameCallback(I420VideoFrame* video_frame) = 0;
 
  protected:
@@ -231,6 +231,10 @@ int16_t ACMGenericCodec::InitEncoder(WebRtcACMCodecParams* codec_params,
   return 0;
 }
 
+void ACMGenericCodec::ResetEncoderState() {
+  ResetAudioEncoder();
+}
+
 void ACMGenericCodec::ResetAudioEncoder() {
   const CodecInst& codec_inst = acm_codec_params_.codec_inst;
   if (!STR_CASE_CMP(codec_inst.plname, "PCMU")) {
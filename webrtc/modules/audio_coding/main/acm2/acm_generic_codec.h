@@ -142,6 +142,13 @@ class ACMGenericCodec {
   int16_t InitEncoder(WebRtcACMCodecParams* codec_params,
                       bool force_initialization);
 
+  ///////////////////////////////////////////////////////////////////////////
+  // void ResetEncoderState()
+  // Discards the audio and the state the encoder has built up, keeping all
+  // its settings.
+  //
+  void ResetEncoderState();
+
   ///////////////////////////////////////////////////////////////////////////
   // uint32_t NoMissedSamples()
   // This function returns the number of samples which are overwritten in
@@ -238,6 +238,7 @@ int AudioCodingModuleImpl::ResetEncoder() {
   if (!HaveValidEncoder("ResetEncoder")) {
     return -1;
   }
+  codec_manager_.current_encoder()->ResetEncoderState();
   return 0;
 }
 
@@ -43,7 +43,7 @@ void Accelerate::SetParametersForPassiveSpeech(size_t /*len*/,
 Accelerate::ReturnCodes Accelerate::CheckCriteriaAndStretch(
     const int16_t* input, size_t input_length, size_t peak_index,
     int16_t best_correlation, bool active_speech,
-    AudioMultiVector* output) const {
+    AudioMultiVector* output) {
   // Check for strong correlation or passive speech.
   if ((best_correlation > kCorrelationThreshold) || !active_speech) {
     // Do accelerate operation by overlap add.
@@ -55,12 +55,12 @@ Accelerate::ReturnCodes Accelerate::CheckCriteriaAndStretch(
     assert(fs_mult_120 >= peak_index);  // Should be handled in Process().
     // Copy first part; 0 to 15 ms.
     output->PushBackInterleaved(input, fs_mult_120 * num_channels_);
-    // Copy the |peak_index| starting at 15 ms to |temp_vector|.
-    AudioMultiVector temp_vector(num_channels_);
-    temp_vector.PushBackInterleaved(&input[fs_mult_120 * num_channels_],
+    // Copy the |peak_index| starting at 15 ms to |temp_vector_|.
+    temp_vector_.Clear();
+    temp_vector_.PushBackInterleaved(&input[fs_mult_120 * num_channels_],
                                     peak_index * num_channels_);
-    // Cross-fade |temp_vector| onto the end of |output|.
-    output->CrossFade(temp_vector, peak_index);
+    // Cross-fade |temp_vector_| onto the end of |output|.
+    output->CrossFade(temp_vector_, peak_index);
     // Copy the last unmodified part, 15 ms + pitch period until the end.
     output->PushBackInterleaved(
         &input[(fs_mult_120 + peak_index) * num_channels_],
@@ -58,7 +58,7 @@ class Accelerate : public TimeStretch {
                                       size_t peak_index,
                                       int16_t best_correlation,
                                       bool active_speech,
-                                      AudioMultiVector* output) const override;
+                                      AudioMultiVector* output) override;
 
  private:
   DISALLOW_COPY_AND_ASSIGN(Accelerate);
@@ -543,6 +543,29 @@ int CodecSampleRateHz(NetEqDecoder codec_type) {
   }
 }
 
+bool CodecIsStateless(NetEqDecoder codec_type) {
+  switch (codec_type) {
+    case kDecoderPCMu:
+    case kDecoderPCMa:
+    case kDecoderPCMu_2ch:
+    case kDecoderPCMa_2ch:
+#ifdef WEBRTC_CODEC_PCM16
+    case kDecoderPCM16B:
+    case kDecoderPCM16Bwb:
+    case kDecoderPCM16Bswb32kHz:
+    case kDecoderPCM16Bswb48kHz:
+    case kDecoderPCM16B_2ch:
+    case kDecoderPCM16Bwb_2ch:
+    case kDecoderPCM16Bswb32kHz_2ch:
+    case kDecoderPCM16Bswb48kHz_2ch:
+    case kDecoderPCM16B_5ch:
+#endif
+      return true;
+    default:
+      return false;
+  }
+}
+
 AudioDecoder* CreateAudioDecoder(NetEqDecoder codec_type) {
   if (!CodecSupported(codec_type)) {
     return NULL;
@@ -307,6 +307,11 @@ bool CodecSupported(NetEqDecoder codec_type);
 // Returns the sample rate for |codec_type|.
 int CodecSampleRateHz(NetEqDecoder codec_type);
 
+// Returns true if decoders of type |codec_type| keep no state between calls,
+// so that one AudioDecoder object can be used for any number of streams, from
+// any number of threads.
+bool CodecIsStateless(NetEqDecoder codec_type);
+
 // Creates an AudioDecoder object of type |codec_type|. Returns NULL for for
 // unsupported codecs, and when creating an AudioDecoder is not applicable
 // (e.g., for RED and DTMF/AVT types).
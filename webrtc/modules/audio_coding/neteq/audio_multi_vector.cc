@@ -74,18 +74,19 @@ void AudioMultiVector::PushBackInterleaved(const int16_t* append_this,
     return;
   }
   size_t length_per_channel = length / num_channels_;
-  int16_t* temp_array = new int16_t[length_per_channel];  // Temporary storage.
   for (size_t channel = 0; channel < num_channels_; ++channel) {
-    // Copy elements to |temp_array|.
+    // De-interleave straight into the end of the channel.
+    AudioVector* vector = channels_[channel];
+    const size_t start_index = vector->Size();
+    vector->Extend(length_per_channel);
+    int16_t* destination_ptr = &(*vector)[start_index];
     // Set |source_ptr| to first element of this channel.
     const int16_t* source_ptr = &append_this[channel];
     for (size_t i = 0; i < length_per_channel; ++i) {
-      temp_array[i] = *source_ptr;
+      destination_ptr[i] = *source_ptr;
       source_ptr += num_channels_;  // Jump to next element of this channel.
     }
-    channels_[channel]->PushBack(temp_array, length_per_channel);
   }
-  delete [] temp_array;
 }
 
 void AudioMultiVector::PushBack(const AudioMultiVector& append_this) {
@@ -91,19 +91,33 @@ class AudioVector {
   // Returns true if this AudioVector is empty.
   virtual bool Empty() const;
 
-  // Accesses and modifies an element of AudioVector.
+  // Accesses and modifies an element of AudioVector. The elements are stored
+  // contiguously, so &vector[0] points to Size() consecutive samples, until
+  // the vector is modified.
   const int16_t& operator[](size_t index) const;
   int16_t& operator[](size_t index);
 
  private:
   static const size_t kDefaultInitialSize = 10;
 
-  void Reserve(size_t n);
+  // Makes sure that |front| samples can be added before the first sample and
+  // |back| samples after the last one without moving the others. When there
+  // is not enough free space at either end, the samples are moved to the
+  // middle of the array, which is first reallocated to twice the required
+  // size if less than half of it would be free. Adding or removing samples at
+  // either end is thus amortized O(1), and a vector that has reached its
+  // largest size never allocates again.
+  void Reserve(size_t front, size_t back);
+
+  // Makes room for |length| samples at |position|, moving whichever part of
+  // the vector is shorter, and returns a pointer to the new samples.
+  int16_t* MakeRoomAt(size_t length, size_t position);
 
   rtc::scoped_ptr<int16_t[]> array_;
-  size_t first_free_ix_;  // The first index after the last sample in array_.
-                          // Note that this index may point outside of array_.
   size_t capacity_;  // Allocated number of samples in the array.
+  size_t begin_index_;  // The index of the first sample in array_.
+  size_t end_index_;  // The first index after the last sample in array_.
+                      // Note that this index may point outside of array_.
 
   DISALLOW_COPY_AND_ASSIGN(AudioVector);
 };
@@ -13,7 +13,9 @@
 #include <assert.h>
 #include <stdlib.h>
 
+#include <algorithm>
 #include <string>
+#include <vector>
 
 #include "testing/gtest/include/gtest/gtest.h"
 #include "webrtc/typedefs.h"
@@ -391,4 +393,73 @@ TEST_F(AudioVectorTest, CrossFade) {
   }
 }
 
+// Runs a random sequence of operations at both ends and in the middle of an
+// AudioVector, and compares the result with a std::vector after each one.
+TEST_F(AudioVectorTest, RandomOperationsMatchReference) {
+  srand(42);
+  AudioVector vec;
+  std::vector<int16_t> reference;
+  int16_t data[50];
+  for (size_t i = 0; i < sizeof(data) / sizeof(data[0]); ++i)
+    data[i] = static_cast<int16_t>(i + 1);
+
+  for (int n = 0; n < 1000; ++n) {
+    const size_t length = rand() % 50;
+    const size_t position = rand() % (reference.size() + 1);
+    switch (rand() % 7) {
+      case 0:
+        vec.PushBack(data, length);
+        reference.insert(reference.end(), data, data + length);
+        break;
+      case 1:
+        vec.PushFront(data, length);
+        reference.insert(reference.begin(), data, data + length);
+        break;
+      case 2:
+        vec.InsertAt(data, length, position);
+        reference.insert(reference.begin() + position, data, data + length);
+        break;
+      case 3:
+        vec.InsertZerosAt(length, position);
+        reference.insert(reference.begin() + position, length, 0);
+        break;
+      case 4: {
+        const size_t pop_length = std::min(length, reference.size());
+        vec.PopFront(length);
+        reference.erase(reference.begin(), reference.begin() + pop_length);
+        break;
+      }
+      case 5: {
+        const size_t pop_length = std::min(length, reference.size());
+        vec.PopBack(length);
+        reference.erase(reference.end() - pop_length, reference.end());
+        break;
+      }
+      case 6: {
+        // Fades into the end of the vector, wherever it currently starts in
+        // the underlying storage.
+        const size_t fade_length =
+            std::min(rand() % (length + 1), reference.size());
+        AudioVector append_this;
+        append_this.PushBack(data, length);
+        vec.CrossFade(append_this, fade_length);
+        const size_t fade_position = reference.size() - fade_length;
+        const int alpha_step = 16384 / (static_cast<int>(fade_length) + 1);
+        int alpha = 16384;
+        for (size_t i = 0; i < fade_length; ++i) {
+          alpha -= alpha_step;
+          reference[fade_position + i] =
+              (alpha * reference[fade_position + i] +
+               (16384 - alpha) * data[i] + 8192) >> 14;
+        }
+        reference.insert(reference.end(), data + fade_length, data + length);
+        break;
+      }
+    }
+    ASSERT_EQ(reference.size(), vec.Size());
+    for (size_t i = 0; i < reference.size(); ++i)
+      ASSERT_EQ(reference[i], vec[i]);
+  }
+}
+
 }  // namespace webrtc
@@ -13,17 +13,81 @@
 #include <assert.h>
 #include <utility>  // pair
 
+#include "webrtc/base/scoped_ptr.h"
 #include "webrtc/modules/audio_coding/codecs/audio_decoder.h"
+#include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
+#include "webrtc/system_wrappers/interface/static_instance.h"
 
 namespace webrtc {
 
+namespace {
+// How often ReleaseIdleDecoders() looks for idle decoders.
+const int kIdleCheckIntervalMs = 1000;
+}  // namespace
+
+const int DecoderDatabase::kMaxIdleTimeMs;
+
+// Holds one AudioDecoder object for each stateless codec type. The objects are
+// shared by all DecoderDatabase instances in the process; the holder is
+// created with the first database and deleted with the last one.
+class DecoderDatabase::SharedDecoders {
+ public:
+  static SharedDecoders* CreateInstance() { return new SharedDecoders; }
+
+  ~SharedDecoders() {
+    for (DecoderMap::iterator it = decoders_.begin(); it != decoders_.end();
+         ++it) {
+      delete it->second;
+    }
+  }
+
+  AudioDecoder* GetDecoder(NetEqDecoder codec_type) {
+    assert(CodecIsStateless(codec_type));
+    CriticalSectionScoped lock(crit_sect_.get());
+    AudioDecoder*& decoder = decoders_[codec_type];
+    if (!decoder) {
+      decoder = CreateAudioDecoder(codec_type);
+      assert(decoder);
+      decoder->Init();
+    }
+    return decoder;
+  }
+
+ private:
+  typedef std::map<NetEqDecoder, AudioDecoder*> DecoderMap;
+
+  SharedDecoders()
+      : crit_sect_(CriticalSectionWrapper::CreateCriticalSection()) {}
+
+  const rtc::scoped_ptr<CriticalSectionWrapper> crit_sect_;
+  DecoderMap decoders_;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedDecoders);
+};
+
 DecoderDatabase::DecoderDatabase()
-    : active_decoder_(-1), active_cng_decoder_(-1) {}
+    : active_decoder_(-1),
+      active_cng_decoder_(-1),
+      shared_decoders_(GetStaticInstance<SharedDecoders>(kAddRef)),
+      time_ms_(0),
+      next_idle_check_ms_(kIdleCheckIntervalMs) {}
 
-DecoderDatabase::~DecoderDatabase() {}
+DecoderDatabase::~DecoderDatabase() {
+  decoders_.clear();
+  GetStaticInstance<SharedDecoders>(kRelease);
+}
 
 DecoderDatabase::DecoderInfo::~DecoderInfo() {
-  if (!external) delete decoder;
+  if (!external && !shared) delete decoder;
+}
+
+void DecoderDatabase::DeleteDecoder(DecoderInfo* info) {
+  if (!info->external) {
+    if (!info->shared)
+      delete info->decoder;
+    info->decoder = NULL;
+    info->shared = false;
+  }
 }
 
 bool DecoderDatabase::Empty() const { return decoders_.empty(); }
@@ -131,12 +195,18 @@ AudioDecoder* DecoderDatabase::GetDecoder(uint8_t rtp_payload_type) {
   }
   DecoderInfo* info = &(*it).second;
   if (!info->decoder) {
-    // Create the decoder object.
-    AudioDecoder* decoder = CreateAudioDecoder(info->codec_type);
-    assert(decoder);  // Should not be able to have an unsupported codec here.
-    info->decoder = decoder;
-    info->decoder->Init();
+    if (CodecIsStateless(info->codec_type)) {
+      info->decoder = shared_decoders_->GetDecoder(info->codec_type);
+      info->shared = true;
+    } else {
+      // Create the decoder object.
+      AudioDecoder* decoder = CreateAudioDecoder(info->codec_type);
+      assert(decoder);  // Should not be able to have an unsupported codec here.
+      info->decoder = decoder;
+      info->decoder->Init();
+    }
   }
+  info->last_used_ms = time_ms_;
   return info->decoder;
 }
 
@@ -190,12 +260,7 @@ int DecoderDatabase::SetActiveDecoder(uint8_t rtp_payload_type,
       assert(false);
       return kDecoderNotFound;
     }
-    if (!(*it).second.external) {
-      // Delete the AudioDecoder object, unless it is an externally created
-      // decoder.
-      delete (*it).second.decoder;
-      (*it).second.decoder = NULL;
-    }
+    DeleteDecoder(&(*it).second);
     *new_decoder = true;
   }
   active_decoder_ = rtp_payload_type;
@@ -225,12 +290,7 @@ int DecoderDatabase::SetActiveCngDecoder(uint8_t rtp_payload_type) {
       assert(false);
       return kDecoderNotFound;
     }
-    if (!(*it).second.external) {
-      // Delete the AudioDecoder object, unless it is an externally created
-      // decoder.
-      delete (*it).second.decoder;
-      (*it).second.decoder = NULL;
-    }
+    DeleteDecoder(&(*it).second);
   }
   active_cng_decoder_ = rtp_payload_type;
   return kOK;
@@ -255,5 +315,19 @@ int DecoderDatabase::CheckPayloadTypes(const PacketList& packet_list) const {
   return kOK;
 }
 
+void DecoderDatabase::ReleaseIdleDecoders(int elapsed_ms) {
+  time_ms_ += elapsed_ms;
+  if (time_ms_ < next_idle_check_ms_) {
+    return;
+  }
+  next_idle_check_ms_ = time_ms_ + kIdleCheckIntervalMs;
+  for (DecoderMap::iterator it = decoders_.begin(); it != decoders_.end();
+       ++it) {
+    DecoderInfo* info = &(*it).second;
+    if (info->decoder && time_ms_ - info->last_used_ms >= kMaxIdleTimeMs) {
+      DeleteDecoder(info);
+    }
+  }
+}
 
 }  // namespace webrtc
@@ -40,13 +40,17 @@ class DecoderDatabase {
         : codec_type(kDecoderArbitrary),
           fs_hz(8000),
           decoder(NULL),
-          external(false) {
+          external(false),
+          shared(false),
+          last_used_ms(0) {
     }
     DecoderInfo(NetEqDecoder ct, int fs, AudioDecoder* dec, bool ext)
         : codec_type(ct),
           fs_hz(fs),
           decoder(dec),
-          external(ext) {
+          external(ext),
+          shared(false),
+          last_used_ms(0) {
     }
     // Destructor. (Defined in decoder_database.cc.)
     ~DecoderInfo();
@@ -55,8 +59,16 @@ class DecoderDatabase {
     int fs_hz;
     AudioDecoder* decoder;
     bool external;
+    // True if |decoder| is a stateless decoder shared with other databases.
+    bool shared;
+    // The database time when |decoder| was last requested.
+    int64_t last_used_ms;
   };
 
+  // AudioDecoder objects that have not been used for this long are deleted by
+  // ReleaseIdleDecoders().
+  static const int kMaxIdleTimeMs = 10000;
+
   // Maximum value for 8 bits, and an invalid RTP payload type (since it is
   // only 7 bits).
   static const uint8_t kRtpPayloadTypeError = 0xFF;
@@ -103,7 +115,9 @@ class DecoderDatabase {
 
   // Returns a pointer to the AudioDecoder object associated with
   // |rtp_payload_type|, or NULL if none is registered. If the AudioDecoder
-  // object does not exist for that decoder, the object is created.
+  // object does not exist for that decoder, the object is created. Stateless
+  // codecs (see CodecIsStateless()) get an object that is shared by all
+  // databases.
   virtual AudioDecoder* GetDecoder(uint8_t rtp_payload_type);
 
   // Returns true if |rtp_payload_type| is registered as a |codec_type|.
@@ -140,12 +154,26 @@ class DecoderDatabase {
   // registered in the database. Otherwise, returns kDecoderNotFound.
   virtual int CheckPayloadTypes(const PacketList& packet_list) const;
 
+  // Advances the time of the database by |elapsed_ms|, and deletes the
+  // AudioDecoder objects that have not been requested for |kMaxIdleTimeMs|.
+  // They are created again the next time they are needed. Externally created
+  // decoders are never deleted.
+  virtual void ReleaseIdleDecoders(int elapsed_ms);
+
  private:
+  class SharedDecoders;
   typedef std::map<uint8_t, DecoderInfo> DecoderMap;
 
+  // Deletes the AudioDecoder object of |info|, unless it is externally created
+  // or shared.
+  static void DeleteDecoder(DecoderInfo* info);
+
   DecoderMap decoders_;
   int active_decoder_;
   int active_cng_decoder_;
+  SharedDecoders* const shared_decoders_;
+  int64_t time_ms_;
+  int64_t next_idle_check_ms_;
 
   DISALLOW_COPY_AND_ASSIGN(DecoderDatabase);
 };
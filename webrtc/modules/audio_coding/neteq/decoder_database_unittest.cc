@@ -136,6 +136,77 @@ TEST(DecoderDatabase, ExternalDecoder) {
   EXPECT_CALL(decoder, Die()).Times(1);  // Will be called when |db| is deleted.
 }
 
+// Stateless decoders are shared between databases; other decoders are not.
+TEST(DecoderDatabase, SharedStatelessDecoders) {
+  DecoderDatabase db1;
+  DecoderDatabase db2;
+  const uint8_t kPayloadTypePcmU = 0;
+  const uint8_t kPayloadTypeCng = 13;
+  DecoderDatabase* databases[] = {&db1, &db2};
+  for (size_t i = 0; i < 2; ++i) {
+    ASSERT_EQ(DecoderDatabase::kOK,
+              databases[i]->RegisterPayload(kPayloadTypePcmU, kDecoderPCMu));
+    ASSERT_EQ(DecoderDatabase::kOK,
+              databases[i]->RegisterPayload(kPayloadTypeCng, kDecoderCNGnb));
+  }
+  AudioDecoder* pcmu = db1.GetDecoder(kPayloadTypePcmU);
+  ASSERT_TRUE(pcmu != NULL);
+  EXPECT_EQ(pcmu, db2.GetDecoder(kPayloadTypePcmU));
+  EXPECT_TRUE(db1.GetDecoderInfo(kPayloadTypePcmU)->shared);
+  EXPECT_NE(db1.GetDecoder(kPayloadTypeCng), db2.GetDecoder(kPayloadTypeCng));
+  EXPECT_FALSE(db1.GetDecoderInfo(kPayloadTypeCng)->shared);
+
+  // Removing the payload type from one database leaves the decoder usable
+  // from the other.
+  EXPECT_EQ(DecoderDatabase::kOK, db1.Remove(kPayloadTypePcmU));
+  db1.Reset();
+  const uint8_t kEncoded[] = {0xFF, 0x7F, 0x00, 0x80};
+  int16_t decoded[sizeof(kEncoded)];
+  AudioDecoder::SpeechType speech_type;
+  EXPECT_EQ(static_cast<int>(sizeof(kEncoded)),
+            db2.GetDecoder(kPayloadTypePcmU)->Decode(
+                kEncoded, sizeof(kEncoded), 8000, sizeof(decoded), decoded,
+                &speech_type));
+}
+
+TEST(DecoderDatabase, ReleaseIdleDecoders) {
+  DecoderDatabase db;
+  const uint8_t kPayloadTypeIdle = 13;
+  const uint8_t kPayloadTypeInUse = 98;
+  const uint8_t kPayloadTypeExternal = 99;
+  const int kTickMs = 10;
+  ASSERT_EQ(DecoderDatabase::kOK,
+            db.RegisterPayload(kPayloadTypeIdle, kDecoderCNGnb));
+  ASSERT_EQ(DecoderDatabase::kOK,
+            db.RegisterPayload(kPayloadTypeInUse, kDecoderCNGwb));
+  MockAudioDecoder external_decoder;
+  ASSERT_EQ(DecoderDatabase::kOK,
+            db.InsertExternal(kPayloadTypeExternal, kDecoderCNGswb32kHz,
+                              32000, &external_decoder));
+  ASSERT_TRUE(db.GetDecoder(kPayloadTypeIdle) != NULL);
+  ASSERT_TRUE(db.GetDecoder(kPayloadTypeExternal) != NULL);
+
+  // The external decoder is never deleted, and a decoder that is used all
+  // the time is kept.
+  EXPECT_CALL(external_decoder, Die()).Times(0);
+  int elapsed_ms = 0;
+  while (db.GetDecoderInfo(kPayloadTypeIdle)->decoder) {
+    ASSERT_TRUE(db.GetDecoder(kPayloadTypeInUse) != NULL);
+    db.ReleaseIdleDecoders(kTickMs);
+    elapsed_ms += kTickMs;
+    ASSERT_LE(elapsed_ms, 2 * DecoderDatabase::kMaxIdleTimeMs);
+  }
+  EXPECT_GE(elapsed_ms, DecoderDatabase::kMaxIdleTimeMs);
+  EXPECT_TRUE(db.GetDecoderInfo(kPayloadTypeInUse)->decoder != NULL);
+  EXPECT_EQ(&external_decoder,
+            db.GetDecoderInfo(kPayloadTypeExternal)->decoder);
+
+  // The idle decoder is created again when it is needed.
+  EXPECT_TRUE(db.GetDecoder(kPayloadTypeIdle) != NULL);
+
+  EXPECT_CALL(external_decoder, Die()).Times(1);  // When |db| is deleted.
+}
+
 TEST(DecoderDatabase, CheckPayloadTypes) {
   DecoderDatabase db;
   // Load a number of payloads into the database. Payload types are 0, 1, ...,
@@ -585,8 +585,8 @@ void Expand::AnalyzeSignal(int16_t* random_vector) {
     size_t temp_index = signal_length - fs_mult_lpc_analysis_len -
         kUnvoicedLpcOrder;
     // Copy signal to temporary vector to be able to pad with leading zeros.
-    int16_t* temp_signal = new int16_t[fs_mult_lpc_analysis_len
-                                       + kUnvoicedLpcOrder];
+    int16_t temp_signal[kMaxSampleRate / 8000 * kLpcAnalysisLength
+                        + kUnvoicedLpcOrder];
     memset(temp_signal, 0,
            sizeof(int16_t) * (fs_mult_lpc_analysis_len + kUnvoicedLpcOrder));
     memcpy(&temp_signal[kUnvoicedLpcOrder],
@@ -597,7 +597,6 @@ void Expand::AnalyzeSignal(int16_t* random_vector) {
                                &temp_signal[kUnvoicedLpcOrder],
                                fs_mult_lpc_analysis_len, kUnvoicedLpcOrder + 1,
                                correlation_scale, -1);
-    delete [] temp_signal;
 
     // Verify that variance is positive.
     if (auto_correlation[0] > 0) {
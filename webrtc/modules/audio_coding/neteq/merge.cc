@@ -15,7 +15,6 @@
 
 #include <algorithm>  // min, max
 
-#include "webrtc/base/scoped_ptr.h"
 #include "webrtc/common_audio/signal_processing/include/signal_processing_library.h"
 #include "webrtc/modules/audio_coding/neteq/audio_multi_vector.h"
 #include "webrtc/modules/audio_coding/neteq/dsp_helper.h"
@@ -34,7 +33,9 @@ Merge::Merge(int fs_hz,
       timestamps_per_call_(fs_hz_ / 100),
       expand_(expand),
       sync_buffer_(sync_buffer),
-      expanded_(num_channels_) {
+      expanded_(num_channels_),
+      input_vector_(num_channels_),
+      expanded_temp_(num_channels_) {
   assert(num_channels_ > 0);
 }
 
@@ -52,16 +53,16 @@ int Merge::Process(int16_t* input, size_t input_length,
   int expanded_length = GetExpandedSignal(&old_length, &expand_period);
 
   // Transfer input signal to an AudioMultiVector.
-  AudioMultiVector input_vector(num_channels_);
-  input_vector.PushBackInterleaved(input, input_length);
-  size_t input_length_per_channel = input_vector.Size();
+  input_vector_.Clear();
+  input_vector_.PushBackInterleaved(input, input_length);
+  size_t input_length_per_channel = input_vector_.Size();
   assert(input_length_per_channel == input_length / num_channels_);
 
   int16_t best_correlation_index = 0;
   size_t output_length = 0;
 
   for (size_t channel = 0; channel < num_channels_; ++channel) {
-    int16_t* input_channel = &input_vector[channel][0];
+    int16_t* input_channel = &input_vector_[channel][0];
     int16_t* expanded_channel = &expanded_[channel][0];
     int16_t expanded_max, input_max;
     int16_t new_mute_factor = SignalScaling(
@@ -177,23 +178,23 @@ int Merge::GetExpandedSignal(int* old_length, int* expand_period) {
   // This assert should always be true thanks to the if statement above.
   assert(210 * kMaxSampleRate / 8000 - *old_length >= 0);
 
-  AudioMultiVector expanded_temp(num_channels_);
-  expand_->Process(&expanded_temp);
-  *expand_period = static_cast<int>(expanded_temp.Size());  // Samples per
-                                                            // channel.
+  expanded_temp_.Clear();
+  expand_->Process(&expanded_temp_);
+  *expand_period = static_cast<int>(expanded_temp_.Size());  // Samples per
+                                                             // channel.
 
   expanded_.Clear();
   // Copy what is left since earlier into the expanded vector.
   expanded_.PushBackFromIndex(*sync_buffer_, sync_buffer_->next_index());
   assert(expanded_.Size() == static_cast<size_t>(*old_length));
-  assert(expanded_temp.Size() > 0);
+  assert(expanded_temp_.Size() > 0);
   // Do "ugly" copy and paste from the expanded in order to generate more data
   // to correlate (but not interpolate) with.
   const int required_length = (120 + 80 + 2) * fs_mult_;
   if (expanded_.Size() < static_cast<size_t>(required_length)) {
     while (expanded_.Size() < static_cast<size_t>(required_length)) {
       // Append one more pitch period each time.
-      expanded_.PushBack(expanded_temp);
+      expanded_.PushBack(expanded_temp_);
     }
     // Trim the length to exactly |required_length|.
     expanded_.PopBack(expanded_.Size() - required_length);
@@ -324,9 +325,9 @@ int16_t Merge::CorrelateAndPeakSearch(int16_t expanded_max, int16_t input_max,
   // Normalize correlation to 14 bits and copy to a 16-bit array.
   const int pad_length = static_cast<int>(expand_->overlap_length() - 1);
   const int correlation_buffer_size = 2 * pad_length + kMaxCorrelationLength;
-  rtc::scoped_ptr<int16_t[]> correlation16(
-      new int16_t[correlation_buffer_size]);
-  memset(correlation16.get(), 0, correlation_buffer_size * sizeof(int16_t));
+  assert(correlation_buffer_size <= kMaxCorrelationBufferSize);
+  int16_t correlation16[kMaxCorrelationBufferSize];
+  memset(correlation16, 0, correlation_buffer_size * sizeof(int16_t));
   int16_t* correlation_ptr = &correlation16[pad_length];
   int32_t max_correlation = WebRtcSpl_MaxAbsValueW32(correlation,
                                                      stop_position_downsamp);
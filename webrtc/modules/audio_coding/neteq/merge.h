@@ -61,6 +61,10 @@ class Merge {
   static const int kExpandDownsampLength = 100;
   static const int kInputDownsampLength = 40;
   static const int kMaxCorrelationLength = 60;
+  // Expand::overlap_length() is at most 5 ms at kMaxSampleRate, which bounds
+  // the padding around the correlation in CorrelateAndPeakSearch().
+  static const int kMaxCorrelationBufferSize =
+      2 * (5 * kMaxSampleRate / 8000 - 1) + kMaxCorrelationLength;
 
   // Calls |expand_| to get more expansion data to merge with. The data is
   // written to |expanded_signal_|. Returns the length of the expanded data,
@@ -95,6 +99,9 @@ class Merge {
   int16_t expanded_downsampled_[kExpandDownsampLength];
   int16_t input_downsampled_[kInputDownsampLength];
   AudioMultiVector expanded_;
+  // Scratch vectors for Process() and GetExpandedSignal().
+  AudioMultiVector input_vector_;
+  AudioMultiVector expanded_temp_;
 
   DISALLOW_COPY_AND_ASSIGN(Merge);
 };
@@ -58,6 +58,8 @@ class MockDecoderDatabase : public DecoderDatabase {
       AudioDecoder*());
   MOCK_CONST_METHOD1(CheckPayloadTypes,
       int(const PacketList& packet_list));
+  MOCK_METHOD1(ReleaseIdleDecoders,
+      void(int elapsed_ms));
 };
 
 }  // namespace webrtc
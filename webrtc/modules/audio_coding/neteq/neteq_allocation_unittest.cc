@@ -0,0 +1,175 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// Test to verify that NetEq::GetAudio() does not allocate memory once NetEq
+// has reached a steady state. This file replaces the global operator new and
+// delete, and is built into an executable of its own.
+
+#include <math.h>
+#include <stdlib.h>
+
+#include <new>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/base/criticalsection.h"
+#include "webrtc/base/scoped_ptr.h"
+#include "webrtc/modules/audio_coding/codecs/pcm16b/include/pcm16b.h"
+#include "webrtc/modules/audio_coding/neteq/interface/neteq.h"
+#include "webrtc/modules/audio_coding/neteq/tools/rtp_generator.h"
+
+// The sanitizers provide their own operator new and delete.
+#if !defined(ADDRESS_SANITIZER) && !defined(MEMORY_SANITIZER) && \
+    !defined(THREAD_SANITIZER)
+#define WEBRTC_NETEQ_COUNT_ALLOCATIONS
+#endif
+
+#if defined(WEBRTC_NETEQ_COUNT_ALLOCATIONS)
+
+namespace {
+
+// Counts the calls to operator new while |count_allocations| is set. Other
+// threads may allocate at any time, so both are only accessed atomically.
+volatile int count_allocations = 0;
+volatile int allocation_count = 0;
+
+void* CountedAlloc(size_t size) {
+  if (rtc::AtomicOps::Load(&count_allocations))
+    rtc::AtomicOps::Increment(&allocation_count);
+  void* p = malloc(size ? size : 1);
+  if (!p)
+    throw std::bad_alloc();
+  return p;
+}
+
+}  // namespace
+
+void* operator new(size_t size) {
+  return CountedAlloc(size);
+}
+
+void* operator new[](size_t size) {
+  return CountedAlloc(size);
+}
+
+void operator delete(void* p) throw() {
+  free(p);
+}
+
+void operator delete[](void* p) throw() {
+  free(p);
+}
+
+#endif  // defined(WEBRTC_NETEQ_COUNT_ALLOCATIONS)
+
+namespace webrtc {
+
+#if defined(WEBRTC_NETEQ_COUNT_ALLOCATIONS)
+
+namespace {
+
+const int kSampleRateHz = 16000;
+const int kSamplesPerMs = kSampleRateHz / 1000;
+const int kFrameSizeMs = 20;
+const int kFrameSizeSamples = kFrameSizeMs * kSamplesPerMs;
+const int kOutputSizeSamples = 10 * kSamplesPerMs;
+const uint8_t kPayloadType = 94;
+
+}  // namespace
+
+class NetEqAllocationTest : public ::testing::Test {
+ protected:
+  NetEqAllocationTest()
+      : rtp_generator_(kSamplesPerMs),
+        time_ms_(0),
+        next_arrival_time_ms_(0),
+        sample_index_(0) {
+    NetEq::Config config;
+    config.sample_rate_hz = kSampleRateHz;
+    neteq_.reset(NetEq::Create(config));
+  }
+
+  void SetUp() override {
+    ASSERT_EQ(NetEq::kOK,
+              neteq_->RegisterPayloadType(kDecoderPCM16Bwb, kPayloadType));
+  }
+
+  void TearDown() override {
+    rtc::AtomicOps::Store(&count_allocations, 0);
+  }
+
+  // Encodes the next frame of a voiced signal and inserts it into NetEq,
+  // unless |lost| is set.
+  void InsertPacket(bool lost) {
+    int16_t input[kFrameSizeSamples];
+    for (int i = 0; i < kFrameSizeSamples; ++i, ++sample_index_) {
+      input[i] = static_cast<int16_t>(
+          8000 * sin(0.05 * sample_index_) + 2000 * sin(0.31 * sample_index_));
+    }
+    uint8_t payload[2 * kFrameSizeSamples];
+    const int16_t payload_length =
+        WebRtcPcm16b_Encode(input, kFrameSizeSamples, payload);
+    WebRtcRTPHeader rtp_header;
+    next_arrival_time_ms_ = rtp_generator_.GetRtpHeader(
+        kPayloadType, kFrameSizeSamples, &rtp_header);
+    if (!lost) {
+      ASSERT_EQ(NetEq::kOK,
+                neteq_->InsertPacket(rtp_header, payload, payload_length,
+                                     time_ms_ * kSamplesPerMs));
+    }
+  }
+
+  // Runs NetEq for |duration_ms|, dropping every |loss_period|th packet if
+  // |loss_period| is non-zero. Returns the number of allocations made by
+  // GetAudio().
+  int Run(int duration_ms, int loss_period) {
+    rtc::AtomicOps::Store(&allocation_count, 0);
+    int packets = 0;
+    for (int end_ms = time_ms_ + duration_ms; time_ms_ < end_ms;
+         time_ms_ += 10) {
+      while (time_ms_ >= next_arrival_time_ms_) {
+        ++packets;
+        InsertPacket(loss_period != 0 && packets % loss_period == 0);
+      }
+      int16_t output[kOutputSizeSamples];
+      int samples_per_channel;
+      int num_channels;
+      NetEqOutputType type;
+      rtc::AtomicOps::Store(&count_allocations, 1);
+      const int error = neteq_->GetAudio(kOutputSizeSamples, output,
+                                         &samples_per_channel, &num_channels,
+                                         &type);
+      rtc::AtomicOps::Store(&count_allocations, 0);
+      EXPECT_EQ(NetEq::kOK, error);
+      EXPECT_EQ(kOutputSizeSamples, samples_per_channel);
+    }
+    return rtc::AtomicOps::Load(&allocation_count);
+  }
+
+  rtc::scoped_ptr<NetEq> neteq_;
+  test::RtpGenerator rtp_generator_;
+  int time_ms_;
+  uint32_t next_arrival_time_ms_;
+  int sample_index_;
+};
+
+TEST_F(NetEqAllocationTest, NoAllocationsInNormalPlayout) {
+  Run(2000, 0);  // Warm up.
+  EXPECT_EQ(0, Run(5000, 0));
+}
+
+TEST_F(NetEqAllocationTest, NoAllocationsWithPacketLoss) {
+  // Every tenth packet is lost, which exercises Expand and Merge.
+  Run(2000, 10);  // Warm up.
+  EXPECT_EQ(0, Run(5000, 10));
+}
+
+#endif  // defined(WEBRTC_NETEQ_COUNT_ALLOCATIONS)
+
+}  // namespace webrtc
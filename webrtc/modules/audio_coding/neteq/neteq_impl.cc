@@ -708,6 +708,7 @@ int NetEqImpl::GetAudioInternal(size_t max_length, int16_t* output,
   DtmfEvent dtmf_event;
   Operations operation;
   bool play_dtmf;
+  decoder_database_->ReleaseIdleDecoders(kOutputSizeMs);
   int return_value = GetDecision(&operation, &packet_list, &dtmf_event,
                                  &play_dtmf);
   if (return_value != 0) {
@@ -1263,7 +1264,7 @@ int NetEqImpl::DecodeLoop(PacketList* packet_list, Operations* operation,
     assert(decoded_buffer_length_ >= kMaxFrameSize * decoder->Channels());
     assert(*operation == kNormal || *operation == kAccelerate ||
            *operation == kMerge || *operation == kPreemptiveExpand);
-    packet_list->pop_front();
+    RecyclePacketListNode(packet_list);
     size_t payload_length = packet->payload_length;
     int16_t decode_length;
     if (packet->sync_packet) {
@@ -1570,7 +1571,7 @@ int NetEqImpl::DoRfc3389Cng(PacketList* packet_list, bool play_dtmf) {
     // Must have exactly one SID frame at this point.
     assert(packet_list->size() == 1);
     Packet* packet = packet_list->front();
-    packet_list->pop_front();
+    RecyclePacketListNode(packet_list);
     if (!decoder_database_->IsComfortNoise(packet->header.payloadType)) {
 #ifdef LEGACY_BITEXACT
       // This can happen due to a bug in GetDecision. Change the payload type
@@ -1774,6 +1775,12 @@ int NetEqImpl::DtmfOverdub(const DtmfEvent& dtmf_event, size_t num_channels,
   return dtmf_return_value < 0 ? dtmf_return_value : 0;
 }
 
+void NetEqImpl::RecyclePacketListNode(PacketList* packet_list) {
+  assert(!packet_list->empty());
+  free_packet_list_nodes_.splice(free_packet_list_nodes_.end(), *packet_list,
+                                 packet_list->begin());
+}
+
 int NetEqImpl::ExtractPackets(int required_samples, PacketList* packet_list) {
   bool first_packet = true;
   uint8_t prev_payload_type = 0;
@@ -1806,7 +1813,14 @@ int NetEqImpl::ExtractPackets(int required_samples, PacketList* packet_list) {
     // Store waiting time in ms; packets->waiting_time is in "output blocks".
     stats_.StoreWaitingTime(packet->waiting_time * kOutputSizeMs);
     assert(packet->payload_length > 0);
-    packet_list->push_back(packet);  // Store packet in list.
+    // Store packet in list, reusing a list node if there is one.
+    if (free_packet_list_nodes_.empty()) {
+      packet_list->push_back(packet);
+    } else {
+      packet_list->splice(packet_list->end(), free_packet_list_nodes_,
+                          free_packet_list_nodes_.begin());
+      packet_list->back() = packet;
+    }
 
     if (first_packet) {
       first_packet = false;
@@ -312,6 +312,11 @@ class NetEqImpl : public webrtc::NetEq {
                   size_t num_channels,
                   int16_t* output) const EXCLUSIVE_LOCKS_REQUIRED(crit_sect_);
 
+  // Removes the first packet from |packet_list| without freeing its list node,
+  // which ExtractPackets() will reuse. Does not delete the packet.
+  void RecyclePacketListNode(PacketList* packet_list)
+      EXCLUSIVE_LOCKS_REQUIRED(crit_sect_);
+
   // Extracts packets from |packet_buffer_| to produce at least
   // |required_samples| samples. The packets are inserted into |packet_list|.
   // Returns the number of samples that the packets in the list will produce, or
@@ -379,6 +384,8 @@ class NetEqImpl : public webrtc::NetEq {
   rtc::scoped_ptr<int16_t[]> mute_factor_array_ GUARDED_BY(crit_sect_);
   size_t decoded_buffer_length_ GUARDED_BY(crit_sect_);
   rtc::scoped_ptr<int16_t[]> decoded_buffer_ GUARDED_BY(crit_sect_);
+  // Spare PacketList nodes, so that GetAudio() does not allocate.
+  PacketList free_packet_list_nodes_ GUARDED_BY(crit_sect_);
   uint32_t playout_timestamp_ GUARDED_BY(crit_sect_);
   bool new_codec_ GUARDED_BY(crit_sect_);
   uint32_t timestamp_ GUARDED_BY(crit_sect_);
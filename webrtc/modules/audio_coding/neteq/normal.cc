@@ -60,7 +60,10 @@ int Normal::Process(const int16_t* input,
     expand_->SetParametersForNormalAfterExpand();
 
     // Call Expand.
-    AudioMultiVector expanded(output->Channels());
+    if (!expanded_ || expanded_->Channels() != output->Channels())
+      expanded_.reset(new AudioMultiVector(output->Channels()));
+    AudioMultiVector& expanded = *expanded_;
+    expanded.Clear();
     expand_->Process(&expanded);
     expand_->Reset();
 
@@ -16,6 +16,7 @@
 #include <vector>
 
 #include "webrtc/base/constructormagic.h"
+#include "webrtc/base/scoped_ptr.h"
 #include "webrtc/modules/audio_coding/neteq/audio_multi_vector.h"
 #include "webrtc/modules/audio_coding/neteq/defines.h"
 #include "webrtc/typedefs.h"
@@ -60,6 +61,9 @@ class Normal {
   DecoderDatabase* decoder_database_;
   const BackgroundNoise& background_noise_;
   Expand* expand_;
+  // Receives the expansion to cross-fade with after an Expand. Kept between
+  // calls to avoid allocating.
+  rtc::scoped_ptr<AudioMultiVector> expanded_;
 
   DISALLOW_COPY_AND_ASSIGN(Normal);
 };
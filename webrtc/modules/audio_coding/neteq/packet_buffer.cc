@@ -8,36 +8,26 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
-// This is the implementation of the PacketBuffer class. It is mostly based on
-// an STL list. The list is kept sorted at all times so that the next packet to
-// decode is at the beginning of the list.
+// This is the implementation of the PacketBuffer class. It is based on a ring
+// buffer of packet pointers, which is kept sorted at all times so that the next
+// packet to decode is at the beginning of the buffer. New packets are placed
+// with a binary search, and only the pointers on the shorter side of the
+// insertion point are moved.
 
 #include "webrtc/modules/audio_coding/neteq/packet_buffer.h"
 
-#include <algorithm>  // find_if()
+#include <algorithm>  // max()
 
 #include "webrtc/modules/audio_coding/codecs/audio_decoder.h"
 #include "webrtc/modules/audio_coding/neteq/decoder_database.h"
 
 namespace webrtc {
 
-// Predicate used when inserting packets in the buffer list.
-// Operator() returns true when |packet| goes before |new_packet|.
-class NewTimestampIsLarger {
- public:
-  explicit NewTimestampIsLarger(const Packet* new_packet)
-      : new_packet_(new_packet) {
-  }
-  bool operator()(Packet* packet) {
-    return (*new_packet_ >= *packet);
-  }
-
- private:
-  const Packet* new_packet_;
-};
-
 PacketBuffer::PacketBuffer(size_t max_number_of_packets)
-    : max_number_of_packets_(max_number_of_packets) {}
+    : max_number_of_packets_(max_number_of_packets),
+      buffer_(std::max(max_number_of_packets, static_cast<size_t>(1))),
+      first_index_(0),
+      num_packets_(0) {}
 
 // Destructor. All packets in the buffer will be destroyed.
 PacketBuffer::~PacketBuffer() {
@@ -46,11 +36,16 @@ PacketBuffer::~PacketBuffer() {
 
 // Flush the buffer. All packets in the buffer will be destroyed.
 void PacketBuffer::Flush() {
-  DeleteAllPackets(&buffer_);
+  while (!Empty()) {
+    Packet* packet = PopFront();
+    delete [] packet->payload;
+    delete packet;
+  }
+  first_index_ = 0;
 }
 
 bool PacketBuffer::Empty() const {
-  return buffer_.empty();
+  return num_packets_ == 0;
 }
 
 int PacketBuffer::InsertPacket(Packet* packet) {
@@ -63,41 +58,36 @@ int PacketBuffer::InsertPacket(Packet* packet) {
 
   int return_val = kOK;
 
-  if (buffer_.size() >= max_number_of_packets_) {
+  if (num_packets_ >= max_number_of_packets_) {
     // Buffer is full. Flush it.
     Flush();
     return_val = kFlushed;
   }
 
-  // Get an iterator pointing to the place in the buffer where the new packet
-  // should be inserted. The list is searched from the back, since the most
-  // likely case is that the new packet should be near the end of the list.
-  PacketList::reverse_iterator rit = std::find_if(
-      buffer_.rbegin(), buffer_.rend(),
-      NewTimestampIsLarger(packet));
-
-  // The new packet is to be inserted to the right of |rit|. If it has the same
-  // timestamp as |rit|, which has a higher priority, do not insert the new
-  // packet to list.
-  if (rit != buffer_.rend() &&
-      packet->header.timestamp == (*rit)->header.timestamp) {
+  // The new packet is to be inserted before the packet at |index|.
+  const size_t index = InsertionIndex(*packet);
+
+  // If the new packet has the same timestamp as the packet before it, which
+  // has a higher priority, do not insert the new packet.
+  if (index > 0 &&
+      packet->header.timestamp == PacketAt(index - 1)->header.timestamp) {
     delete [] packet->payload;
     delete packet;
     return return_val;
   }
 
-  // The new packet is to be inserted to the left of |it|. If it has the same
-  // timestamp as |it|, which has a lower priority, replace |it| with the new
-  // packet.
-  PacketList::iterator it = rit.base();
-  if (it != buffer_.end() &&
-      packet->header.timestamp == (*it)->header.timestamp) {
-    delete [] (*it)->payload;
-    delete *it;
-    it = buffer_.erase(it);
+  // If the new packet has the same timestamp as the packet after it, which
+  // has a lower priority, replace that packet with the new one.
+  if (index < num_packets_ &&
+      packet->header.timestamp == PacketAt(index)->header.timestamp) {
+    Packet*& replaced = PacketAt(index);
+    delete [] replaced->payload;
+    delete replaced;
+    replaced = packet;
+    return return_val;
   }
-  buffer_.insert(it, packet);  // Insert the packet at that position.
 
+  InsertAt(index, packet);
   return return_val;
 }
 
@@ -148,7 +138,7 @@ int PacketBuffer::NextTimestamp(uint32_t* next_timestamp) const {
   if (!next_timestamp) {
     return kInvalidPointer;
   }
-  *next_timestamp = buffer_.front()->header.timestamp;
+  *next_timestamp = PacketAt(0)->header.timestamp;
   return kOK;
 }
 
@@ -160,11 +150,11 @@ int PacketBuffer::NextHigherTimestamp(uint32_t timestamp,
   if (!next_timestamp) {
     return kInvalidPointer;
   }
-  PacketList::const_iterator it;
-  for (it = buffer_.begin(); it != buffer_.end(); ++it) {
-    if ((*it)->header.timestamp >= timestamp) {
+  for (size_t i = 0; i < num_packets_; ++i) {
+    const Packet* packet = PacketAt(i);
+    if (packet->header.timestamp >= timestamp) {
       // Found a packet matching the search.
-      *next_timestamp = (*it)->header.timestamp;
+      *next_timestamp = packet->header.timestamp;
       return kOK;
     }
   }
@@ -175,7 +165,7 @@ const RTPHeader* PacketBuffer::NextRtpHeader() const {
   if (Empty()) {
     return NULL;
   }
-  return const_cast<const RTPHeader*>(&(buffer_.front()->header));
+  return const_cast<const RTPHeader*>(&(PacketAt(0)->header));
 }
 
 Packet* PacketBuffer::GetNextPacket(int* discard_count) {
@@ -184,17 +174,16 @@ Packet* PacketBuffer::GetNextPacket(int* discard_count) {
     return NULL;
   }
 
-  Packet* packet = buffer_.front();
+  Packet* packet = PopFront();
   // Assert that the packet sanity checks in InsertPacket method works.
   assert(packet && packet->payload);
-  buffer_.pop_front();
 
   // Discard other packets with the same timestamp. These are duplicates or
   // redundant payloads that should not be used.
   int discards = 0;
 
   while (!Empty() &&
-      buffer_.front()->header.timestamp == packet->header.timestamp) {
+      PacketAt(0)->header.timestamp == packet->header.timestamp) {
     if (DiscardNextPacket() != kOK) {
       assert(false);  // Must be ok by design.
     }
@@ -213,17 +202,19 @@ int PacketBuffer::DiscardNextPacket() {
   if (Empty()) {
     return kBufferEmpty;
   }
+  Packet* packet = PopFront();
   // Assert that the packet sanity checks in InsertPacket method works.
-  assert(buffer_.front());
-  assert(buffer_.front()->payload);
-  DeleteFirstPacket(&buffer_);
+  assert(packet);
+  assert(packet->payload);
+  delete [] packet->payload;
+  delete packet;
   return kOK;
 }
 
 int PacketBuffer::DiscardOldPackets(uint32_t timestamp_limit,
                                     uint32_t horizon_samples) {
-  while (!Empty() && timestamp_limit != buffer_.front()->header.timestamp &&
-         IsObsoleteTimestamp(buffer_.front()->header.timestamp,
+  while (!Empty() && timestamp_limit != PacketAt(0)->header.timestamp &&
+         IsObsoleteTimestamp(PacketAt(0)->header.timestamp,
                              timestamp_limit,
                              horizon_samples)) {
     if (DiscardNextPacket() != kOK) {
@@ -238,16 +229,15 @@ int PacketBuffer::DiscardAllOldPackets(uint32_t timestamp_limit) {
 }
 
 int PacketBuffer::NumPacketsInBuffer() const {
-  return static_cast<int>(buffer_.size());
+  return static_cast<int>(num_packets_);
 }
 
 int PacketBuffer::NumSamplesInBuffer(DecoderDatabase* decoder_database,
                                      int last_decoded_length) const {
-  PacketList::const_iterator it;
   int num_samples = 0;
   int last_duration = last_decoded_length;
-  for (it = buffer_.begin(); it != buffer_.end(); ++it) {
-    Packet* packet = (*it);
+  for (size_t i = 0; i < num_packets_; ++i) {
+    Packet* packet = PacketAt(i);
     AudioDecoder* decoder =
         decoder_database->GetDecoder(packet->header.payloadType);
     if (decoder) {
@@ -270,9 +260,8 @@ int PacketBuffer::NumSamplesInBuffer(DecoderDatabase* decoder_database,
 }
 
 void PacketBuffer::IncrementWaitingTimes(int inc) {
-  PacketList::iterator it;
-  for (it = buffer_.begin(); it != buffer_.end(); ++it) {
-    (*it)->waiting_time += inc;
+  for (size_t i = 0; i < num_packets_; ++i) {
+    PacketAt(i)->waiting_time += inc;
   }
 }
 
@@ -294,8 +283,65 @@ void PacketBuffer::DeleteAllPackets(PacketList* packet_list) {
 }
 
 void PacketBuffer::BufferStat(int* num_packets, int* max_num_packets) const {
-  *num_packets = static_cast<int>(buffer_.size());
+  *num_packets = static_cast<int>(num_packets_);
   *max_num_packets = static_cast<int>(max_number_of_packets_);
 }
 
+Packet*& PacketBuffer::PacketAt(size_t index) {
+  assert(index < buffer_.size());
+  index += first_index_;
+  return buffer_[index < buffer_.size() ? index : index - buffer_.size()];
+}
+
+Packet* PacketBuffer::PacketAt(size_t index) const {
+  assert(index < buffer_.size());
+  index += first_index_;
+  return buffer_[index < buffer_.size() ? index : index - buffer_.size()];
+}
+
+size_t PacketBuffer::InsertionIndex(const Packet& packet) const {
+  // Packets mostly arrive in order, so check the end of the buffer first.
+  if (num_packets_ == 0 || packet >= *PacketAt(num_packets_ - 1))
+    return num_packets_;
+  // Find the first packet that |packet| is smaller than.
+  size_t low = 0;
+  size_t high = num_packets_ - 1;
+  while (low < high) {
+    const size_t middle = low + (high - low) / 2;
+    if (packet >= *PacketAt(middle)) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return low;
+}
+
+void PacketBuffer::InsertAt(size_t index, Packet* packet) {
+  assert(num_packets_ < buffer_.size());
+  assert(index <= num_packets_);
+  if (index < num_packets_ - index) {
+    // Move the packets before |index| one step towards the front.
+    first_index_ = (first_index_ == 0 ? buffer_.size() : first_index_) - 1;
+    for (size_t i = 0; i < index; ++i)
+      PacketAt(i) = PacketAt(i + 1);
+  } else {
+    // Move the packets from |index| one step towards the back.
+    for (size_t i = num_packets_; i > index; --i)
+      PacketAt(i) = PacketAt(i - 1);
+  }
+  PacketAt(index) = packet;
+  ++num_packets_;
+}
+
+Packet* PacketBuffer::PopFront() {
+  assert(!Empty());
+  Packet* packet = PacketAt(0);
+  ++first_index_;
+  if (first_index_ == buffer_.size())
+    first_index_ = 0;
+  --num_packets_;
+  return packet;
+}
+
 }  // namespace webrtc
@@ -11,6 +11,8 @@
 #ifndef WEBRTC_MODULES_AUDIO_CODING_NETEQ_PACKET_BUFFER_H_
 #define WEBRTC_MODULES_AUDIO_CODING_NETEQ_PACKET_BUFFER_H_
 
+#include <vector>
+
 #include "webrtc/base/constructormagic.h"
 #include "webrtc/modules/audio_coding/neteq/packet.h"
 #include "webrtc/typedefs.h"
@@ -33,7 +35,8 @@ class PacketBuffer {
   };
 
   // Constructor creates a buffer which can hold a maximum of
-  // |max_number_of_packets| packets.
+  // |max_number_of_packets| packets. The storage for all of them is allocated
+  // up front.
   PacketBuffer(size_t max_number_of_packets);
 
   // Deletes all packets in the buffer before destroying the buffer.
@@ -146,8 +149,27 @@ class PacketBuffer {
   }
 
  private:
+  // Returns the |index|th packet from the front of the buffer.
+  Packet*& PacketAt(size_t index);
+  Packet* PacketAt(size_t index) const;
+
+  // Returns the position at which |packet| is to be inserted, i.e., the index
+  // of the first packet in the buffer that goes after it.
+  size_t InsertionIndex(const Packet& packet) const;
+
+  // Inserts |packet| before the |index|th packet, moving whichever side of
+  // the buffer is shorter.
+  void InsertAt(size_t index, Packet* packet);
+
+  // Removes the first packet from the buffer without deleting it.
+  Packet* PopFront();
+
   size_t max_number_of_packets_;
-  PacketList buffer_;
+  // Ring buffer of the packets, sorted so that the next packet to decode is
+  // at |first_index_|.
+  std::vector<Packet*> buffer_;
+  size_t first_index_;
+  size_t num_packets_;
   DISALLOW_COPY_AND_ASSIGN(PacketBuffer);
 };
 
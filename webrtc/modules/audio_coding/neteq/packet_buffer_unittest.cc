@@ -12,10 +12,17 @@
 
 #include "webrtc/modules/audio_coding/neteq/packet_buffer.h"
 
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <vector>
+
 #include "testing/gmock/include/gmock/gmock.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "webrtc/modules/audio_coding/neteq/mock/mock_decoder_database.h"
 #include "webrtc/modules/audio_coding/neteq/packet.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
 
 using ::testing::Return;
 using ::testing::_;
@@ -77,6 +84,23 @@ struct PacketsToInsert {
   int extract_order;
 };
 
+// Returns |num_packets| packets from |gen| in the order they arrive when each
+// is delayed by up to 8 packets, and every 50th by |depth| / 2 packets.
+std::vector<Packet*> GenerateReorderedPackets(PacketGenerator* gen,
+                                              int num_packets,
+                                              int depth) {
+  std::vector<std::pair<int, Packet*> > arrivals;
+  for (int i = 0; i < num_packets; ++i) {
+    const int delay = i % 50 == 0 ? depth / 2 : rand() % 8;
+    arrivals.push_back(std::make_pair(i + delay, gen->NextPacket(1)));
+  }
+  std::stable_sort(arrivals.begin(), arrivals.end());
+  std::vector<Packet*> packets;
+  for (size_t i = 0; i < arrivals.size(); ++i)
+    packets.push_back(arrivals[i].second);
+  return packets;
+}
+
 // Start of test definitions.
 
 TEST(PacketBuffer, CreateAndDestroy) {
@@ -561,6 +585,70 @@ void TestIsObsoleteTimestamp(uint32_t limit_timestamp) {
 }
 }  // namespace
 
+// Keeps a reordered stream of packets at a constant buffer depth, long enough
+// for the packets to wrap around the buffer storage many times, and verifies
+// that they are extracted in order.
+TEST(PacketBuffer, ReorderedStreamAtConstantDepth) {
+  const int kDepth = 20;
+  const int kNumPackets = 1000;
+  srand(17);
+  PacketBuffer buffer(kDepth + 1);
+  PacketGenerator gen(0xFFF0, 0xFFFFFF00, 0, 10);  // Both wrap around.
+  std::vector<Packet*> packets =
+      GenerateReorderedPackets(&gen, kNumPackets, kDepth);
+
+  uint32_t expected_timestamp = 0xFFFFFF00;
+  for (size_t i = 0; i < packets.size(); ++i) {
+    ASSERT_EQ(PacketBuffer::kOK, buffer.InsertPacket(packets[i]));
+    if (buffer.NumPacketsInBuffer() > kDepth) {
+      Packet* packet = buffer.GetNextPacket(NULL);
+      ASSERT_TRUE(packet);
+      EXPECT_EQ(expected_timestamp, packet->header.timestamp);
+      expected_timestamp += 10;
+      delete [] packet->payload;
+      delete packet;
+    }
+  }
+  EXPECT_EQ(kDepth, buffer.NumPacketsInBuffer());
+  while (!buffer.Empty()) {
+    Packet* packet = buffer.GetNextPacket(NULL);
+    EXPECT_EQ(expected_timestamp, packet->header.timestamp);
+    expected_timestamp += 10;
+    delete [] packet->payload;
+    delete packet;
+  }
+}
+
+// Measures inserting reordered packets into, and extracting them from, a
+// buffer kept at depths of 50, 200 and 1000 packets.
+TEST(PacketBuffer, DISABLED_InsertReorderedPerf) {
+  const int kDepths[] = {50, 200, 1000};
+  const int kNumPackets = 200000;
+  for (size_t d = 0; d < sizeof(kDepths) / sizeof(kDepths[0]); ++d) {
+    const int depth = kDepths[d];
+    srand(17);
+    PacketBuffer buffer(depth + 1);
+    PacketGenerator gen(0, 0, 0, 160);
+    std::vector<Packet*> packets =
+        GenerateReorderedPackets(&gen, kNumPackets, depth);
+    std::vector<Packet*> extracted;
+    extracted.reserve(packets.size());
+
+    const int64_t start_us = TickTime::MicrosecondTimestamp();
+    for (size_t i = 0; i < packets.size(); ++i) {
+      buffer.InsertPacket(packets[i]);
+      if (buffer.NumPacketsInBuffer() > depth)
+        extracted.push_back(buffer.GetNextPacket(NULL));
+    }
+    const int64_t elapsed_us = TickTime::MicrosecondTimestamp() - start_us;
+    printf("Depth %4d: %.1f ns per packet.\n", depth,
+           1000.0 * elapsed_us / kNumPackets);
+
+    PacketList extracted_list(extracted.begin(), extracted.end());
+    PacketBuffer::DeleteAllPackets(&extracted_list);
+  }
+}
+
 // Test the IsObsoleteTimestamp method with different limit timestamps.
 TEST(PacketBuffer, IsObsoleteTimestamp) {
   TestIsObsoleteTimestamp(0);
@@ -56,7 +56,7 @@ void PreemptiveExpand::SetParametersForPassiveSpeech(size_t len,
 PreemptiveExpand::ReturnCodes PreemptiveExpand::CheckCriteriaAndStretch(
     const int16_t *input, size_t input_length, size_t peak_index,
     int16_t best_correlation, bool active_speech,
-    AudioMultiVector* output) const {
+    AudioMultiVector* output) {
   // Pre-calculate common multiplication with |fs_mult_|.
   // 120 corresponds to 15 ms.
   int fs_mult_120 = fs_mult_ * 120;
@@ -74,13 +74,13 @@ PreemptiveExpand::ReturnCodes PreemptiveExpand::CheckCriteriaAndStretch(
     // Copy first part, including cross-fade region.
     output->PushBackInterleaved(
         input, (unmodified_length + peak_index) * num_channels_);
-    // Copy the last |peak_index| samples up to 15 ms to |temp_vector|.
-    AudioMultiVector temp_vector(num_channels_);
-    temp_vector.PushBackInterleaved(
+    // Copy the last |peak_index| samples up to 15 ms to |temp_vector_|.
+    temp_vector_.Clear();
+    temp_vector_.PushBackInterleaved(
         &input[(unmodified_length - peak_index) * num_channels_],
         peak_index * num_channels_);
-    // Cross-fade |temp_vector| onto the end of |output|.
-    output->CrossFade(temp_vector, peak_index);
+    // Cross-fade |temp_vector_| onto the end of |output|.
+    output->CrossFade(temp_vector_, peak_index);
     // Copy the last unmodified part, 15 ms + pitch period until the end.
     output->PushBackInterleaved(
         &input[unmodified_length * num_channels_],
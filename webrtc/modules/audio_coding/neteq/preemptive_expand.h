@@ -63,7 +63,7 @@ class PreemptiveExpand : public TimeStretch {
                                       size_t w16_bestIndex,
                                       int16_t w16_bestCorr,
                                       bool w16_VAD,
-                                      AudioMultiVector* output) const override;
+                                      AudioMultiVector* output) override;
 
  private:
   int old_data_length_per_channel_;
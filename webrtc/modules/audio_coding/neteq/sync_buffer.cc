@@ -22,8 +22,14 @@ size_t SyncBuffer::FutureLength() const {
 
 void SyncBuffer::PushBack(const AudioMultiVector& append_this) {
   size_t samples_added = append_this.Size();
+  // Drop the oldest samples before appending, so that the buffer never has to
+  // grow beyond its size.
+  const size_t size = Size();
+  AudioMultiVector::PopFront(std::min(samples_added, size));
   AudioMultiVector::PushBack(append_this);
-  AudioMultiVector::PopFront(samples_added);
+  if (samples_added > size) {
+    AudioMultiVector::PopFront(samples_added - size);
+  }
   if (samples_added <= next_index_) {
     next_index_ -= samples_added;
   } else {
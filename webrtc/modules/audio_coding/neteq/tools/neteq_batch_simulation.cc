@@ -0,0 +1,258 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// Replays many RTP dump files through NetEq in parallel and writes the
+// resulting network statistics as a CSV report, one row per file and a final
+// row with the totals.
+
+#include <stdio.h>
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "google/gflags.h"
+#include "webrtc/modules/audio_coding/neteq/interface/neteq.h"
+#include "webrtc/modules/audio_coding/neteq/tools/neteq_simulation.h"
+#include "webrtc/modules/audio_coding/neteq/tools/rtp_file_source.h"
+#include "webrtc/system_wrappers/interface/cpu_info.h"
+
+namespace {
+
+// Flag validators.
+bool ValidatePayloadType(const char* flagname, int32_t value) {
+  if (value >= 0 && value <= 127)  // Value is ok.
+    return true;
+  printf("Invalid value for --%s: %d\n", flagname, static_cast<int>(value));
+  return false;
+}
+
+bool ValidateNonNegative(const char* flagname, int32_t value) {
+  if (value >= 0)  // Value is ok.
+    return true;
+  printf("Invalid value for --%s: %d\n", flagname, static_cast<int>(value));
+  return false;
+}
+
+bool ValidatePositive(const char* flagname, int32_t value) {
+  if (value > 0)  // Value is ok.
+    return true;
+  printf("Invalid value for --%s: %d\n", flagname, static_cast<int>(value));
+  return false;
+}
+
+// Define command line flags. The payload type flags are the same as in
+// neteq_rtpplay.
+DEFINE_int32(pcmu, 0, "RTP payload type for PCM-u");
+const bool pcmu_dummy =
+    google::RegisterFlagValidator(&FLAGS_pcmu, &ValidatePayloadType);
+DEFINE_int32(pcma, 8, "RTP payload type for PCM-a");
+const bool pcma_dummy =
+    google::RegisterFlagValidator(&FLAGS_pcma, &ValidatePayloadType);
+DEFINE_int32(ilbc, 102, "RTP payload type for iLBC");
+const bool ilbc_dummy =
+    google::RegisterFlagValidator(&FLAGS_ilbc, &ValidatePayloadType);
+DEFINE_int32(isac, 103, "RTP payload type for iSAC");
+const bool isac_dummy =
+    google::RegisterFlagValidator(&FLAGS_isac, &ValidatePayloadType);
+DEFINE_int32(isac_swb, 104, "RTP payload type for iSAC-swb (32 kHz)");
+const bool isac_swb_dummy =
+    google::RegisterFlagValidator(&FLAGS_isac_swb, &ValidatePayloadType);
+DEFINE_int32(opus, 111, "RTP payload type for Opus");
+const bool opus_dummy =
+    google::RegisterFlagValidator(&FLAGS_opus, &ValidatePayloadType);
+DEFINE_int32(pcm16b, 93, "RTP payload type for PCM16b-nb (8 kHz)");
+const bool pcm16b_dummy =
+    google::RegisterFlagValidator(&FLAGS_pcm16b, &ValidatePayloadType);
+DEFINE_int32(pcm16b_wb, 94, "RTP payload type for PCM16b-wb (16 kHz)");
+const bool pcm16b_wb_dummy =
+    google::RegisterFlagValidator(&FLAGS_pcm16b_wb, &ValidatePayloadType);
+DEFINE_int32(pcm16b_swb32, 95, "RTP payload type for PCM16b-swb32 (32 kHz)");
+const bool pcm16b_swb32_dummy =
+    google::RegisterFlagValidator(&FLAGS_pcm16b_swb32, &ValidatePayloadType);
+DEFINE_int32(pcm16b_swb48, 96, "RTP payload type for PCM16b-swb48 (48 kHz)");
+const bool pcm16b_swb48_dummy =
+    google::RegisterFlagValidator(&FLAGS_pcm16b_swb48, &ValidatePayloadType);
+DEFINE_int32(g722, 9, "RTP payload type for G.722");
+const bool g722_dummy =
+    google::RegisterFlagValidator(&FLAGS_g722, &ValidatePayloadType);
+DEFINE_int32(avt, 106, "RTP payload type for AVT/DTMF");
+const bool avt_dummy =
+    google::RegisterFlagValidator(&FLAGS_avt, &ValidatePayloadType);
+DEFINE_int32(red, 117, "RTP payload type for redundant audio (RED)");
+const bool red_dummy =
+    google::RegisterFlagValidator(&FLAGS_red, &ValidatePayloadType);
+DEFINE_int32(cn_nb, 13, "RTP payload type for comfort noise (8 kHz)");
+const bool cn_nb_dummy =
+    google::RegisterFlagValidator(&FLAGS_cn_nb, &ValidatePayloadType);
+DEFINE_int32(cn_wb, 98, "RTP payload type for comfort noise (16 kHz)");
+const bool cn_wb_dummy =
+    google::RegisterFlagValidator(&FLAGS_cn_wb, &ValidatePayloadType);
+DEFINE_int32(cn_swb32, 99, "RTP payload type for comfort noise (32 kHz)");
+const bool cn_swb32_dummy =
+    google::RegisterFlagValidator(&FLAGS_cn_swb32, &ValidatePayloadType);
+DEFINE_int32(cn_swb48, 100, "RTP payload type for comfort noise (48 kHz)");
+const bool cn_swb48_dummy =
+    google::RegisterFlagValidator(&FLAGS_cn_swb48, &ValidatePayloadType);
+
+DEFINE_int32(threads, 0,
+             "Number of worker threads; 0 means one per CPU core.");
+const bool threads_dummy =
+    google::RegisterFlagValidator(&FLAGS_threads, &ValidateNonNegative);
+DEFINE_string(input_list, "",
+              "File with one RTP dump file name per line, replayed in "
+              "addition to the files given on the command line.");
+DEFINE_string(report, "", "Output CSV file; the default is stdout.");
+DEFINE_int32(max_duration_s, 0,
+             "Maximum simulated time per file in seconds; 0 means the whole "
+             "file.");
+const bool max_duration_s_dummy =
+    google::RegisterFlagValidator(&FLAGS_max_duration_s, &ValidateNonNegative);
+DEFINE_int32(max_packets_in_buffer, 50,
+             "NetEq::Config::max_packets_in_buffer");
+const bool max_packets_in_buffer_dummy = google::RegisterFlagValidator(
+    &FLAGS_max_packets_in_buffer, &ValidatePositive);
+DEFINE_int32(max_delay_ms, 2000, "NetEq::Config::max_delay_ms");
+const bool max_delay_ms_dummy =
+    google::RegisterFlagValidator(&FLAGS_max_delay_ms, &ValidateNonNegative);
+
+webrtc::test::NetEqSimulation::DecoderMap DecoderMapFromFlags() {
+  webrtc::test::NetEqSimulation::DecoderMap decoders;
+  decoders[static_cast<uint8_t>(FLAGS_pcmu)] = webrtc::kDecoderPCMu;
+  decoders[static_cast<uint8_t>(FLAGS_pcma)] = webrtc::kDecoderPCMa;
+  decoders[static_cast<uint8_t>(FLAGS_ilbc)] = webrtc::kDecoderILBC;
+  decoders[static_cast<uint8_t>(FLAGS_isac)] = webrtc::kDecoderISAC;
+  decoders[static_cast<uint8_t>(FLAGS_isac_swb)] = webrtc::kDecoderISACswb;
+  decoders[static_cast<uint8_t>(FLAGS_opus)] = webrtc::kDecoderOpus;
+  decoders[static_cast<uint8_t>(FLAGS_pcm16b)] = webrtc::kDecoderPCM16B;
+  decoders[static_cast<uint8_t>(FLAGS_pcm16b_wb)] = webrtc::kDecoderPCM16Bwb;
+  decoders[static_cast<uint8_t>(FLAGS_pcm16b_swb32)] =
+      webrtc::kDecoderPCM16Bswb32kHz;
+  decoders[static_cast<uint8_t>(FLAGS_pcm16b_swb48)] =
+      webrtc::kDecoderPCM16Bswb48kHz;
+  decoders[static_cast<uint8_t>(FLAGS_g722)] = webrtc::kDecoderG722;
+  decoders[static_cast<uint8_t>(FLAGS_avt)] = webrtc::kDecoderAVT;
+  decoders[static_cast<uint8_t>(FLAGS_red)] = webrtc::kDecoderRED;
+  decoders[static_cast<uint8_t>(FLAGS_cn_nb)] = webrtc::kDecoderCNGnb;
+  decoders[static_cast<uint8_t>(FLAGS_cn_wb)] = webrtc::kDecoderCNGwb;
+  decoders[static_cast<uint8_t>(FLAGS_cn_swb32)] = webrtc::kDecoderCNGswb32kHz;
+  decoders[static_cast<uint8_t>(FLAGS_cn_swb48)] = webrtc::kDecoderCNGswb48kHz;
+  return decoders;
+}
+
+class RtpFileSourceFactory
+    : public webrtc::test::NetEqBatchSimulation::SourceFactory {
+ public:
+  explicit RtpFileSourceFactory(const std::vector<std::string>& file_names)
+      : file_names_(file_names) {}
+
+  webrtc::test::PacketSource* CreateSource(size_t index) override {
+    // RtpFileSource::Create() does not return on failure, which would end the
+    // whole batch.
+    if (!webrtc::test::RtpFileSource::ValidRtpFile(file_names_[index]))
+      return NULL;
+    return webrtc::test::RtpFileSource::Create(file_names_[index]);
+  }
+
+ private:
+  const std::vector<std::string>& file_names_;
+};
+
+void WriteReportRow(std::ostream& out,
+                    const std::string& name,
+                    bool succeeded,
+                    const webrtc::test::NetEqSimulationStats& stats) {
+  out << name << "," << (succeeded ? 1 : 0) << ","
+      << stats.simulated_time_ms << "," << stats.num_packets << ","
+      << stats.num_insert_errors << "," << stats.packet_loss_rate << ","
+      << stats.expand_rate << "," << stats.speech_expand_rate << ","
+      << stats.preemptive_rate << "," << stats.accelerate_rate << ","
+      << stats.mean_current_buffer_size_ms << ","
+      << stats.mean_preferred_buffer_size_ms << ","
+      << stats.max_preferred_buffer_size_ms << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  std::string program_name = argv[0];
+  std::string usage = "Tool for replaying many RTP dumps through NetEq in "
+      "parallel.\n"
+      "Payload types are mapped to decoders with the same flags as in "
+      "neteq_rtpplay.\n"
+      "Example usage:\n" + program_name +
+      " --threads=8 --report=report.csv input1.rtp input2.rtp\n";
+  google::SetUsageMessage(usage);
+  google::ParseCommandLineFlags(&argc, &argv, true);
+
+  std::vector<std::string> file_names;
+  for (int i = 1; i < argc; ++i)
+    file_names.push_back(argv[i]);
+  if (!FLAGS_input_list.empty()) {
+    std::ifstream list(FLAGS_input_list.c_str());
+    if (!list) {
+      std::cerr << "Cannot open input list " << FLAGS_input_list << std::endl;
+      return 1;
+    }
+    std::string line;
+    while (std::getline(list, line)) {
+      if (!line.empty())
+        file_names.push_back(line);
+    }
+  }
+  if (file_names.empty()) {
+    // Print usage information.
+    std::cout << google::ProgramUsage();
+    return 0;
+  }
+
+  std::ofstream report_file;
+  if (!FLAGS_report.empty()) {
+    report_file.open(FLAGS_report.c_str());
+    if (!report_file) {
+      std::cerr << "Cannot open report file " << FLAGS_report << std::endl;
+      return 1;
+    }
+  }
+  std::ostream& report = FLAGS_report.empty() ? std::cout : report_file;
+
+  int num_threads = FLAGS_threads;
+  if (num_threads == 0)
+    num_threads = static_cast<int>(webrtc::CpuInfo::DetectNumberOfCores());
+
+  webrtc::NetEq::Config config;
+  config.max_packets_in_buffer = FLAGS_max_packets_in_buffer;
+  config.max_delay_ms = FLAGS_max_delay_ms;
+  RtpFileSourceFactory factory(file_names);
+  webrtc::test::NetEqBatchSimulation batch(
+      &factory, config, DecoderMapFromFlags());
+  std::vector<webrtc::test::NetEqSimulationStats> stats;
+  std::vector<bool> succeeded;
+  const size_t num_succeeded =
+      batch.Run(file_names.size(), num_threads,
+                static_cast<int64_t>(FLAGS_max_duration_s) * 1000, &stats,
+                &succeeded);
+
+  report << "file,ok,simulated_time_ms,packets,insert_errors,"
+            "packet_loss_rate,expand_rate,speech_expand_rate,"
+            "preemptive_rate,accelerate_rate,mean_current_buffer_size_ms,"
+            "mean_preferred_buffer_size_ms,max_preferred_buffer_size_ms"
+         << std::endl;
+  for (size_t i = 0; i < file_names.size(); ++i)
+    WriteReportRow(report, file_names[i], succeeded[i], stats[i]);
+  WriteReportRow(report, "TOTAL", num_succeeded == file_names.size(),
+                 webrtc::test::AggregateStats(stats));
+
+  std::cerr << num_succeeded << " of " << file_names.size()
+            << " files simulated on " << num_threads << " threads"
+            << std::endl;
+  return num_succeeded == file_names.size() ? 0 : 1;
+}
@@ -0,0 +1,332 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/audio_coding/neteq/tools/neteq_simulation.h"
+
+#include <assert.h>
+
+#include <algorithm>
+
+#include "webrtc/modules/audio_coding/neteq/audio_decoder_impl.h"
+#include "webrtc/modules/audio_coding/neteq/tools/packet.h"
+#include "webrtc/modules/audio_coding/neteq/tools/packet_source.h"
+#include "webrtc/modules/interface/module_common_types.h"
+#include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
+#include "webrtc/system_wrappers/interface/event_wrapper.h"
+#include "webrtc/system_wrappers/interface/scoped_vector.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
+
+namespace webrtc {
+namespace test {
+
+namespace {
+
+const int kOutputBlockSizeMs = 10;
+const int kMaxChannels = 2;
+const int kMaxSamplesPerMs = 48000 / 1000;
+const int kOutDataLen = kOutputBlockSizeMs * kMaxSamplesPerMs * kMaxChannels;
+// NetEq::NetworkStatistics() is polled with this interval.
+const int kStatsIntervalMs = 1000;
+
+double Q14ToDouble(uint16_t value) {
+  return value / 16384.0;
+}
+
+}  // namespace
+
+NetEqSimulationStats AggregateStats(
+    const std::vector<NetEqSimulationStats>& stats) {
+  NetEqSimulationStats total;
+  for (size_t i = 0; i < stats.size(); ++i) {
+    const NetEqSimulationStats& s = stats[i];
+    const double weight = static_cast<double>(s.simulated_time_ms);
+    total.simulated_time_ms += s.simulated_time_ms;
+    total.num_packets += s.num_packets;
+    total.num_insert_errors += s.num_insert_errors;
+    total.packet_loss_rate += weight * s.packet_loss_rate;
+    total.expand_rate += weight * s.expand_rate;
+    total.speech_expand_rate += weight * s.speech_expand_rate;
+    total.preemptive_rate += weight * s.preemptive_rate;
+    total.accelerate_rate += weight * s.accelerate_rate;
+    total.mean_current_buffer_size_ms += weight * s.mean_current_buffer_size_ms;
+    total.mean_preferred_buffer_size_ms +=
+        weight * s.mean_preferred_buffer_size_ms;
+    total.max_preferred_buffer_size_ms = std::max(
+        total.max_preferred_buffer_size_ms, s.max_preferred_buffer_size_ms);
+  }
+  if (total.simulated_time_ms > 0) {
+    const double scale = 1.0 / total.simulated_time_ms;
+    total.packet_loss_rate *= scale;
+    total.expand_rate *= scale;
+    total.speech_expand_rate *= scale;
+    total.preemptive_rate *= scale;
+    total.accelerate_rate *= scale;
+    total.mean_current_buffer_size_ms *= scale;
+    total.mean_preferred_buffer_size_ms *= scale;
+  }
+  return total;
+}
+
+NetEqSimulation::DecoderMap NetEqSimulation::DefaultDecoderMap() {
+  DecoderMap decoders;
+  decoders[0] = kDecoderPCMu;
+  decoders[8] = kDecoderPCMa;
+  decoders[102] = kDecoderILBC;
+  decoders[103] = kDecoderISAC;
+  decoders[104] = kDecoderISACswb;
+  decoders[111] = kDecoderOpus;
+  decoders[93] = kDecoderPCM16B;
+  decoders[94] = kDecoderPCM16Bwb;
+  decoders[95] = kDecoderPCM16Bswb32kHz;
+  decoders[96] = kDecoderPCM16Bswb48kHz;
+  decoders[9] = kDecoderG722;
+  decoders[106] = kDecoderAVT;
+  decoders[117] = kDecoderRED;
+  decoders[13] = kDecoderCNGnb;
+  decoders[98] = kDecoderCNGwb;
+  decoders[99] = kDecoderCNGswb32kHz;
+  decoders[100] = kDecoderCNGswb48kHz;
+  return decoders;
+}
+
+NetEqSimulation::NetEqSimulation(PacketSource* source,
+                                 const NetEq::Config& config,
+                                 const DecoderMap& decoders)
+    : source_(source), config_(config), decoders_(decoders) {
+  assert(source);
+}
+
+NetEqSimulation::~NetEqSimulation() {}
+
+bool NetEqSimulation::Run(int64_t max_duration_ms,
+                          NetEqSimulationStats* stats) {
+  assert(stats);
+  stats_ = NetEqSimulationStats();
+  *stats = stats_;
+
+  rtc::scoped_ptr<Packet> packet(source_->NextPacket());
+  if (!packet)
+    return false;
+
+  // Start NetEq at the sample rate of the first packet, if it is known.
+  int sample_rate_hz = config_.sample_rate_hz;
+  DecoderMap::const_iterator it = decoders_.find(packet->header().payloadType);
+  if (it != decoders_.end() && CodecSampleRateHz(it->second) > 0)
+    sample_rate_hz = CodecSampleRateHz(it->second);
+  NetEq::Config config = config_;
+  config.sample_rate_hz = sample_rate_hz;
+  neteq_.reset(NetEq::Create(config));
+  for (it = decoders_.begin(); it != decoders_.end(); ++it) {
+    // Decoders that are not available in this build fail to register; packets
+    // with those payload types are counted as insert errors.
+    neteq_->RegisterPayloadType(it->second, it->first);
+  }
+
+  // The clock starts with the first packet, as in neteq_rtpplay.
+  const int64_t start_time_ms = static_cast<int64_t>(packet->time_ms());
+  int64_t time_now_ms = start_time_ms;
+  int64_t next_input_time_ms = time_now_ms;
+  int64_t next_output_time_ms = time_now_ms;
+  if (time_now_ms % kOutputBlockSizeMs != 0) {
+    next_output_time_ms +=
+        kOutputBlockSizeMs - time_now_ms % kOutputBlockSizeMs;
+  }
+  int64_t next_stats_time_ms = next_output_time_ms + kStatsIntervalMs;
+  int64_t last_stats_time_ms = next_output_time_ms;
+  int16_t out_data[kOutDataLen];
+  bool packet_available = true;
+  while (packet_available) {
+    if (max_duration_ms > 0 && time_now_ms - start_time_ms >= max_duration_ms)
+      break;
+
+    while (time_now_ms >= next_input_time_ms && packet_available) {
+      WebRtcRTPHeader rtp_header;
+      packet->ConvertHeader(&rtp_header);
+      const uint32_t receive_timestamp = static_cast<uint32_t>(
+          packet->time_ms() * sample_rate_hz / 1000);
+      if (neteq_->InsertPacket(rtp_header, packet->payload(),
+                               packet->payload_length_bytes(),
+                               receive_timestamp) != NetEq::kOK) {
+        ++stats_.num_insert_errors;
+      }
+      ++stats_.num_packets;
+      Packet* next_packet = source_->NextPacket();
+      if (next_packet) {
+        packet.reset(next_packet);
+        next_input_time_ms = static_cast<int64_t>(packet->time_ms());
+      } else {
+        packet_available = false;
+      }
+    }
+
+    if (time_now_ms >= next_output_time_ms) {
+      int samples_per_channel;
+      int num_channels;
+      if (neteq_->GetAudio(kOutDataLen, out_data, &samples_per_channel,
+                           &num_channels, NULL) == NetEq::kOK) {
+        sample_rate_hz = 1000 * samples_per_channel / kOutputBlockSizeMs;
+      }
+      next_output_time_ms += kOutputBlockSizeMs;
+      if (next_output_time_ms >= next_stats_time_ms) {
+        AccumulateNetworkStatistics(
+            static_cast<int>(next_output_time_ms - last_stats_time_ms));
+        last_stats_time_ms = next_output_time_ms;
+        next_stats_time_ms += kStatsIntervalMs;
+      }
+    }
+    time_now_ms = std::min(next_input_time_ms, next_output_time_ms);
+  }
+  // Include the last, partial statistics interval.
+  if (next_output_time_ms > last_stats_time_ms) {
+    AccumulateNetworkStatistics(
+        static_cast<int>(next_output_time_ms - last_stats_time_ms));
+  }
+
+  if (stats_.simulated_time_ms > 0) {
+    const double scale = 1.0 / stats_.simulated_time_ms;
+    stats_.packet_loss_rate *= scale;
+    stats_.expand_rate *= scale;
+    stats_.speech_expand_rate *= scale;
+    stats_.preemptive_rate *= scale;
+    stats_.accelerate_rate *= scale;
+    stats_.mean_current_buffer_size_ms *= scale;
+    stats_.mean_preferred_buffer_size_ms *= scale;
+  }
+  *stats = stats_;
+  neteq_.reset();
+  return true;
+}
+
+void NetEqSimulation::AccumulateNetworkStatistics(int interval_ms) {
+  NetEqNetworkStatistics network_stats;
+  if (neteq_->NetworkStatistics(&network_stats) != NetEq::kOK)
+    return;
+  // The sums are weighted by the interval length and normalized once the
+  // simulation is done.
+  stats_.simulated_time_ms += interval_ms;
+  stats_.packet_loss_rate +=
+      interval_ms * Q14ToDouble(network_stats.packet_loss_rate);
+  stats_.expand_rate += interval_ms * Q14ToDouble(network_stats.expand_rate);
+  stats_.speech_expand_rate +=
+      interval_ms * Q14ToDouble(network_stats.speech_expand_rate);
+  stats_.preemptive_rate +=
+      interval_ms * Q14ToDouble(network_stats.preemptive_rate);
+  stats_.accelerate_rate +=
+      interval_ms * Q14ToDouble(network_stats.accelerate_rate);
+  stats_.mean_current_buffer_size_ms +=
+      interval_ms * network_stats.current_buffer_size_ms;
+  stats_.mean_preferred_buffer_size_ms +=
+      interval_ms * network_stats.preferred_buffer_size_ms;
+  stats_.max_preferred_buffer_size_ms =
+      std::max(stats_.max_preferred_buffer_size_ms,
+               static_cast<int>(network_stats.preferred_buffer_size_ms));
+}
+
+NetEqBatchSimulation::NetEqBatchSimulation(
+    SourceFactory* factory,
+    const NetEq::Config& config,
+    const NetEqSimulation::DecoderMap& decoders)
+    : factory_(factory),
+      config_(config),
+      decoders_(decoders),
+      crit_(CriticalSectionWrapper::CreateCriticalSection()),
+      done_event_(EventWrapper::Create()),
+      num_jobs_(0),
+      next_job_(0),
+      jobs_finished_(0),
+      max_duration_ms_(0),
+      stats_(NULL),
+      succeeded_(NULL) {
+  assert(factory);
+}
+
+NetEqBatchSimulation::~NetEqBatchSimulation() {}
+
+size_t NetEqBatchSimulation::Run(size_t num_jobs,
+                                 int num_threads,
+                                 int64_t max_duration_ms,
+                                 std::vector<NetEqSimulationStats>* stats,
+                                 std::vector<bool>* succeeded) {
+  assert(stats);
+  assert(succeeded);
+  stats->assign(num_jobs, NetEqSimulationStats());
+  succeeded->assign(num_jobs, false);
+  if (num_jobs == 0)
+    return 0;
+
+  {
+    CriticalSectionScoped cs(crit_.get());
+    num_jobs_ = num_jobs;
+    next_job_ = 0;
+    jobs_finished_ = 0;
+    max_duration_ms_ = max_duration_ms;
+    stats_ = stats;
+    succeeded_ = succeeded;
+  }
+
+  // Each worker keeps taking jobs until there are none left. ThreadWrapper
+  // ends the loop when the run function returns false.
+  num_threads = static_cast<int>(
+      std::min(static_cast<size_t>(std::max(num_threads, 1)), num_jobs));
+  ScopedVector<ThreadWrapper> threads;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.push_back(
+        ThreadWrapper::CreateThread(WorkerThread, this, "neteq_simulation")
+            .release());
+    threads.back()->Start();
+  }
+  done_event_->Wait(WEBRTC_EVENT_INFINITE);
+  for (size_t i = 0; i < threads.size(); ++i)
+    threads[i]->Stop();
+
+  size_t num_succeeded = 0;
+  for (size_t i = 0; i < num_jobs; ++i) {
+    if ((*succeeded)[i])
+      ++num_succeeded;
+  }
+  CriticalSectionScoped cs(crit_.get());
+  stats_ = NULL;
+  succeeded_ = NULL;
+  return num_succeeded;
+}
+
+bool NetEqBatchSimulation::WorkerThread(void* obj) {
+  return static_cast<NetEqBatchSimulation*>(obj)->ProcessNextJob();
+}
+
+bool NetEqBatchSimulation::ProcessNextJob() {
+  size_t job;
+  int64_t max_duration_ms;
+  {
+    CriticalSectionScoped cs(crit_.get());
+    if (next_job_ >= num_jobs_)
+      return false;
+    job = next_job_++;
+    max_duration_ms = max_duration_ms_;
+  }
+
+  NetEqSimulationStats job_stats;
+  bool job_succeeded = false;
+  PacketSource* source = factory_->CreateSource(job);
+  if (source) {
+    NetEqSimulation simulation(source, config_, decoders_);
+    job_succeeded = simulation.Run(max_duration_ms, &job_stats);
+  }
+
+  CriticalSectionScoped cs(crit_.get());
+  (*stats_)[job] = job_stats;
+  (*succeeded_)[job] = job_succeeded;
+  if (++jobs_finished_ == num_jobs_)
+    done_event_->Set();
+  return true;
+}
+
+}  // namespace test
+}  // namespace webrtc
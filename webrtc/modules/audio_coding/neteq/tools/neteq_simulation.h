@@ -0,0 +1,152 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_AUDIO_CODING_NETEQ_TOOLS_NETEQ_SIMULATION_H_
+#define WEBRTC_MODULES_AUDIO_CODING_NETEQ_TOOLS_NETEQ_SIMULATION_H_
+
+#include <map>
+#include <vector>
+
+#include "webrtc/base/constructormagic.h"
+#include "webrtc/base/scoped_ptr.h"
+#include "webrtc/modules/audio_coding/neteq/interface/neteq.h"
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+
+class CriticalSectionWrapper;
+class EventWrapper;
+
+namespace test {
+
+class PacketSource;
+
+// Statistics collected over one simulation. The rates are fractions in
+// [0, 1], averaged over the simulated time.
+struct NetEqSimulationStats {
+  NetEqSimulationStats()
+      : simulated_time_ms(0),
+        num_packets(0),
+        num_insert_errors(0),
+        packet_loss_rate(0.0),
+        expand_rate(0.0),
+        speech_expand_rate(0.0),
+        preemptive_rate(0.0),
+        accelerate_rate(0.0),
+        mean_current_buffer_size_ms(0.0),
+        mean_preferred_buffer_size_ms(0.0),
+        max_preferred_buffer_size_ms(0) {}
+
+  int64_t simulated_time_ms;
+  int num_packets;
+  int num_insert_errors;
+  double packet_loss_rate;
+  double expand_rate;
+  double speech_expand_rate;
+  double preemptive_rate;
+  double accelerate_rate;
+  double mean_current_buffer_size_ms;
+  double mean_preferred_buffer_size_ms;
+  int max_preferred_buffer_size_ms;
+};
+
+// Combines the statistics of several simulations, weighting each one by its
+// simulated time.
+NetEqSimulationStats AggregateStats(
+    const std::vector<NetEqSimulationStats>& stats);
+
+// Replays the packets from a PacketSource through one NetEq instance, driven
+// by a simulated clock in the same way as neteq_rtpplay. No audio is written;
+// the result of the simulation is the network statistics.
+class NetEqSimulation {
+ public:
+  typedef std::map<uint8_t, NetEqDecoder> DecoderMap;
+
+  // Returns the payload type mapping used by default in neteq_rtpplay.
+  static DecoderMap DefaultDecoderMap();
+
+  // The object takes ownership of |source|. The |config| is used to create
+  // the NetEq instance, except that the initial sample rate is taken from the
+  // first packet.
+  NetEqSimulation(PacketSource* source,
+                  const NetEq::Config& config,
+                  const DecoderMap& decoders);
+  ~NetEqSimulation();
+
+  // Runs the simulation until the source is depleted, or until
+  // |max_duration_ms| of audio has been produced if |max_duration_ms| is
+  // positive. Returns false if the source did not deliver any usable packet.
+  bool Run(int64_t max_duration_ms, NetEqSimulationStats* stats);
+
+ private:
+  // Polls NetEq::NetworkStatistics() and accumulates the result, weighted by
+  // |interval_ms|.
+  void AccumulateNetworkStatistics(int interval_ms);
+
+  rtc::scoped_ptr<PacketSource> source_;
+  NetEq::Config config_;
+  const DecoderMap decoders_;
+  rtc::scoped_ptr<NetEq> neteq_;
+  NetEqSimulationStats stats_;
+
+  DISALLOW_COPY_AND_ASSIGN(NetEqSimulation);
+};
+
+// Runs many independent simulations in parallel on a pool of worker threads.
+// Each simulation has its own NetEq instance and simulated clock.
+class NetEqBatchSimulation {
+ public:
+  class SourceFactory {
+   public:
+    virtual ~SourceFactory() {}
+    // Returns a new packet source for job number |index|, or NULL if the
+    // source could not be created. Called on the worker threads.
+    virtual PacketSource* CreateSource(size_t index) = 0;
+  };
+
+  NetEqBatchSimulation(SourceFactory* factory,
+                       const NetEq::Config& config,
+                       const NetEqSimulation::DecoderMap& decoders);
+  ~NetEqBatchSimulation();
+
+  // Runs jobs 0 to |num_jobs| - 1 on |num_threads| threads, each simulation
+  // limited to |max_duration_ms| as in NetEqSimulation::Run(). On return,
+  // |stats| holds one entry per job and |succeeded| tells which jobs
+  // completed. Returns the number of jobs that completed.
+  size_t Run(size_t num_jobs,
+             int num_threads,
+             int64_t max_duration_ms,
+             std::vector<NetEqSimulationStats>* stats,
+             std::vector<bool>* succeeded);
+
+ private:
+  static bool WorkerThread(void* obj);
+  bool ProcessNextJob();
+
+  SourceFactory* const factory_;
+  const NetEq::Config config_;
+  const NetEqSimulation::DecoderMap decoders_;
+  rtc::scoped_ptr<CriticalSectionWrapper> crit_;
+  rtc::scoped_ptr<EventWrapper> done_event_;
+
+  // The following members are protected by |crit_| while Run() is active.
+  size_t num_jobs_;
+  size_t next_job_;
+  size_t jobs_finished_;
+  int64_t max_duration_ms_;
+  std::vector<NetEqSimulationStats>* stats_;
+  std::vector<bool>* succeeded_;
+
+  DISALLOW_COPY_AND_ASSIGN(NetEqBatchSimulation);
+};
+
+}  // namespace test
+}  // namespace webrtc
+#endif  // WEBRTC_MODULES_AUDIO_CODING_NETEQ_TOOLS_NETEQ_SIMULATION_H_
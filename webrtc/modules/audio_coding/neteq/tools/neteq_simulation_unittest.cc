@@ -0,0 +1,212 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// Unit tests for NetEqSimulation and NetEqBatchSimulation.
+
+#include "webrtc/modules/audio_coding/neteq/tools/neteq_simulation.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/modules/audio_coding/neteq/tools/constant_pcm_packet_source.h"
+
+namespace webrtc {
+namespace test {
+
+namespace {
+
+const int kSampleRateHz = 16000;
+const int kFrameSizeSamples = 20 * kSampleRateHz / 1000;
+const int kPayloadType = 94;  // PCM16b-wb in the default decoder map.
+const int16_t kSampleValue = 1000;
+
+// Delivers |num_packets| packets from a ConstantPcmPacketSource, dropping
+// every |loss_period|th packet if |loss_period| is non-zero.
+class FinitePcmPacketSource : public PacketSource {
+ public:
+  FinitePcmPacketSource(int num_packets, int loss_period)
+      : source_(kFrameSizeSamples, kSampleValue, kSampleRateHz, kPayloadType),
+        packets_left_(num_packets),
+        loss_period_(loss_period),
+        packet_count_(0) {}
+
+  Packet* NextPacket() override {
+    while (packets_left_ > 0) {
+      --packets_left_;
+      Packet* packet = source_.NextPacket();
+      ++packet_count_;
+      if (loss_period_ == 0 || packet_count_ % loss_period_ != 0)
+        return packet;
+      delete packet;
+    }
+    return NULL;
+  }
+
+ private:
+  ConstantPcmPacketSource source_;
+  int packets_left_;
+  const int loss_period_;
+  int packet_count_;
+};
+
+// Creates sources with a different loss period for each job.
+class LossySourceFactory : public NetEqBatchSimulation::SourceFactory {
+ public:
+  explicit LossySourceFactory(int num_packets) : num_packets_(num_packets) {}
+
+  PacketSource* CreateSource(size_t index) override {
+    const int loss_period = index == 0 ? 0 : static_cast<int>(index) + 2;
+    return new FinitePcmPacketSource(num_packets_, loss_period);
+  }
+
+ private:
+  const int num_packets_;
+};
+
+NetEqSimulationStats RunSimulation(int num_packets, int loss_period) {
+  NetEqSimulation simulation(
+      new FinitePcmPacketSource(num_packets, loss_period), NetEq::Config(),
+      NetEqSimulation::DefaultDecoderMap());
+  NetEqSimulationStats stats;
+  EXPECT_TRUE(simulation.Run(0, &stats));
+  return stats;
+}
+
+void ExpectEqualStats(const NetEqSimulationStats& a,
+                      const NetEqSimulationStats& b) {
+  EXPECT_EQ(a.simulated_time_ms, b.simulated_time_ms);
+  EXPECT_EQ(a.num_packets, b.num_packets);
+  EXPECT_EQ(a.num_insert_errors, b.num_insert_errors);
+  EXPECT_EQ(a.packet_loss_rate, b.packet_loss_rate);
+  EXPECT_EQ(a.expand_rate, b.expand_rate);
+  EXPECT_EQ(a.speech_expand_rate, b.speech_expand_rate);
+  EXPECT_EQ(a.preemptive_rate, b.preemptive_rate);
+  EXPECT_EQ(a.accelerate_rate, b.accelerate_rate);
+  EXPECT_EQ(a.mean_current_buffer_size_ms, b.mean_current_buffer_size_ms);
+  EXPECT_EQ(a.mean_preferred_buffer_size_ms, b.mean_preferred_buffer_size_ms);
+  EXPECT_EQ(a.max_preferred_buffer_size_ms, b.max_preferred_buffer_size_ms);
+}
+
+}  // namespace
+
+TEST(NetEqSimulation, NoLoss) {
+  const int kNumPackets = 250;  // 5 seconds.
+  NetEqSimulationStats stats = RunSimulation(kNumPackets, 0);
+  EXPECT_EQ(kNumPackets, stats.num_packets);
+  EXPECT_EQ(0, stats.num_insert_errors);
+  EXPECT_NEAR(kNumPackets * 20, stats.simulated_time_ms, 20);
+  EXPECT_EQ(0.0, stats.packet_loss_rate);
+  EXPECT_LT(stats.expand_rate, 0.01);
+  EXPECT_GT(stats.max_preferred_buffer_size_ms, 0);
+}
+
+TEST(NetEqSimulation, LossIsReported) {
+  const int kNumPackets = 250;
+  NetEqSimulationStats stats = RunSimulation(kNumPackets, 5);
+  EXPECT_EQ(kNumPackets - kNumPackets / 5, stats.num_packets);
+  EXPECT_GT(stats.packet_loss_rate, 0.1);
+  EXPECT_GT(stats.expand_rate, 0.1);
+}
+
+TEST(NetEqSimulation, MaxDuration) {
+  NetEqSimulation simulation(new FinitePcmPacketSource(1000, 0),
+                             NetEq::Config(),
+                             NetEqSimulation::DefaultDecoderMap());
+  NetEqSimulationStats stats;
+  ASSERT_TRUE(simulation.Run(2000, &stats));
+  EXPECT_EQ(2000, stats.simulated_time_ms);
+  EXPECT_EQ(100, stats.num_packets);
+}
+
+TEST(NetEqSimulation, EmptySource) {
+  NetEqSimulation simulation(new FinitePcmPacketSource(0, 0), NetEq::Config(),
+                             NetEqSimulation::DefaultDecoderMap());
+  NetEqSimulationStats stats;
+  EXPECT_FALSE(simulation.Run(0, &stats));
+  EXPECT_EQ(0, stats.num_packets);
+}
+
+TEST(NetEqSimulation, UnknownPayloadType) {
+  NetEqSimulation simulation(new FinitePcmPacketSource(50, 0), NetEq::Config(),
+                             NetEqSimulation::DecoderMap());
+  NetEqSimulationStats stats;
+  ASSERT_TRUE(simulation.Run(0, &stats));
+  EXPECT_EQ(50, stats.num_insert_errors);
+}
+
+TEST(NetEqSimulation, AggregateStatsIsTimeWeighted) {
+  std::vector<NetEqSimulationStats> stats(2);
+  stats[0].simulated_time_ms = 1000;
+  stats[0].num_packets = 50;
+  stats[0].expand_rate = 0.4;
+  stats[0].mean_preferred_buffer_size_ms = 100;
+  stats[0].max_preferred_buffer_size_ms = 120;
+  stats[1].simulated_time_ms = 3000;
+  stats[1].num_packets = 150;
+  stats[1].expand_rate = 0.0;
+  stats[1].mean_preferred_buffer_size_ms = 20;
+  stats[1].max_preferred_buffer_size_ms = 40;
+  NetEqSimulationStats total = AggregateStats(stats);
+  EXPECT_EQ(4000, total.simulated_time_ms);
+  EXPECT_EQ(200, total.num_packets);
+  EXPECT_DOUBLE_EQ(0.1, total.expand_rate);
+  EXPECT_DOUBLE_EQ(40.0, total.mean_preferred_buffer_size_ms);
+  EXPECT_EQ(120, total.max_preferred_buffer_size_ms);
+}
+
+// Verifies that running the jobs in parallel gives the same result as running
+// each of them on its own.
+TEST(NetEqBatchSimulation, MatchesSerialSimulation) {
+  const int kNumPackets = 150;
+  const size_t kNumJobs = 7;
+  LossySourceFactory factory(kNumPackets);
+  NetEqBatchSimulation batch(&factory, NetEq::Config(),
+                             NetEqSimulation::DefaultDecoderMap());
+  for (int num_threads = 1; num_threads <= 4; num_threads *= 2) {
+    SCOPED_TRACE(num_threads);
+    std::vector<NetEqSimulationStats> stats;
+    std::vector<bool> succeeded;
+    EXPECT_EQ(kNumJobs,
+              batch.Run(kNumJobs, num_threads, 0, &stats, &succeeded));
+    ASSERT_EQ(kNumJobs, stats.size());
+    ASSERT_EQ(kNumJobs, succeeded.size());
+    for (size_t i = 0; i < kNumJobs; ++i) {
+      SCOPED_TRACE(i);
+      EXPECT_TRUE(succeeded[i]);
+      NetEqSimulation simulation(factory.CreateSource(i), NetEq::Config(),
+                                 NetEqSimulation::DefaultDecoderMap());
+      NetEqSimulationStats expected;
+      ASSERT_TRUE(simulation.Run(0, &expected));
+      ExpectEqualStats(expected, stats[i]);
+    }
+  }
+}
+
+TEST(NetEqBatchSimulation, FailedJobs) {
+  class EmptySourceFactory : public NetEqBatchSimulation::SourceFactory {
+   public:
+    PacketSource* CreateSource(size_t index) override {
+      // Odd jobs have no source at all; even jobs have an empty one.
+      return index % 2 ? NULL : new FinitePcmPacketSource(0, 0);
+    }
+  };
+  EmptySourceFactory factory;
+  NetEqBatchSimulation batch(&factory, NetEq::Config(),
+                             NetEqSimulation::DefaultDecoderMap());
+  std::vector<NetEqSimulationStats> stats;
+  std::vector<bool> succeeded;
+  EXPECT_EQ(0u, batch.Run(4, 2, 0, &stats, &succeeded));
+  ASSERT_EQ(4u, succeeded.size());
+  for (size_t i = 0; i < succeeded.size(); ++i)
+    EXPECT_FALSE(succeeded[i]);
+  EXPECT_EQ(0u, batch.Run(0, 2, 0, &stats, &succeeded));
+  EXPECT_TRUE(stats.empty());
+}
+
+}  // namespace test
+}  // namespace webrtc
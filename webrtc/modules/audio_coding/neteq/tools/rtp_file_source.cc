@@ -32,6 +32,14 @@ RtpFileSource* RtpFileSource::Create(const std::string& file_name) {
   return source;
 }
 
+bool RtpFileSource::ValidRtpFile(const std::string& file_name) {
+  rtc::scoped_ptr<RtpFileReader> reader(
+      RtpFileReader::Create(RtpFileReader::kRtpDump, file_name));
+  if (!reader)
+    reader.reset(RtpFileReader::Create(RtpFileReader::kPcap, file_name));
+  return reader.get() != NULL;
+}
+
 RtpFileSource::~RtpFileSource() {
 }
 
@@ -34,6 +34,9 @@ class RtpFileSource : public PacketSource {
   // opened, or has the wrong format, NULL will be returned.
   static RtpFileSource* Create(const std::string& file_name);
 
+  // Returns true if |file_name| can be opened as an rtpdump or a .pcap file.
+  static bool ValidRtpFile(const std::string& file_name);
+
   virtual ~RtpFileSource();
 
   // Registers an RTP header extension and binds it to |id|.
@@ -71,6 +71,11 @@ public:
     virtual int32_t AnonymousMixabilityStatus(MixerParticipant& participant,
                                               bool& mixable) = 0;
 
+    // Set the maximum number of participants, not counting anonymous ones,
+    // that are mixed at the same time. The default is
+    // kMaximumAmountOfMixedParticipants.
+    virtual int32_t SetMaximumMixedParticipants(size_t maxParticipants) = 0;
+
     // Set the minimum sampling frequency at which to mix. The mixing algorithm
     // may still choose to mix at a higher samling frequency to avoid
     // downsampling of audio contributing to the mixed audio.
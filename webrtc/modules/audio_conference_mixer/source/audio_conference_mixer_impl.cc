@@ -12,7 +12,6 @@
 #include "webrtc/modules/audio_conference_mixer/source/audio_conference_mixer_impl.h"
 #include "webrtc/modules/audio_conference_mixer/source/audio_frame_manipulator.h"
 #include "webrtc/modules/audio_processing/include/audio_processing.h"
-#include "webrtc/modules/utility/interface/audio_frame_operations.h"
 #include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
 #include "webrtc/system_wrappers/interface/trace.h"
 
@@ -26,27 +25,42 @@ struct ParticipantFramePair {
 
 typedef std::list<ParticipantFramePair*> ParticipantFramePairList;
 
-// Mix |frame| into |mixed_frame|, with saturation protection and upmixing.
-// These effects are applied to |frame| itself prior to mixing. Assumes that
+// Queue |frame| in |sources| for mixing into |mixed_frame|, and update the
+// metadata of |mixed_frame| like AudioFrame::operator+=() would. Assumes that
 // |mixed_frame| always has at least as many channels as |frame|. Supports
 // stereo at most.
-//
-// TODO(andrew): consider not modifying |frame| here.
-void MixFrames(AudioFrame* mixed_frame, AudioFrame* frame, bool use_limiter) {
+void AddFrameToMix(AudioFrame* mixed_frame,
+                   const AudioFrame* frame,
+                   bool use_limiter,
+                   std::vector<MixingSource>* sources) {
   assert(mixed_frame->num_channels_ >= frame->num_channels_);
-  if (use_limiter) {
-    // Divide by two to avoid saturation in the mixing.
-    // This is only meaningful if the limiter will be used.
-    *frame >>= 1;
-  }
-  if (mixed_frame->num_channels_ > frame->num_channels_) {
-    // We only support mono-to-stereo.
-    assert(mixed_frame->num_channels_ == 2 &&
-           frame->num_channels_ == 1);
-    AudioFrameOperations::MonoToStereo(frame);
+  // We only support mono-to-stereo.
+  assert(mixed_frame->num_channels_ == frame->num_channels_ ||
+         (mixed_frame->num_channels_ == 2 && frame->num_channels_ == 1));
+  if (mixed_frame->samples_per_channel_ == 0) {
+    mixed_frame->samples_per_channel_ = frame->samples_per_channel_;
+  } else if (mixed_frame->samples_per_channel_ !=
+             frame->samples_per_channel_) {
+    return;
   }
 
-  *mixed_frame += *frame;
+  if (mixed_frame->vad_activity_ == AudioFrame::kVadActive ||
+      frame->vad_activity_ == AudioFrame::kVadActive) {
+    mixed_frame->vad_activity_ = AudioFrame::kVadActive;
+  } else if (mixed_frame->vad_activity_ == AudioFrame::kVadUnknown ||
+             frame->vad_activity_ == AudioFrame::kVadUnknown) {
+    mixed_frame->vad_activity_ = AudioFrame::kVadUnknown;
+  }
+  if (mixed_frame->speech_type_ != frame->speech_type_)
+    mixed_frame->speech_type_ = AudioFrame::kUndefined;
+
+  MixingSource source;
+  source.data = frame->data_;
+  source.num_channels = frame->num_channels_;
+  // Halve the level to avoid saturation in the mixing. This is only
+  // meaningful if the limiter will be used.
+  source.gain_q14 = use_limiter ? kUnityGainQ14 / 2 : kUnityGainQ14;
+  sources->push_back(source);
 }
 
 // Return the max number of channels from a |list| composed of AudioFrames.
@@ -118,9 +132,7 @@ AudioConferenceMixer* AudioConferenceMixer::Create(int id) {
 
 AudioConferenceMixerImpl::AudioConferenceMixerImpl(int id)
     : _scratchParticipantsToMixAmount(0),
-      _scratchMixedParticipants(),
       _scratchVadPositiveParticipantsAmount(0),
-      _scratchVadPositiveParticipants(),
       _id(id),
       _minimumMixingFreq(kLowestPossible),
       _mixReceiver(NULL),
@@ -134,11 +146,13 @@ AudioConferenceMixerImpl::AudioConferenceMixerImpl(int id)
       _participantList(),
       _additionalParticipantList(),
       _numMixedParticipants(0),
+      _maxMixedParticipants(kMaximumAmountOfMixedParticipants),
       use_limiter_(true),
       _timeStamp(0),
       _timeScheduler(kProcessPeriodicityInMs),
       _mixedAudioLevel(),
-      _processCalls(0) {}
+      _processCalls(0),
+      mix_sources_(GetMixSourcesFunction()) {}
 
 bool AudioConferenceMixerImpl::Init() {
     _crit.reset(CriticalSectionWrapper::CreateCriticalSection());
@@ -206,8 +220,7 @@ int64_t AudioConferenceMixerImpl::TimeUntilNextProcess() {
 }
 
 int32_t AudioConferenceMixerImpl::Process() {
-    size_t remainingParticipantsAllowedToMix =
-        kMaximumAmountOfMixedParticipants;
+    size_t remainingParticipantsAllowedToMix = 0;
     {
         CriticalSectionScoped cs(_crit.get());
         assert(_processCalls == 0);
@@ -270,6 +283,9 @@ int32_t AudioConferenceMixerImpl::Process() {
             }
         }
 
+        remainingParticipantsAllowedToMix = _maxMixedParticipants;
+        _scratchMixedParticipants.resize(_maxMixedParticipants);
+        _scratchVadPositiveParticipants.resize(_maxMixedParticipants);
         UpdateToMix(&mixList, &rampOutList, &mixedParticipantsMap,
                     remainingParticipantsAllowedToMix);
 
@@ -315,6 +331,14 @@ int32_t AudioConferenceMixerImpl::Process() {
         MixFromList(*mixedAudio, &mixList);
         MixAnonomouslyFromList(*mixedAudio, &additionalFramesList);
         MixAnonomouslyFromList(*mixedAudio, &rampOutList);
+        // Mix all frames in a single pass.
+        if (!_mixSources.empty()) {
+            mix_sources_(&_mixSources[0], _mixSources.size(),
+                         mixedAudio->samples_per_channel_,
+                         mixedAudio->num_channels_, mixedAudio->data_);
+            mixedAudio->energy_ = 0xffffffff;
+            _mixSources.clear();
+        }
 
         if(mixedAudio->samples_per_channel_ == 0) {
             // Nothing was mixed, set the audio samples to silence.
@@ -354,12 +378,12 @@ int32_t AudioConferenceMixerImpl::Process() {
             timeForMixerCallback) {
             _mixerStatusCallback->MixedParticipants(
                 _id,
-                _scratchMixedParticipants,
+                &_scratchMixedParticipants[0],
                 static_cast<uint32_t>(_scratchParticipantsToMixAmount));
 
             _mixerStatusCallback->VADPositiveParticipants(
                 _id,
-                _scratchVadPositiveParticipants,
+                &_scratchVadPositiveParticipants[0],
                 _scratchVadPositiveParticipantsAmount);
             _mixerStatusCallback->MixedAudioLevel(_id,audioLevel);
         }
@@ -493,12 +517,7 @@ int32_t AudioConferenceMixerImpl::SetMixabilityStatus(
             return -1;
         }
 
-        size_t numMixedNonAnonymous = _participantList.size();
-        if (numMixedNonAnonymous > kMaximumAmountOfMixedParticipants) {
-            numMixedNonAnonymous = kMaximumAmountOfMixedParticipants;
-        }
-        numMixedParticipants =
-            numMixedNonAnonymous + _additionalParticipantList.size();
+        numMixedParticipants = NumMixedParticipants();
     }
     // A MixerParticipant was added or removed. Make sure the scratch
     // buffer is updated if necessary.
@@ -508,6 +527,14 @@ int32_t AudioConferenceMixerImpl::SetMixabilityStatus(
     return 0;
 }
 
+size_t AudioConferenceMixerImpl::NumMixedParticipants() const {
+    size_t numMixedNonAnonymous = _participantList.size();
+    if (numMixedNonAnonymous > _maxMixedParticipants) {
+        numMixedNonAnonymous = _maxMixedParticipants;
+    }
+    return numMixedNonAnonymous + _additionalParticipantList.size();
+}
+
 int32_t AudioConferenceMixerImpl::MixabilityStatus(
     MixerParticipant& participant,
     bool& mixable) {
@@ -581,6 +608,24 @@ int32_t AudioConferenceMixerImpl::SetMinimumMixingFrequency(
     }
 }
 
+int32_t AudioConferenceMixerImpl::SetMaximumMixedParticipants(
+    size_t maxParticipants) {
+    if(maxParticipants == 0) {
+        WEBRTC_TRACE(kTraceError, kTraceAudioMixerServer, _id,
+                     "SetMaximumMixedParticipants needs at least one");
+        return -1;
+    }
+    size_t numMixedParticipants;
+    {
+        CriticalSectionScoped cs(_cbCrit.get());
+        _maxMixedParticipants = maxParticipants;
+        numMixedParticipants = NumMixedParticipants();
+    }
+    CriticalSectionScoped cs(_crit.get());
+    _numMixedParticipants = numMixedParticipants;
+    return 0;
+}
+
 // Check all AudioFrames that are to be mixed. The highest sampling frequency
 // found is the lowest that can be used without losing information.
 int32_t AudioConferenceMixerImpl::GetLowestMixingFrequency() {
@@ -711,13 +756,13 @@ void AudioConferenceMixerImpl::UpdateToMix(
                     activeList.push_front(audioFrame);
                     (*mixParticipantList)[audioFrame->id_] = *participant;
                     assert(mixParticipantList->size() <=
-                           kMaximumAmountOfMixedParticipants);
+                           _maxMixedParticipants);
 
                     if (replaceWasMixed) {
                       RampOut(*replaceFrame);
                       rampOutList->push_back(replaceFrame);
                       assert(rampOutList->size() <=
-                             kMaximumAmountOfMixedParticipants);
+                             _maxMixedParticipants);
                     } else {
                       _audioFramePool->PushMemory(replaceFrame);
                     }
@@ -726,7 +771,7 @@ void AudioConferenceMixerImpl::UpdateToMix(
                         RampOut(*audioFrame);
                         rampOutList->push_back(audioFrame);
                         assert(rampOutList->size() <=
-                               kMaximumAmountOfMixedParticipants);
+                               _maxMixedParticipants);
                     } else {
                         _audioFramePool->PushMemory(audioFrame);
                     }
@@ -735,7 +780,7 @@ void AudioConferenceMixerImpl::UpdateToMix(
                 activeList.push_front(audioFrame);
                 (*mixParticipantList)[audioFrame->id_] = *participant;
                 assert(mixParticipantList->size() <=
-                       kMaximumAmountOfMixedParticipants);
+                       _maxMixedParticipants);
             }
         } else {
             if(wasMixed) {
@@ -774,7 +819,7 @@ void AudioConferenceMixerImpl::UpdateToMix(
             (*mixParticipantList)[(*iter)->audioFrame->id_] =
                 (*iter)->participant;
             assert(mixParticipantList->size() <=
-                   kMaximumAmountOfMixedParticipants);
+                   _maxMixedParticipants);
         } else {
             _audioFramePool->PushMemory((*iter)->audioFrame);
         }
@@ -790,7 +835,7 @@ void AudioConferenceMixerImpl::UpdateToMix(
             (*mixParticipantList)[(*iter)->audioFrame->id_] =
                 (*iter)->participant;
             assert(mixParticipantList->size() <=
-                   kMaximumAmountOfMixedParticipants);
+                   _maxMixedParticipants);
         } else {
             _audioFramePool->PushMemory((*iter)->audioFrame);
         }
@@ -844,7 +889,7 @@ void AudioConferenceMixerImpl::UpdateMixedStatus(
     std::map<int, MixerParticipant*>& mixedParticipantsMap) {
     WEBRTC_TRACE(kTraceStream, kTraceAudioMixerServer, _id,
                  "UpdateMixedStatus(mixedParticipantsMap)");
-    assert(mixedParticipantsMap.size() <= kMaximumAmountOfMixedParticipants);
+    assert(mixedParticipantsMap.size() <= _maxMixedParticipants);
 
     // Loop through all participants. If they are in the mix map they
     // were mixed.
@@ -964,18 +1009,18 @@ int32_t AudioConferenceMixerImpl::MixFromList(
     for (AudioFrameList::const_iterator iter = audioFrameList->begin();
          iter != audioFrameList->end();
          ++iter) {
-        if(position >= kMaximumAmountOfMixedParticipants) {
+        if(position >= _scratchMixedParticipants.size()) {
             WEBRTC_TRACE(
                 kTraceMemory,
                 kTraceAudioMixerServer,
                 _id,
                 "Trying to mix more than max amount of mixed participants:%d!",
-                kMaximumAmountOfMixedParticipants);
+                static_cast<int>(_scratchMixedParticipants.size()));
             // Assert and avoid crash
             assert(false);
             position = 0;
         }
-        MixFrames(&mixedAudio, (*iter), use_limiter_);
+        AddFrameToMix(&mixedAudio, *iter, use_limiter_, &_mixSources);
 
         SetParticipantStatistics(&_scratchMixedParticipants[position],
                                  **iter);
@@ -998,7 +1043,7 @@ int32_t AudioConferenceMixerImpl::MixAnonomouslyFromList(
     for (AudioFrameList::const_iterator iter = audioFrameList->begin();
          iter != audioFrameList->end();
          ++iter) {
-        MixFrames(&mixedAudio, *iter, use_limiter_);
+        AddFrameToMix(&mixedAudio, *iter, use_limiter_, &_mixSources);
     }
     return 0;
 }
@@ -13,10 +13,12 @@
 
 #include <list>
 #include <map>
+#include <vector>
 
 #include "webrtc/base/scoped_ptr.h"
 #include "webrtc/engine_configurations.h"
 #include "webrtc/modules/audio_conference_mixer/interface/audio_conference_mixer.h"
+#include "webrtc/modules/audio_conference_mixer/source/audio_mixing.h"
 #include "webrtc/modules/audio_conference_mixer/source/level_indicator.h"
 #include "webrtc/modules/audio_conference_mixer/source/memory_pool.h"
 #include "webrtc/modules/audio_conference_mixer/source/time_scheduler.h"
@@ -84,6 +86,7 @@ public:
                                          const bool mixable) override;
     int32_t AnonymousMixabilityStatus(MixerParticipant& participant,
                                       bool& mixable) override;
+    int32_t SetMaximumMixedParticipants(size_t maxParticipants) override;
 
 private:
     enum{DEFAULT_AUDIO_FRAME_POOLSIZE = 50};
@@ -119,6 +122,10 @@ private:
     void UpdateMixedStatus(
         std::map<int, MixerParticipant*>& mixedParticipantsList);
 
+    // Returns the number of participants that will be mixed, given the
+    // current participant lists and |_maxMixedParticipants|.
+    size_t NumMixedParticipants() const;
+
     // Clears audioFrameList and reclaims all memory associated with it.
     void ClearAudioFrameList(AudioFrameList* audioFrameList);
 
@@ -142,13 +149,14 @@ private:
         MixerParticipant& removeParticipant,
         MixerParticipantList* participantList);
 
-    // Mix the AudioFrames stored in audioFrameList into mixedAudio.
+    // Queue the AudioFrames stored in audioFrameList for mixing into
+    // mixedAudio. The frames are mixed by a single call to |mix_sources_|.
     int32_t MixFromList(
         AudioFrame& mixedAudio,
         const AudioFrameList* audioFrameList);
-    // Mix the AudioFrames stored in audioFrameList into mixedAudio. No
-    // record will be kept of this mix (e.g. the corresponding MixerParticipants
-    // will not be marked as IsMixed()
+    // Queue the AudioFrames stored in audioFrameList for mixing into
+    // mixedAudio. No record will be kept of this mix (e.g. the corresponding
+    // MixerParticipants will not be marked as IsMixed()
     int32_t MixAnonomouslyFromList(AudioFrame& mixedAudio,
                                    const AudioFrameList* audioFrameList);
 
@@ -158,11 +166,11 @@ private:
     // Note that the scratch memory may only be touched in the scope of
     // Process().
     size_t         _scratchParticipantsToMixAmount;
-    ParticipantStatistics  _scratchMixedParticipants[
-        kMaximumAmountOfMixedParticipants];
+    std::vector<ParticipantStatistics> _scratchMixedParticipants;
     uint32_t         _scratchVadPositiveParticipantsAmount;
-    ParticipantStatistics  _scratchVadPositiveParticipants[
-        kMaximumAmountOfMixedParticipants];
+    std::vector<ParticipantStatistics> _scratchVadPositiveParticipants;
+    // Frames to be mixed in this iteration.
+    std::vector<MixingSource> _mixSources;
 
     rtc::scoped_ptr<CriticalSectionWrapper> _crit;
     rtc::scoped_ptr<CriticalSectionWrapper> _cbCrit;
@@ -192,6 +200,8 @@ private:
     MixerParticipantList _additionalParticipantList;
 
     size_t _numMixedParticipants;
+    // Maximum number of non-anonymous participants mixed at the same time.
+    size_t _maxMixedParticipants;
     // Determines if we will use a limiter for clipping protection during
     // mixing.
     bool use_limiter_;
@@ -210,6 +220,9 @@ private:
 
     // Used for inhibiting saturation in mixing.
     rtc::scoped_ptr<AudioProcessing> _limiter;
+
+    // Mixing kernel for the CPU we're running on.
+    const MixSourcesFunction mix_sources_;
 };
 }  // namespace webrtc
 
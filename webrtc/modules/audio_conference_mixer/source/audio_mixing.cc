@@ -0,0 +1,56 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/audio_conference_mixer/source/audio_mixing.h"
+
+#include <assert.h>
+
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
+
+namespace webrtc {
+
+void MixSources_C(const MixingSource* sources,
+                  size_t num_sources,
+                  int samples_per_channel,
+                  int num_channels,
+                  int16_t* mixed) {
+  const int length = samples_per_channel * num_channels;
+  for (int i = 0; i < length; ++i) {
+    int32_t sum = 0;
+    for (size_t k = 0; k < num_sources; ++k) {
+      assert(sources[k].num_channels == num_channels ||
+             (sources[k].num_channels == 1 && num_channels == 2));
+      // Mono sources are upmixed by reading each sample twice.
+      const int16_t sample = sources[k].num_channels == num_channels ?
+          sources[k].data[i] : sources[k].data[i >> 1];
+      if (sources[k].gain_q14 == kUnityGainQ14) {
+        sum += sample;
+      } else {
+        sum += (static_cast<int32_t>(sample) * sources[k].gain_q14) >> 14;
+      }
+    }
+    if (sum > 32767) {
+      sum = 32767;
+    } else if (sum < -32768) {
+      sum = -32768;
+    }
+    mixed[i] = static_cast<int16_t>(sum);
+  }
+}
+
+MixSourcesFunction GetMixSourcesFunction() {
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (WebRtc_GetCPUInfo(kSSE2))
+    return &MixSources_SSE2;
+#endif
+  return &MixSources_C;
+}
+
+}  // namespace webrtc
@@ -0,0 +1,60 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_AUDIO_CONFERENCE_MIXER_SOURCE_AUDIO_MIXING_H_
+#define WEBRTC_MODULES_AUDIO_CONFERENCE_MIXER_SOURCE_AUDIO_MIXING_H_
+
+#include <stddef.h>
+
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+
+// Gain of 1.0 in MixingSource::gain_q14.
+const int kUnityGainQ14 = 1 << 14;
+
+// Interleaved audio to be mixed, scaled by |gain_q14| / 2^14. Mono sources are
+// upmixed when mixed into stereo.
+struct MixingSource {
+  const int16_t* data;
+  int num_channels;
+  int16_t gain_q14;
+};
+
+// Writes the sum of |num_sources| sources of |samples_per_channel| samples to
+// |mixed|, which has |num_channels| interleaved channels. The sum is
+// accumulated in 32 bits and saturated once per sample, and each block of
+// |mixed| is written in a single pass over all sources. Sources may have
+// |num_channels| channels, or one channel if |num_channels| is 2.
+typedef void (*MixSourcesFunction)(const MixingSource* sources,
+                                   size_t num_sources,
+                                   int samples_per_channel,
+                                   int num_channels,
+                                   int16_t* mixed);
+
+void MixSources_C(const MixingSource* sources,
+                  size_t num_sources,
+                  int samples_per_channel,
+                  int num_channels,
+                  int16_t* mixed);
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+void MixSources_SSE2(const MixingSource* sources,
+                     size_t num_sources,
+                     int samples_per_channel,
+                     int num_channels,
+                     int16_t* mixed);
+#endif
+
+// Returns the fastest MixSources implementation supported by the CPU.
+MixSourcesFunction GetMixSourcesFunction();
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_AUDIO_CONFERENCE_MIXER_SOURCE_AUDIO_MIXING_H_
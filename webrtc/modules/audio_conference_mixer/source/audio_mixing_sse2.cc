@@ -0,0 +1,73 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/audio_conference_mixer/source/audio_mixing.h"
+
+#include <emmintrin.h>
+
+namespace webrtc {
+
+void MixSources_SSE2(const MixingSource* sources,
+                     size_t num_sources,
+                     int samples_per_channel,
+                     int num_channels,
+                     int16_t* mixed) {
+  const int length = samples_per_channel * num_channels;
+  int i = 0;
+  // Mix 8 output samples at a time, accumulating all sources in two registers
+  // of 32-bit sums.
+  for (; i + 8 <= length; i += 8) {
+    __m128i sum_lo = _mm_setzero_si128();
+    __m128i sum_hi = _mm_setzero_si128();
+    for (size_t k = 0; k < num_sources; ++k) {
+      __m128i samples;
+      if (sources[k].num_channels == num_channels) {
+        samples = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(&sources[k].data[i]));
+      } else {
+        // Upmix 4 mono samples to 4 stereo pairs.
+        samples = _mm_loadl_epi64(
+            reinterpret_cast<const __m128i*>(&sources[k].data[i >> 1]));
+        samples = _mm_unpacklo_epi16(samples, samples);
+      }
+      __m128i lo;
+      __m128i hi;
+      if (sources[k].gain_q14 == kUnityGainQ14) {
+        // Sign extend to 32 bits.
+        lo = _mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16);
+        hi = _mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16);
+      } else {
+        // Form the full 32-bit products from their low and high halves.
+        const __m128i gain = _mm_set1_epi16(sources[k].gain_q14);
+        const __m128i product_lo = _mm_mullo_epi16(samples, gain);
+        const __m128i product_hi = _mm_mulhi_epi16(samples, gain);
+        lo = _mm_srai_epi32(_mm_unpacklo_epi16(product_lo, product_hi), 14);
+        hi = _mm_srai_epi32(_mm_unpackhi_epi16(product_lo, product_hi), 14);
+      }
+      sum_lo = _mm_add_epi32(sum_lo, lo);
+      sum_hi = _mm_add_epi32(sum_hi, hi);
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&mixed[i]),
+                     _mm_packs_epi32(sum_lo, sum_hi));
+  }
+
+  for (; i < length; ++i) {
+    int32_t sum = 0;
+    for (size_t k = 0; k < num_sources; ++k) {
+      const int16_t sample = sources[k].num_channels == num_channels ?
+          sources[k].data[i] : sources[k].data[i >> 1];
+      sum += (static_cast<int32_t>(sample) * sources[k].gain_q14) >> 14;
+    }
+    mixed[i] = static_cast<int16_t>(
+        sum > 32767 ? 32767 : (sum < -32768 ? -32768 : sum));
+  }
+}
+
+}  // namespace webrtc
@@ -0,0 +1,164 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/audio_conference_mixer/source/audio_mixing.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/modules/interface/module_common_types.h"
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+
+namespace webrtc {
+namespace {
+
+const int kSamplesPerChannel = 480;  // 10 ms at 48 kHz.
+
+void FillRandom(int16_t* data, int length, int amplitude) {
+  for (int i = 0; i < length; ++i)
+    data[i] = static_cast<int16_t>(rand() % (2 * amplitude + 1) - amplitude);
+}
+
+// Mixes |num_sources| random frames, half of them mono, with |mix| and checks
+// the result against the generic implementation.
+void TestMixSources(MixSourcesFunction mix, size_t num_sources,
+                    int samples_per_channel, int amplitude) {
+  const int kNumChannels = 2;
+  std::vector<std::vector<int16_t> > data(num_sources);
+  std::vector<MixingSource> sources(num_sources);
+  for (size_t k = 0; k < num_sources; ++k) {
+    sources[k].num_channels = k % 2 == 0 ? kNumChannels : 1;
+    data[k].resize(samples_per_channel * sources[k].num_channels);
+    FillRandom(&data[k][0], static_cast<int>(data[k].size()), amplitude);
+    sources[k].data = &data[k][0];
+    sources[k].gain_q14 = k % 3 == 0 ? kUnityGainQ14 :
+        static_cast<int16_t>(rand() % (2 * kUnityGainQ14));
+  }
+  const int length = samples_per_channel * kNumChannels;
+  std::vector<int16_t> expected(length);
+  std::vector<int16_t> mixed(length);
+  MixSources_C(&sources[0], num_sources, samples_per_channel, kNumChannels,
+               &expected[0]);
+  mix(&sources[0], num_sources, samples_per_channel, kNumChannels, &mixed[0]);
+  for (int i = 0; i < length; ++i)
+    ASSERT_EQ(expected[i], mixed[i]) << "sample " << i;
+}
+
+}  // namespace
+
+TEST(AudioMixingTest, MixesWithGainAndUpmixing) {
+  const int16_t stereo[] = {100, -100, 2000, -2000};
+  const int16_t mono[] = {10, -30};
+  MixingSource sources[2];
+  sources[0].data = stereo;
+  sources[0].num_channels = 2;
+  sources[0].gain_q14 = kUnityGainQ14 / 2;
+  sources[1].data = mono;
+  sources[1].num_channels = 1;
+  sources[1].gain_q14 = kUnityGainQ14;
+  int16_t mixed[4];
+  MixSources_C(sources, 2, 2, 2, mixed);
+  EXPECT_EQ(60, mixed[0]);
+  EXPECT_EQ(-40, mixed[1]);
+  EXPECT_EQ(970, mixed[2]);
+  EXPECT_EQ(-1030, mixed[3]);
+}
+
+TEST(AudioMixingTest, SaturatesOnlyOnce) {
+  const int16_t loud[] = {30000, -30000};
+  const int16_t quiet[] = {-20000, 20000};
+  MixingSource sources[4];
+  for (int k = 0; k < 4; ++k) {
+    sources[k].data = k < 2 ? loud : quiet;
+    sources[k].num_channels = 1;
+    sources[k].gain_q14 = kUnityGainQ14;
+  }
+  int16_t mixed[2];
+  // The intermediate sums would saturate in 16 bits, but not the total.
+  MixSources_C(sources, 4, 2, 1, mixed);
+  EXPECT_EQ(20000, mixed[0]);
+  EXPECT_EQ(-20000, mixed[1]);
+  MixSources_C(sources, 3, 2, 1, mixed);
+  EXPECT_EQ(32767, mixed[0]);
+  EXPECT_EQ(-32768, mixed[1]);
+}
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+TEST(AudioMixingTest, SSE2MatchesGenericImplementation) {
+  if (!WebRtc_GetCPUInfo(kSSE2))
+    return;
+  srand(42);
+  const size_t kNumSources[] = {1, 2, 3, 10, 50};
+  for (size_t n = 0; n < sizeof(kNumSources) / sizeof(kNumSources[0]); ++n) {
+    SCOPED_TRACE(kNumSources[n]);
+    TestMixSources(&MixSources_SSE2, kNumSources[n], kSamplesPerChannel, 8000);
+    // Odd lengths exercise the tail, and loud input the saturation.
+    TestMixSources(&MixSources_SSE2, kNumSources[n], 441, 32768);
+  }
+}
+#endif
+
+// Compares the mixing kernel against mixing one AudioFrame at a time.
+TEST(AudioMixingTest, DISABLED_MixPerf) {
+  const int kNumChannels = 2;
+  const int kNumIterations = 10000;
+  const size_t kNumParticipants[] = {3, 10, 50};
+  MixSourcesFunction mix = GetMixSourcesFunction();
+  for (size_t n = 0; n < sizeof(kNumParticipants) / sizeof(kNumParticipants[0]);
+       ++n) {
+    const size_t num_participants = kNumParticipants[n];
+    std::vector<AudioFrame*> frames(num_participants);
+    std::vector<MixingSource> sources(num_participants);
+    for (size_t k = 0; k < num_participants; ++k) {
+      frames[k] = new AudioFrame();
+      frames[k]->samples_per_channel_ = kSamplesPerChannel;
+      frames[k]->num_channels_ = kNumChannels;
+      FillRandom(frames[k]->data_, kSamplesPerChannel * kNumChannels, 8000);
+      sources[k].data = frames[k]->data_;
+      sources[k].num_channels = kNumChannels;
+      sources[k].gain_q14 = kUnityGainQ14 / 2;
+    }
+    AudioFrame mixed;
+    mixed.num_channels_ = kNumChannels;
+
+    int64_t start_us = TickTime::MicrosecondTimestamp();
+    for (int i = 0; i < kNumIterations; ++i) {
+      mixed.samples_per_channel_ = 0;
+      for (size_t k = 0; k < num_participants; ++k) {
+        AudioFrame frame;
+        frame.CopyFrom(*frames[k]);
+        frame >>= 1;
+        mixed += frame;
+      }
+    }
+    const int64_t frame_us = TickTime::MicrosecondTimestamp() - start_us;
+
+    start_us = TickTime::MicrosecondTimestamp();
+    for (int i = 0; i < kNumIterations; ++i) {
+      mix(&sources[0], num_participants, kSamplesPerChannel, kNumChannels,
+          mixed.data_);
+    }
+    const int64_t kernel_us = TickTime::MicrosecondTimestamp() - start_us;
+
+    printf("%3d participants, 48 kHz stereo: AudioFrame %6.2f us, "
+           "kernel %6.2f us per 10 ms\n",
+           static_cast<int>(num_participants),
+           static_cast<double>(frame_us) / kNumIterations,
+           static_cast<double>(kernel_us) / kNumIterations);
+    for (size_t k = 0; k < num_participants; ++k)
+      delete frames[k];
+  }
+}
+
+}  // namespace webrtc
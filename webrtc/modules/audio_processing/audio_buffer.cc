@@ -460,4 +460,44 @@ void AudioBuffer::MergeFrequencyBands() {
   splitting_filter_->Synthesis(split_data_.get(), data_.get());
 }
 
+void AudioBuffer::SplitIntoFrequencyBands(AudioBuffer* const* buffers,
+                                          int num_buffers) {
+  FilterBatch(buffers, num_buffers, true);
+}
+
+void AudioBuffer::MergeFrequencyBands(AudioBuffer* const* buffers,
+                                      int num_buffers) {
+  FilterBatch(buffers, num_buffers, false);
+}
+
+void AudioBuffer::FilterBatch(AudioBuffer* const* buffers,
+                              int num_buffers,
+                              bool split) {
+  assert(num_buffers <= kMaxBatchSize);
+  SplittingFilter* filters[kMaxBatchSize];
+  IFChannelBuffer* data[kMaxBatchSize];
+  IFChannelBuffer* split_data[kMaxBatchSize];
+  bool done[kMaxBatchSize] = {false};
+  for (int i = 0; i < num_buffers; ++i) {
+    if (done[i]) {
+      continue;
+    }
+    int num_filters = 0;
+    for (int j = i; j < num_buffers; ++j) {
+      if (!done[j] && buffers[j]->num_bands_ == buffers[i]->num_bands_) {
+        filters[num_filters] = buffers[j]->splitting_filter_.get();
+        data[num_filters] = buffers[j]->data_.get();
+        split_data[num_filters] = buffers[j]->split_data_.get();
+        ++num_filters;
+        done[j] = true;
+      }
+    }
+    if (split) {
+      SplittingFilter::AnalysisBatch(filters, data, split_data, num_filters);
+    } else {
+      SplittingFilter::SynthesisBatch(filters, split_data, data, num_filters);
+    }
+  }
+}
+
 }  // namespace webrtc
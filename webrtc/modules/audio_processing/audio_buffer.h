@@ -128,10 +128,25 @@ class AudioBuffer {
   // Recombine the different bands into one signal.
   void MergeFrequencyBands();
 
+  static const int kMaxBatchSize = 16;
+  // Same as calling SplitIntoFrequencyBands() or MergeFrequencyBands() on each
+  // of up to kMaxBatchSize |buffers|. Buffers with the same number of bands
+  // are filtered together.
+  static void SplitIntoFrequencyBands(AudioBuffer* const* buffers,
+                                      int num_buffers);
+  static void MergeFrequencyBands(AudioBuffer* const* buffers,
+                                  int num_buffers);
+
  private:
   // Called from DeinterleaveFrom() and CopyFrom().
   void InitForNewData();
 
+  // Runs the analysis, if |split| is true, or the synthesis of the splitting
+  // filters of |buffers|.
+  static void FilterBatch(AudioBuffer* const* buffers,
+                          int num_buffers,
+                          bool split);
+
   // The audio is passed into DeinterleaveFrom() or CopyFrom() with input
   // format (samples per channel and number of channels).
   const int input_num_frames_;
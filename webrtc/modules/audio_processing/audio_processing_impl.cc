@@ -12,6 +12,8 @@
 
 #include <assert.h>
 
+#include <algorithm>
+
 #include "webrtc/base/platform_file.h"
 #include "webrtc/common_audio/include/audio_util.h"
 #include "webrtc/common_audio/channel_buffer.h"
@@ -35,13 +37,8 @@
 #include "webrtc/system_wrappers/interface/logging.h"
 
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
-// Files generated at build-time by the protobuf compiler.
-#ifdef WEBRTC_ANDROID_PLATFORM_BUILD
-#include "external/webrtc/webrtc/modules/audio_processing/debug.pb.h"
-#else
-#include "webrtc/audio_processing/debug.pb.h"
+#include "webrtc/modules/audio_processing/debug_dump_writer.h"
 #endif
-#endif  // WEBRTC_AUDIOPROC_DEBUG_DUMP
 
 #define RETURN_ON_ERR(expr)  \
   do {                       \
@@ -56,6 +53,14 @@ namespace webrtc {
 // Throughout webrtc, it's assumed that success is represented by zero.
 static_assert(AudioProcessing::kNoError == 0, "kNoError must be zero");
 
+const int AudioProcessingImpl::kMaxBatchSize;
+
+#ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
+// Debug dump records waiting to be written are dropped beyond this size. At
+// 48 kHz stereo this is a few seconds of the writer falling behind.
+static const size_t kMaxQueuedDebugDumpBytes = 4 * 1024 * 1024;
+#endif
+
 // This class has two main functionalities:
 //
 // 1) It is returned instead of the real GainControl after the new AGC has been
@@ -156,11 +161,8 @@ AudioProcessingImpl::AudioProcessingImpl(const Config& config,
       level_estimator_(NULL),
       noise_suppression_(NULL),
       voice_detection_(NULL),
+      render_crit_(CriticalSectionWrapper::CreateCriticalSection()),
       crit_(CriticalSectionWrapper::CreateCriticalSection()),
-#ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
-      debug_file_(FileWrapper::Create()),
-      event_msg_(new audioproc::Event()),
-#endif
       fwd_in_format_(kSampleRate16kHz, 1),
       fwd_proc_format_(kSampleRate16kHz),
       fwd_out_format_(kSampleRate16kHz, 1),
@@ -211,6 +213,7 @@ AudioProcessingImpl::AudioProcessingImpl(const Config& config,
 
 AudioProcessingImpl::~AudioProcessingImpl() {
   {
+    CriticalSectionScoped crit_render(render_crit_);
     CriticalSectionScoped crit_scoped(crit_);
     // Depends on gain_control_ and gain_control_for_new_agc_.
     agc_manager_.reset();
@@ -224,21 +227,23 @@ AudioProcessingImpl::~AudioProcessingImpl() {
     }
 
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
-    if (debug_file_->Open()) {
-      debug_file_->CloseFile();
-    }
+    debug_writer_.reset();
 #endif
   }
   delete crit_;
   crit_ = NULL;
+  delete render_crit_;
+  render_crit_ = NULL;
 }
 
 int AudioProcessingImpl::Initialize() {
+  CriticalSectionScoped crit_render(render_crit_);
   CriticalSectionScoped crit_scoped(crit_);
   return InitializeLocked();
 }
 
 int AudioProcessingImpl::set_sample_rate_hz(int rate) {
+  CriticalSectionScoped crit_render(render_crit_);
   CriticalSectionScoped crit_scoped(crit_);
   return InitializeLocked(rate,
                           rate,
@@ -254,6 +259,7 @@ int AudioProcessingImpl::Initialize(int input_sample_rate_hz,
                                     ChannelLayout input_layout,
                                     ChannelLayout output_layout,
                                     ChannelLayout reverse_layout) {
+  CriticalSectionScoped crit_render(render_crit_);
   CriticalSectionScoped crit_scoped(crit_);
   return InitializeLocked(input_sample_rate_hz,
                           output_sample_rate_hz,
@@ -293,11 +299,8 @@ int AudioProcessingImpl::InitializeLocked() {
   InitializeBeamformer();
 
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
-  if (debug_file_->Open()) {
-    int err = WriteInitMessage();
-    if (err != kNoError) {
-      return err;
-    }
+  if (debug_writer_.get()) {
+    WriteInitMessage();
   }
 #endif
 
@@ -380,6 +383,22 @@ int AudioProcessingImpl::InitializeLocked(int input_sample_rate_hz,
   return InitializeLocked();
 }
 
+// Returns true if any of the audio parameters differ from their current
+// values. Either lock is enough to read them.
+bool AudioProcessingImpl::FormatChanged(int input_sample_rate_hz,
+                                        int output_sample_rate_hz,
+                                        int reverse_sample_rate_hz,
+                                        int num_input_channels,
+                                        int num_output_channels,
+                                        int num_reverse_channels) const {
+  return input_sample_rate_hz != fwd_in_format_.rate() ||
+         output_sample_rate_hz != fwd_out_format_.rate() ||
+         reverse_sample_rate_hz != rev_in_format_.rate() ||
+         num_input_channels != fwd_in_format_.num_channels() ||
+         num_output_channels != fwd_out_format_.num_channels() ||
+         num_reverse_channels != rev_in_format_.num_channels();
+}
+
 // Calls InitializeLocked() if any of the audio parameters have changed from
 // their current values.
 int AudioProcessingImpl::MaybeInitializeLocked(int input_sample_rate_hz,
@@ -388,12 +407,9 @@ int AudioProcessingImpl::MaybeInitializeLocked(int input_sample_rate_hz,
                                                int num_input_channels,
                                                int num_output_channels,
                                                int num_reverse_channels) {
-  if (input_sample_rate_hz == fwd_in_format_.rate() &&
-      output_sample_rate_hz == fwd_out_format_.rate() &&
-      reverse_sample_rate_hz == rev_in_format_.rate() &&
-      num_input_channels == fwd_in_format_.num_channels() &&
-      num_output_channels == fwd_out_format_.num_channels() &&
-      num_reverse_channels == rev_in_format_.num_channels()) {
+  if (!FormatChanged(input_sample_rate_hz, output_sample_rate_hz,
+                     reverse_sample_rate_hz, num_input_channels,
+                     num_output_channels, num_reverse_channels)) {
     return kNoError;
   }
   return InitializeLocked(input_sample_rate_hz,
@@ -404,6 +420,49 @@ int AudioProcessingImpl::MaybeInitializeLocked(int input_sample_rate_hz,
                           num_reverse_channels);
 }
 
+int AudioProcessingImpl::MaybeInitializeCapture(int input_sample_rate_hz,
+                                                int output_sample_rate_hz,
+                                                int num_input_channels,
+                                                int num_output_channels) {
+  {
+    CriticalSectionScoped crit_scoped(crit_);
+    if (!FormatChanged(input_sample_rate_hz, output_sample_rate_hz,
+                       rev_in_format_.rate(), num_input_channels,
+                       num_output_channels, rev_in_format_.num_channels())) {
+      return kNoError;
+    }
+  }
+  // The render lock has to be taken first.
+  CriticalSectionScoped crit_render(render_crit_);
+  CriticalSectionScoped crit_scoped(crit_);
+  return MaybeInitializeLocked(input_sample_rate_hz,
+                               output_sample_rate_hz,
+                               rev_in_format_.rate(),
+                               num_input_channels,
+                               num_output_channels,
+                               rev_in_format_.num_channels());
+}
+
+int AudioProcessingImpl::MaybeInitializeRender(int input_sample_rate_hz,
+                                               int output_sample_rate_hz,
+                                               int reverse_sample_rate_hz,
+                                               int num_input_channels,
+                                               int num_output_channels,
+                                               int num_reverse_channels) {
+  if (!FormatChanged(input_sample_rate_hz, output_sample_rate_hz,
+                     reverse_sample_rate_hz, num_input_channels,
+                     num_output_channels, num_reverse_channels)) {
+    return kNoError;
+  }
+  CriticalSectionScoped crit_scoped(crit_);
+  return InitializeLocked(input_sample_rate_hz,
+                          output_sample_rate_hz,
+                          reverse_sample_rate_hz,
+                          num_input_channels,
+                          num_output_channels,
+                          num_reverse_channels);
+}
+
 void AudioProcessingImpl::SetExtraOptions(const Config& config) {
   CriticalSectionScoped crit_scoped(crit_);
   for (auto item : component_list_) {
@@ -466,29 +525,27 @@ int AudioProcessingImpl::ProcessStream(const float* const* src,
                                        int output_sample_rate_hz,
                                        ChannelLayout output_layout,
                                        float* const* dest) {
-  CriticalSectionScoped crit_scoped(crit_);
   if (!src || !dest) {
     return kNullPointerError;
   }
 
-  RETURN_ON_ERR(MaybeInitializeLocked(input_sample_rate_hz,
-                                      output_sample_rate_hz,
-                                      rev_in_format_.rate(),
-                                      ChannelsFromLayout(input_layout),
-                                      ChannelsFromLayout(output_layout),
-                                      rev_in_format_.num_channels()));
+  RETURN_ON_ERR(MaybeInitializeCapture(input_sample_rate_hz,
+                                       output_sample_rate_hz,
+                                       ChannelsFromLayout(input_layout),
+                                       ChannelsFromLayout(output_layout)));
+  CriticalSectionScoped crit_scoped(crit_);
   if (samples_per_channel != fwd_in_format_.samples_per_channel()) {
     return kBadDataLengthError;
   }
 
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
-  if (debug_file_->Open()) {
-    event_msg_->set_type(audioproc::Event::STREAM);
-    audioproc::Stream* msg = event_msg_->mutable_stream();
+  if (debug_writer_.get()) {
+    DebugDumpWriter::Producer* dump = debug_writer_->capture();
+    dump->BeginRecord(DebugDumpWriter::kStream);
     const size_t channel_size =
         sizeof(float) * fwd_in_format_.samples_per_channel();
     for (int i = 0; i < fwd_in_format_.num_channels(); ++i)
-      msg->add_input_channel(src[i], channel_size);
+      dump->AddChunk(DebugDumpWriter::kInputChannel, src[i], channel_size);
   }
 #endif
 
@@ -499,13 +556,13 @@ int AudioProcessingImpl::ProcessStream(const float* const* src,
                          dest);
 
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
-  if (debug_file_->Open()) {
-    audioproc::Stream* msg = event_msg_->mutable_stream();
+  if (debug_writer_.get()) {
     const size_t channel_size =
         sizeof(float) * fwd_out_format_.samples_per_channel();
+    DebugDumpWriter::Producer* dump = debug_writer_->capture();
     for (int i = 0; i < fwd_out_format_.num_channels(); ++i)
-      msg->add_output_channel(dest[i], channel_size);
-    RETURN_ON_ERR(WriteMessageToDebugFile());
+      dump->AddChunk(DebugDumpWriter::kOutputChannel, dest[i], channel_size);
+    dump->EndRecord();
   }
 #endif
 
@@ -513,7 +570,100 @@ int AudioProcessingImpl::ProcessStream(const float* const* src,
 }
 
 int AudioProcessingImpl::ProcessStream(AudioFrame* frame) {
+  RETURN_ON_ERR(MaybeInitializeCaptureFrame(frame));
   CriticalSectionScoped crit_scoped(crit_);
+  RETURN_ON_ERR(ReadCaptureFrameLocked(frame));
+  RETURN_ON_ERR(ProcessStreamLocked());
+  WriteCaptureFrameLocked(frame);
+  return kNoError;
+}
+
+int AudioProcessing::ProcessStreams(AudioProcessing* const* apms,
+                                    AudioFrame* const* frames,
+                                    int num_streams,
+                                    int* stream_errors) {
+  int first_error = kNoError;
+  for (int i = 0; i < num_streams; i += AudioProcessingImpl::kMaxBatchSize) {
+    int errors[AudioProcessingImpl::kMaxBatchSize];
+    const int batch_size =
+        std::min(num_streams - i, AudioProcessingImpl::kMaxBatchSize);
+    AudioProcessingImpl::ProcessStreamBatch(&apms[i], &frames[i], batch_size,
+                                            errors);
+    for (int j = 0; j < batch_size; ++j) {
+      if (first_error == kNoError) {
+        first_error = errors[j];
+      }
+      if (stream_errors) {
+        stream_errors[i + j] = errors[j];
+      }
+    }
+  }
+  return first_error;
+}
+
+void AudioProcessingImpl::ProcessStreamBatch(AudioProcessing* const* apms,
+                                             AudioFrame* const* frames,
+                                             int num_streams,
+                                             int* stream_errors) {
+  assert(num_streams <= kMaxBatchSize);
+  AudioProcessingImpl* apm[kMaxBatchSize];
+  bool data_processed[kMaxBatchSize];
+  AudioBuffer* buffers[kMaxBatchSize];
+  int num_buffers = 0;
+
+  for (int i = 0; i < num_streams; ++i) {
+    apm[i] = static_cast<AudioProcessingImpl*>(apms[i]);
+    stream_errors[i] = apm[i]->MaybeInitializeCaptureFrame(frames[i]);
+  }
+  for (int i = 0; i < num_streams; ++i) {
+    apm[i]->crit_->Enter();
+  }
+
+  // Each stream goes through the same stages as in ProcessStream(), and is
+  // left out of the remaining ones as soon as one of them fails.
+  for (int i = 0; i < num_streams; ++i) {
+    if (stream_errors[i] == kNoError) {
+      stream_errors[i] = apm[i]->ReadCaptureFrameLocked(frames[i]);
+    }
+    if (stream_errors[i] == kNoError) {
+      stream_errors[i] = apm[i]->BeginCaptureLocked();
+    }
+    if (stream_errors[i] == kNoError) {
+      data_processed[i] = apm[i]->is_data_processed();
+      if (apm[i]->analysis_needed(data_processed[i])) {
+        buffers[num_buffers++] = apm[i]->capture_audio_.get();
+      }
+    }
+  }
+  AudioBuffer::SplitIntoFrequencyBands(buffers, num_buffers);
+
+  num_buffers = 0;
+  for (int i = 0; i < num_streams; ++i) {
+    if (stream_errors[i] == kNoError) {
+      stream_errors[i] = apm[i]->ProcessSplitBandsLocked();
+    }
+    if (stream_errors[i] == kNoError &&
+        apm[i]->synthesis_needed(data_processed[i])) {
+      buffers[num_buffers++] = apm[i]->capture_audio_.get();
+    }
+  }
+  AudioBuffer::MergeFrequencyBands(buffers, num_buffers);
+
+  for (int i = 0; i < num_streams; ++i) {
+    if (stream_errors[i] == kNoError) {
+      stream_errors[i] = apm[i]->EndCaptureLocked();
+    }
+    if (stream_errors[i] == kNoError) {
+      apm[i]->WriteCaptureFrameLocked(frames[i]);
+    }
+  }
+
+  for (int i = num_streams - 1; i >= 0; --i) {
+    apm[i]->crit_->Leave();
+  }
+}
+
+int AudioProcessingImpl::MaybeInitializeCaptureFrame(AudioFrame* frame) {
   if (!frame) {
     return kNullPointerError;
   }
@@ -524,62 +674,89 @@ int AudioProcessingImpl::ProcessStream(AudioFrame* frame) {
       frame->sample_rate_hz_ != kSampleRate48kHz) {
     return kBadSampleRateError;
   }
-  if (echo_control_mobile_->is_enabled() &&
-      frame->sample_rate_hz_ > kSampleRate16kHz) {
-    LOG(LS_ERROR) << "AECM only supports 16 or 8 kHz sample rates";
-    return kUnsupportedComponentError;
+  {
+    CriticalSectionScoped crit_scoped(crit_);
+    if (echo_control_mobile_->is_enabled() &&
+        frame->sample_rate_hz_ > kSampleRate16kHz) {
+      LOG(LS_ERROR) << "AECM only supports 16 or 8 kHz sample rates";
+      return kUnsupportedComponentError;
+    }
   }
 
   // TODO(ajm): The input and output rates and channels are currently
   // constrained to be identical in the int16 interface.
-  RETURN_ON_ERR(MaybeInitializeLocked(frame->sample_rate_hz_,
-                                      frame->sample_rate_hz_,
-                                      rev_in_format_.rate(),
-                                      frame->num_channels_,
-                                      frame->num_channels_,
-                                      rev_in_format_.num_channels()));
+  return MaybeInitializeCapture(frame->sample_rate_hz_,
+                                frame->sample_rate_hz_,
+                                frame->num_channels_,
+                                frame->num_channels_);
+}
+
+int AudioProcessingImpl::ReadCaptureFrameLocked(AudioFrame* frame) {
   if (frame->samples_per_channel_ != fwd_in_format_.samples_per_channel()) {
     return kBadDataLengthError;
   }
 
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
-  if (debug_file_->Open()) {
-    event_msg_->set_type(audioproc::Event::STREAM);
-    audioproc::Stream* msg = event_msg_->mutable_stream();
+  if (debug_writer_.get()) {
+    DebugDumpWriter::Producer* dump = debug_writer_->capture();
+    dump->BeginRecord(DebugDumpWriter::kStream);
     const size_t data_size = sizeof(int16_t) *
                              frame->samples_per_channel_ *
                              frame->num_channels_;
-    msg->set_input_data(frame->data_, data_size);
+    dump->AddChunk(DebugDumpWriter::kInputData, frame->data_, data_size);
   }
 #endif
 
   capture_audio_->DeinterleaveFrom(frame);
-  RETURN_ON_ERR(ProcessStreamLocked());
+  return kNoError;
+}
+
+void AudioProcessingImpl::WriteCaptureFrameLocked(AudioFrame* frame) {
   capture_audio_->InterleaveTo(frame, output_copy_needed(is_data_processed()));
 
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
-  if (debug_file_->Open()) {
-    audioproc::Stream* msg = event_msg_->mutable_stream();
+  if (debug_writer_.get()) {
     const size_t data_size = sizeof(int16_t) *
                              frame->samples_per_channel_ *
                              frame->num_channels_;
-    msg->set_output_data(frame->data_, data_size);
-    RETURN_ON_ERR(WriteMessageToDebugFile());
+    DebugDumpWriter::Producer* dump = debug_writer_->capture();
+    dump->AddChunk(DebugDumpWriter::kOutputData, frame->data_, data_size);
+    dump->EndRecord();
   }
 #endif
+}
 
-  return kNoError;
+int AudioProcessingImpl::ProcessStreamLocked() {
+  RETURN_ON_ERR(BeginCaptureLocked());
+
+  bool data_processed = is_data_processed();
+  if (analysis_needed(data_processed)) {
+    capture_audio_->SplitIntoFrequencyBands();
+  }
+
+  RETURN_ON_ERR(ProcessSplitBandsLocked());
+
+  if (synthesis_needed(data_processed)) {
+    capture_audio_->MergeFrequencyBands();
+  }
+
+  return EndCaptureLocked();
 }
 
+int AudioProcessingImpl::BeginCaptureLocked() {
+  // Far-end audio queued by the render thread since the last call.
+  RETURN_ON_ERR(echo_cancellation_->ReadQueuedRenderData());
+  RETURN_ON_ERR(echo_control_mobile_->ReadQueuedRenderData());
+  RETURN_ON_ERR(gain_control_->ReadQueuedRenderData());
 
-int AudioProcessingImpl::ProcessStreamLocked() {
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
-  if (debug_file_->Open()) {
-    audioproc::Stream* msg = event_msg_->mutable_stream();
-    msg->set_delay(stream_delay_ms_);
-    msg->set_drift(echo_cancellation_->stream_drift_samples());
-    msg->set_level(gain_control()->stream_analog_level());
-    msg->set_keypress(key_pressed_);
+  if (debug_writer_.get()) {
+    DebugDumpWriter::StreamFields fields;
+    fields.delay = stream_delay_ms_;
+    fields.drift = echo_cancellation_->stream_drift_samples();
+    fields.level = gain_control()->stream_analog_level();
+    fields.keypress = key_pressed_;
+    debug_writer_->capture()->SetStreamFields(fields);
   }
 #endif
 
@@ -589,12 +766,11 @@ int AudioProcessingImpl::ProcessStreamLocked() {
                                     ca->num_channels(),
                                     fwd_proc_format_.samples_per_channel());
   }
+  return kNoError;
+}
 
-  bool data_processed = is_data_processed();
-  if (analysis_needed(data_processed)) {
-    ca->SplitIntoFrequencyBands();
-  }
-
+int AudioProcessingImpl::ProcessSplitBandsLocked() {
+  AudioBuffer* ca = capture_audio_.get();  // For brevity.
   if (beamformer_enabled_) {
     beamformer_->ProcessChunk(*ca->split_data_f(), ca->split_data_f());
     ca->set_num_channels(1);
@@ -619,12 +795,11 @@ int AudioProcessingImpl::ProcessStreamLocked() {
                           ca->num_frames_per_band(),
                           split_rate_);
   }
-  RETURN_ON_ERR(gain_control_->ProcessCaptureAudio(ca));
-
-  if (synthesis_needed(data_processed)) {
-    ca->MergeFrequencyBands();
-  }
+  return gain_control_->ProcessCaptureAudio(ca);
+}
 
+int AudioProcessingImpl::EndCaptureLocked() {
+  AudioBuffer* ca = capture_audio_.get();  // For brevity.
   // TODO(aluebs): Investigate if the transient suppression placement should be
   // before or after the AGC.
   if (transient_suppressor_enabled_) {
@@ -653,13 +828,13 @@ int AudioProcessingImpl::AnalyzeReverseStream(const float* const* data,
                                               int samples_per_channel,
                                               int sample_rate_hz,
                                               ChannelLayout layout) {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_scoped(render_crit_);
   if (data == NULL) {
     return kNullPointerError;
   }
 
   const int num_channels = ChannelsFromLayout(layout);
-  RETURN_ON_ERR(MaybeInitializeLocked(fwd_in_format_.rate(),
+  RETURN_ON_ERR(MaybeInitializeRender(fwd_in_format_.rate(),
                                       fwd_out_format_.rate(),
                                       sample_rate_hz,
                                       fwd_in_format_.num_channels(),
@@ -670,14 +845,14 @@ int AudioProcessingImpl::AnalyzeReverseStream(const float* const* data,
   }
 
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
-  if (debug_file_->Open()) {
-    event_msg_->set_type(audioproc::Event::REVERSE_STREAM);
-    audioproc::ReverseStream* msg = event_msg_->mutable_reverse_stream();
+  if (debug_writer_.get()) {
+    DebugDumpWriter::Producer* dump = debug_writer_->render();
+    dump->BeginRecord(DebugDumpWriter::kReverseStream);
     const size_t channel_size =
         sizeof(float) * rev_in_format_.samples_per_channel();
     for (int i = 0; i < num_channels; ++i)
-      msg->add_channel(data[i], channel_size);
-    RETURN_ON_ERR(WriteMessageToDebugFile());
+      dump->AddChunk(DebugDumpWriter::kReverseChannel, data[i], channel_size);
+    dump->EndRecord();
   }
 #endif
 
@@ -686,7 +861,7 @@ int AudioProcessingImpl::AnalyzeReverseStream(const float* const* data,
 }
 
 int AudioProcessingImpl::AnalyzeReverseStream(AudioFrame* frame) {
-  CriticalSectionScoped crit_scoped(crit_);
+  CriticalSectionScoped crit_scoped(render_crit_);
   if (frame == NULL) {
     return kNullPointerError;
   }
@@ -702,7 +877,7 @@ int AudioProcessingImpl::AnalyzeReverseStream(AudioFrame* frame) {
     return kBadSampleRateError;
   }
 
-  RETURN_ON_ERR(MaybeInitializeLocked(fwd_in_format_.rate(),
+  RETURN_ON_ERR(MaybeInitializeRender(fwd_in_format_.rate(),
                                       fwd_out_format_.rate(),
                                       frame->sample_rate_hz_,
                                       fwd_in_format_.num_channels(),
@@ -713,14 +888,14 @@ int AudioProcessingImpl::AnalyzeReverseStream(AudioFrame* frame) {
   }
 
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
-  if (debug_file_->Open()) {
-    event_msg_->set_type(audioproc::Event::REVERSE_STREAM);
-    audioproc::ReverseStream* msg = event_msg_->mutable_reverse_stream();
+  if (debug_writer_.get()) {
+    DebugDumpWriter::Producer* dump = debug_writer_->render();
+    dump->BeginRecord(DebugDumpWriter::kReverseStream);
     const size_t data_size = sizeof(int16_t) *
                              frame->samples_per_channel_ *
                              frame->num_channels_;
-    msg->set_data(frame->data_, data_size);
-    RETURN_ON_ERR(WriteMessageToDebugFile());
+    dump->AddChunk(DebugDumpWriter::kReverseData, frame->data_, data_size);
+    dump->EndRecord();
   }
 #endif
 
@@ -790,6 +965,7 @@ int AudioProcessingImpl::delay_offset_ms() const {
 
 int AudioProcessingImpl::StartDebugRecording(
     const char filename[AudioProcessing::kMaxFilenameSize]) {
+  CriticalSectionScoped crit_render(render_crit_);
   CriticalSectionScoped crit_scoped(crit_);
   assert(kMaxFilenameSize == FileWrapper::kMaxFileNameSize);
 
@@ -799,21 +975,14 @@ int AudioProcessingImpl::StartDebugRecording(
 
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
   // Stop any ongoing recording.
-  if (debug_file_->Open()) {
-    if (debug_file_->CloseFile() == -1) {
-      return kFileError;
-    }
-  }
+  RETURN_ON_ERR(StopDebugWriterLocked());
 
-  if (debug_file_->OpenFile(filename, false) == -1) {
-    debug_file_->CloseFile();
+  rtc::scoped_ptr<FileWrapper> debug_file(FileWrapper::Create());
+  if (debug_file->OpenFile(filename, false) == -1) {
+    debug_file->CloseFile();
     return kFileError;
   }
-
-  int err = WriteInitMessage();
-  if (err != kNoError) {
-    return err;
-  }
+  StartDebugWriterLocked(debug_file.release());
   return kNoError;
 #else
   return kUnsupportedFunctionError;
@@ -821,6 +990,7 @@ int AudioProcessingImpl::StartDebugRecording(
 }
 
 int AudioProcessingImpl::StartDebugRecording(FILE* handle) {
+  CriticalSectionScoped crit_render(render_crit_);
   CriticalSectionScoped crit_scoped(crit_);
 
   if (handle == NULL) {
@@ -829,20 +999,13 @@ int AudioProcessingImpl::StartDebugRecording(FILE* handle) {
 
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
   // Stop any ongoing recording.
-  if (debug_file_->Open()) {
-    if (debug_file_->CloseFile() == -1) {
-      return kFileError;
-    }
-  }
+  RETURN_ON_ERR(StopDebugWriterLocked());
 
-  if (debug_file_->OpenFromFileHandle(handle, true, false) == -1) {
+  rtc::scoped_ptr<FileWrapper> debug_file(FileWrapper::Create());
+  if (debug_file->OpenFromFileHandle(handle, true, false) == -1) {
     return kFileError;
   }
-
-  int err = WriteInitMessage();
-  if (err != kNoError) {
-    return err;
-  }
+  StartDebugWriterLocked(debug_file.release());
   return kNoError;
 #else
   return kUnsupportedFunctionError;
@@ -856,16 +1019,11 @@ int AudioProcessingImpl::StartDebugRecordingForPlatformFile(
 }
 
 int AudioProcessingImpl::StopDebugRecording() {
+  CriticalSectionScoped crit_render(render_crit_);
   CriticalSectionScoped crit_scoped(crit_);
 
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
-  // We just return if recording hasn't started.
-  if (debug_file_->Open()) {
-    if (debug_file_->CloseFile() == -1) {
-      return kFileError;
-    }
-  }
-  return kNoError;
+  return StopDebugWriterLocked();
 #else
   return kUnsupportedFunctionError;
 #endif  // WEBRTC_AUDIOPROC_DEBUG_DUMP
@@ -987,49 +1145,37 @@ void AudioProcessingImpl::InitializeBeamformer() {
 }
 
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
-int AudioProcessingImpl::WriteMessageToDebugFile() {
-  int32_t size = event_msg_->ByteSize();
-  if (size <= 0) {
-    return kUnspecifiedError;
-  }
-#if defined(WEBRTC_ARCH_BIG_ENDIAN)
-  // TODO(ajm): Use little-endian "on the wire". For the moment, we can be
-  //            pretty safe in assuming little-endian.
-#endif
-
-  if (!event_msg_->SerializeToString(&event_str_)) {
-    return kUnspecifiedError;
-  }
-
-  // Write message preceded by its size.
-  if (!debug_file_->Write(&size, sizeof(int32_t))) {
-    return kFileError;
-  }
-  if (!debug_file_->Write(event_str_.data(), event_str_.length())) {
-    return kFileError;
-  }
-
-  event_msg_->Clear();
-
-  return kNoError;
+void AudioProcessingImpl::StartDebugWriterLocked(FileWrapper* debug_file) {
+  debug_writer_.reset(
+      new DebugDumpWriter(debug_file, kMaxQueuedDebugDumpBytes));
+  WriteInitMessage();
 }
 
-int AudioProcessingImpl::WriteInitMessage() {
-  event_msg_->set_type(audioproc::Event::INIT);
-  audioproc::Init* msg = event_msg_->mutable_init();
-  msg->set_sample_rate(fwd_in_format_.rate());
-  msg->set_num_input_channels(fwd_in_format_.num_channels());
-  msg->set_num_output_channels(fwd_out_format_.num_channels());
-  msg->set_num_reverse_channels(rev_in_format_.num_channels());
-  msg->set_reverse_sample_rate(rev_in_format_.rate());
-  msg->set_output_sample_rate(fwd_out_format_.rate());
-
-  int err = WriteMessageToDebugFile();
-  if (err != kNoError) {
-    return err;
+int AudioProcessingImpl::StopDebugWriterLocked() {
+  // We just return if recording hasn't started.
+  if (!debug_writer_.get()) {
+    return kNoError;
   }
+  // Writes the remaining records and reports any write error since the
+  // recording started.
+  const bool ok = debug_writer_->Stop();
+  debug_writer_.reset();
+  return ok ? kNoError : kFileError;
+}
 
-  return kNoError;
+void AudioProcessingImpl::WriteInitMessage() {
+  DebugDumpWriter::InitFields fields;
+  fields.sample_rate = fwd_in_format_.rate();
+  fields.num_input_channels = fwd_in_format_.num_channels();
+  fields.num_output_channels = fwd_out_format_.num_channels();
+  fields.num_reverse_channels = rev_in_format_.num_channels();
+  fields.reverse_sample_rate = rev_in_format_.rate();
+  fields.output_sample_rate = fwd_out_format_.rate();
+
+  DebugDumpWriter::Producer* dump = debug_writer_->capture();
+  dump->BeginRecord(DebugDumpWriter::kInit);
+  dump->SetInitFields(fields);
+  dump->EndRecord();
 }
 #endif  // WEBRTC_AUDIOPROC_DEBUG_DUMP
 
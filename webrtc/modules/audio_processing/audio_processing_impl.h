@@ -40,11 +40,7 @@ class TransientSuppressor;
 class VoiceDetectionImpl;
 
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
-namespace audioproc {
-
-class Event;
-
-}  // namespace audioproc
+class DebugDumpWriter;
 #endif
 
 class AudioRate {
@@ -144,9 +140,19 @@ class AudioProcessingImpl : public AudioProcessing {
   NoiseSuppression* noise_suppression() const override;
   VoiceDetection* voice_detection() const override;
 
+  // The number of streams ProcessStreamBatch() takes at once.
+  static const int kMaxBatchSize = 16;
+
+  // Runs AudioProcessing::ProcessStreams() on up to kMaxBatchSize streams,
+  // holding the capture locks of all of them.
+  static void ProcessStreamBatch(AudioProcessing* const* apms,
+                                 AudioFrame* const* frames,
+                                 int num_streams,
+                                 int* stream_errors) NO_THREAD_SAFETY_ANALYSIS;
+
  protected:
   // Overridden in a mock.
-  virtual int InitializeLocked() EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  virtual int InitializeLocked() EXCLUSIVE_LOCKS_REQUIRED(render_crit_, crit_);
 
  private:
   int InitializeLocked(int input_sample_rate_hz,
@@ -155,16 +161,53 @@ class AudioProcessingImpl : public AudioProcessing {
                        int num_input_channels,
                        int num_output_channels,
                        int num_reverse_channels)
-      EXCLUSIVE_LOCKS_REQUIRED(crit_);
+      EXCLUSIVE_LOCKS_REQUIRED(render_crit_, crit_);
+  bool FormatChanged(int input_sample_rate_hz,
+                     int output_sample_rate_hz,
+                     int reverse_sample_rate_hz,
+                     int num_input_channels,
+                     int num_output_channels,
+                     int num_reverse_channels) const;
   int MaybeInitializeLocked(int input_sample_rate_hz,
                             int output_sample_rate_hz,
                             int reverse_sample_rate_hz,
                             int num_input_channels,
                             int num_output_channels,
                             int num_reverse_channels)
+      EXCLUSIVE_LOCKS_REQUIRED(render_crit_, crit_);
+  // Called from the capture side without any lock held. Only takes the render
+  // lock if the forward format has changed.
+  int MaybeInitializeCapture(int input_sample_rate_hz,
+                             int output_sample_rate_hz,
+                             int num_input_channels,
+                             int num_output_channels)
+      LOCKS_EXCLUDED(crit_);
+  // Only takes the capture lock if the format has changed.
+  int MaybeInitializeRender(int input_sample_rate_hz,
+                            int output_sample_rate_hz,
+                            int reverse_sample_rate_hz,
+                            int num_input_channels,
+                            int num_output_channels,
+                            int num_reverse_channels)
+      EXCLUSIVE_LOCKS_REQUIRED(render_crit_);
+  // The stages of ProcessStream(AudioFrame*), which ProcessStreamBatch() runs
+  // on all the streams in turn.
+  //
+  // Checks |frame| and initializes for its format if it has changed.
+  int MaybeInitializeCaptureFrame(AudioFrame* frame) LOCKS_EXCLUDED(crit_);
+  int ReadCaptureFrameLocked(AudioFrame* frame) EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  void WriteCaptureFrameLocked(AudioFrame* frame)
       EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
+  // The stages of ProcessStreamLocked(). The capture audio is split into bands
+  // between the first and second, and merged again between the second and
+  // third, if needed.
+  int BeginCaptureLocked() EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  int ProcessSplitBandsLocked() EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  int EndCaptureLocked() EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
   int ProcessStreamLocked() EXCLUSIVE_LOCKS_REQUIRED(crit_);
-  int AnalyzeReverseStreamLocked() EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  int AnalyzeReverseStreamLocked() EXCLUSIVE_LOCKS_REQUIRED(render_crit_);
 
   bool is_data_processed() const;
   bool output_copy_needed(bool is_data_processed) const;
@@ -184,17 +227,28 @@ class AudioProcessingImpl : public AudioProcessing {
   rtc::scoped_ptr<GainControlForNewAgc> gain_control_for_new_agc_;
 
   std::list<ProcessingComponent*> component_list_;
+  // The render and capture threads each take their own lock, and far-end audio
+  // reaches the components through lock-free queues, so neither thread waits
+  // for the other. Changing the audio format, debug recording and a full
+  // render queue take both locks, render_crit_ first. The audio formats are
+  // only changed with both locks held, so either lock is enough to read them.
+  CriticalSectionWrapper* render_crit_ ACQUIRED_BEFORE(crit_);
+  // Protects the capture side, the components and the configuration.
   CriticalSectionWrapper* crit_;
   rtc::scoped_ptr<AudioBuffer> render_audio_;
   rtc::scoped_ptr<AudioBuffer> capture_audio_;
 #ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
-  // TODO(andrew): make this more graceful. Ideally we would split this stuff
-  // out into a separate class with an "enabled" and "disabled" implementation.
-  int WriteMessageToDebugFile();
-  int WriteInitMessage();
-  rtc::scoped_ptr<FileWrapper> debug_file_;
-  rtc::scoped_ptr<audioproc::Event> event_msg_;  // Protobuf message.
-  std::string event_str_;  // Memory for protobuf serialization.
+  // Starts recording to |debug_file|, which must be open. Takes ownership.
+  void StartDebugWriterLocked(FileWrapper* debug_file)
+      EXCLUSIVE_LOCKS_REQUIRED(render_crit_, crit_);
+  int StopDebugWriterLocked() EXCLUSIVE_LOCKS_REQUIRED(render_crit_, crit_);
+  void WriteInitMessage() EXCLUSIVE_LOCKS_REQUIRED(crit_);
+  // Serializes and writes the recording on a thread of its own; NULL when not
+  // recording. Only set with both locks held. The capture side records through
+  // its capture() producer under crit_, and the render side through its
+  // render() producer under render_crit_, so recording never makes one thread
+  // wait for the other.
+  rtc::scoped_ptr<DebugDumpWriter> debug_writer_;
 #endif
 
   AudioFormat fwd_in_format_;
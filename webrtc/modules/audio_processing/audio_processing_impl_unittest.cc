@@ -10,16 +10,133 @@
 
 #include "webrtc/modules/audio_processing/audio_processing_impl.h"
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+
 #include "testing/gmock/include/gmock/gmock.h"
 #include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/common_audio/channel_buffer.h"
+#include "webrtc/common_audio/include/audio_util.h"
 #include "webrtc/config.h"
+#include "webrtc/modules/audio_processing/beamformer/beamformer.h"
 #include "webrtc/modules/audio_processing/test/test_utils.h"
 #include "webrtc/modules/interface/module_common_types.h"
+#include "webrtc/system_wrappers/interface/event_wrapper.h"
+#include "webrtc/system_wrappers/interface/scoped_vector.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+#include "webrtc/test/testsupport/fileutils.h"
 
 using ::testing::Invoke;
 using ::testing::Return;
 
 namespace webrtc {
+namespace {
+
+const int kEventTimeoutMs = 10000;
+
+// Holds the capture thread inside ProcessStream() until released.
+class BlockingBeamformer : public Beamformer<float> {
+ public:
+  BlockingBeamformer()
+      : entered_(EventWrapper::Create()), release_(EventWrapper::Create()) {}
+
+  void ProcessChunk(const ChannelBuffer<float>& input,
+                    ChannelBuffer<float>* output) override {
+    entered_->Set();
+    release_->Wait(kEventTimeoutMs);
+  }
+  void Initialize(int chunk_size_ms, int sample_rate_hz) override {}
+  bool is_target_present() override { return true; }
+
+  EventWrapper* entered() { return entered_.get(); }
+  EventWrapper* release() { return release_.get(); }
+
+ private:
+  rtc::scoped_ptr<EventWrapper> entered_;
+  rtc::scoped_ptr<EventWrapper> release_;
+};
+
+struct CaptureState {
+  AudioProcessing* apm;
+  ChannelBuffer<float>* audio;
+  int sample_rate_hz;
+  volatile bool done;
+};
+
+bool ProcessOneCaptureChunk(void* obj) {
+  CaptureState* state = static_cast<CaptureState*>(obj);
+  state->apm->set_stream_delay_ms(0);
+  state->apm->ProcessStream(state->audio->channels(),
+                            state->audio->num_frames(),
+                            state->sample_rate_hz,
+                            AudioProcessing::kStereo,
+                            state->sample_rate_hz,
+                            AudioProcessing::kMono,
+                            state->audio->channels());
+  state->done = true;
+  return false;
+}
+
+struct RenderState {
+  AudioProcessing* apm;
+  ChannelBuffer<float>* audio;
+  int num_chunks;
+  int num_errors;
+};
+
+bool ProcessRenderChunks(void* obj) {
+  RenderState* state = static_cast<RenderState*>(obj);
+  if (state->apm->AnalyzeReverseStream(state->audio->channels(),
+                                       state->audio->num_frames(),
+                                       16000,
+                                       AudioProcessing::kMono) !=
+      AudioProcessing::kNoError) {
+    ++state->num_errors;
+  }
+  return --state->num_chunks > 0;
+}
+
+
+AudioProcessing* CreateApmWith48kHzSupport() {
+  Config config;
+  config.Set<AudioProcessing48kHzSupport>(new AudioProcessing48kHzSupport(true));
+  return AudioProcessing::Create(config);
+}
+
+void FillRandom(AudioFrame* frame) {
+  for (int i = 0; i < frame->samples_per_channel_ * frame->num_channels_; ++i)
+    frame->data_[i] = static_cast<int16_t>(rand() % 8000 - 4000);
+}
+
+// Sets up stream |index| of a mix of rates, channels and components.
+void ConfigureStream(int index, AudioProcessing* apm, AudioFrame* frame) {
+  const int kSampleRatesHz[] = {16000, 32000, 48000};
+  frame->num_channels_ = index % 4 == 3 ? 2 : 1;
+  SetFrameSampleRate(frame, kSampleRatesHz[index % 3]);
+  const AudioProcessing::ChannelLayout layout =
+      frame->num_channels_ == 2 ? AudioProcessing::kStereo
+                                : AudioProcessing::kMono;
+  ASSERT_EQ(AudioProcessing::kNoError,
+            apm->Initialize(frame->sample_rate_hz_, frame->sample_rate_hz_,
+                            frame->sample_rate_hz_, layout, layout,
+                            AudioProcessing::kMono));
+  ASSERT_EQ(AudioProcessing::kNoError, apm->high_pass_filter()->Enable(true));
+  ASSERT_EQ(AudioProcessing::kNoError,
+            apm->noise_suppression()->Enable(true));
+  ASSERT_EQ(AudioProcessing::kNoError,
+            apm->gain_control()->set_mode(GainControl::kAdaptiveDigital));
+  ASSERT_EQ(AudioProcessing::kNoError, apm->gain_control()->Enable(true));
+  // The AEC isn't used at 48 kHz.
+  ASSERT_EQ(AudioProcessing::kNoError,
+            apm->echo_cancellation()->Enable(
+                index % 2 == 0 && frame->sample_rate_hz_ != 48000));
+}
+
+}  // namespace
 
 class MockInitialize : public AudioProcessingImpl {
  public:
@@ -73,4 +190,214 @@ TEST(AudioProcessingImplTest, AudioParameterChangeTriggersInit) {
   EXPECT_EQ(mock.kBadSampleRateError, mock.AnalyzeReverseStream(&frame));
 }
 
+namespace {
+
+// Holds the capture lock in a capture thread and checks that the render side
+// keeps going, optionally while recording to |debug_filename|.
+void ExpectRenderNotBlockedByCapture(const std::string& debug_filename) {
+  std::vector<Point> array_geometry;
+  array_geometry.push_back(Point(0.f, 0.f, 0.f));
+  array_geometry.push_back(Point(0.05f, 0.f, 0.f));
+  Config config;
+  config.Set<Beamforming>(new Beamforming(true, array_geometry));
+  BlockingBeamformer* beamformer = new BlockingBeamformer();
+  AudioProcessingImpl apm(config, beamformer);
+  EXPECT_NOERR(apm.Initialize(16000, 16000, 16000, AudioProcessing::kStereo,
+                              AudioProcessing::kMono, AudioProcessing::kMono));
+  EXPECT_NOERR(apm.echo_cancellation()->Enable(true));
+  EXPECT_NOERR(apm.gain_control()->set_mode(GainControl::kAdaptiveDigital));
+  EXPECT_NOERR(apm.gain_control()->Enable(true));
+  if (!debug_filename.empty())
+    EXPECT_NOERR(apm.StartDebugRecording(debug_filename.c_str()));
+
+  ChannelBuffer<float> capture_audio(160, 2);
+  CaptureState capture = {&apm, &capture_audio, 16000, false};
+  rtc::scoped_ptr<ThreadWrapper> capture_thread = ThreadWrapper::CreateThread(
+      ProcessOneCaptureChunk, &capture, "capture");
+  ASSERT_TRUE(capture_thread->Start());
+  ASSERT_EQ(kEventSignaled, beamformer->entered()->Wait(kEventTimeoutMs));
+
+  // The capture thread now holds the capture lock until released. The render
+  // side must not need it while there is room in the queues.
+  ChannelBuffer<float> render_audio(160, 1);
+  for (int i = 0; i < 50; ++i) {
+    EXPECT_NOERR(apm.AnalyzeReverseStream(render_audio.channels(), 160, 16000,
+                                          AudioProcessing::kMono));
+  }
+  EXPECT_FALSE(capture.done);
+
+  beamformer->release()->Set();
+  capture_thread->Stop();
+  EXPECT_TRUE(capture.done);
+  if (!debug_filename.empty())
+    EXPECT_NOERR(apm.StopDebugRecording());
+}
+
+}  // namespace
+
+TEST(AudioProcessingImplTest, RenderIsNotBlockedByCapture) {
+  ExpectRenderNotBlockedByCapture("");
+}
+
+#ifdef WEBRTC_AUDIOPROC_DEBUG_DUMP
+TEST(AudioProcessingImplTest, RenderIsNotBlockedByCaptureWhileRecording) {
+  const std::string filename =
+      test::TempFilename(test::OutputPath(), "render_not_blocked");
+  ExpectRenderNotBlockedByCapture(filename);
+  remove(filename.c_str());
+}
+#endif
+
+TEST(AudioProcessingImplTest, ConcurrentCaptureAndRender) {
+  Config config;
+  AudioProcessingImpl apm(config);
+  EXPECT_NOERR(apm.echo_cancellation()->Enable(true));
+  EXPECT_NOERR(apm.gain_control()->set_mode(GainControl::kAdaptiveDigital));
+  EXPECT_NOERR(apm.gain_control()->Enable(true));
+
+  ChannelBuffer<float> render_audio(160, 1);
+  for (int i = 0; i < 160; ++i)
+    render_audio.channels()[0][i] = (i % 16 - 8) / 8.f;
+  RenderState render = {&apm, &render_audio, 1000, 0};
+  rtc::scoped_ptr<ThreadWrapper> render_thread = ThreadWrapper::CreateThread(
+      ProcessRenderChunks, &render, "render");
+  ASSERT_TRUE(render_thread->Start());
+
+  // Switching the capture rate reinitializes under both locks while the
+  // render thread keeps running.
+  ChannelBuffer<float> capture_audio_16k(160, 2);
+  ChannelBuffer<float> capture_audio_32k(320, 2);
+  for (int i = 0; i < 1000; ++i) {
+    const bool use_32k = (i / 50) % 2 == 1;
+    ChannelBuffer<float>* capture_audio =
+        use_32k ? &capture_audio_32k : &capture_audio_16k;
+    const int sample_rate_hz = use_32k ? 32000 : 16000;
+    EXPECT_NOERR(apm.set_stream_delay_ms(0));
+    EXPECT_NOERR(apm.ProcessStream(capture_audio->channels(),
+                                   capture_audio->num_frames(),
+                                   sample_rate_hz,
+                                   AudioProcessing::kStereo,
+                                   sample_rate_hz,
+                                   AudioProcessing::kStereo,
+                                   capture_audio->channels()));
+  }
+
+  render_thread->Stop();
+  EXPECT_EQ(0, render.num_errors);
+}
+
+TEST(AudioProcessingImplTest, ProcessStreamsMatchesProcessStream) {
+  // More than one batch, with the last stream failing.
+  const int kNumStreams = AudioProcessingImpl::kMaxBatchSize + 4;
+  const int kNumChunks = 100;
+  ScopedVector<AudioProcessing> batch_apms;
+  ScopedVector<AudioProcessing> single_apms;
+  ScopedVector<AudioFrame> batch_frames;
+  ScopedVector<AudioFrame> single_frames;
+  ScopedVector<AudioFrame> render_frames;
+  for (int i = 0; i < kNumStreams; ++i) {
+    batch_apms.push_back(CreateApmWith48kHzSupport());
+    single_apms.push_back(CreateApmWith48kHzSupport());
+    batch_frames.push_back(new AudioFrame);
+    single_frames.push_back(new AudioFrame);
+    render_frames.push_back(new AudioFrame);
+    ConfigureStream(i, batch_apms[i], batch_frames[i]);
+    ConfigureStream(i, single_apms[i], single_frames[i]);
+    render_frames[i]->num_channels_ = 1;
+    SetFrameSampleRate(render_frames[i], batch_frames[i]->sample_rate_hz_);
+  }
+
+  srand(42);
+  float render[AudioFrame::kMaxDataSizeSamples];
+  const float* const render_channels[] = {render};
+  int stream_errors[kNumStreams];
+  for (int chunk = 0; chunk < kNumChunks; ++chunk) {
+    for (int i = 0; i < kNumStreams; ++i) {
+      // The int16 interface doesn't take 48 kHz far-end audio.
+      FillRandom(render_frames[i]);
+      S16ToFloat(render_frames[i]->data_,
+                 render_frames[i]->samples_per_channel_, render);
+      FillRandom(batch_frames[i]);
+      single_frames[i]->CopyFrom(*batch_frames[i]);
+      for (AudioProcessing* apm : {batch_apms[i], single_apms[i]}) {
+        ASSERT_EQ(AudioProcessing::kNoError,
+                  apm->AnalyzeReverseStream(
+                      render_channels, render_frames[i]->samples_per_channel_,
+                      render_frames[i]->sample_rate_hz_,
+                      AudioProcessing::kMono));
+        ASSERT_EQ(AudioProcessing::kNoError, apm->set_stream_delay_ms(20));
+      }
+    }
+    batch_frames[kNumStreams - 1]->samples_per_channel_ /= 2;
+    single_frames[kNumStreams - 1]->samples_per_channel_ /= 2;
+
+    EXPECT_EQ(AudioProcessing::kBadDataLengthError,
+              AudioProcessing::ProcessStreams(&batch_apms.get()[0],
+                                              &batch_frames.get()[0],
+                                              kNumStreams,
+                                              stream_errors));
+    for (int i = 0; i < kNumStreams; ++i) {
+      EXPECT_EQ(single_apms[i]->ProcessStream(single_frames[i]),
+                stream_errors[i]);
+      const AudioFrame& batch_frame = *batch_frames[i];
+      const AudioFrame& single_frame = *single_frames[i];
+      ASSERT_EQ(single_frame.samples_per_channel_,
+                batch_frame.samples_per_channel_);
+      ASSERT_EQ(0, memcmp(single_frame.data_, batch_frame.data_,
+                          sizeof(int16_t) * single_frame.samples_per_channel_ *
+                              single_frame.num_channels_))
+          << "stream " << i << ", chunk " << chunk;
+      EXPECT_EQ(single_frame.vad_activity_, batch_frame.vad_activity_);
+    }
+    EXPECT_EQ(AudioProcessing::kBadDataLengthError,
+              stream_errors[kNumStreams - 1]);
+    batch_frames[kNumStreams - 1]->samples_per_channel_ *= 2;
+    single_frames[kNumStreams - 1]->samples_per_channel_ *= 2;
+  }
+}
+
+// Compares processing many 32 kHz streams one by one and as a batch.
+TEST(AudioProcessingImplTest, DISABLED_ProcessStreamsPerf) {
+  const int kNumStreams = 64;
+  const int kNumChunks = 1000;
+  ScopedVector<AudioProcessing> apms;
+  ScopedVector<AudioFrame> frames;
+  for (int i = 0; i < kNumStreams; ++i) {
+    apms.push_back(AudioProcessing::Create());
+    frames.push_back(new AudioFrame);
+    frames[i]->num_channels_ = 1;
+    SetFrameSampleRate(frames[i], 32000);
+    ASSERT_EQ(AudioProcessing::kNoError,
+              apms[i]->high_pass_filter()->Enable(true));
+    ASSERT_EQ(AudioProcessing::kNoError,
+              apms[i]->noise_suppression()->Enable(true));
+  }
+
+  srand(42);
+  int64_t single_us = 0;
+  int64_t batch_us = 0;
+  for (int chunk = 0; chunk < kNumChunks; ++chunk) {
+    for (int i = 0; i < kNumStreams; ++i)
+      FillRandom(frames[i]);
+    int64_t start_us = TickTime::MicrosecondTimestamp();
+    for (int i = 0; i < kNumStreams; ++i)
+      ASSERT_EQ(AudioProcessing::kNoError, apms[i]->ProcessStream(frames[i]));
+    single_us += TickTime::MicrosecondTimestamp() - start_us;
+
+    for (int i = 0; i < kNumStreams; ++i)
+      FillRandom(frames[i]);
+    start_us = TickTime::MicrosecondTimestamp();
+    ASSERT_EQ(AudioProcessing::kNoError,
+              AudioProcessing::ProcessStreams(&apms.get()[0],
+                                              &frames.get()[0],
+                                              kNumStreams,
+                                              NULL));
+    batch_us += TickTime::MicrosecondTimestamp() - start_us;
+  }
+  printf("%d streams, per chunk: ProcessStream %d us, ProcessStreams %d us\n",
+         kNumStreams,
+         static_cast<int>(single_us / kNumChunks),
+         static_cast<int>(batch_us / kNumChunks));
+}
+
 }  // namespace webrtc
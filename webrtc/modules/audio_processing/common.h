@@ -30,6 +30,13 @@ static inline int ChannelsFromLayout(AudioProcessing::ChannelLayout layout) {
   return -1;
 }
 
+// Far-end blocks queued between the render and capture threads; one second of
+// 10 ms chunks.
+static const size_t kMaxQueuedRenderBlocks = 100;
+// Samples in the largest queued far-end block: the lowest band of both render
+// channels.
+static const size_t kMaxRenderBlockSize = 2 * 160;
+
 }  // namespace webrtc
 
 #endif  // WEBRTC_MODULES_AUDIO_PROCESSING_COMMON_H_
@@ -0,0 +1,289 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/audio_processing/debug_dump_writer.h"
+
+#include <assert.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "webrtc/base/criticalsection.h"
+#include "webrtc/system_wrappers/interface/event_wrapper.h"
+#include "webrtc/system_wrappers/interface/file_wrapper.h"
+#include "webrtc/system_wrappers/interface/logging.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
+
+// Files generated at build-time by the protobuf compiler.
+#ifdef WEBRTC_ANDROID_PLATFORM_BUILD
+#include "external/webrtc/webrtc/modules/audio_processing/debug.pb.h"
+#else
+#include "webrtc/audio_processing/debug.pb.h"
+#endif
+
+namespace webrtc {
+namespace {
+
+// How often the writer thread checks for queued records.
+const unsigned long kPollIntervalMs = 10;
+
+}  // namespace
+
+DebugDumpWriter::Producer::Producer(DebugDumpWriter* writer,
+                                    size_t max_queued_bytes)
+    : writer_(writer),
+      ring_size_(static_cast<int>(max_queued_bytes) + 1),
+      ring_(new uint8_t[ring_size_]),
+      read_position_(0),
+      write_position_(0) {
+  memset(&header_, 0, sizeof(header_));
+}
+
+void DebugDumpWriter::Producer::BeginRecord(RecordType type) {
+  memset(&header_, 0, sizeof(header_));
+  header_.type = type;
+  record_.resize(sizeof(header_));
+}
+
+void DebugDumpWriter::Producer::SetInitFields(const InitFields& fields) {
+  header_.init = fields;
+}
+
+void DebugDumpWriter::Producer::SetStreamFields(const StreamFields& fields) {
+  header_.stream = fields;
+}
+
+void DebugDumpWriter::Producer::AddChunk(ChunkType type,
+                                         const void* data,
+                                         size_t size) {
+  const ChunkHeader chunk = {type, size};
+  const size_t offset = record_.size();
+  record_.resize(offset + sizeof(chunk) + size);
+  memcpy(&record_[offset], &chunk, sizeof(chunk));
+  if (size > 0)
+    memcpy(&record_[offset + sizeof(chunk)], data, size);
+}
+
+void DebugDumpWriter::Producer::EndRecord() {
+  assert(record_.size() >= sizeof(header_));
+  header_.size = record_.size();
+  header_.sequence_number =
+      rtc::AtomicOps::Increment(&writer_->next_sequence_number_);
+  memcpy(&record_[0], &header_, sizeof(header_));
+  if (!Push(&record_[0], record_.size()))
+    rtc::AtomicOps::Increment(&writer_->dropped_records_);
+}
+
+bool DebugDumpWriter::Producer::Push(const uint8_t* record, size_t size) {
+  const int read_position = rtc::AtomicOps::Load(&read_position_);
+  const int write_position = write_position_;
+  const int free_bytes =
+      (read_position - write_position - 1 + ring_size_) % ring_size_;
+  if (size > static_cast<size_t>(free_bytes))
+    return false;
+
+  const size_t first_part =
+      std::min(size, static_cast<size_t>(ring_size_ - write_position));
+  memcpy(&ring_[write_position], record, first_part);
+  memcpy(&ring_[0], record + first_part, size - first_part);
+  rtc::AtomicOps::Store(
+      &write_position_,
+      static_cast<int>((write_position + size) % ring_size_));
+  return true;
+}
+
+bool DebugDumpWriter::Producer::Peek(RecordHeader* header) const {
+  const int write_position = rtc::AtomicOps::Load(&write_position_);
+  const int read_position = read_position_;
+  if (read_position == write_position)
+    return false;
+  ReadRing(read_position, header, sizeof(*header));
+  return true;
+}
+
+bool DebugDumpWriter::Producer::Pop(std::vector<uint8_t>* record) {
+  RecordHeader header;
+  if (!Peek(&header))
+    return false;
+  const int read_position = read_position_;
+  record->resize(header.size);
+  ReadRing(read_position, &(*record)[0], header.size);
+  rtc::AtomicOps::Store(
+      &read_position_,
+      static_cast<int>((read_position + header.size) % ring_size_));
+  return true;
+}
+
+void DebugDumpWriter::Producer::ReadRing(int position,
+                                         void* data,
+                                         size_t size) const {
+  uint8_t* dest = static_cast<uint8_t*>(data);
+  const size_t first_part =
+      std::min(size, static_cast<size_t>(ring_size_ - position));
+  memcpy(dest, &ring_[position], first_part);
+  memcpy(dest + first_part, &ring_[0], size - first_part);
+}
+
+DebugDumpWriter::DebugDumpWriter(FileWrapper* file, size_t max_queued_bytes)
+    : file_(file),
+      next_sequence_number_(0),
+      dropped_records_(0),
+      capture_(new Producer(this, max_queued_bytes)),
+      render_(new Producer(this, max_queued_bytes)),
+      event_msg_(new audioproc::Event()),
+      write_failed_(false),
+      wake_event_(EventWrapper::Create()),
+      thread_(ThreadWrapper::CreateThread(Run, this, "AudioDebugDump")) {
+  assert(file_->Open());
+  thread_->Start();
+}
+
+DebugDumpWriter::~DebugDumpWriter() {
+  Stop();
+}
+
+bool DebugDumpWriter::Stop() {
+  if (thread_.get()) {
+    wake_event_->Set();
+    thread_->Stop();
+    thread_.reset();
+    // The writer thread is gone; write whatever it didn't get to.
+    WriteQueuedRecords();
+    if (file_->Flush() == -1 || file_->CloseFile() == -1)
+      write_failed_ = true;
+    const int dropped = dropped_records();
+    if (dropped > 0)
+      LOG(LS_WARNING) << "Dropped " << dropped << " debug dump records.";
+  }
+  return !write_failed_;
+}
+
+int DebugDumpWriter::dropped_records() const {
+  return rtc::AtomicOps::Load(&dropped_records_);
+}
+
+bool DebugDumpWriter::Run(void* obj) {
+  return static_cast<DebugDumpWriter*>(obj)->Process();
+}
+
+bool DebugDumpWriter::Process() {
+  wake_event_->Wait(kPollIntervalMs);
+  WriteQueuedRecords();
+  return true;
+}
+
+void DebugDumpWriter::WriteQueuedRecords() {
+  // Merges the two queues by sequence number. A record numbered just before
+  // one already written may still be on its way into the other queue; the
+  // two were then queued at the same time, and either order is right.
+  RecordHeader capture_header;
+  RecordHeader render_header;
+  while (true) {
+    const bool has_capture = capture_->Peek(&capture_header);
+    const bool has_render = render_->Peek(&render_header);
+    Producer* producer;
+    if (has_capture && has_render) {
+      // Wrap-safe comparison of the sequence numbers.
+      const bool capture_first =
+          static_cast<int>(static_cast<unsigned int>(
+                               capture_header.sequence_number) -
+                           static_cast<unsigned int>(
+                               render_header.sequence_number)) < 0;
+      producer = capture_first ? capture_.get() : render_.get();
+    } else if (has_capture) {
+      producer = capture_.get();
+    } else if (has_render) {
+      producer = render_.get();
+    } else {
+      break;
+    }
+    producer->Pop(&write_record_);
+    if (!WriteRecord(write_record_) && !write_failed_) {
+      LOG(LS_ERROR) << "Failed to write debug dump record.";
+      write_failed_ = true;
+    }
+  }
+}
+
+bool DebugDumpWriter::WriteRecord(const std::vector<uint8_t>& record) {
+  RecordHeader header;
+  memcpy(&header, &record[0], sizeof(header));
+
+  event_msg_->Clear();
+  switch (header.type) {
+    case kInit: {
+      event_msg_->set_type(audioproc::Event::INIT);
+      audioproc::Init* msg = event_msg_->mutable_init();
+      msg->set_sample_rate(header.init.sample_rate);
+      msg->set_num_input_channels(header.init.num_input_channels);
+      msg->set_num_output_channels(header.init.num_output_channels);
+      msg->set_num_reverse_channels(header.init.num_reverse_channels);
+      msg->set_reverse_sample_rate(header.init.reverse_sample_rate);
+      msg->set_output_sample_rate(header.init.output_sample_rate);
+      break;
+    }
+    case kStream: {
+      event_msg_->set_type(audioproc::Event::STREAM);
+      audioproc::Stream* msg = event_msg_->mutable_stream();
+      msg->set_delay(header.stream.delay);
+      msg->set_drift(header.stream.drift);
+      msg->set_level(header.stream.level);
+      msg->set_keypress(header.stream.keypress);
+      break;
+    }
+    case kReverseStream:
+      event_msg_->set_type(audioproc::Event::REVERSE_STREAM);
+      event_msg_->mutable_reverse_stream();
+      break;
+  }
+
+  size_t offset = sizeof(header);
+  while (offset < header.size) {
+    ChunkHeader chunk;
+    memcpy(&chunk, &record[offset], sizeof(chunk));
+    offset += sizeof(chunk);
+    const void* data = &record[offset];
+    switch (chunk.type) {
+      case kInputData:
+        event_msg_->mutable_stream()->set_input_data(data, chunk.size);
+        break;
+      case kOutputData:
+        event_msg_->mutable_stream()->set_output_data(data, chunk.size);
+        break;
+      case kInputChannel:
+        event_msg_->mutable_stream()->add_input_channel(data, chunk.size);
+        break;
+      case kOutputChannel:
+        event_msg_->mutable_stream()->add_output_channel(data, chunk.size);
+        break;
+      case kReverseData:
+        event_msg_->mutable_reverse_stream()->set_data(data, chunk.size);
+        break;
+      case kReverseChannel:
+        event_msg_->mutable_reverse_stream()->add_channel(data, chunk.size);
+        break;
+    }
+    offset += chunk.size;
+  }
+
+  if (!event_msg_->SerializeToString(&event_str_))
+    return false;
+
+#if defined(WEBRTC_ARCH_BIG_ENDIAN)
+  // TODO(ajm): Use little-endian "on the wire". For the moment, we can be
+  //            pretty safe in assuming little-endian.
+#endif
+  // Write message preceded by its size.
+  const int32_t size = static_cast<int32_t>(event_str_.size());
+  return file_->Write(&size, sizeof(size)) &&
+         file_->Write(event_str_.data(), event_str_.size());
+}
+
+}  // namespace webrtc
@@ -0,0 +1,177 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_AUDIO_PROCESSING_DEBUG_DUMP_WRITER_H_
+#define WEBRTC_MODULES_AUDIO_PROCESSING_DEBUG_DUMP_WRITER_H_
+
+#include <string>
+#include <vector>
+
+#include "webrtc/base/constructormagic.h"
+#include "webrtc/base/scoped_ptr.h"
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+
+class EventWrapper;
+class FileWrapper;
+class ThreadWrapper;
+
+namespace audioproc {
+
+class Event;
+
+}  // namespace audioproc
+
+// Writes the audioproc::Event messages of a debug recording from a background
+// thread. The audio threads only copy the raw data of each message into
+// lock-free queues of bounded size, and the writer thread builds, serializes
+// and writes the messages. Messages that don't fit in a queue are dropped and
+// counted rather than blocking the audio threads.
+class DebugDumpWriter {
+ public:
+  enum RecordType {
+    kInit,
+    kStream,
+    kReverseStream
+  };
+
+  // Raw data of a record, stored in the bytes field of the same name.
+  enum ChunkType {
+    kInputData,
+    kOutputData,
+    kInputChannel,
+    kOutputChannel,
+    kReverseData,
+    kReverseChannel
+  };
+
+  struct InitFields {
+    int sample_rate;
+    int num_input_channels;
+    int num_output_channels;
+    int num_reverse_channels;
+    int reverse_sample_rate;
+    int output_sample_rate;
+  };
+
+  struct StreamFields {
+    int delay;
+    int drift;
+    int level;
+    bool keypress;
+  };
+
+  // Builds records and queues them for the writer thread; see below.
+  class Producer;
+
+  // Takes ownership of |file|, which must be open, and starts the writer
+  // thread. Queues up to |max_queued_bytes| of records from each producer.
+  DebugDumpWriter(FileWrapper* file, size_t max_queued_bytes);
+  ~DebugDumpWriter();
+
+  // Producers for the capture and the render side. Records are written in the
+  // order they were queued, across both producers.
+  Producer* capture() { return capture_.get(); }
+  Producer* render() { return render_.get(); }
+
+  // Writes all queued records, stops the writer thread and closes the file.
+  // Returns false if any record couldn't be written or the file couldn't be
+  // closed.
+  bool Stop();
+
+  // The number of records dropped because a queue was full.
+  int dropped_records() const;
+
+ private:
+  // A record is a RecordHeader followed by its chunks, each a ChunkHeader
+  // followed by the chunk data.
+  struct RecordHeader {
+    size_t size;  // Including the header.
+    // Orders records across producers.
+    int sequence_number;
+    RecordType type;
+    InitFields init;
+    StreamFields stream;
+  };
+
+  struct ChunkHeader {
+    ChunkType type;
+    size_t size;  // Excluding the header.
+  };
+
+  static bool Run(void* obj);
+  bool Process();
+
+  void WriteQueuedRecords();
+  bool WriteRecord(const std::vector<uint8_t>& record);
+
+  const rtc::scoped_ptr<FileWrapper> file_;
+  volatile int next_sequence_number_;
+  volatile int dropped_records_;
+
+  const rtc::scoped_ptr<Producer> capture_;
+  const rtc::scoped_ptr<Producer> render_;
+
+  // Only used by the writer thread, or after it has stopped.
+  std::vector<uint8_t> write_record_;
+  rtc::scoped_ptr<audioproc::Event> event_msg_;
+  std::string event_str_;
+  bool write_failed_;
+
+  const rtc::scoped_ptr<EventWrapper> wake_event_;
+  rtc::scoped_ptr<ThreadWrapper> thread_;
+
+  DISALLOW_COPY_AND_ASSIGN(DebugDumpWriter);
+};
+
+// Builds records and queues them for the writer thread. Each producer has a
+// record buffer and queue of its own, so the capture and render threads can
+// record at the same time without sharing a lock. A producer is used by one
+// thread at a time. Its methods never block, and only allocate until the
+// largest record has been seen.
+class DebugDumpWriter::Producer {
+ public:
+  void BeginRecord(RecordType type);
+  void SetInitFields(const InitFields& fields);
+  void SetStreamFields(const StreamFields& fields);
+  void AddChunk(ChunkType type, const void* data, size_t size);
+  // Queues the record, or drops it if there isn't room for it.
+  void EndRecord();
+
+ private:
+  friend class DebugDumpWriter;
+
+  Producer(DebugDumpWriter* writer, size_t max_queued_bytes);
+
+  // Single producer, single consumer ring buffer of records.
+  bool Push(const uint8_t* record, size_t size);
+  // Reads the header of the oldest queued record, if any.
+  bool Peek(RecordHeader* header) const;
+  bool Pop(std::vector<uint8_t>* record);
+  void ReadRing(int position, void* data, size_t size) const;
+
+  DebugDumpWriter* const writer_;
+  // One byte is always left unused, to tell a full ring from an empty one.
+  const int ring_size_;
+  const rtc::scoped_ptr<uint8_t[]> ring_;
+  volatile int read_position_;
+  volatile int write_position_;
+
+  // The record being built.
+  RecordHeader header_;
+  std::vector<uint8_t> record_;
+
+  DISALLOW_COPY_AND_ASSIGN(Producer);
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_AUDIO_PROCESSING_DEBUG_DUMP_WRITER_H_
@@ -0,0 +1,307 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/audio_processing/debug_dump_writer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/modules/audio_processing/test/test_utils.h"
+#include "webrtc/system_wrappers/interface/file_wrapper.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+#include "webrtc/test/testsupport/fileutils.h"
+
+namespace webrtc {
+namespace {
+
+FileWrapper* OpenDebugFile(const std::string& filename) {
+  FileWrapper* file = FileWrapper::Create();
+  EXPECT_EQ(0, file->OpenFile(filename.c_str(), false));
+  return file;
+}
+
+std::vector<audioproc::Event> ReadEvents(const std::string& filename) {
+  std::vector<audioproc::Event> events;
+  FILE* file = fopen(filename.c_str(), "rb");
+  EXPECT_TRUE(file != NULL);
+  if (file == NULL)
+    return events;
+  audioproc::Event event;
+  while (ReadMessageFromFile(file, &event))
+    events.push_back(event);
+  fclose(file);
+  return events;
+}
+
+// Processes |num_frames| of 48 kHz stereo and prints percentiles of the
+// ProcessStream() call durations.
+void PrintProcessStreamLatency(AudioProcessing* apm,
+                               int num_frames,
+                               const char* label) {
+  const int kSampleRateHz = 48000;
+  const int kSamplesPerChannel = kSampleRateHz / 100;
+  ChannelBuffer<float> render(kSamplesPerChannel, 2);
+  ChannelBuffer<float> capture(kSamplesPerChannel, 2);
+  std::vector<int64_t> latencies_us(num_frames);
+  srand(42);
+  for (int i = 0; i < num_frames; ++i) {
+    for (int ch = 0; ch < 2; ++ch) {
+      for (int j = 0; j < kSamplesPerChannel; ++j) {
+        render.channels()[ch][j] = (rand() % 2000 - 1000) / 32768.f;
+        capture.channels()[ch][j] = (rand() % 2000 - 1000) / 32768.f;
+      }
+    }
+    ASSERT_EQ(AudioProcessing::kNoError,
+              apm->AnalyzeReverseStream(render.channels(), kSamplesPerChannel,
+                                        kSampleRateHz,
+                                        AudioProcessing::kStereo));
+    ASSERT_EQ(AudioProcessing::kNoError, apm->set_stream_delay_ms(50));
+    const int64_t start_us = TickTime::MicrosecondTimestamp();
+    ASSERT_EQ(AudioProcessing::kNoError,
+              apm->ProcessStream(capture.channels(), kSamplesPerChannel,
+                                 kSampleRateHz, AudioProcessing::kStereo,
+                                 kSampleRateHz, AudioProcessing::kStereo,
+                                 capture.channels()));
+    latencies_us[i] = TickTime::MicrosecondTimestamp() - start_us;
+  }
+  std::sort(latencies_us.begin(), latencies_us.end());
+  printf("ProcessStream %s: p50 %d us, p99 %d us, p99.9 %d us, max %d us\n",
+         label,
+         static_cast<int>(latencies_us[num_frames / 2]),
+         static_cast<int>(latencies_us[num_frames * 99 / 100]),
+         static_cast<int>(latencies_us[num_frames * 999 / 1000]),
+         static_cast<int>(latencies_us[num_frames - 1]));
+}
+
+}  // namespace
+
+class DebugDumpWriterTest : public ::testing::Test {
+ protected:
+  DebugDumpWriterTest()
+      : filename_(test::TempFilename(test::OutputPath(), "debug_dump_writer")) {
+  }
+  // Removes the file however the test ends.
+  ~DebugDumpWriterTest() override { remove(filename_.c_str()); }
+
+  const std::string filename_;
+};
+
+TEST_F(DebugDumpWriterTest, WritesRecordsInOrder) {
+  const int16_t kInput[] = {1, 2, 3, 4};
+  const int16_t kOutput[] = {5, 6, 7, 8};
+  const float kChannel[] = {0.5f, -0.5f};
+
+  DebugDumpWriter writer(OpenDebugFile(filename_), 1024 * 1024);
+  DebugDumpWriter::Producer* capture = writer.capture();
+  DebugDumpWriter::InitFields init = {16000, 2, 1, 2, 32000, 8000};
+  capture->BeginRecord(DebugDumpWriter::kInit);
+  capture->SetInitFields(init);
+  capture->EndRecord();
+
+  DebugDumpWriter::StreamFields stream = {50, 3, 127, true};
+  capture->BeginRecord(DebugDumpWriter::kStream);
+  capture->AddChunk(DebugDumpWriter::kInputData, kInput, sizeof(kInput));
+  capture->SetStreamFields(stream);
+  capture->AddChunk(DebugDumpWriter::kOutputData, kOutput, sizeof(kOutput));
+  capture->EndRecord();
+
+  DebugDumpWriter::Producer* render = writer.render();
+  render->BeginRecord(DebugDumpWriter::kReverseStream);
+  render->AddChunk(DebugDumpWriter::kReverseChannel, kChannel,
+                   sizeof(kChannel));
+  render->AddChunk(DebugDumpWriter::kReverseChannel, kChannel,
+                   sizeof(kChannel[0]));
+  render->EndRecord();
+  EXPECT_TRUE(writer.Stop());
+  EXPECT_EQ(0, writer.dropped_records());
+
+  const std::vector<audioproc::Event> events = ReadEvents(filename_);
+  ASSERT_EQ(3u, events.size());
+
+  ASSERT_EQ(audioproc::Event::INIT, events[0].type());
+  const audioproc::Init& init_msg = events[0].init();
+  EXPECT_EQ(16000, init_msg.sample_rate());
+  EXPECT_EQ(2, init_msg.num_input_channels());
+  EXPECT_EQ(1, init_msg.num_output_channels());
+  EXPECT_EQ(2, init_msg.num_reverse_channels());
+  EXPECT_EQ(32000, init_msg.reverse_sample_rate());
+  EXPECT_EQ(8000, init_msg.output_sample_rate());
+
+  ASSERT_EQ(audioproc::Event::STREAM, events[1].type());
+  const audioproc::Stream& stream_msg = events[1].stream();
+  EXPECT_EQ(std::string(reinterpret_cast<const char*>(kInput), sizeof(kInput)),
+            stream_msg.input_data());
+  EXPECT_EQ(
+      std::string(reinterpret_cast<const char*>(kOutput), sizeof(kOutput)),
+      stream_msg.output_data());
+  EXPECT_EQ(50, stream_msg.delay());
+  EXPECT_EQ(3, stream_msg.drift());
+  EXPECT_EQ(127, stream_msg.level());
+  EXPECT_TRUE(stream_msg.keypress());
+
+  ASSERT_EQ(audioproc::Event::REVERSE_STREAM, events[2].type());
+  const audioproc::ReverseStream& reverse_msg = events[2].reverse_stream();
+  ASSERT_EQ(2, reverse_msg.channel_size());
+  EXPECT_EQ(sizeof(kChannel), reverse_msg.channel(0).size());
+  EXPECT_EQ(sizeof(kChannel[0]), reverse_msg.channel(1).size());
+  EXPECT_FALSE(reverse_msg.has_data());
+}
+
+TEST_F(DebugDumpWriterTest, DropsRecordsThatDontFit) {
+  std::vector<int16_t> large_data(1000);
+
+  DebugDumpWriter writer(OpenDebugFile(filename_), 512);
+  DebugDumpWriter::Producer* render = writer.render();
+  render->BeginRecord(DebugDumpWriter::kReverseStream);
+  render->AddChunk(DebugDumpWriter::kReverseData, &large_data[0],
+                   large_data.size() * sizeof(large_data[0]));
+  render->EndRecord();
+  EXPECT_EQ(1, writer.dropped_records());
+
+  // Records wrap around the end of the queue as the writer catches up.
+  for (int i = 0; i < 100; ++i) {
+    render->BeginRecord(DebugDumpWriter::kReverseStream);
+    render->AddChunk(DebugDumpWriter::kReverseData, &large_data[0], 100);
+    render->EndRecord();
+  }
+  EXPECT_TRUE(writer.Stop());
+
+  const std::vector<audioproc::Event> events = ReadEvents(filename_);
+  EXPECT_EQ(100 - writer.dropped_records() + 1,
+            static_cast<int>(events.size()));
+  for (size_t i = 0; i < events.size(); ++i)
+    EXPECT_EQ(100u, events[i].reverse_stream().data().size());
+}
+
+TEST_F(DebugDumpWriterTest, InterleavesProducersInQueueOrder) {
+  const int kNumRecords = 50;
+  DebugDumpWriter writer(OpenDebugFile(filename_), 1024 * 1024);
+  for (int i = 0; i < kNumRecords; ++i) {
+    // Two capture records, then one render record.
+    DebugDumpWriter::Producer* producer =
+        i % 3 == 2 ? writer.render() : writer.capture();
+    const int16_t value = static_cast<int16_t>(i);
+    if (producer == writer.render()) {
+      producer->BeginRecord(DebugDumpWriter::kReverseStream);
+      producer->AddChunk(DebugDumpWriter::kReverseData, &value,
+                         sizeof(value));
+    } else {
+      producer->BeginRecord(DebugDumpWriter::kStream);
+      producer->AddChunk(DebugDumpWriter::kInputData, &value, sizeof(value));
+    }
+    producer->EndRecord();
+  }
+  EXPECT_TRUE(writer.Stop());
+
+  const std::vector<audioproc::Event> events = ReadEvents(filename_);
+  ASSERT_EQ(kNumRecords, static_cast<int>(events.size()));
+  for (int i = 0; i < kNumRecords; ++i) {
+    std::string data;
+    if (i % 3 == 2) {
+      ASSERT_EQ(audioproc::Event::REVERSE_STREAM, events[i].type());
+      data = events[i].reverse_stream().data();
+    } else {
+      ASSERT_EQ(audioproc::Event::STREAM, events[i].type());
+      data = events[i].stream().input_data();
+    }
+    int16_t value;
+    ASSERT_EQ(sizeof(value), data.size());
+    memcpy(&value, data.data(), sizeof(value));
+    EXPECT_EQ(i, value);
+  }
+}
+
+namespace {
+
+struct ProducerThreadParams {
+  DebugDumpWriter::Producer* producer;
+  DebugDumpWriter::RecordType type;
+  DebugDumpWriter::ChunkType chunk_type;
+  int num_records;
+};
+
+bool ProduceRecords(void* obj) {
+  const ProducerThreadParams* params =
+      static_cast<const ProducerThreadParams*>(obj);
+  for (int i = 0; i < params->num_records; ++i) {
+    const int16_t value = static_cast<int16_t>(i);
+    params->producer->BeginRecord(params->type);
+    params->producer->AddChunk(params->chunk_type, &value, sizeof(value));
+    params->producer->EndRecord();
+  }
+  return false;
+}
+
+}  // namespace
+
+// The capture and render threads record at the same time, without a lock
+// between them, and each side's records keep their order.
+TEST_F(DebugDumpWriterTest, ProducersRecordConcurrently) {
+  const int kNumRecords = 2000;
+  DebugDumpWriter writer(OpenDebugFile(filename_), 1024 * 1024);
+  ProducerThreadParams capture_params = {
+      writer.capture(), DebugDumpWriter::kStream, DebugDumpWriter::kInputData,
+      kNumRecords};
+  ProducerThreadParams render_params = {
+      writer.render(), DebugDumpWriter::kReverseStream,
+      DebugDumpWriter::kReverseData, kNumRecords};
+  rtc::scoped_ptr<ThreadWrapper> capture_thread(ThreadWrapper::CreateThread(
+      ProduceRecords, &capture_params, "capture"));
+  rtc::scoped_ptr<ThreadWrapper> render_thread(ThreadWrapper::CreateThread(
+      ProduceRecords, &render_params, "render"));
+  ASSERT_TRUE(capture_thread->Start());
+  ASSERT_TRUE(render_thread->Start());
+  capture_thread->Stop();
+  render_thread->Stop();
+  EXPECT_TRUE(writer.Stop());
+  EXPECT_EQ(0, writer.dropped_records());
+
+  const std::vector<audioproc::Event> events = ReadEvents(filename_);
+  ASSERT_EQ(2 * kNumRecords, static_cast<int>(events.size()));
+  int next_capture = 0;
+  int next_render = 0;
+  for (size_t i = 0; i < events.size(); ++i) {
+    const bool is_capture = events[i].type() == audioproc::Event::STREAM;
+    const std::string& data = is_capture ? events[i].stream().input_data()
+                                         : events[i].reverse_stream().data();
+    int16_t value;
+    ASSERT_EQ(sizeof(value), data.size());
+    memcpy(&value, data.data(), sizeof(value));
+    EXPECT_EQ(is_capture ? next_capture++ : next_render++, value);
+  }
+}
+
+// Compares the ProcessStream() latency distribution with and without a debug
+// recording, which shouldn't add file I/O or serialization to the audio thread.
+TEST_F(DebugDumpWriterTest, DISABLED_ProcessStreamLatencyPerf) {
+  const int kNumFrames = 6000;
+  rtc::scoped_ptr<AudioProcessing> apm(AudioProcessing::Create());
+  ASSERT_EQ(AudioProcessing::kNoError,
+            apm->echo_cancellation()->Enable(true));
+  ASSERT_EQ(AudioProcessing::kNoError,
+            apm->noise_suppression()->Enable(true));
+  ASSERT_EQ(AudioProcessing::kNoError, apm->high_pass_filter()->Enable(true));
+
+  PrintProcessStreamLatency(apm.get(), kNumFrames, "without dump");
+
+  ASSERT_EQ(AudioProcessing::kNoError,
+            apm->StartDebugRecording(filename_.c_str()));
+  PrintProcessStreamLatency(apm.get(), kNumFrames, "with dump");
+  ASSERT_EQ(AudioProcessing::kNoError, apm->StopDebugRecording());
+}
+
+}  // namespace webrtc
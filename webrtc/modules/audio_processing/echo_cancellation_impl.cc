@@ -18,6 +18,7 @@ extern "C" {
 }
 #include "webrtc/modules/audio_processing/aec/include/echo_cancellation.h"
 #include "webrtc/modules/audio_processing/audio_buffer.h"
+#include "webrtc/modules/audio_processing/common.h"
 #include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
 
 namespace webrtc {
@@ -68,11 +69,17 @@ EchoCancellationImpl::EchoCancellationImpl(const AudioProcessing* apm,
     stream_has_echo_(false),
     delay_logging_enabled_(false),
     delay_correction_enabled_(false),
-    reported_delay_enabled_(true) {}
+    reported_delay_enabled_(true),
+    render_queue_(kMaxQueuedRenderBlocks, kMaxRenderBlockSize) {
+  render_queue_buffer_.reserve(kMaxRenderBlockSize);
+  capture_queue_buffer_.reserve(kMaxRenderBlockSize);
+}
 
 EchoCancellationImpl::~EchoCancellationImpl() {}
 
 int EchoCancellationImpl::ProcessRenderAudio(const AudioBuffer* audio) {
+  // Read without the capture lock; a block queued or skipped around a change
+  // of the enabled state is dropped or fed to freshly initialized handles.
   if (!is_component_enabled()) {
     return apm_->kNoError;
   }
@@ -80,27 +87,54 @@ int EchoCancellationImpl::ProcessRenderAudio(const AudioBuffer* audio) {
   assert(audio->num_frames_per_band() <= 160);
   assert(audio->num_channels() == apm_->num_reverse_channels());
 
+  render_queue_buffer_.clear();
+  for (int j = 0; j < audio->num_channels(); j++) {
+    const float* band = audio->split_bands_const_f(j)[kBand0To8kHz];
+    render_queue_buffer_.insert(render_queue_buffer_.end(), band,
+                                band + audio->num_frames_per_band());
+  }
+
+  if (!render_queue_.Insert(&render_queue_buffer_)) {
+    // The capture thread isn't keeping up; make room on its behalf.
+    CriticalSectionScoped crit_scoped(crit_);
+    int err = ReadQueuedRenderData();
+    // Can't fail; the queue was just emptied.
+    render_queue_.Insert(&render_queue_buffer_);
+    return err;
+  }
+  return apm_->kNoError;
+}
+
+int EchoCancellationImpl::ReadQueuedRenderData() {
   int err = apm_->kNoError;
+  while (render_queue_.Remove(&capture_queue_buffer_)) {
+    if (!is_component_enabled() || err != apm_->kNoError) {
+      continue;
+    }
 
-  // The ordering convention must be followed to pass to the correct AEC.
-  size_t handle_index = 0;
-  for (int i = 0; i < apm_->num_output_channels(); i++) {
-    for (int j = 0; j < audio->num_channels(); j++) {
-      Handle* my_handle = static_cast<Handle*>(handle(handle_index));
-      err = WebRtcAec_BufferFarend(
-          my_handle,
-          audio->split_bands_const_f(j)[kBand0To8kHz],
-          static_cast<int16_t>(audio->num_frames_per_band()));
+    // The ordering convention must be followed to pass to the correct AEC.
+    const int num_reverse_channels = apm_->num_reverse_channels();
+    const size_t num_frames_per_band =
+        capture_queue_buffer_.size() / num_reverse_channels;
+    size_t handle_index = 0;
+    for (int i = 0; i < apm_->num_output_channels(); i++) {
+      for (int j = 0; j < num_reverse_channels; j++) {
+        Handle* my_handle = static_cast<Handle*>(handle(handle_index));
+        if (WebRtcAec_BufferFarend(
+                my_handle,
+                &capture_queue_buffer_[j * num_frames_per_band],
+                static_cast<int16_t>(num_frames_per_band)) !=
+            apm_->kNoError) {
+          // TODO(ajm): warning possible?
+          err = GetHandleError(my_handle);
+        }
 
-      if (err != apm_->kNoError) {
-        return GetHandleError(my_handle);  // TODO(ajm): warning possible?
+        handle_index++;
       }
-
-      handle_index++;
     }
   }
 
-  return apm_->kNoError;
+  return err;
 }
 
 int EchoCancellationImpl::ProcessCaptureAudio(AudioBuffer* audio) {
@@ -318,6 +352,9 @@ struct AecCore* EchoCancellationImpl::aec_core() const {
 }
 
 int EchoCancellationImpl::Initialize() {
+  // Queued blocks may not match the new format.
+  render_queue_.Clear();
+
   int err = ProcessingComponent::Initialize();
   if (err != apm_->kNoError || !is_component_enabled()) {
     return err;
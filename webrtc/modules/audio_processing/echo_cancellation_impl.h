@@ -11,8 +11,11 @@
 #ifndef WEBRTC_MODULES_AUDIO_PROCESSING_ECHO_CANCELLATION_IMPL_H_
 #define WEBRTC_MODULES_AUDIO_PROCESSING_ECHO_CANCELLATION_IMPL_H_
 
+#include <vector>
+
 #include "webrtc/modules/audio_processing/include/audio_processing.h"
 #include "webrtc/modules/audio_processing/processing_component.h"
+#include "webrtc/modules/audio_processing/render_queue.h"
 
 namespace webrtc {
 
@@ -26,7 +29,11 @@ class EchoCancellationImpl : public EchoCancellation,
                        CriticalSectionWrapper* crit);
   virtual ~EchoCancellationImpl();
 
+  // Queues the far-end audio for the capture thread. Called on the render
+  // thread, which only takes the capture lock if the queue is full.
   int ProcessRenderAudio(const AudioBuffer* audio);
+  // Passes the queued far-end audio to the AEC. Called with the capture lock.
+  int ReadQueuedRenderData();
   int ProcessCaptureAudio(AudioBuffer* audio);
 
   // EchoCancellation implementation.
@@ -76,6 +83,11 @@ class EchoCancellationImpl : public EchoCancellation,
   bool delay_logging_enabled_;
   bool delay_correction_enabled_;
   bool reported_delay_enabled_;
+
+  // The lowest band of each render channel in turn, one block per render call.
+  RenderQueue<float> render_queue_;
+  std::vector<float> render_queue_buffer_;
+  std::vector<float> capture_queue_buffer_;
 };
 
 }  // namespace webrtc
@@ -15,6 +15,7 @@
 
 #include "webrtc/modules/audio_processing/aecm/include/echo_control_mobile.h"
 #include "webrtc/modules/audio_processing/audio_buffer.h"
+#include "webrtc/modules/audio_processing/common.h"
 #include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
 #include "webrtc/system_wrappers/interface/logging.h"
 
@@ -69,7 +70,11 @@ EchoControlMobileImpl::EchoControlMobileImpl(const AudioProcessing* apm,
     crit_(crit),
     routing_mode_(kSpeakerphone),
     comfort_noise_enabled_(true),
-    external_echo_path_(NULL) {}
+    external_echo_path_(NULL),
+    render_queue_(kMaxQueuedRenderBlocks, kMaxRenderBlockSize) {
+  render_queue_buffer_.reserve(kMaxRenderBlockSize);
+  capture_queue_buffer_.reserve(kMaxRenderBlockSize);
+}
 
 EchoControlMobileImpl::~EchoControlMobileImpl() {
     if (external_echo_path_ != NULL) {
@@ -79,6 +84,8 @@ EchoControlMobileImpl::~EchoControlMobileImpl() {
 }
 
 int EchoControlMobileImpl::ProcessRenderAudio(const AudioBuffer* audio) {
+  // Read without the capture lock; a block queued or skipped around a change
+  // of the enabled state is dropped or fed to freshly initialized handles.
   if (!is_component_enabled()) {
     return apm_->kNoError;
   }
@@ -86,27 +93,54 @@ int EchoControlMobileImpl::ProcessRenderAudio(const AudioBuffer* audio) {
   assert(audio->num_frames_per_band() <= 160);
   assert(audio->num_channels() == apm_->num_reverse_channels());
 
-  int err = apm_->kNoError;
+  render_queue_buffer_.clear();
+  for (int j = 0; j < audio->num_channels(); j++) {
+    const int16_t* band = audio->split_bands_const(j)[kBand0To8kHz];
+    render_queue_buffer_.insert(render_queue_buffer_.end(), band,
+                                band + audio->num_frames_per_band());
+  }
 
-  // The ordering convention must be followed to pass to the correct AECM.
-  size_t handle_index = 0;
-  for (int i = 0; i < apm_->num_output_channels(); i++) {
-    for (int j = 0; j < audio->num_channels(); j++) {
-      Handle* my_handle = static_cast<Handle*>(handle(handle_index));
-      err = WebRtcAecm_BufferFarend(
-          my_handle,
-          audio->split_bands_const(j)[kBand0To8kHz],
-          static_cast<int16_t>(audio->num_frames_per_band()));
+  if (!render_queue_.Insert(&render_queue_buffer_)) {
+    // The capture thread isn't keeping up; make room on its behalf.
+    CriticalSectionScoped crit_scoped(crit_);
+    int err = ReadQueuedRenderData();
+    // Can't fail; the queue was just emptied.
+    render_queue_.Insert(&render_queue_buffer_);
+    return err;
+  }
+  return apm_->kNoError;
+}
 
-      if (err != apm_->kNoError) {
-        return GetHandleError(my_handle);  // TODO(ajm): warning possible?
-      }
+int EchoControlMobileImpl::ReadQueuedRenderData() {
+  int err = apm_->kNoError;
+  while (render_queue_.Remove(&capture_queue_buffer_)) {
+    if (!is_component_enabled() || err != apm_->kNoError) {
+      continue;
+    }
 
-      handle_index++;
+    // The ordering convention must be followed to pass to the correct AECM.
+    const int num_reverse_channels = apm_->num_reverse_channels();
+    const size_t num_frames_per_band =
+        capture_queue_buffer_.size() / num_reverse_channels;
+    size_t handle_index = 0;
+    for (int i = 0; i < apm_->num_output_channels(); i++) {
+      for (int j = 0; j < num_reverse_channels; j++) {
+        Handle* my_handle = static_cast<Handle*>(handle(handle_index));
+        if (WebRtcAecm_BufferFarend(
+                my_handle,
+                &capture_queue_buffer_[j * num_frames_per_band],
+                static_cast<int16_t>(num_frames_per_band)) !=
+            apm_->kNoError) {
+          // TODO(ajm): warning possible?
+          err = GetHandleError(my_handle);
+        }
+
+        handle_index++;
+      }
     }
   }
 
-  return apm_->kNoError;
+  return err;
 }
 
 int EchoControlMobileImpl::ProcessCaptureAudio(AudioBuffer* audio) {
@@ -237,6 +271,9 @@ int EchoControlMobileImpl::GetEchoPath(void* echo_path,
 }
 
 int EchoControlMobileImpl::Initialize() {
+  // Queued blocks may not match the new format.
+  render_queue_.Clear();
+
   if (!is_component_enabled()) {
     return apm_->kNoError;
   }
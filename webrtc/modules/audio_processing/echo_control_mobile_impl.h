@@ -11,8 +11,11 @@
 #ifndef WEBRTC_MODULES_AUDIO_PROCESSING_ECHO_CONTROL_MOBILE_IMPL_H_
 #define WEBRTC_MODULES_AUDIO_PROCESSING_ECHO_CONTROL_MOBILE_IMPL_H_
 
+#include <vector>
+
 #include "webrtc/modules/audio_processing/include/audio_processing.h"
 #include "webrtc/modules/audio_processing/processing_component.h"
+#include "webrtc/modules/audio_processing/render_queue.h"
 
 namespace webrtc {
 
@@ -26,7 +29,11 @@ class EchoControlMobileImpl : public EchoControlMobile,
                         CriticalSectionWrapper* crit);
   virtual ~EchoControlMobileImpl();
 
+  // Queues the far-end audio for the capture thread. Called on the render
+  // thread, which only takes the capture lock if the queue is full.
   int ProcessRenderAudio(const AudioBuffer* audio);
+  // Passes the queued far-end audio to the AECM. Called with the capture lock.
+  int ReadQueuedRenderData();
   int ProcessCaptureAudio(AudioBuffer* audio);
 
   // EchoControlMobile implementation.
@@ -58,6 +65,11 @@ class EchoControlMobileImpl : public EchoControlMobile,
   RoutingMode routing_mode_;
   bool comfort_noise_enabled_;
   unsigned char* external_echo_path_;
+
+  // The lowest band of each render channel in turn, one block per render call.
+  RenderQueue<int16_t> render_queue_;
+  std::vector<int16_t> render_queue_buffer_;
+  std::vector<int16_t> capture_queue_buffer_;
 };
 }  // namespace webrtc
 
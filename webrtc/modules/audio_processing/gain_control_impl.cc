@@ -13,6 +13,7 @@
 #include <assert.h>
 
 #include "webrtc/modules/audio_processing/audio_buffer.h"
+#include "webrtc/modules/audio_processing/common.h"
 #include "webrtc/modules/audio_processing/agc/legacy/gain_control.h"
 #include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
 
@@ -48,30 +49,58 @@ GainControlImpl::GainControlImpl(const AudioProcessing* apm,
     compression_gain_db_(9),
     analog_capture_level_(0),
     was_analog_level_set_(false),
-    stream_is_saturated_(false) {}
+    stream_is_saturated_(false),
+    render_queue_(kMaxQueuedRenderBlocks, kMaxRenderBlockSize) {
+  render_queue_buffer_.reserve(kMaxRenderBlockSize);
+  capture_queue_buffer_.reserve(kMaxRenderBlockSize);
+}
 
 GainControlImpl::~GainControlImpl() {}
 
 int GainControlImpl::ProcessRenderAudio(AudioBuffer* audio) {
+  // Read without the capture lock; a block queued or skipped around a change
+  // of the enabled state is dropped or fed to freshly initialized handles.
   if (!is_component_enabled()) {
     return apm_->kNoError;
   }
 
   assert(audio->num_frames_per_band() <= 160);
 
-  for (int i = 0; i < num_handles(); i++) {
-    Handle* my_handle = static_cast<Handle*>(handle(i));
-    int err = WebRtcAgc_AddFarend(
-        my_handle,
-        audio->mixed_low_pass_data(),
-        static_cast<int16_t>(audio->num_frames_per_band()));
+  const int16_t* mixed_data = audio->mixed_low_pass_data();
+  render_queue_buffer_.assign(mixed_data,
+                              mixed_data + audio->num_frames_per_band());
 
-    if (err != apm_->kNoError) {
-      return GetHandleError(my_handle);
+  if (!render_queue_.Insert(&render_queue_buffer_)) {
+    // The capture thread isn't keeping up; make room on its behalf.
+    CriticalSectionScoped crit_scoped(crit_);
+    int err = ReadQueuedRenderData();
+    // Can't fail; the queue was just emptied.
+    render_queue_.Insert(&render_queue_buffer_);
+    return err;
+  }
+  return apm_->kNoError;
+}
+
+int GainControlImpl::ReadQueuedRenderData() {
+  int err = apm_->kNoError;
+  while (render_queue_.Remove(&capture_queue_buffer_)) {
+    if (!is_component_enabled() || err != apm_->kNoError) {
+      continue;
+    }
+
+    for (int i = 0; i < num_handles(); i++) {
+      Handle* my_handle = static_cast<Handle*>(handle(i));
+      if (WebRtcAgc_AddFarend(
+              my_handle,
+              &capture_queue_buffer_[0],
+              static_cast<int16_t>(capture_queue_buffer_.size())) !=
+          apm_->kNoError) {
+        err = GetHandleError(my_handle);
+      }
     }
   }
 
-  return apm_->kNoError;
+  return err;
 }
 
 int GainControlImpl::AnalyzeCaptureAudio(AudioBuffer* audio) {
@@ -290,6 +319,9 @@ bool GainControlImpl::is_limiter_enabled() const {
 }
 
 int GainControlImpl::Initialize() {
+  // Queued blocks may not match the new format.
+  render_queue_.Clear();
+
   int err = ProcessingComponent::Initialize();
   if (err != apm_->kNoError || !is_component_enabled()) {
     return err;
@@ -15,6 +15,7 @@
 
 #include "webrtc/modules/audio_processing/include/audio_processing.h"
 #include "webrtc/modules/audio_processing/processing_component.h"
+#include "webrtc/modules/audio_processing/render_queue.h"
 
 namespace webrtc {
 
@@ -28,7 +29,11 @@ class GainControlImpl : public GainControl,
                   CriticalSectionWrapper* crit);
   virtual ~GainControlImpl();
 
+  // Queues the far-end audio for the capture thread. Called on the render
+  // thread, which only takes the capture lock if the queue is full.
   int ProcessRenderAudio(AudioBuffer* audio);
+  // Passes the queued far-end audio to the AGC. Called with the capture lock.
+  int ReadQueuedRenderData();
   int AnalyzeCaptureAudio(AudioBuffer* audio);
   int ProcessCaptureAudio(AudioBuffer* audio);
 
@@ -76,6 +81,11 @@ class GainControlImpl : public GainControl,
   int analog_capture_level_;
   bool was_analog_level_set_;
   bool stream_is_saturated_;
+
+  // The mixed lowest band of the render channels, one block per render call.
+  RenderQueue<int16_t> render_queue_;
+  std::vector<int16_t> render_queue_buffer_;
+  std::vector<int16_t> capture_queue_buffer_;
 };
 }  // namespace webrtc
 
@@ -282,6 +282,21 @@ class AudioProcessing {
   // method, it will trigger an initialization.
   virtual int ProcessStream(AudioFrame* frame) = 0;
 
+  // Processes |frames[i]| with |apms[i]| for each of |num_streams| independent
+  // streams, as calling apms[i]->ProcessStream(frames[i]) would, with the same
+  // results. Intended for servers processing many streams at once, where
+  // parts of the processing can be run on several streams together.
+  //
+  // The instances must have been created by Create(), and each may appear at
+  // most once in a call and be part of only one call at a time. The result of
+  // each stream is written to |stream_errors[i]| if |stream_errors| is not
+  // NULL. Returns kNoError if all the streams succeeded, and otherwise the
+  // first error.
+  static int ProcessStreams(AudioProcessing* const* apms,
+                            AudioFrame* const* frames,
+                            int num_streams,
+                            int* stream_errors);
+
   // Accepts deinterleaved float audio with the range [-1, 1]. Each element
   // of |src| points to a channel buffer, arranged according to
   // |input_layout|. At output, the channels will be arranged according to
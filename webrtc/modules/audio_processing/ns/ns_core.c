@@ -18,6 +18,15 @@
 #include "webrtc/modules/audio_processing/ns/include/noise_suppression.h"
 #include "webrtc/modules/audio_processing/ns/ns_core.h"
 #include "webrtc/modules/audio_processing/ns/windows_private.h"
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
+
+WebRtcNsLog WebRtcNs_Log;
+WebRtcNsExp WebRtcNs_Exp;
+WebRtcNsUpdateQuantile WebRtcNs_UpdateQuantile;
+WebRtcNsComputeSnr WebRtcNs_ComputeSnr;
+WebRtcNsUpdateLogLrt WebRtcNs_UpdateLogLrt;
+WebRtcNsSpeechProbability WebRtcNs_SpeechProbability;
+WebRtcNsComputeWienerFilter WebRtcNs_ComputeWienerFilter;
 
 // Set Feature Extraction Parameters.
 static void set_feature_extraction_parameters(NoiseSuppressionC* self) {
@@ -209,62 +218,121 @@ int WebRtcNs_InitCore(NoiseSuppressionC* self, uint32_t fs) {
   // Default mode.
   WebRtcNs_set_policy_core(self, 0);
 
+  // Assembly optimization.
+  WebRtcNs_InitKernels_C();
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (WebRtc_GetCPUInfo(kSSE2)) {
+    WebRtcNs_InitKernels_SSE2();
+  }
+#endif
+
   self->initFlag = 1;
   return 0;
 }
 
+static void LogC(const float* in, int length, float* out) {
+  int i;
+  for (i = 0; i < length; i++) {
+    out[i] = (float)log(in[i]);
+  }
+}
+
+static void ExpC(const float* in, int length, float* out) {
+  int i;
+  for (i = 0; i < length; i++) {
+    out[i] = (float)exp(in[i]);
+  }
+}
+
+static void UpdateQuantileC(const float* lmagn,
+                            int counter,
+                            int length,
+                            float* lquantile,
+                            float* density) {
+  int i;
+  float delta;
+
+  for (i = 0; i < length; i++) {
+    // Compute delta.
+    if (density[i] > 1.0) {
+      delta = FACTOR * 1.f / density[i];
+    } else {
+      delta = FACTOR;
+    }
+
+    // Update log quantile estimate.
+    if (lmagn[i] > lquantile[i]) {
+      lquantile[i] += QUANTILE * delta / (float)(counter + 1);
+    } else {
+      lquantile[i] -= (1.f - QUANTILE) * delta / (float)(counter + 1);
+    }
+
+    // Update density estimate.
+    if (fabs(lmagn[i] - lquantile[i]) < WIDTH) {
+      density[i] = ((float)counter * density[i] + 1.f / (2.f * WIDTH)) /
+                   (float)(counter + 1);
+    }
+  }  // End loop over magnitude spectrum.
+}
+
+static void UpdateLogLrtC(const float* snrLocPrior,
+                          const float* snrLocPost,
+                          int length,
+                          float* logLrtTimeAvg) {
+  int i;
+  float tmpFloat1, tmpFloat2, besselTmp;
+
+  for (i = 0; i < length; i++) {
+    tmpFloat1 = 1.f + 2.f * snrLocPrior[i];
+    tmpFloat2 = 2.f * snrLocPrior[i] / (tmpFloat1 + 0.0001f);
+    besselTmp = (snrLocPost[i] + 1.f) * tmpFloat2;
+    logLrtTimeAvg[i] +=
+        LRT_TAVG * (besselTmp - (float)log(tmpFloat1) - logLrtTimeAvg[i]);
+  }
+}
+
+static void SpeechProbabilityC(const float* logLrtTimeAvg,
+                               float gainPrior,
+                               int length,
+                               float* probSpeechFinal) {
+  int i;
+  float invLrt;
+
+  for (i = 0; i < length; i++) {
+    invLrt = (float)exp(-logLrtTimeAvg[i]);
+    invLrt = (float)gainPrior * invLrt;
+    probSpeechFinal[i] = 1.f / (1.f + invLrt);
+  }
+}
+
 // Estimate noise.
 static void NoiseEstimation(NoiseSuppressionC* self,
                             float* magn,
                             float* noise) {
   int i, s, offset;
-  float lmagn[HALF_ANAL_BLOCKL], delta;
+  float lmagn[HALF_ANAL_BLOCKL];
 
   if (self->updates < END_STARTUP_LONG) {
     self->updates++;
   }
 
-  for (i = 0; i < self->magnLen; i++) {
-    lmagn[i] = (float)log(magn[i]);
-  }
+  WebRtcNs_Log(magn, self->magnLen, lmagn);
 
   // Loop over simultaneous estimates.
   for (s = 0; s < SIMULT; s++) {
     offset = s * self->magnLen;
 
     // newquantest(...)
-    for (i = 0; i < self->magnLen; i++) {
-      // Compute delta.
-      if (self->density[offset + i] > 1.0) {
-        delta = FACTOR * 1.f / self->density[offset + i];
-      } else {
-        delta = FACTOR;
-      }
-
-      // Update log quantile estimate.
-      if (lmagn[i] > self->lquantile[offset + i]) {
-        self->lquantile[offset + i] +=
-            QUANTILE * delta / (float)(self->counter[s] + 1);
-      } else {
-        self->lquantile[offset + i] -=
-            (1.f - QUANTILE) * delta / (float)(self->counter[s] + 1);
-      }
-
-      // Update density estimate.
-      if (fabs(lmagn[i] - self->lquantile[offset + i]) < WIDTH) {
-        self->density[offset + i] =
-            ((float)self->counter[s] * self->density[offset + i] +
-             1.f / (2.f * WIDTH)) /
-            (float)(self->counter[s] + 1);
-      }
-    }  // End loop over magnitude spectrum.
+    WebRtcNs_UpdateQuantile(lmagn,
+                            self->counter[s],
+                            self->magnLen,
+                            &self->lquantile[offset],
+                            &self->density[offset]);
 
     if (self->counter[s] >= END_STARTUP_LONG) {
       self->counter[s] = 0;
       if (self->updates >= END_STARTUP_LONG) {
-        for (i = 0; i < self->magnLen; i++) {
-          self->quantile[i] = (float)exp(self->lquantile[offset + i]);
-        }
+        WebRtcNs_Exp(&self->lquantile[offset], self->magnLen, self->quantile);
       }
     }
 
@@ -274,9 +342,7 @@ static void NoiseEstimation(NoiseSuppressionC* self,
   // Sequentially update the noise during startup.
   if (self->updates < END_STARTUP_LONG) {
     // Use the last "s" to get noise during startup that differ from zero.
-    for (i = 0; i < self->magnLen; i++) {
-      self->quantile[i] = (float)exp(self->lquantile[offset + i]);
-    }
+    WebRtcNs_Exp(&self->lquantile[offset], self->magnLen, self->quantile);
   }
 
   for (i = 0; i < self->magnLen; i++) {
@@ -525,6 +591,7 @@ static void ComputeSpectralFlatness(NoiseSuppressionC* self,
   int i;
   int shiftLP = 1;  // Option to remove first bin(s) from spectral measures.
   float avgSpectralFlatnessNum, avgSpectralFlatnessDen, spectralTmp;
+  float logMagn[HALF_ANAL_BLOCKL];
 
   // Compute spectral measures.
   // For flatness.
@@ -536,13 +603,15 @@ static void ComputeSpectralFlatness(NoiseSuppressionC* self,
   // Compute log of ratio of the geometric to arithmetic mean: check for log(0)
   // case.
   for (i = shiftLP; i < self->magnLen; i++) {
-    if (magnIn[i] > 0.0) {
-      avgSpectralFlatnessNum += (float)log(magnIn[i]);
-    } else {
+    if (magnIn[i] <= 0.0) {
       self->featureData[0] -= SPECT_FL_TAVG * self->featureData[0];
       return;
     }
   }
+  WebRtcNs_Log(&magnIn[shiftLP], self->magnLen - shiftLP, &logMagn[shiftLP]);
+  for (i = shiftLP; i < self->magnLen; i++) {
+    avgSpectralFlatnessNum += logMagn[i];
+  }
   // Normalize.
   avgSpectralFlatnessDen = avgSpectralFlatnessDen / self->magnLen;
   avgSpectralFlatnessNum = avgSpectralFlatnessNum / self->magnLen;
@@ -563,11 +632,11 @@ static void ComputeSpectralFlatness(NoiseSuppressionC* self,
 // Outputs:
 //   * |snrLocPrior| is the computed prior SNR.
 //   * |snrLocPost| is the computed post SNR.
-static void ComputeSnr(const NoiseSuppressionC* self,
-                       const float* magn,
-                       const float* noise,
-                       float* snrLocPrior,
-                       float* snrLocPost) {
+static void ComputeSnrC(const NoiseSuppressionC* self,
+                        const float* magn,
+                        const float* noise,
+                        float* snrLocPrior,
+                        float* snrLocPost) {
   int i;
 
   for (i = 0; i < self->magnLen; i++) {
@@ -644,10 +713,10 @@ static void SpeechNoiseProb(NoiseSuppressionC* self,
                             const float* snrLocPrior,
                             const float* snrLocPost) {
   int i, sgnMap;
-  float invLrt, gainPrior, indPrior;
-  float logLrtTimeAvgKsum, besselTmp;
+  float gainPrior, indPrior;
+  float logLrtTimeAvgKsum;
   float indicator0, indicator1, indicator2;
-  float tmpFloat1, tmpFloat2;
+  float tmpFloat1;
   float weightIndPrior0, weightIndPrior1, weightIndPrior2;
   float threshPrior0, threshPrior1, threshPrior2;
   float widthPrior, widthPrior0, widthPrior1, widthPrior2;
@@ -673,12 +742,9 @@ static void SpeechNoiseProb(NoiseSuppressionC* self,
   // Compute feature based on average LR factor.
   // This is the average over all frequencies of the smooth log LRT.
   logLrtTimeAvgKsum = 0.0;
+  WebRtcNs_UpdateLogLrt(snrLocPrior, snrLocPost, self->magnLen,
+                        self->logLrtTimeAvg);
   for (i = 0; i < self->magnLen; i++) {
-    tmpFloat1 = 1.f + 2.f * snrLocPrior[i];
-    tmpFloat2 = 2.f * snrLocPrior[i] / (tmpFloat1 + 0.0001f);
-    besselTmp = (snrLocPost[i] + 1.f) * tmpFloat2;
-    self->logLrtTimeAvg[i] +=
-        LRT_TAVG * (besselTmp - (float)log(tmpFloat1) - self->logLrtTimeAvg[i]);
     logLrtTimeAvgKsum += self->logLrtTimeAvg[i];
   }
   logLrtTimeAvgKsum = (float)logLrtTimeAvgKsum / (self->magnLen);
@@ -741,11 +807,8 @@ static void SpeechNoiseProb(NoiseSuppressionC* self,
 
   // Final speech probability: combine prior model with LR factor:.
   gainPrior = (1.f - self->priorSpeechProb) / (self->priorSpeechProb + 0.0001f);
-  for (i = 0; i < self->magnLen; i++) {
-    invLrt = (float)exp(-self->logLrtTimeAvg[i]);
-    invLrt = (float)gainPrior * invLrt;
-    probSpeechFinal[i] = 1.f / (1.f + invLrt);
-  }
+  WebRtcNs_SpeechProbability(self->logLrtTimeAvg, gainPrior, self->magnLen,
+                             probSpeechFinal);
 }
 
 // Update the noise features.
@@ -982,9 +1045,9 @@ static void Windowing(const float* window,
 //   * |magn| is the signal magnitude spectrum estimate.
 // Output:
 //   * |theFilter| is the frequency response of the computed Wiener filter.
-static void ComputeDdBasedWienerFilter(const NoiseSuppressionC* self,
-                                       const float* magn,
-                                       float* theFilter) {
+static void ComputeDdBasedWienerFilterC(const NoiseSuppressionC* self,
+                                        const float* magn,
+                                        float* theFilter) {
   int i;
   float snrPrior, previousEstimateStsa, currentEstimateStsa;
 
@@ -1169,7 +1232,7 @@ void WebRtcNs_AnalyzeCore(NoiseSuppressionC* self, const float* speechFrame) {
   }
 
   // Post and prior SNR needed for SpeechNoiseProb.
-  ComputeSnr(self, magn, noise, snrLocPrior, snrLocPost);
+  WebRtcNs_ComputeSnr(self, magn, noise, snrLocPrior, snrLocPost);
 
   FeatureUpdate(self, magn, updateParsFlag);
   SpeechNoiseProb(self, self->speechProb, snrLocPrior, snrLocPost);
@@ -1271,7 +1334,7 @@ void WebRtcNs_ProcessCore(NoiseSuppressionC* self,
     }
   }
 
-  ComputeDdBasedWienerFilter(self, magn, theFilter);
+  WebRtcNs_ComputeWienerFilter(self, magn, theFilter);
 
   for (i = 0; i < self->magnLen; i++) {
     // Flooring bottom.
@@ -1413,3 +1476,13 @@ void WebRtcNs_ProcessCore(NoiseSuppressionC* self,
     }
   }  // End of H band gain computation.
 }
+
+void WebRtcNs_InitKernels_C(void) {
+  WebRtcNs_Log = LogC;
+  WebRtcNs_Exp = ExpC;
+  WebRtcNs_UpdateQuantile = UpdateQuantileC;
+  WebRtcNs_ComputeSnr = ComputeSnrC;
+  WebRtcNs_UpdateLogLrt = UpdateLogLrtC;
+  WebRtcNs_SpeechProbability = SpeechProbabilityC;
+  WebRtcNs_ComputeWienerFilter = ComputeDdBasedWienerFilterC;
+}
@@ -12,6 +12,7 @@
 #define WEBRTC_MODULES_AUDIO_PROCESSING_NS_NS_CORE_H_
 
 #include "webrtc/modules/audio_processing/ns/defines.h"
+#include "webrtc/typedefs.h"
 
 typedef struct NSParaExtract_ {
   // Bin size of histogram.
@@ -184,6 +185,59 @@ void WebRtcNs_ProcessCore(NoiseSuppressionC* self,
                           int num_bands,
                           float* const* outFrame);
 
+// Speed-critical kernels of the noise suppressor, operating on |length| bins.
+// WebRtcNs_InitCore() points them at the fastest implementation available.
+
+// Natural logarithm of each element in |in|, which must be positive.
+typedef void (*WebRtcNsLog)(const float* in, int length, float* out);
+extern WebRtcNsLog WebRtcNs_Log;
+// Exponential of each element in |in|.
+typedef void (*WebRtcNsExp)(const float* in, int length, float* out);
+extern WebRtcNsExp WebRtcNs_Exp;
+// Updates one of the simultaneous quantile estimates with the log magnitude
+// spectrum |lmagn|. |counter| is the number of updates of the estimate.
+typedef void (*WebRtcNsUpdateQuantile)(const float* lmagn,
+                                       int counter,
+                                       int length,
+                                       float* lquantile,
+                                       float* density);
+extern WebRtcNsUpdateQuantile WebRtcNs_UpdateQuantile;
+// Computes the prior and post SNR from |magn| and the |noise| estimate.
+typedef void (*WebRtcNsComputeSnr)(const NoiseSuppressionC* self,
+                                   const float* magn,
+                                   const float* noise,
+                                   float* snrLocPrior,
+                                   float* snrLocPost);
+extern WebRtcNsComputeSnr WebRtcNs_ComputeSnr;
+// Updates the time-smoothed log likelihood ratio in |logLrtTimeAvg|.
+typedef void (*WebRtcNsUpdateLogLrt)(const float* snrLocPrior,
+                                     const float* snrLocPost,
+                                     int length,
+                                     float* logLrtTimeAvg);
+extern WebRtcNsUpdateLogLrt WebRtcNs_UpdateLogLrt;
+// Combines the log likelihood ratio with the prior model, weighted by
+// |gainPrior|, into the speech probability |probSpeechFinal|.
+typedef void (*WebRtcNsSpeechProbability)(const float* logLrtTimeAvg,
+                                          float gainPrior,
+                                          int length,
+                                          float* probSpeechFinal);
+extern WebRtcNsSpeechProbability WebRtcNs_SpeechProbability;
+// Computes the decision-directed Wiener filter |theFilter| for |magn|.
+typedef void (*WebRtcNsComputeWienerFilter)(const NoiseSuppressionC* self,
+                                            const float* magn,
+                                            float* theFilter);
+extern WebRtcNsComputeWienerFilter WebRtcNs_ComputeWienerFilter;
+
+// Points the kernels at their C implementations.
+void WebRtcNs_InitKernels_C(void);
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+// Points the kernels at their SSE2 implementations. The SSE2 logarithm and
+// exponential are polynomial approximations, so the results differ slightly
+// from the C implementations.
+void WebRtcNs_InitKernels_SSE2(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,346 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * The core noise suppression algorithm, SSE2 version of speed-critical
+ * functions.
+ */
+
+#include <emmintrin.h>
+#include <math.h>
+
+#include "webrtc/modules/audio_processing/ns/defines.h"
+#include "webrtc/modules/audio_processing/ns/ns_core.h"
+
+// Natural logarithm of four positive normal floats. Uses the range reduction
+// and the polynomial of the Cephes logf(), with a relative error of a few ulp.
+static __m128 LogSSE2(__m128 x) {
+  const __m128 kOne = _mm_set1_ps(1.f);
+  const __m128 kHalf = _mm_set1_ps(0.5f);
+  const __m128 kSqrtHalf = _mm_set1_ps(0.707106781186547524f);
+  const __m128 kMantissaMask = _mm_castsi128_ps(_mm_set1_epi32(0x007fffff));
+  __m128i exponent;
+  __m128 e, mask, z, y;
+
+  // Split |x| into a mantissa in [0.5, 1) and an exponent.
+  exponent = _mm_srli_epi32(_mm_castps_si128(x), 23);
+  exponent = _mm_sub_epi32(exponent, _mm_set1_epi32(126));
+  e = _mm_cvtepi32_ps(exponent);
+  x = _mm_or_ps(_mm_and_ps(x, kMantissaMask), kHalf);
+
+  // Move the mantissa to [sqrt(0.5), sqrt(2)) and subtract one.
+  mask = _mm_cmplt_ps(x, kSqrtHalf);
+  e = _mm_sub_ps(e, _mm_and_ps(kOne, mask));
+  x = _mm_add_ps(_mm_sub_ps(x, kOne), _mm_and_ps(x, mask));
+
+  z = _mm_mul_ps(x, x);
+  y = _mm_set1_ps(7.0376836292e-2f);
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(-1.1514610310e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.1676998740e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(-1.2420140846e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.4249322787e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(-1.6668057665e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(2.0000714765e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(-2.4999993993e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(3.3333331174e-1f));
+  y = _mm_mul_ps(_mm_mul_ps(y, x), z);
+
+  // log(x) = log(1 + mantissa) + e * log(2), with log(2) split in two parts.
+  y = _mm_add_ps(y, _mm_mul_ps(e, _mm_set1_ps(-2.12194440e-4f)));
+  y = _mm_sub_ps(y, _mm_mul_ps(z, kHalf));
+  x = _mm_add_ps(x, y);
+  return _mm_add_ps(x, _mm_mul_ps(e, _mm_set1_ps(0.693359375f)));
+}
+
+// Exponential of four floats. Uses the range reduction and the polynomial of
+// the Cephes expf(), with a relative error of a few ulp. Results are clamped
+// to the range of normal floats.
+static __m128 ExpSSE2(__m128 x) {
+  const __m128 kOne = _mm_set1_ps(1.f);
+  __m128 fx, floor_fx, z, y;
+  __m128i exponent;
+
+  x = _mm_min_ps(x, _mm_set1_ps(88.02969f));
+  x = _mm_max_ps(x, _mm_set1_ps(-87.33654f));
+
+  // exp(x) = 2^n * exp(g), with n = round(x / log(2)) and |g| <= log(2) / 2.
+  fx = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(1.44269504088896341f)),
+                  _mm_set1_ps(0.5f));
+  floor_fx = _mm_cvtepi32_ps(_mm_cvttps_epi32(fx));
+  fx = _mm_sub_ps(floor_fx, _mm_and_ps(_mm_cmpgt_ps(floor_fx, fx), kOne));
+  x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(0.693359375f)));
+  x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(-2.12194440e-4f)));
+
+  z = _mm_mul_ps(x, x);
+  y = _mm_set1_ps(1.9875691500e-4f);
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.3981999507e-3f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(8.3334519073e-3f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(4.1665795894e-2f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.6666665459e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(5.0000001201e-1f));
+  y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(y, z), x), kOne);
+
+  // Build 2^n directly in the exponent bits.
+  exponent = _mm_add_epi32(_mm_cvttps_epi32(fx), _mm_set1_epi32(0x7f));
+  exponent = _mm_slli_epi32(exponent, 23);
+  return _mm_mul_ps(y, _mm_castsi128_ps(exponent));
+}
+
+static void LogSSE2Vector(const float* in, int length, float* out) {
+  int i;
+
+  // Vectorized code (four at once).
+  for (i = 0; i + 3 < length; i += 4) {
+    _mm_storeu_ps(&out[i], LogSSE2(_mm_loadu_ps(&in[i])));
+  }
+  // Scalar code for the remaining items.
+  for (; i < length; i++) {
+    out[i] = (float)log(in[i]);
+  }
+}
+
+static void ExpSSE2Vector(const float* in, int length, float* out) {
+  int i;
+
+  // Vectorized code (four at once).
+  for (i = 0; i + 3 < length; i += 4) {
+    _mm_storeu_ps(&out[i], ExpSSE2(_mm_loadu_ps(&in[i])));
+  }
+  // Scalar code for the remaining items.
+  for (; i < length; i++) {
+    out[i] = (float)exp(in[i]);
+  }
+}
+
+// Same arithmetic as the C version, so the results are identical for the same
+// |lmagn|.
+static void UpdateQuantileSSE2(const float* lmagn,
+                               int counter,
+                               int length,
+                               float* lquantile,
+                               float* density) {
+  const float kDensityStep = 1.f / (2.f * WIDTH);
+  const float counter_plus_one = (float)(counter + 1);
+  const __m128 kOne = _mm_set1_ps(1.f);
+  const __m128 kFactor = _mm_set1_ps(FACTOR * 1.f);
+  const __m128 kQuantile = _mm_set1_ps(QUANTILE);
+  const __m128 kOneMinusQuantile = _mm_set1_ps(1.f - QUANTILE);
+  const __m128 kWidth = _mm_set1_ps(WIDTH);
+  const __m128 kAbsMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  const __m128 counter_ps = _mm_set1_ps((float)counter);
+  const __m128 counter_plus_one_ps = _mm_set1_ps(counter_plus_one);
+  const __m128 density_step = _mm_set1_ps(kDensityStep);
+  int i;
+
+  // Vectorized code (four at once).
+  for (i = 0; i + 3 < length; i += 4) {
+    const __m128 lmagn_ps = _mm_loadu_ps(&lmagn[i]);
+    __m128 lquantile_ps = _mm_loadu_ps(&lquantile[i]);
+    __m128 density_ps = _mm_loadu_ps(&density[i]);
+    __m128 mask, delta, step_up, step_down, new_density;
+
+    // Compute delta.
+    mask = _mm_cmpgt_ps(density_ps, kOne);
+    delta = _mm_or_ps(_mm_and_ps(mask, _mm_div_ps(kFactor, density_ps)),
+                      _mm_andnot_ps(mask, kFactor));
+
+    // Update log quantile estimate.
+    step_up = _mm_div_ps(_mm_mul_ps(kQuantile, delta), counter_plus_one_ps);
+    step_down =
+        _mm_div_ps(_mm_mul_ps(kOneMinusQuantile, delta), counter_plus_one_ps);
+    mask = _mm_cmpgt_ps(lmagn_ps, lquantile_ps);
+    lquantile_ps = _mm_or_ps(
+        _mm_and_ps(mask, _mm_add_ps(lquantile_ps, step_up)),
+        _mm_andnot_ps(mask, _mm_sub_ps(lquantile_ps, step_down)));
+    _mm_storeu_ps(&lquantile[i], lquantile_ps);
+
+    // Update density estimate.
+    mask = _mm_cmplt_ps(
+        _mm_and_ps(_mm_sub_ps(lmagn_ps, lquantile_ps), kAbsMask), kWidth);
+    new_density = _mm_div_ps(
+        _mm_add_ps(_mm_mul_ps(counter_ps, density_ps), density_step),
+        counter_plus_one_ps);
+    density_ps = _mm_or_ps(_mm_and_ps(mask, new_density),
+                           _mm_andnot_ps(mask, density_ps));
+    _mm_storeu_ps(&density[i], density_ps);
+  }
+
+  // Scalar code for the remaining items.
+  for (; i < length; i++) {
+    float delta = FACTOR;
+    if (density[i] > 1.f) {
+      delta = FACTOR * 1.f / density[i];
+    }
+    if (lmagn[i] > lquantile[i]) {
+      lquantile[i] += QUANTILE * delta / counter_plus_one;
+    } else {
+      lquantile[i] -= (1.f - QUANTILE) * delta / counter_plus_one;
+    }
+    if (fabs(lmagn[i] - lquantile[i]) < WIDTH) {
+      density[i] =
+          ((float)counter * density[i] + kDensityStep) / counter_plus_one;
+    }
+  }
+}
+
+// Same arithmetic as the C version.
+static void ComputeSnrSSE2(const NoiseSuppressionC* self,
+                           const float* magn,
+                           const float* noise,
+                           float* snrLocPrior,
+                           float* snrLocPost) {
+  const __m128 kOne = _mm_set1_ps(1.f);
+  const __m128 kEpsilon = _mm_set1_ps(0.0001f);
+  const __m128 kDdPrSnr = _mm_set1_ps(DD_PR_SNR);
+  const __m128 kOneMinusDdPrSnr = _mm_set1_ps(1.f - DD_PR_SNR);
+  int i;
+
+  // Vectorized code (four at once).
+  for (i = 0; i + 3 < self->magnLen; i += 4) {
+    const __m128 magn_ps = _mm_loadu_ps(&magn[i]);
+    const __m128 noise_ps = _mm_loadu_ps(&noise[i]);
+    const __m128 previous_estimate_stsa = _mm_mul_ps(
+        _mm_div_ps(_mm_loadu_ps(&self->magnPrevAnalyze[i]),
+                   _mm_add_ps(_mm_loadu_ps(&self->noisePrev[i]), kEpsilon)),
+        _mm_loadu_ps(&self->smooth[i]));
+    const __m128 post = _mm_and_ps(
+        _mm_cmpgt_ps(magn_ps, noise_ps),
+        _mm_sub_ps(_mm_div_ps(magn_ps, _mm_add_ps(noise_ps, kEpsilon)), kOne));
+    _mm_storeu_ps(&snrLocPost[i], post);
+    _mm_storeu_ps(&snrLocPrior[i],
+                  _mm_add_ps(_mm_mul_ps(kDdPrSnr, previous_estimate_stsa),
+                             _mm_mul_ps(kOneMinusDdPrSnr, post)));
+  }
+
+  // Scalar code for the remaining items.
+  for (; i < self->magnLen; i++) {
+    float previousEstimateStsa = self->magnPrevAnalyze[i] /
+        (self->noisePrev[i] + 0.0001f) * self->smooth[i];
+    snrLocPost[i] = 0.f;
+    if (magn[i] > noise[i]) {
+      snrLocPost[i] = magn[i] / (noise[i] + 0.0001f) - 1.f;
+    }
+    snrLocPrior[i] =
+        DD_PR_SNR * previousEstimateStsa + (1.f - DD_PR_SNR) * snrLocPost[i];
+  }
+}
+
+static void UpdateLogLrtSSE2(const float* snrLocPrior,
+                             const float* snrLocPost,
+                             int length,
+                             float* logLrtTimeAvg) {
+  const __m128 kOne = _mm_set1_ps(1.f);
+  const __m128 kTwo = _mm_set1_ps(2.f);
+  const __m128 kEpsilon = _mm_set1_ps(0.0001f);
+  const __m128 kLrtTavg = _mm_set1_ps(LRT_TAVG);
+  int i;
+
+  // Vectorized code (four at once).
+  for (i = 0; i + 3 < length; i += 4) {
+    const __m128 prior = _mm_loadu_ps(&snrLocPrior[i]);
+    const __m128 two_prior = _mm_mul_ps(kTwo, prior);
+    const __m128 tmp1 = _mm_add_ps(kOne, two_prior);
+    const __m128 tmp2 = _mm_div_ps(two_prior, _mm_add_ps(tmp1, kEpsilon));
+    const __m128 bessel =
+        _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(&snrLocPost[i]), kOne), tmp2);
+    const __m128 lrt = _mm_loadu_ps(&logLrtTimeAvg[i]);
+    const __m128 update =
+        _mm_sub_ps(_mm_sub_ps(bessel, LogSSE2(tmp1)), lrt);
+    _mm_storeu_ps(&logLrtTimeAvg[i],
+                  _mm_add_ps(lrt, _mm_mul_ps(kLrtTavg, update)));
+  }
+
+  // Scalar code for the remaining items.
+  for (; i < length; i++) {
+    const float tmpFloat1 = 1.f + 2.f * snrLocPrior[i];
+    const float tmpFloat2 = 2.f * snrLocPrior[i] / (tmpFloat1 + 0.0001f);
+    const float besselTmp = (snrLocPost[i] + 1.f) * tmpFloat2;
+    logLrtTimeAvg[i] +=
+        LRT_TAVG * (besselTmp - (float)log(tmpFloat1) - logLrtTimeAvg[i]);
+  }
+}
+
+static void SpeechProbabilitySSE2(const float* logLrtTimeAvg,
+                                  float gainPrior,
+                                  int length,
+                                  float* probSpeechFinal) {
+  const __m128 kOne = _mm_set1_ps(1.f);
+  const __m128 gain_prior = _mm_set1_ps(gainPrior);
+  int i;
+
+  // Vectorized code (four at once).
+  for (i = 0; i + 3 < length; i += 4) {
+    const __m128 minus_lrt =
+        _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&logLrtTimeAvg[i]));
+    const __m128 inv_lrt = _mm_mul_ps(gain_prior, ExpSSE2(minus_lrt));
+    _mm_storeu_ps(&probSpeechFinal[i],
+                  _mm_div_ps(kOne, _mm_add_ps(kOne, inv_lrt)));
+  }
+
+  // Scalar code for the remaining items.
+  for (; i < length; i++) {
+    const float invLrt = gainPrior * (float)exp(-logLrtTimeAvg[i]);
+    probSpeechFinal[i] = 1.f / (1.f + invLrt);
+  }
+}
+
+// Same arithmetic as the C version.
+static void ComputeWienerFilterSSE2(const NoiseSuppressionC* self,
+                                    const float* magn,
+                                    float* theFilter) {
+  const __m128 kOne = _mm_set1_ps(1.f);
+  const __m128 kEpsilon = _mm_set1_ps(0.0001f);
+  const __m128 kDdPrSnr = _mm_set1_ps(DD_PR_SNR);
+  const __m128 kOneMinusDdPrSnr = _mm_set1_ps(1.f - DD_PR_SNR);
+  const __m128 overdrive = _mm_set1_ps(self->overdrive);
+  int i;
+
+  // Vectorized code (four at once).
+  for (i = 0; i + 3 < self->magnLen; i += 4) {
+    const __m128 magn_ps = _mm_loadu_ps(&magn[i]);
+    const __m128 noise_ps = _mm_loadu_ps(&self->noise[i]);
+    const __m128 previous_estimate_stsa = _mm_mul_ps(
+        _mm_div_ps(_mm_loadu_ps(&self->magnPrevProcess[i]),
+                   _mm_add_ps(_mm_loadu_ps(&self->noisePrev[i]), kEpsilon)),
+        _mm_loadu_ps(&self->smooth[i]));
+    const __m128 current_estimate_stsa = _mm_and_ps(
+        _mm_cmpgt_ps(magn_ps, noise_ps),
+        _mm_sub_ps(_mm_div_ps(magn_ps, _mm_add_ps(noise_ps, kEpsilon)), kOne));
+    const __m128 snr_prior =
+        _mm_add_ps(_mm_mul_ps(kDdPrSnr, previous_estimate_stsa),
+                   _mm_mul_ps(kOneMinusDdPrSnr, current_estimate_stsa));
+    _mm_storeu_ps(&theFilter[i],
+                  _mm_div_ps(snr_prior, _mm_add_ps(overdrive, snr_prior)));
+  }
+
+  // Scalar code for the remaining items.
+  for (; i < self->magnLen; i++) {
+    const float previousEstimateStsa = self->magnPrevProcess[i] /
+        (self->noisePrev[i] + 0.0001f) * self->smooth[i];
+    float currentEstimateStsa = 0.f;
+    float snrPrior;
+    if (magn[i] > self->noise[i]) {
+      currentEstimateStsa = magn[i] / (self->noise[i] + 0.0001f) - 1.f;
+    }
+    snrPrior = DD_PR_SNR * previousEstimateStsa +
+               (1.f - DD_PR_SNR) * currentEstimateStsa;
+    theFilter[i] = snrPrior / (self->overdrive + snrPrior);
+  }
+}
+
+void WebRtcNs_InitKernels_SSE2(void) {
+  WebRtcNs_Log = LogSSE2Vector;
+  WebRtcNs_Exp = ExpSSE2Vector;
+  WebRtcNs_UpdateQuantile = UpdateQuantileSSE2;
+  WebRtcNs_ComputeSnr = ComputeSnrSSE2;
+  WebRtcNs_UpdateLogLrt = UpdateLogLrtSSE2;
+  WebRtcNs_SpeechProbability = SpeechProbabilitySSE2;
+  WebRtcNs_ComputeWienerFilter = ComputeWienerFilterSSE2;
+}
@@ -0,0 +1,224 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/audio_processing/ns/ns_core.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/base/scoped_ptr.h"
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
+
+namespace webrtc {
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+
+namespace {
+
+const int kLength = HALF_ANAL_BLOCKL;
+
+float RandomFloat(float min_value, float max_value) {
+  return min_value + (max_value - min_value) * rand() / RAND_MAX;
+}
+
+void FillRandom(float min_value, float max_value, float* data) {
+  for (int i = 0; i < kLength; ++i)
+    data[i] = RandomFloat(min_value, max_value);
+}
+
+// Fills |frame| with a tone switching on and off over a noise floor.
+void GenerateFrame(int frame_index, int length, float* frame) {
+  const bool tone_on = (frame_index / 50) % 2 == 1;
+  for (int i = 0; i < length; ++i) {
+    const int n = frame_index * length + i;
+    frame[i] = RandomFloat(-300.f, 300.f);
+    if (tone_on)
+      frame[i] += 4000.f * sinf(0.11f * n) + 2000.f * sinf(0.37f * n);
+  }
+}
+
+void InitializeNs(NoiseSuppressionC* ns, uint32_t fs) {
+  ASSERT_EQ(0, WebRtcNs_InitCore(ns, fs));
+  ASSERT_EQ(0, WebRtcNs_set_policy_core(ns, 2));
+}
+
+// Runs the analysis and processing of |ns| on one frame of each band.
+void ProcessFrame(NoiseSuppressionC* ns,
+                  const float* const* in,
+                  int num_bands,
+                  float* const* out) {
+  WebRtcNs_AnalyzeCore(ns, in[0]);
+  WebRtcNs_ProcessCore(ns, in, num_bands, out);
+}
+
+class NsCoreSse2Test : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(WebRtc_GetCPUInfo(kSSE2));
+    srand(42);
+  }
+
+  void TearDown() override {
+    // Leave the kernels as WebRtcNs_InitCore() would.
+    WebRtcNs_InitKernels_SSE2();
+  }
+};
+
+}  // namespace
+
+TEST_F(NsCoreSse2Test, LogAndExpAreAccurate) {
+  float in[kLength];
+  float out_c[kLength];
+  float out_sse2[kLength];
+
+  // Covers the magnitude spectrum and SNR ranges.
+  for (int i = 0; i < kLength; ++i)
+    in[i] = expf(RandomFloat(-20.f, 40.f));
+  WebRtcNs_InitKernels_C();
+  WebRtcNs_Log(in, kLength, out_c);
+  WebRtcNs_InitKernels_SSE2();
+  WebRtcNs_Log(in, kLength, out_sse2);
+  for (int i = 0; i < kLength; ++i)
+    EXPECT_NEAR(out_c[i], out_sse2[i], 1e-6f * fabsf(out_c[i]) + 1e-7f);
+
+  FillRandom(-80.f, 80.f, in);
+  WebRtcNs_InitKernels_C();
+  WebRtcNs_Exp(in, kLength, out_c);
+  WebRtcNs_InitKernels_SSE2();
+  WebRtcNs_Exp(in, kLength, out_sse2);
+  for (int i = 0; i < kLength; ++i)
+    EXPECT_NEAR(out_c[i], out_sse2[i], 1e-6f * out_c[i]);
+}
+
+TEST_F(NsCoreSse2Test, BitExactKernelsMatchC) {
+  rtc::scoped_ptr<NoiseSuppressionC> ns(new NoiseSuppressionC);
+  InitializeNs(ns.get(), 16000);
+  ASSERT_EQ(kLength, ns->magnLen);
+  FillRandom(0.f, 1.f, ns->smooth);
+  FillRandom(1.f, 1000.f, ns->noise);
+  FillRandom(1.f, 1000.f, ns->noisePrev);
+  FillRandom(1.f, 1000.f, ns->magnPrevAnalyze);
+  FillRandom(1.f, 1000.f, ns->magnPrevProcess);
+
+  float magn[kLength];
+  float lmagn[kLength];
+  FillRandom(1.f, 1000.f, magn);
+  for (int i = 0; i < kLength; ++i)
+    lmagn[i] = logf(magn[i]);
+
+  float lquantile_c[kLength], lquantile_sse2[kLength];
+  float density_c[kLength], density_sse2[kLength];
+  FillRandom(0.f, 7.f, lquantile_c);
+  FillRandom(0.f, 3.f, density_c);
+  // Puts some estimates within WIDTH of the input.
+  for (int i = 0; i < kLength; i += 3)
+    lquantile_c[i] = lmagn[i];
+  memcpy(lquantile_sse2, lquantile_c, sizeof(lquantile_c));
+  memcpy(density_sse2, density_c, sizeof(density_c));
+
+  float prior_c[kLength], prior_sse2[kLength];
+  float post_c[kLength], post_sse2[kLength];
+  float filter_c[kLength], filter_sse2[kLength];
+
+  WebRtcNs_InitKernels_C();
+  WebRtcNs_UpdateQuantile(lmagn, 17, kLength, lquantile_c, density_c);
+  WebRtcNs_ComputeSnr(ns.get(), magn, ns->noise, prior_c, post_c);
+  WebRtcNs_ComputeWienerFilter(ns.get(), magn, filter_c);
+
+  WebRtcNs_InitKernels_SSE2();
+  WebRtcNs_UpdateQuantile(lmagn, 17, kLength, lquantile_sse2, density_sse2);
+  WebRtcNs_ComputeSnr(ns.get(), magn, ns->noise, prior_sse2, post_sse2);
+  WebRtcNs_ComputeWienerFilter(ns.get(), magn, filter_sse2);
+
+  for (int i = 0; i < kLength; ++i) {
+    EXPECT_EQ(lquantile_c[i], lquantile_sse2[i]);
+    EXPECT_EQ(density_c[i], density_sse2[i]);
+    EXPECT_EQ(prior_c[i], prior_sse2[i]);
+    EXPECT_EQ(post_c[i], post_sse2[i]);
+    EXPECT_EQ(filter_c[i], filter_sse2[i]);
+  }
+}
+
+TEST_F(NsCoreSse2Test, SpeechProbabilityKernelsMatchC) {
+  float prior[kLength];
+  float post[kLength];
+  float lrt_c[kLength], lrt_sse2[kLength];
+  float prob_c[kLength], prob_sse2[kLength];
+  FillRandom(0.f, 100.f, prior);
+  FillRandom(0.f, 100.f, post);
+  FillRandom(-1.f, 10.f, lrt_c);
+  memcpy(lrt_sse2, lrt_c, sizeof(lrt_c));
+
+  WebRtcNs_InitKernels_C();
+  WebRtcNs_UpdateLogLrt(prior, post, kLength, lrt_c);
+  WebRtcNs_SpeechProbability(lrt_c, 0.5f, kLength, prob_c);
+  WebRtcNs_InitKernels_SSE2();
+  WebRtcNs_UpdateLogLrt(prior, post, kLength, lrt_sse2);
+  WebRtcNs_SpeechProbability(lrt_sse2, 0.5f, kLength, prob_sse2);
+
+  for (int i = 0; i < kLength; ++i) {
+    EXPECT_NEAR(lrt_c[i], lrt_sse2[i], 1e-6f * fabsf(lrt_c[i]) + 1e-6f);
+    EXPECT_NEAR(prob_c[i], prob_sse2[i], 1e-6f);
+  }
+}
+
+// Runs the C and SSE2 kernels side by side on a signal with speech-like bursts
+// and checks that the outputs stay within a small tolerance of each other.
+TEST_F(NsCoreSse2Test, OutputMatchesC) {
+  const uint32_t kSampleRates[] = {8000, 16000, 32000};
+  const int kNumFrames = 1000;
+  // In units of 16-bit samples.
+  const float kTolerance = 2.f;
+
+  for (size_t r = 0; r < sizeof(kSampleRates) / sizeof(*kSampleRates); ++r) {
+    const uint32_t fs = kSampleRates[r];
+    const int num_bands = fs == 32000 ? 2 : 1;
+    rtc::scoped_ptr<NoiseSuppressionC> ns_c(new NoiseSuppressionC);
+    rtc::scoped_ptr<NoiseSuppressionC> ns_sse2(new NoiseSuppressionC);
+    InitializeNs(ns_c.get(), fs);
+    InitializeNs(ns_sse2.get(), fs);
+    const int length = ns_c->blockLen;
+
+    float in_data[2][BLOCKL_MAX];
+    float out_c_data[2][BLOCKL_MAX];
+    float out_sse2_data[2][BLOCKL_MAX];
+    const float* in[] = {in_data[0], in_data[1]};
+    float* out_c[] = {out_c_data[0], out_c_data[1]};
+    float* out_sse2[] = {out_sse2_data[0], out_sse2_data[1]};
+
+    float max_difference = 0.f;
+    for (int frame = 0; frame < kNumFrames; ++frame) {
+      for (int band = 0; band < num_bands; ++band)
+        GenerateFrame(frame, length, in_data[band]);
+
+      WebRtcNs_InitKernels_C();
+      ProcessFrame(ns_c.get(), in, num_bands, out_c);
+      WebRtcNs_InitKernels_SSE2();
+      ProcessFrame(ns_sse2.get(), in, num_bands, out_sse2);
+
+      for (int band = 0; band < num_bands; ++band) {
+        for (int i = 0; i < length; ++i) {
+          max_difference = std::max(
+              max_difference, fabsf(out_c[band][i] - out_sse2[band][i]));
+        }
+      }
+    }
+    EXPECT_LE(max_difference, kTolerance) << "fs = " << fs;
+    EXPECT_NEAR(ns_c->priorSpeechProb, ns_sse2->priorSpeechProb, 1e-3f);
+  }
+}
+
+#endif  // defined(WEBRTC_ARCH_X86_FAMILY)
+
+}  // namespace webrtc
@@ -0,0 +1,81 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_AUDIO_PROCESSING_RENDER_QUEUE_H_
+#define WEBRTC_MODULES_AUDIO_PROCESSING_RENDER_QUEUE_H_
+
+#include <vector>
+
+#include "webrtc/base/constructormagic.h"
+#include "webrtc/base/criticalsection.h"
+
+namespace webrtc {
+
+// Lock-free queue handing blocks of far-end audio from the render thread to
+// the capture thread. Blocks are passed by swapping vectors in and out of the
+// queue, so once every slot has been used at the largest block size neither
+// side copies or allocates more than the block itself.
+//
+// One thread at a time may call Insert(), and one thread at a time may call
+// Remove() and Clear(); the two may run concurrently.
+template <typename T>
+class RenderQueue {
+ public:
+  // Holds up to |capacity| blocks, with room for |max_block_size| samples
+  // reserved in each.
+  RenderQueue(size_t capacity, size_t max_block_size)
+      : slots_(capacity + 1), read_index_(0), write_index_(0) {
+    for (size_t i = 0; i < slots_.size(); ++i)
+      slots_[i].reserve(max_block_size);
+  }
+
+  // Moves |block| into the queue and leaves an unused vector in its place.
+  // Returns false, leaving |block| untouched, if the queue is full.
+  bool Insert(std::vector<T>* block) {
+    const int write_index = write_index_;
+    const int next_index = Next(write_index);
+    if (next_index == rtc::AtomicOps::Load(&read_index_))
+      return false;
+    slots_[write_index].swap(*block);
+    rtc::AtomicOps::Store(&write_index_, next_index);
+    return true;
+  }
+
+  // Moves the oldest block into |block|. Returns false if the queue is empty.
+  bool Remove(std::vector<T>* block) {
+    const int read_index = read_index_;
+    if (read_index == rtc::AtomicOps::Load(&write_index_))
+      return false;
+    slots_[read_index].swap(*block);
+    rtc::AtomicOps::Store(&read_index_, Next(read_index));
+    return true;
+  }
+
+  // Discards all queued blocks.
+  void Clear() {
+    rtc::AtomicOps::Store(&read_index_, rtc::AtomicOps::Load(&write_index_));
+  }
+
+ private:
+  int Next(int index) const {
+    return (index + 1) % static_cast<int>(slots_.size());
+  }
+
+  // One slot is always left empty, to tell a full queue from an empty one.
+  std::vector<std::vector<T>> slots_;
+  volatile int read_index_;
+  volatile int write_index_;
+
+  DISALLOW_COPY_AND_ASSIGN(RenderQueue);
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_AUDIO_PROCESSING_RENDER_QUEUE_H_
@@ -0,0 +1,92 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/audio_processing/render_queue.h"
+
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/base/scoped_ptr.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
+
+namespace webrtc {
+namespace {
+
+const int kNumBlocks = 10000;
+
+struct ProducerState {
+  RenderQueue<int>* queue;
+  std::vector<int> block;
+  int next_value;
+};
+
+bool InsertBlocks(void* obj) {
+  ProducerState* state = static_cast<ProducerState*>(obj);
+  state->block.assign(1 + state->next_value % 7, state->next_value);
+  if (state->queue->Insert(&state->block))
+    ++state->next_value;
+  return state->next_value < kNumBlocks;
+}
+
+}  // namespace
+
+TEST(RenderQueueTest, InsertAndRemoveInOrder) {
+  RenderQueue<int> queue(2, 4);
+  std::vector<int> block;
+  EXPECT_FALSE(queue.Remove(&block));
+
+  block.assign(3, 1);
+  EXPECT_TRUE(queue.Insert(&block));
+  block.assign(2, 2);
+  EXPECT_TRUE(queue.Insert(&block));
+  block.assign(1, 3);
+  EXPECT_FALSE(queue.Insert(&block));
+  EXPECT_EQ(std::vector<int>(1, 3), block);
+
+  EXPECT_TRUE(queue.Remove(&block));
+  EXPECT_EQ(std::vector<int>(3, 1), block);
+  EXPECT_TRUE(queue.Remove(&block));
+  EXPECT_EQ(std::vector<int>(2, 2), block);
+  EXPECT_FALSE(queue.Remove(&block));
+}
+
+TEST(RenderQueueTest, ClearDiscardsBlocks) {
+  RenderQueue<int> queue(2, 4);
+  std::vector<int> block(1, 1);
+  EXPECT_TRUE(queue.Insert(&block));
+  EXPECT_TRUE(queue.Insert(&block));
+  queue.Clear();
+  EXPECT_FALSE(queue.Remove(&block));
+  EXPECT_TRUE(queue.Insert(&block));
+  EXPECT_TRUE(queue.Remove(&block));
+}
+
+TEST(RenderQueueTest, PassesBlocksBetweenThreads) {
+  RenderQueue<int> queue(16, 8);
+  ProducerState producer = {&queue, std::vector<int>(), 0};
+  rtc::scoped_ptr<ThreadWrapper> thread =
+      ThreadWrapper::CreateThread(InsertBlocks, &producer, "producer");
+  ASSERT_TRUE(thread->Start());
+
+  std::vector<int> block;
+  int expected_value = 0;
+  while (expected_value < kNumBlocks) {
+    if (!queue.Remove(&block))
+      continue;
+    ASSERT_EQ(static_cast<size_t>(1 + expected_value % 7), block.size());
+    for (size_t i = 0; i < block.size(); ++i)
+      ASSERT_EQ(expected_value, block[i]);
+    ++expected_value;
+  }
+  thread->Stop();
+  EXPECT_FALSE(queue.Remove(&block));
+}
+
+}  // namespace webrtc
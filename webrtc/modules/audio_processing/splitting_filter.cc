@@ -14,11 +14,13 @@
 #include "webrtc/common_audio/include/audio_util.h"
 #include "webrtc/common_audio/signal_processing/include/signal_processing_library.h"
 #include "webrtc/common_audio/channel_buffer.h"
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
 
 namespace webrtc {
 
 SplittingFilter::SplittingFilter(int channels)
     : channels_(channels),
+      use_sse2_(false),
       two_bands_states_(new TwoBandsStates[channels]),
       band1_states_(new TwoBandsStates[channels]),
       band2_states_(new TwoBandsStates[channels]) {
@@ -28,137 +30,266 @@ SplittingFilter::SplittingFilter(int channels)
     synthesis_resamplers_.push_back(new PushSincResampler(
         kSamplesPer64kHzChannel, kSamplesPer48kHzChannel));
   }
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  use_sse2_ = WebRtc_GetCPUInfo(kSSE2) != 0;
+#endif
 }
 
 void SplittingFilter::Analysis(const IFChannelBuffer* data,
                                IFChannelBuffer* bands) {
-  DCHECK(bands->num_bands() == 2 || bands->num_bands() == 3);
-  DCHECK_EQ(channels_, data->num_channels());
-  DCHECK_EQ(channels_, bands->num_channels());
-  DCHECK_EQ(data->num_frames(),
-            bands->num_frames_per_band() * bands->num_bands());
-  if (bands->num_bands() == 2) {
-    TwoBandsAnalysis(data, bands);
-  } else if (bands->num_bands() == 3) {
-    ThreeBandsAnalysis(data, bands);
-  }
+  SplittingFilter* filter = this;
+  AnalysisBatch(&filter, &data, &bands, 1);
 }
 
 void SplittingFilter::Synthesis(const IFChannelBuffer* bands,
                                 IFChannelBuffer* data) {
-  DCHECK(bands->num_bands() == 2 || bands->num_bands() == 3);
-  DCHECK_EQ(channels_, data->num_channels());
-  DCHECK_EQ(channels_, bands->num_channels());
-  DCHECK_EQ(data->num_frames(),
-            bands->num_frames_per_band() * bands->num_bands());
-  if (bands->num_bands() == 2) {
-    TwoBandsSynthesis(bands, data);
-  } else if (bands->num_bands() == 3) {
-    ThreeBandsSynthesis(bands, data);
+  SplittingFilter* filter = this;
+  SynthesisBatch(&filter, &bands, &data, 1);
+}
+
+void SplittingFilter::AnalysisBatch(SplittingFilter* const* filters,
+                                    const IFChannelBuffer* const* data,
+                                    IFChannelBuffer* const* bands,
+                                    int num_filters) {
+  DCHECK_GT(num_filters, 0);
+  const int num_bands = bands[0]->num_bands();
+  DCHECK(num_bands == 2 || num_bands == 3);
+  for (int i = 0; i < num_filters; ++i) {
+    DCHECK_EQ(num_bands, bands[i]->num_bands());
+    DCHECK_EQ(data[0]->num_frames(), data[i]->num_frames());
+    DCHECK_EQ(filters[i]->channels_, data[i]->num_channels());
+    DCHECK_EQ(filters[i]->channels_, bands[i]->num_channels());
+    DCHECK_EQ(data[i]->num_frames(),
+              bands[i]->num_frames_per_band() * bands[i]->num_bands());
+  }
+  if (num_bands == 2) {
+    ProcessInGroups(TwoBandsAnalysis, filters, data, bands, num_filters);
+  } else if (num_bands == 3) {
+    ProcessInGroups(ThreeBandsAnalysis, filters, data, bands, num_filters);
   }
 }
 
-void SplittingFilter::TwoBandsAnalysis(const IFChannelBuffer* data,
-                                       IFChannelBuffer* bands) {
-  for (int i = 0; i < channels_; ++i) {
-    WebRtcSpl_AnalysisQMF(data->ibuf_const()->channels()[i],
-                          data->num_frames(),
-                          bands->ibuf()->channels(0)[i],
-                          bands->ibuf()->channels(1)[i],
-                          two_bands_states_[i].analysis_state1,
-                          two_bands_states_[i].analysis_state2);
+void SplittingFilter::SynthesisBatch(SplittingFilter* const* filters,
+                                     const IFChannelBuffer* const* bands,
+                                     IFChannelBuffer* const* data,
+                                     int num_filters) {
+  DCHECK_GT(num_filters, 0);
+  const int num_bands = bands[0]->num_bands();
+  DCHECK(num_bands == 2 || num_bands == 3);
+  for (int i = 0; i < num_filters; ++i) {
+    DCHECK_EQ(num_bands, bands[i]->num_bands());
+    DCHECK_EQ(data[0]->num_frames(), data[i]->num_frames());
+    DCHECK_EQ(filters[i]->channels_, data[i]->num_channels());
+    DCHECK_EQ(filters[i]->channels_, bands[i]->num_channels());
+    DCHECK_EQ(data[i]->num_frames(),
+              bands[i]->num_frames_per_band() * bands[i]->num_bands());
+  }
+  if (num_bands == 2) {
+    ProcessInGroups(TwoBandsSynthesis, filters, bands, data, num_filters);
+  } else if (num_bands == 3) {
+    ProcessInGroups(ThreeBandsSynthesis, filters, bands, data, num_filters);
   }
 }
 
-void SplittingFilter::TwoBandsSynthesis(const IFChannelBuffer* bands,
-                                        IFChannelBuffer* data) {
-  for (int i = 0; i < channels_; ++i) {
-    WebRtcSpl_SynthesisQMF(bands->ibuf_const()->channels(0)[i],
-                           bands->ibuf_const()->channels(1)[i],
-                           bands->num_frames_per_band(),
-                           data->ibuf()->channels()[i],
-                           two_bands_states_[i].synthesis_state1,
-                           two_bands_states_[i].synthesis_state2);
+void SplittingFilter::ProcessInGroups(void (*process)(const ChannelGroup&),
+                                      SplittingFilter* const* filters,
+                                      const IFChannelBuffer* const* in,
+                                      IFChannelBuffer* const* out,
+                                      int num_filters) {
+  ChannelGroup group;
+  group.size = 0;
+  for (int i = 0; i < num_filters; ++i) {
+    for (int j = 0; j < filters[i]->channels_; ++j) {
+      group.filters[group.size] = filters[i];
+      group.channels[group.size] = j;
+      group.in[group.size] = in[i];
+      group.out[group.size] = out[i];
+      if (++group.size == kMaxGroupSize) {
+        process(group);
+        group.size = 0;
+      }
+    }
+  }
+  if (group.size > 0) {
+    process(group);
   }
 }
 
+void SplittingFilter::TwoBandsAnalysis(const ChannelGroup& group) {
+  const int16_t* in_data[kMaxGroupSize];
+  int16_t* low_band[kMaxGroupSize];
+  int16_t* high_band[kMaxGroupSize];
+  TwoBandsStates* states[kMaxGroupSize];
+  for (int i = 0; i < group.size; ++i) {
+    const int channel = group.channels[i];
+    in_data[i] = group.in[i]->ibuf_const()->channels()[channel];
+    low_band[i] = group.out[i]->ibuf()->channels(0)[channel];
+    high_band[i] = group.out[i]->ibuf()->channels(1)[channel];
+    states[i] = &group.filters[i]->two_bands_states_[channel];
+  }
+  AnalysisQmf(group, in_data, group.in[0]->num_frames(), low_band, high_band,
+              states);
+}
+
+void SplittingFilter::TwoBandsSynthesis(const ChannelGroup& group) {
+  const int16_t* low_band[kMaxGroupSize];
+  const int16_t* high_band[kMaxGroupSize];
+  int16_t* out_data[kMaxGroupSize];
+  TwoBandsStates* states[kMaxGroupSize];
+  for (int i = 0; i < group.size; ++i) {
+    const int channel = group.channels[i];
+    low_band[i] = group.in[i]->ibuf_const()->channels(0)[channel];
+    high_band[i] = group.in[i]->ibuf_const()->channels(1)[channel];
+    out_data[i] = group.out[i]->ibuf()->channels()[channel];
+    states[i] = &group.filters[i]->two_bands_states_[channel];
+  }
+  SynthesisQmf(group, low_band, high_band, group.in[0]->num_frames_per_band(),
+               out_data, states);
+}
+
 // This is a simple implementation using the existing code and will be replaced
 // by a proper 3 band filter bank.
 // It up-samples from 48kHz to 64kHz, splits twice into 2 bands and discards the
 // uppermost band, because it is empty anyway.
-void SplittingFilter::ThreeBandsAnalysis(const IFChannelBuffer* data,
-                                         IFChannelBuffer* bands) {
-  DCHECK_EQ(kSamplesPer48kHzChannel,
-            data->num_frames());
-  InitBuffers();
-  for (int i = 0; i < channels_; ++i) {
-    analysis_resamplers_[i]->Resample(data->ibuf_const()->channels()[i],
-                                      kSamplesPer48kHzChannel,
-                                      int_buffer_.get(),
-                                      kSamplesPer64kHzChannel);
-    WebRtcSpl_AnalysisQMF(int_buffer_.get(),
-                          kSamplesPer64kHzChannel,
-                          int_buffer_.get(),
-                          int_buffer_.get() + kSamplesPer32kHzChannel,
-                          two_bands_states_[i].analysis_state1,
-                          two_bands_states_[i].analysis_state2);
-    WebRtcSpl_AnalysisQMF(int_buffer_.get(),
-                          kSamplesPer32kHzChannel,
-                          bands->ibuf()->channels(0)[i],
-                          bands->ibuf()->channels(1)[i],
-                          band1_states_[i].analysis_state1,
-                          band1_states_[i].analysis_state2);
-    WebRtcSpl_AnalysisQMF(int_buffer_.get() + kSamplesPer32kHzChannel,
-                          kSamplesPer32kHzChannel,
-                          int_buffer_.get(),
-                          bands->ibuf()->channels(2)[i],
-                          band2_states_[i].analysis_state1,
-                          band2_states_[i].analysis_state2);
+void SplittingFilter::ThreeBandsAnalysis(const ChannelGroup& group) {
+  int16_t* lower_half[kMaxGroupSize];
+  int16_t* upper_half[kMaxGroupSize];
+  int16_t* bands[3][kMaxGroupSize];
+  TwoBandsStates* two_bands_states[kMaxGroupSize];
+  TwoBandsStates* band1_states[kMaxGroupSize];
+  TwoBandsStates* band2_states[kMaxGroupSize];
+  for (int i = 0; i < group.size; ++i) {
+    SplittingFilter* filter = group.filters[i];
+    const int channel = group.channels[i];
+    DCHECK_EQ(kSamplesPer48kHzChannel, group.in[i]->num_frames());
+    lower_half[i] = filter->int_buffer(channel);
+    upper_half[i] = lower_half[i] + kSamplesPer32kHzChannel;
+    filter->analysis_resamplers_[channel]->Resample(
+        group.in[i]->ibuf_const()->channels()[channel],
+        kSamplesPer48kHzChannel,
+        lower_half[i],
+        kSamplesPer64kHzChannel);
+    for (int j = 0; j < 3; ++j) {
+      bands[j][i] = group.out[i]->ibuf()->channels(j)[channel];
+    }
+    two_bands_states[i] = &filter->two_bands_states_[channel];
+    band1_states[i] = &filter->band1_states_[channel];
+    band2_states[i] = &filter->band2_states_[channel];
   }
+  AnalysisQmf(group, lower_half, kSamplesPer64kHzChannel, lower_half,
+              upper_half, two_bands_states);
+  AnalysisQmf(group, lower_half, kSamplesPer32kHzChannel, bands[0], bands[1],
+              band1_states);
+  AnalysisQmf(group, upper_half, kSamplesPer32kHzChannel, lower_half,
+              bands[2], band2_states);
 }
 
 // This is a simple implementation using the existing code and will be replaced
 // by a proper 3 band filter bank.
 // Using an empty uppermost band, it merges the 4 bands in 2 steps and
 // down-samples from 64kHz to 48kHz.
-void SplittingFilter::ThreeBandsSynthesis(const IFChannelBuffer* bands,
-                                          IFChannelBuffer* data) {
-  DCHECK_EQ(kSamplesPer48kHzChannel,
-            data->num_frames());
-  InitBuffers();
-  for (int i = 0; i < channels_; ++i) {
-    memset(int_buffer_.get(),
+void SplittingFilter::ThreeBandsSynthesis(const ChannelGroup& group) {
+  int16_t* lower_half[kMaxGroupSize];
+  int16_t* upper_half[kMaxGroupSize];
+  const int16_t* bands[3][kMaxGroupSize];
+  TwoBandsStates* two_bands_states[kMaxGroupSize];
+  TwoBandsStates* band1_states[kMaxGroupSize];
+  TwoBandsStates* band2_states[kMaxGroupSize];
+  for (int i = 0; i < group.size; ++i) {
+    SplittingFilter* filter = group.filters[i];
+    const int channel = group.channels[i];
+    DCHECK_EQ(kSamplesPer48kHzChannel, group.out[i]->num_frames());
+    lower_half[i] = filter->int_buffer(channel);
+    upper_half[i] = lower_half[i] + kSamplesPer32kHzChannel;
+    memset(lower_half[i],
            0,
-           kSamplesPer64kHzChannel * sizeof(int_buffer_[0]));
-    WebRtcSpl_SynthesisQMF(bands->ibuf_const()->channels(0)[i],
-                           bands->ibuf_const()->channels(1)[i],
-                           kSamplesPer16kHzChannel,
-                           int_buffer_.get(),
-                           band1_states_[i].synthesis_state1,
-                           band1_states_[i].synthesis_state2);
-    WebRtcSpl_SynthesisQMF(int_buffer_.get() + kSamplesPer32kHzChannel,
-                           bands->ibuf_const()->channels(2)[i],
-                           kSamplesPer16kHzChannel,
-                           int_buffer_.get() + kSamplesPer32kHzChannel,
-                           band2_states_[i].synthesis_state1,
-                           band2_states_[i].synthesis_state2);
-    WebRtcSpl_SynthesisQMF(int_buffer_.get(),
-                           int_buffer_.get() + kSamplesPer32kHzChannel,
-                           kSamplesPer32kHzChannel,
-                           int_buffer_.get(),
-                           two_bands_states_[i].synthesis_state1,
-                           two_bands_states_[i].synthesis_state2);
-    synthesis_resamplers_[i]->Resample(int_buffer_.get(),
-                                       kSamplesPer64kHzChannel,
-                                       data->ibuf()->channels()[i],
-                                       kSamplesPer48kHzChannel);
+           kSamplesPer64kHzChannel * sizeof(lower_half[i][0]));
+    for (int j = 0; j < 3; ++j) {
+      bands[j][i] = group.in[i]->ibuf_const()->channels(j)[channel];
+    }
+    two_bands_states[i] = &filter->two_bands_states_[channel];
+    band1_states[i] = &filter->band1_states_[channel];
+    band2_states[i] = &filter->band2_states_[channel];
+  }
+  SynthesisQmf(group, bands[0], bands[1], kSamplesPer16kHzChannel, lower_half,
+               band1_states);
+  SynthesisQmf(group, upper_half, bands[2], kSamplesPer16kHzChannel,
+               upper_half, band2_states);
+  SynthesisQmf(group, lower_half, upper_half, kSamplesPer32kHzChannel,
+               lower_half, two_bands_states);
+  for (int i = 0; i < group.size; ++i) {
+    const int channel = group.channels[i];
+    group.filters[i]->synthesis_resamplers_[channel]->Resample(
+        lower_half[i],
+        kSamplesPer64kHzChannel,
+        group.out[i]->ibuf()->channels()[channel],
+        kSamplesPer48kHzChannel);
+  }
+}
+
+void SplittingFilter::AnalysisQmf(const ChannelGroup& group,
+                                  const int16_t* const* in_data,
+                                  int in_data_length,
+                                  int16_t* const* low_band,
+                                  int16_t* const* high_band,
+                                  TwoBandsStates* const* states) {
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (group.size == kMaxGroupSize && group.filters[0]->use_sse2_) {
+    int32_t* filter_state1[kMaxGroupSize];
+    int32_t* filter_state2[kMaxGroupSize];
+    for (int i = 0; i < kMaxGroupSize; ++i) {
+      filter_state1[i] = states[i]->analysis_state1;
+      filter_state2[i] = states[i]->analysis_state2;
+    }
+    AnalysisQmf_SSE2(in_data, in_data_length, low_band, high_band,
+                     filter_state1, filter_state2);
+    return;
+  }
+#endif
+  for (int i = 0; i < group.size; ++i) {
+    WebRtcSpl_AnalysisQMF(in_data[i],
+                          in_data_length,
+                          low_band[i],
+                          high_band[i],
+                          states[i]->analysis_state1,
+                          states[i]->analysis_state2);
+  }
+}
+
+void SplittingFilter::SynthesisQmf(const ChannelGroup& group,
+                                   const int16_t* const* low_band,
+                                   const int16_t* const* high_band,
+                                   int band_length,
+                                   int16_t* const* out_data,
+                                   TwoBandsStates* const* states) {
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (group.size == kMaxGroupSize && group.filters[0]->use_sse2_) {
+    int32_t* filter_state1[kMaxGroupSize];
+    int32_t* filter_state2[kMaxGroupSize];
+    for (int i = 0; i < kMaxGroupSize; ++i) {
+      filter_state1[i] = states[i]->synthesis_state1;
+      filter_state2[i] = states[i]->synthesis_state2;
+    }
+    SynthesisQmf_SSE2(low_band, high_band, band_length, out_data,
+                      filter_state1, filter_state2);
+    return;
+  }
+#endif
+  for (int i = 0; i < group.size; ++i) {
+    WebRtcSpl_SynthesisQMF(low_band[i],
+                           high_band[i],
+                           band_length,
+                           out_data[i],
+                           states[i]->synthesis_state1,
+                           states[i]->synthesis_state2);
   }
 }
 
-void SplittingFilter::InitBuffers() {
+int16_t* SplittingFilter::int_buffer(int channel) {
   if (!int_buffer_) {
-    int_buffer_.reset(new int16_t[kSamplesPer64kHzChannel]);
+    int_buffer_.reset(new int16_t[channels_ * kSamplesPer64kHzChannel]);
   }
+  return &int_buffer_[channel * kSamplesPer64kHzChannel];
 }
 
 }  // namespace webrtc
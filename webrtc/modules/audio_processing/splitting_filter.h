@@ -59,21 +59,92 @@ class SplittingFilter {
   void Analysis(const IFChannelBuffer* data, IFChannelBuffer* bands);
   void Synthesis(const IFChannelBuffer* bands, IFChannelBuffer* data);
 
+  // Same as calling Analysis() or Synthesis() of each of |num_filters|
+  // filters on its own data, with the same results. The two-band filters are
+  // recursive, so they can't be vectorized within a channel. Instead, they are
+  // run on four channels at a time, taken across all the filters, which is
+  // where several independent streams pay off. All the filters must use the
+  // same number of bands.
+  static void AnalysisBatch(SplittingFilter* const* filters,
+                            const IFChannelBuffer* const* data,
+                            IFChannelBuffer* const* bands,
+                            int num_filters);
+  static void SynthesisBatch(SplittingFilter* const* filters,
+                             const IFChannelBuffer* const* bands,
+                             IFChannelBuffer* const* data,
+                             int num_filters);
+
  private:
+  // The number of channels run through the two-band filters together.
+  static const int kMaxGroupSize = 4;
+
+  // Up to kMaxGroupSize channels, possibly of different filters.
+  struct ChannelGroup {
+    int size;
+    SplittingFilter* filters[kMaxGroupSize];
+    int channels[kMaxGroupSize];
+    const IFChannelBuffer* in[kMaxGroupSize];
+    IFChannelBuffer* out[kMaxGroupSize];
+  };
+
+  // Calls |process| on consecutive groups of the channels of |filters|.
+  static void ProcessInGroups(void (*process)(const ChannelGroup&),
+                              SplittingFilter* const* filters,
+                              const IFChannelBuffer* const* in,
+                              IFChannelBuffer* const* out,
+                              int num_filters);
+
   // These work for 640 samples or less.
-  void TwoBandsAnalysis(const IFChannelBuffer* data, IFChannelBuffer* bands);
-  void TwoBandsSynthesis(const IFChannelBuffer* bands, IFChannelBuffer* data);
+  static void TwoBandsAnalysis(const ChannelGroup& group);
+  static void TwoBandsSynthesis(const ChannelGroup& group);
   // These only work for 480 samples at the moment.
-  void ThreeBandsAnalysis(const IFChannelBuffer* data, IFChannelBuffer* bands);
-  void ThreeBandsSynthesis(const IFChannelBuffer* bands, IFChannelBuffer* data);
-  void InitBuffers();
+  static void ThreeBandsAnalysis(const ChannelGroup& group);
+  static void ThreeBandsSynthesis(const ChannelGroup& group);
+
+  // Run the two-band analysis or synthesis filter of each channel in a group,
+  // as WebRtcSpl_AnalysisQMF() and WebRtcSpl_SynthesisQMF() do.
+  static void AnalysisQmf(const ChannelGroup& group,
+                          const int16_t* const* in_data,
+                          int in_data_length,
+                          int16_t* const* low_band,
+                          int16_t* const* high_band,
+                          TwoBandsStates* const* states);
+  static void SynthesisQmf(const ChannelGroup& group,
+                           const int16_t* const* low_band,
+                           const int16_t* const* high_band,
+                           int band_length,
+                           int16_t* const* out_data,
+                           TwoBandsStates* const* states);
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  // Four-channel versions of WebRtcSpl_AnalysisQMF() and
+  // WebRtcSpl_SynthesisQMF(), with one channel in each lane of the SSE2
+  // registers. The results are identical.
+  static void AnalysisQmf_SSE2(const int16_t* const* in_data,
+                               int in_data_length,
+                               int16_t* const* low_band,
+                               int16_t* const* high_band,
+                               int32_t* const* filter_state1,
+                               int32_t* const* filter_state2);
+  static void SynthesisQmf_SSE2(const int16_t* const* low_band,
+                                const int16_t* const* high_band,
+                                int band_length,
+                                int16_t* const* out_data,
+                                int32_t* const* filter_state1,
+                                int32_t* const* filter_state2);
+#endif
+
+  // Returns the work buffer of |channel|.
+  int16_t* int_buffer(int channel);
 
   int channels_;
+  bool use_sse2_;
   rtc::scoped_ptr<TwoBandsStates[]> two_bands_states_;
   rtc::scoped_ptr<TwoBandsStates[]> band1_states_;
   rtc::scoped_ptr<TwoBandsStates[]> band2_states_;
   ScopedVector<PushSincResampler> analysis_resamplers_;
   ScopedVector<PushSincResampler> synthesis_resamplers_;
+  // One block of kSamplesPer64kHzChannel per channel.
   rtc::scoped_ptr<int16_t[]> int_buffer_;
 };
 
@@ -0,0 +1,202 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/audio_processing/splitting_filter.h"
+
+#include <emmintrin.h>
+
+#include "webrtc/base/checks.h"
+
+namespace webrtc {
+namespace {
+
+// Maximum number of samples in a low/high-band frame.
+const int kMaxBandFrameLength = 320;  // 10 ms at 64 kHz.
+
+// QMF filter coefficients in Q16, as in common_audio/signal_processing.
+const int32_t kAllPassFilter1[3] = {6418, 36982, 57261};
+const int32_t kAllPassFilter2[3] = {21333, 49062, 63010};
+
+// WebRtcSpl_SubSatW32() of each lane.
+__m128i SubSat32(__m128i a, __m128i b) {
+  const __m128i diff = _mm_sub_epi32(a, b);
+  const __m128i overflow = _mm_srai_epi32(
+      _mm_and_si128(_mm_xor_si128(a, b), _mm_xor_si128(a, diff)), 31);
+  const __m128i saturated =
+      _mm_xor_si128(_mm_srai_epi32(a, 31), _mm_set1_epi32(0x7fffffff));
+  return _mm_xor_si128(
+      diff, _mm_and_si128(_mm_xor_si128(diff, saturated), overflow));
+}
+
+// WEBRTC_SPL_SCALEDIFF32(A, B, C) of each lane, for a Q16 coefficient in each
+// lane of |coefficient|.
+__m128i ScaleDiff32(__m128i coefficient, __m128i b, __m128i c) {
+  // (B >> 16) * A, of which only the low 32 bits are kept.
+  const __m128i b_high = _mm_srai_epi32(b, 16);
+  const __m128i even = _mm_mul_epu32(b_high, coefficient);
+  const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(b_high, 32), coefficient);
+  const __m128i product =
+      _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                         _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+  // ((B & 0xffff) * A) >> 16. The upper halves of the coefficient are zero, so
+  // the upper halves of the result are as well.
+  const __m128i low = _mm_mulhi_epu16(b, coefficient);
+  return _mm_add_epi32(c, _mm_add_epi32(product, low));
+}
+
+// WebRtcSpl_AllPassQMF() on four channels, one in each lane. Runs the three
+// cascaded sections sample by sample, which gives the same results as running
+// them one after the other.
+void AllPassQmf(const __m128i* in_data,
+                int data_length,
+                __m128i* out_data,
+                const int32_t* filter_coefficients,
+                int32_t* const* filter_state) {
+  const __m128i a1 = _mm_set1_epi32(filter_coefficients[0]);
+  const __m128i a2 = _mm_set1_epi32(filter_coefficients[1]);
+  const __m128i a3 = _mm_set1_epi32(filter_coefficients[2]);
+  __m128i state[TwoBandsStates::kStateSize];
+  for (int i = 0; i < TwoBandsStates::kStateSize; ++i) {
+    state[i] = _mm_set_epi32(filter_state[3][i], filter_state[2][i],
+                             filter_state[1][i], filter_state[0][i]);
+  }
+
+  for (int k = 0; k < data_length; ++k) {
+    const __m128i x = in_data[k];
+    // y_1[n] = x[n-1] + a_1 * (x[n] - y_1[n-1])
+    const __m128i y1 = ScaleDiff32(a1, SubSat32(x, state[1]), state[0]);
+    // y_2[n] = y_1[n-1] + a_2 * (y_1[n] - y_2[n-1])
+    const __m128i y2 = ScaleDiff32(a2, SubSat32(y1, state[3]), state[2]);
+    // y[n] = y_2[n-1] + a_3 * (y_2[n] - y[n-1])
+    const __m128i y = ScaleDiff32(a3, SubSat32(y2, state[5]), state[4]);
+    state[0] = x;
+    state[1] = y1;
+    state[2] = y1;
+    state[3] = y2;
+    state[4] = y2;
+    state[5] = y;
+    out_data[k] = y;
+  }
+
+  for (int i = 0; i < TwoBandsStates::kStateSize; ++i) {
+    int32_t lanes[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), state[i]);
+    for (int j = 0; j < 4; ++j)
+      filter_state[j][i] = lanes[j];
+  }
+}
+
+// Saturates the 32-bit lanes of |a| and |b| to 16 bits and stores lane |j| of
+// each at |a_out[j]| and |b_out[j]|.
+void StoreSaturated(__m128i a,
+                    __m128i b,
+                    int16_t* const* a_out,
+                    int16_t* const* b_out,
+                    int index) {
+  int16_t lanes[8];
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), _mm_packs_epi32(a, b));
+  for (int j = 0; j < 4; ++j) {
+    a_out[j][index] = lanes[j];
+    b_out[j][index] = lanes[j + 4];
+  }
+}
+
+}  // namespace
+
+void SplittingFilter::AnalysisQmf_SSE2(const int16_t* const* in_data,
+                                       int in_data_length,
+                                       int16_t* const* low_band,
+                                       int16_t* const* high_band,
+                                       int32_t* const* filter_state1,
+                                       int32_t* const* filter_state2) {
+  __m128i half_in1[kMaxBandFrameLength];
+  __m128i half_in2[kMaxBandFrameLength];
+  __m128i filter1[kMaxBandFrameLength];
+  __m128i filter2[kMaxBandFrameLength];
+  const int band_length = in_data_length / 2;
+  DCHECK_EQ(0, in_data_length % 2);
+  DCHECK_LE(band_length, kMaxBandFrameLength);
+
+  // Split even and odd samples. Also shift them to Q10. All the input is read
+  // before any output is written, since the bands may overlap it.
+  for (int i = 0, k = 0; i < band_length; ++i, k += 2) {
+    half_in2[i] = _mm_slli_epi32(
+        _mm_set_epi32(in_data[3][k], in_data[2][k], in_data[1][k],
+                      in_data[0][k]),
+        10);
+    half_in1[i] = _mm_slli_epi32(
+        _mm_set_epi32(in_data[3][k + 1], in_data[2][k + 1], in_data[1][k + 1],
+                      in_data[0][k + 1]),
+        10);
+  }
+
+  // All pass filter even and odd samples, independently.
+  AllPassQmf(half_in1, band_length, filter1, kAllPassFilter1, filter_state1);
+  AllPassQmf(half_in2, band_length, filter2, kAllPassFilter2, filter_state2);
+
+  // Take the sum and difference of filtered version of odd and even
+  // branches to get upper & lower band.
+  const __m128i kRounding = _mm_set1_epi32(1024);
+  for (int i = 0; i < band_length; ++i) {
+    const __m128i low = _mm_srai_epi32(
+        _mm_add_epi32(_mm_add_epi32(filter1[i], filter2[i]), kRounding), 11);
+    const __m128i high = _mm_srai_epi32(
+        _mm_add_epi32(_mm_sub_epi32(filter1[i], filter2[i]), kRounding), 11);
+    StoreSaturated(low, high, low_band, high_band, i);
+  }
+}
+
+void SplittingFilter::SynthesisQmf_SSE2(const int16_t* const* low_band,
+                                        const int16_t* const* high_band,
+                                        int band_length,
+                                        int16_t* const* out_data,
+                                        int32_t* const* filter_state1,
+                                        int32_t* const* filter_state2) {
+  __m128i half_in1[kMaxBandFrameLength];
+  __m128i half_in2[kMaxBandFrameLength];
+  __m128i filter1[kMaxBandFrameLength];
+  __m128i filter2[kMaxBandFrameLength];
+  DCHECK_LE(band_length, kMaxBandFrameLength);
+
+  // Obtain the sum and difference channels out of upper and lower-band
+  // channels. Also shift to Q10 domain.
+  for (int i = 0; i < band_length; ++i) {
+    const __m128i low = _mm_set_epi32(low_band[3][i], low_band[2][i],
+                                      low_band[1][i], low_band[0][i]);
+    const __m128i high = _mm_set_epi32(high_band[3][i], high_band[2][i],
+                                       high_band[1][i], high_band[0][i]);
+    half_in1[i] = _mm_slli_epi32(_mm_add_epi32(low, high), 10);
+    half_in2[i] = _mm_slli_epi32(_mm_sub_epi32(low, high), 10);
+  }
+
+  // all-pass filter the sum and difference channels
+  AllPassQmf(half_in1, band_length, filter1, kAllPassFilter2, filter_state1);
+  AllPassQmf(half_in2, band_length, filter2, kAllPassFilter1, filter_state2);
+
+  // The filtered signals are even and odd samples of the output. Combine
+  // them. The signals are Q10 should shift them back to Q0 and take care of
+  // saturation.
+  const __m128i kRounding = _mm_set1_epi32(512);
+  for (int i = 0; i < band_length; ++i) {
+    const __m128i even =
+        _mm_srai_epi32(_mm_add_epi32(filter2[i], kRounding), 10);
+    const __m128i odd =
+        _mm_srai_epi32(_mm_add_epi32(filter1[i], kRounding), 10);
+    int16_t lanes[8];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes),
+                     _mm_packs_epi32(even, odd));
+    for (int j = 0; j < 4; ++j) {
+      out_data[j][2 * i] = lanes[j];
+      out_data[j][2 * i + 1] = lanes[j + 4];
+    }
+  }
+}
+
+}  // namespace webrtc
@@ -12,11 +12,14 @@
 #define _USE_MATH_DEFINES
 
 #include <math.h>
+#include <stdlib.h>
 
 #include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/base/scoped_ptr.h"
 #include "webrtc/common_audio/channel_buffer.h"
 #include "webrtc/modules/audio_processing/splitting_filter.h"
 #include "webrtc/common_audio/include/audio_util.h"
+#include "webrtc/system_wrappers/interface/scoped_vector.h"
 
 namespace webrtc {
 
@@ -95,4 +98,79 @@ TEST(SplittingFilterTest, SplitsIntoThreeBandsAndReconstructs) {
   }
 }
 
+namespace {
+
+// Runs several filters with different numbers of channels through the batch
+// functions and checks that they give exactly the same bands and
+// reconstruction as running each filter on its own.
+void RunBatchAndCompare(int num_frames, int num_bands) {
+  static const int kNumFilters = 5;
+  static const int kChannels[kNumFilters] = {1, 2, 1, 3, 2};
+  static const int kChunks = 10;
+  ScopedVector<SplittingFilter> batch_filters;
+  ScopedVector<SplittingFilter> single_filters;
+  ScopedVector<IFChannelBuffer> data;
+  ScopedVector<IFChannelBuffer> batch_bands;
+  ScopedVector<IFChannelBuffer> single_bands;
+  ScopedVector<IFChannelBuffer> batch_out;
+  ScopedVector<IFChannelBuffer> single_out;
+  for (int i = 0; i < kNumFilters; ++i) {
+    batch_filters.push_back(new SplittingFilter(kChannels[i]));
+    single_filters.push_back(new SplittingFilter(kChannels[i]));
+    data.push_back(new IFChannelBuffer(num_frames, kChannels[i]));
+    batch_bands.push_back(
+        new IFChannelBuffer(num_frames, kChannels[i], num_bands));
+    single_bands.push_back(
+        new IFChannelBuffer(num_frames, kChannels[i], num_bands));
+    batch_out.push_back(new IFChannelBuffer(num_frames, kChannels[i]));
+    single_out.push_back(new IFChannelBuffer(num_frames, kChannels[i]));
+  }
+
+  srand(42);
+  for (int chunk = 0; chunk < kChunks; ++chunk) {
+    for (int i = 0; i < kNumFilters; ++i) {
+      for (int ch = 0; ch < kChannels[i]; ++ch) {
+        for (int k = 0; k < num_frames; ++k) {
+          data[i]->ibuf()->channels()[ch][k] =
+              static_cast<int16_t>(rand() % 65536 - 32768);
+        }
+      }
+    }
+
+    SplittingFilter::AnalysisBatch(&batch_filters.get()[0],
+                                   &data.get()[0],
+                                   &batch_bands.get()[0],
+                                   kNumFilters);
+    SplittingFilter::SynthesisBatch(&batch_filters.get()[0],
+                                    &batch_bands.get()[0],
+                                    &batch_out.get()[0],
+                                    kNumFilters);
+    for (int i = 0; i < kNumFilters; ++i) {
+      single_filters[i]->Analysis(data[i], single_bands[i]);
+      single_filters[i]->Synthesis(single_bands[i], single_out[i]);
+    }
+
+    for (int i = 0; i < kNumFilters; ++i) {
+      for (int ch = 0; ch < kChannels[i]; ++ch) {
+        for (int k = 0; k < num_frames; ++k) {
+          ASSERT_EQ(single_bands[i]->ibuf_const()->channels()[ch][k],
+                    batch_bands[i]->ibuf_const()->channels()[ch][k]);
+          ASSERT_EQ(single_out[i]->ibuf_const()->channels()[ch][k],
+                    batch_out[i]->ibuf_const()->channels()[ch][k]);
+        }
+      }
+    }
+  }
+}
+
+}  // namespace
+
+TEST(SplittingFilterTest, BatchMatchesSingleFiltersForTwoBands) {
+  RunBatchAndCompare(kSamplesPer32kHzChannel, 2);
+}
+
+TEST(SplittingFilterTest, BatchMatchesSingleFiltersForThreeBands) {
+  RunBatchAndCompare(kSamplesPer48kHzChannel, 3);
+}
+
 }  // namespace webrtc
@@ -12,11 +12,99 @@
 
 #include "string.h"
 
+#include <algorithm>
+
 #include "webrtc/modules/desktop_capture/differ_block.h"
+#include "webrtc/system_wrappers/interface/cpu_info.h"
+#include "webrtc/system_wrappers/interface/event_wrapper.h"
 #include "webrtc/system_wrappers/interface/logging.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
 
 namespace webrtc {
 
+namespace {
+
+// Marks the blocks that CalcDirtyRegionWithHint() needs to compare. Each of
+// them is overwritten with the result of the comparison before merging.
+const DiffInfo kBlockInHint = 2;
+
+// Frames are only split into bands when every band gets at least this many
+// block rows, so that small frames are diffed on the calling thread alone.
+const int kMinBlockRowsPerBand = 8;
+const int kMaxBands = 8;
+
+}  // namespace
+
+// Diffs one band of block rows on its own thread whenever Start() is called.
+class Differ::BandThread {
+ public:
+  BandThread(Differ* differ, int first_row, int end_row)
+      : differ_(differ),
+        first_row_(first_row),
+        end_row_(end_row),
+        start_event_(EventWrapper::Create()),
+        done_event_(EventWrapper::Create()),
+        prev_buffer_(NULL),
+        curr_buffer_(NULL),
+        hinted_only_(false),
+        stopping_(false) {
+    thread_ = ThreadWrapper::CreateThread(&BandThread::Run, this,
+                                          "DifferBandThread");
+    thread_->Start();
+  }
+
+  ~BandThread() {
+    stopping_ = true;
+    start_event_->Set();
+    thread_->Stop();
+  }
+
+  // Starts diffing the band. Every call must be followed by Wait() before the
+  // next one.
+  void Start(const uint8_t* prev_buffer,
+             const uint8_t* curr_buffer,
+             bool hinted_only) {
+    prev_buffer_ = prev_buffer;
+    curr_buffer_ = curr_buffer;
+    hinted_only_ = hinted_only;
+    start_event_->Set();
+  }
+
+  // Blocks until the band started by Start() is diffed.
+  void Wait() { done_event_->Wait(WEBRTC_EVENT_INFINITE); }
+
+ private:
+  static bool Run(void* obj) {
+    return static_cast<BandThread*>(obj)->Process();
+  }
+
+  bool Process() {
+    if (start_event_->Wait(WEBRTC_EVENT_INFINITE) != kEventSignaled)
+      return true;
+    if (stopping_)
+      return false;
+    differ_->MarkDirtyBlockRows(prev_buffer_, curr_buffer_, first_row_,
+                                end_row_, hinted_only_);
+    done_event_->Set();
+    return true;
+  }
+
+  Differ* const differ_;
+  const int first_row_;
+  const int end_row_;
+  rtc::scoped_ptr<ThreadWrapper> thread_;
+  const rtc::scoped_ptr<EventWrapper> start_event_;
+  const rtc::scoped_ptr<EventWrapper> done_event_;
+  // Written by the owner before signaling |start_event_|, and read by the
+  // band thread after waking up on it.
+  const uint8_t* prev_buffer_;
+  const uint8_t* curr_buffer_;
+  bool hinted_only_;
+  bool stopping_;
+
+  DISALLOW_COPY_AND_ASSIGN(BandThread);
+};
+
 Differ::Differ(int width, int height, int bpp, int stride) {
   // Dimensions of screen.
   width_ = width;
@@ -30,6 +118,12 @@ Differ::Differ(int width, int height, int bpp, int stride) {
   diff_info_height_ = ((height_ + kBlockSize - 1) / kBlockSize) + 1;
   diff_info_size_ = diff_info_width_ * diff_info_height_ * sizeof(DiffInfo);
   diff_info_.reset(new DiffInfo[diff_info_size_]);
+
+  block_difference_ = GetBlockDifferenceFunction();
+
+  int num_bands = std::min(static_cast<int>(CpuInfo::DetectNumberOfCores()),
+                           (diff_info_height_ - 1) / kMinBlockRowsPerBand);
+  SetNumberOfBands(std::min(num_bands, kMaxBands));
 }
 
 Differ::~Differ() {}
@@ -44,9 +138,63 @@ void Differ::CalcDirtyRegion(const void* prev_buffer, const void* curr_buffer,
   MergeBlocks(region);
 }
 
+void Differ::CalcDirtyRegionWithHint(const void* prev_buffer,
+                                     const void* curr_buffer,
+                                     const DesktopRegion& hint,
+                                     DesktopRegion* region) {
+  memset(diff_info_.get(), 0, diff_info_size_);
+
+  // Mark the blocks covered by |hint|. The boundary blocks are never marked,
+  // since the hint is clipped to the screen first.
+  DesktopRect screen_rect = DesktopRect::MakeWH(width_, height_);
+  for (DesktopRegion::Iterator it(hint); !it.IsAtEnd(); it.Advance()) {
+    DesktopRect rect = it.rect();
+    rect.IntersectWith(screen_rect);
+    if (rect.is_empty())
+      continue;
+    int left = rect.left() / kBlockSize;
+    int right = (rect.right() - 1) / kBlockSize + 1;
+    int top = rect.top() / kBlockSize;
+    int bottom = (rect.bottom() - 1) / kBlockSize + 1;
+    for (int y = top; y < bottom; y++) {
+      memset(diff_info_.get() + y * diff_info_width_ + left, kBlockInHint,
+             (right - left) * sizeof(DiffInfo));
+    }
+  }
+
+  MarkDirtyHintedBlocks(prev_buffer, curr_buffer);
+  MergeBlocks(region);
+}
+
 void Differ::MarkDirtyBlocks(const void* prev_buffer, const void* curr_buffer) {
   memset(diff_info_.get(), 0, diff_info_size_);
+  MarkDirtyBands(prev_buffer, curr_buffer, false);
+}
+
+void Differ::MarkDirtyHintedBlocks(const void* prev_buffer,
+                                   const void* curr_buffer) {
+  MarkDirtyBands(prev_buffer, curr_buffer, true);
+}
+
+void Differ::MarkDirtyBands(const void* prev_buffer,
+                            const void* curr_buffer,
+                            bool hinted_only) {
+  const uint8_t* prev = static_cast<const uint8_t*>(prev_buffer);
+  const uint8_t* curr = static_cast<const uint8_t*>(curr_buffer);
+
+  // Each band writes to its own rows of |diff_info_| only.
+  for (size_t i = 0; i < band_threads_.size(); ++i)
+    band_threads_[i]->Start(prev, curr, hinted_only);
+  MarkDirtyBlockRows(prev, curr, 0, first_band_end_row_, hinted_only);
+  for (size_t i = 0; i < band_threads_.size(); ++i)
+    band_threads_[i]->Wait();
+}
 
+void Differ::MarkDirtyBlockRows(const uint8_t* prev_buffer,
+                                const uint8_t* curr_buffer,
+                                int first_row,
+                                int end_row,
+                                bool hinted_only) {
   // Calc number of full blocks.
   int x_full_blocks = width_ / kBlockSize;
   int y_full_blocks = height_ / kBlockSize;
@@ -58,25 +206,32 @@ void Differ::MarkDirtyBlocks(const void* prev_buffer, const void* curr_buffer) {
   // Offset from the start of one block-column to the next.
   int block_x_offset = bytes_per_pixel_ * kBlockSize;
   // Offset from the start of one block-row to the next.
-  int block_y_stride = (width_ * bytes_per_pixel_) * kBlockSize;
+  int block_y_stride = bytes_per_row_ * kBlockSize;
   // Offset from the start of one diff_info row to the next.
   int diff_info_stride = diff_info_width_ * sizeof(DiffInfo);
 
-  const uint8_t* prev_block_row_start =
-      static_cast<const uint8_t*>(prev_buffer);
-  const uint8_t* curr_block_row_start =
-      static_cast<const uint8_t*>(curr_buffer);
-  DiffInfo* diff_info_row_start = static_cast<DiffInfo*>(diff_info_.get());
+  for (int y = first_row; y < end_row; y++) {
+    const uint8_t* prev_block = prev_buffer + y * block_y_stride;
+    const uint8_t* curr_block = curr_buffer + y * block_y_stride;
+    DiffInfo* diff_info = diff_info_.get() + y * diff_info_stride;
 
-  for (int y = 0; y < y_full_blocks; y++) {
-    const uint8_t* prev_block = prev_block_row_start;
-    const uint8_t* curr_block = curr_block_row_start;
-    DiffInfo* diff_info = diff_info_row_start;
+    // If the screen height is not a multiple of the block size, then the last
+    // row is a partial one. This situation is far more common than the
+    // 'partial column' case.
+    bool partial_row = y >= y_full_blocks;
 
     for (int x = 0; x < x_full_blocks; x++) {
       // Mark this block as being modified so that it gets incorporated into
       // a dirty rect.
-      *diff_info = BlockDifference(prev_block, curr_block, bytes_per_row_);
+      if (!hinted_only || *diff_info == kBlockInHint) {
+        if (partial_row) {
+          *diff_info = DiffPartialBlock(prev_block, curr_block, bytes_per_row_,
+                                        kBlockSize, partial_row_height);
+        } else {
+          *diff_info = block_difference_(prev_block, curr_block,
+                                         bytes_per_row_);
+        }
+      }
       prev_block += block_x_offset;
       curr_block += block_x_offset;
       diff_info += sizeof(DiffInfo);
@@ -84,37 +239,30 @@ void Differ::MarkDirtyBlocks(const void* prev_buffer, const void* curr_buffer) {
 
     // If there is a partial column at the end, handle it.
     // This condition should rarely, if ever, occur.
-    if (partial_column_width != 0) {
-      *diff_info = DiffPartialBlock(prev_block, curr_block, bytes_per_row_,
-                                    partial_column_width, kBlockSize);
-      diff_info += sizeof(DiffInfo);
+    if (partial_column_width != 0 &&
+        (!hinted_only || *diff_info == kBlockInHint)) {
+      *diff_info = DiffPartialBlock(
+          prev_block, curr_block, bytes_per_row_, partial_column_width,
+          partial_row ? partial_row_height : kBlockSize);
     }
-
-    // Update pointers for next row.
-    prev_block_row_start += block_y_stride;
-    curr_block_row_start += block_y_stride;
-    diff_info_row_start += diff_info_stride;
   }
+}
 
-  // If the screen height is not a multiple of the block size, then this
-  // handles the last partial row. This situation is far more common than the
-  // 'partial column' case.
-  if (partial_row_height != 0) {
-    const uint8_t* prev_block = prev_block_row_start;
-    const uint8_t* curr_block = curr_block_row_start;
-    DiffInfo* diff_info = diff_info_row_start;
-    for (int x = 0; x < x_full_blocks; x++) {
-      *diff_info = DiffPartialBlock(prev_block, curr_block,
-                                    bytes_per_row_,
-                                    kBlockSize, partial_row_height);
-      prev_block += block_x_offset;
-      curr_block += block_x_offset;
-      diff_info += sizeof(DiffInfo);
-    }
-    if (partial_column_width != 0) {
-      *diff_info = DiffPartialBlock(prev_block, curr_block, bytes_per_row_,
-                                    partial_column_width, partial_row_height);
-      diff_info += sizeof(DiffInfo);
+void Differ::SetNumberOfBands(int num_bands) {
+  band_threads_.clear();
+
+  // Spread the block rows evenly, the first bands get one more row when they
+  // don't divide.
+  int block_rows = diff_info_height_ - 1;
+  num_bands = std::max(1, std::min(num_bands, block_rows));
+  int end_row = 0;
+  for (int i = 0; i < num_bands; i++) {
+    int first_row = end_row;
+    end_row += block_rows / num_bands + (i < block_rows % num_bands ? 1 : 0);
+    if (i == 0) {
+      first_band_end_row_ = end_row;
+    } else {
+      band_threads_.push_back(new BandThread(this, first_row, end_row));
     }
   }
 }
@@ -15,6 +15,8 @@
 
 #include "webrtc/base/scoped_ptr.h"
 #include "webrtc/modules/desktop_capture/desktop_region.h"
+#include "webrtc/modules/desktop_capture/differ_block.h"
+#include "webrtc/system_wrappers/interface/scoped_vector.h"
 
 namespace webrtc {
 
@@ -26,6 +28,10 @@ typedef uint8_t DiffInfo;
 // http://crbug.com/92379
 // TODO(sergeyu): Rename this class to something more sensible, e.g.
 // ScreenCaptureFrameDifferencer.
+//
+// Large frames are split into horizontal bands of block rows that are diffed
+// in parallel, one band on the calling thread and the others on worker threads
+// owned by the differ.
 class Differ {
  public:
   // Create a differ that operates on bitmaps with the specified width, height
@@ -43,13 +49,46 @@ class Differ {
   void CalcDirtyRegion(const void* prev_buffer, const void* curr_buffer,
                        DesktopRegion* region);
 
+  // Same as above, but only compares the blocks that intersect |hint|, e.g.
+  // the damaged region reported by the window system. Pixels outside of |hint|
+  // are assumed to be unchanged. The result is a subset of |hint| expanded to
+  // block boundaries.
+  void CalcDirtyRegionWithHint(const void* prev_buffer,
+                               const void* curr_buffer,
+                               const DesktopRegion& hint,
+                               DesktopRegion* region);
+
  private:
   // Allow tests to access our private parts.
   friend class DifferTest;
 
+  class BandThread;
+
   // Identify all of the blocks that contain changed pixels.
   void MarkDirtyBlocks(const void* prev_buffer, const void* curr_buffer);
 
+  // Same as MarkDirtyBlocks(), but only diffs the blocks that are marked with
+  // kBlockInHint in |diff_info_|.
+  void MarkDirtyHintedBlocks(const void* prev_buffer, const void* curr_buffer);
+
+  // Diffs the blocks of all bands, using the worker threads if there are any.
+  void MarkDirtyBands(const void* prev_buffer,
+                      const void* curr_buffer,
+                      bool hinted_only);
+
+  // Diffs the block rows in [|first_row|, |end_row|). With |hinted_only|, only
+  // the blocks marked with kBlockInHint are compared and all others are
+  // assumed to be unchanged.
+  void MarkDirtyBlockRows(const uint8_t* prev_buffer,
+                          const uint8_t* curr_buffer,
+                          int first_row,
+                          int end_row,
+                          bool hinted_only);
+
+  // Splits the frame into |num_bands| bands of block rows and starts a worker
+  // thread for each band but the first one.
+  void SetNumberOfBands(int num_bands);
+
   // After the dirty blocks have been identified, this routine merges adjacent
   // blocks into a region.
   // The goal is to minimize the region that covers the dirty blocks.
@@ -83,6 +122,14 @@ class Differ {
   int diff_info_height_;
   int diff_info_size_;
 
+  // Block comparison function selected for this CPU.
+  BlockDifferenceFunction block_difference_;
+
+  // The calling thread diffs the block rows before |first_band_end_row_|,
+  // and each of |band_threads_| one of the following bands.
+  int first_band_end_row_;
+  ScopedVector<BandThread> band_threads_;
+
   DISALLOW_COPY_AND_ASSIGN(Differ);
 };
 
@@ -13,6 +13,7 @@
 #include <string.h>
 
 #include "build/build_config.h"
+#include "webrtc/modules/desktop_capture/differ_block_avx2.h"
 #include "webrtc/modules/desktop_capture/differ_block_sse2.h"
 #include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
 
@@ -32,8 +33,8 @@ int BlockDifference_C(const uint8_t* image1,
   return 0;
 }
 
-int BlockDifference(const uint8_t* image1, const uint8_t* image2, int stride) {
-  static int (*diff_proc)(const uint8_t*, const uint8_t*, int) = NULL;
+BlockDifferenceFunction GetBlockDifferenceFunction() {
+  static BlockDifferenceFunction diff_proc = NULL;
 
   if (!diff_proc) {
 #if defined(ARCH_CPU_ARM_FAMILY) || defined(ARCH_CPU_MIPS_FAMILY)
@@ -41,9 +42,12 @@ int BlockDifference(const uint8_t* image1, const uint8_t* image2, int stride) {
     // TODO(hclam): Implement a NEON version.
     diff_proc = &BlockDifference_C;
 #else
+    bool have_avx2 = WebRtc_GetCPUInfo(kAVX2) != 0;
     bool have_sse2 = WebRtc_GetCPUInfo(kSSE2) != 0;
-    // For x86 processors, check if SSE2 is supported.
-    if (have_sse2 && kBlockSize == 32) {
+    // For x86 processors, check if AVX2 or SSE2 is supported.
+    if (have_avx2 && kBlockSize == 32) {
+      diff_proc = &BlockDifference_AVX2_W32;
+    } else if (have_sse2 && kBlockSize == 32) {
       diff_proc = &BlockDifference_SSE2_W32;
     } else if (have_sse2 && kBlockSize == 16) {
       diff_proc = &BlockDifference_SSE2_W16;
@@ -53,7 +57,11 @@ int BlockDifference(const uint8_t* image1, const uint8_t* image2, int stride) {
 #endif
   }
 
-  return diff_proc(image1, image2, stride);
+  return diff_proc;
+}
+
+int BlockDifference(const uint8_t* image1, const uint8_t* image2, int stride) {
+  return GetBlockDifferenceFunction()(image1, image2, stride);
 }
 
 }  // namespace webrtc
@@ -26,6 +26,14 @@ const int kBytesPerPixel = 4;
 // are identical. One - the blocks are different.
 int BlockDifference(const uint8_t* image1, const uint8_t* image2, int stride);
 
+typedef int (*BlockDifferenceFunction)(const uint8_t* image1,
+                                       const uint8_t* image2,
+                                       int stride);
+
+// Returns the fastest implementation of BlockDifference() for this CPU, so
+// that callers comparing many blocks can skip the dispatch.
+BlockDifferenceFunction GetBlockDifferenceFunction();
+
 }  // namespace webrtc
 
 #endif  // WEBRTC_MODULES_DESKTOP_CAPTURE_DIFFER_BLOCK_H_
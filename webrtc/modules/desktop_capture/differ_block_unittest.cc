@@ -8,8 +8,12 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <stdio.h>
+
 #include "testing/gmock/include/gmock/gmock.h"
 #include "webrtc/modules/desktop_capture/differ_block.h"
+#include "webrtc/modules/desktop_capture/differ_block_avx2.h"
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
 #include "webrtc/system_wrappers/interface/ref_count.h"
 
 namespace webrtc {
@@ -84,4 +88,29 @@ TEST(BlockDifferenceTestFirst, BlockDifference) {
   }
 }
 
+#if defined(WEBRTC_ARCH_X86_FAMILY) && !defined(WEBRTC_IOS)
+// Changes one byte at a time, since the AVX2 version compares whole rows at
+// once.
+TEST(BlockDifferenceTestAVX2, EveryByte) {
+  if (!WebRtc_GetCPUInfo(kAVX2)) {
+    printf("Skipping test, AVX2 is not supported.\n");
+    return;
+  }
+
+  uint8_t* block1;
+  uint8_t* block2;
+  PrepareBuffers(block1, block2);
+  EXPECT_EQ(0, BlockDifference_AVX2_W32(block1, block2,
+                                        kBlockSize * kBytesPerPixel));
+
+  for (int i = 0; i < kSizeOfBlock; ++i) {
+    block2[i] += 1;
+    EXPECT_EQ(1, BlockDifference_AVX2_W32(block1, block2,
+                                          kBlockSize * kBytesPerPixel))
+        << "when i = " << i;
+    block2[i] -= 1;
+  }
+}
+#endif
+
 }  // namespace webrtc
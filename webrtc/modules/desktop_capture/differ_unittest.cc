@@ -8,10 +8,13 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <stdio.h>
+
 #include "testing/gmock/include/gmock/gmock.h"
 #include "webrtc/base/scoped_ptr.h"
 #include "webrtc/modules/desktop_capture/differ.h"
 #include "webrtc/modules/desktop_capture/differ_block.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
 
 namespace webrtc {
 
@@ -59,6 +62,14 @@ class DifferTest : public testing::Test {
     differ_->MergeBlocks(dirty);
   }
 
+  void SetNumberOfBands(int num_bands) {
+    differ_->SetNumberOfBands(num_bands);
+  }
+
+  int GetNumberOfBands() {
+    return static_cast<int>(differ_->band_threads_.size()) + 1;
+  }
+
   // Convenience method to count rectangles in a region.
   int RegionRectCount(const DesktopRegion& region) {
     int count = 0;
@@ -649,4 +660,136 @@ TEST_F(DifferTest, MergeBlocks_MultiRect) {
   ASSERT_TRUE(CheckDirtyRegionContainsRect(dirty, 1, 2, 1, 1));
 }
 
+TEST_F(DifferTest, Bands_MatchSingleBand) {
+  // 10 partial block rows and columns, so that the bands don't divide evenly.
+  InitDiffer(kBlockSize * 9 + 7, kBlockSize * 9 + 5);
+
+  // Update a pixel in a diagonal of blocks, including the partial ones.
+  for (int i = 0; i < GetDiffInfoHeight() - 1; i++)
+    WriteBlockPixel(curr_.get(), i, i, 3, 4, 0xff00ff);
+  WriteBlockPixel(curr_.get(), 2, 9, 0, 0, 0xff00ff);
+
+  SetNumberOfBands(1);
+  DesktopRegion single_band;
+  differ_->CalcDirtyRegion(prev_.get(), curr_.get(), &single_band);
+
+  for (int num_bands = 2; num_bands <= 4; num_bands++) {
+    SetNumberOfBands(num_bands);
+    EXPECT_EQ(num_bands, GetNumberOfBands());
+    DesktopRegion bands;
+    differ_->CalcDirtyRegion(prev_.get(), curr_.get(), &bands);
+    EXPECT_TRUE(single_band.Equals(bands)) << "when num_bands = " << num_bands;
+  }
+}
+
+TEST_F(DifferTest, Bands_NoMoreThanBlockRows) {
+  InitDiffer(kScreenWidth, kScreenHeight);
+  SetNumberOfBands(8);
+  EXPECT_EQ(3, GetNumberOfBands());
+}
+
+TEST_F(DifferTest, Hint_OnlyHintedBlocksAreDirty) {
+  InitDiffer(kScreenWidth, kScreenHeight);
+
+  WriteBlockPixel(curr_.get(), 0, 0, 10, 10, 0xff00ff);
+  WriteBlockPixel(curr_.get(), 2, 2, 10, 10, 0xff00ff);
+
+  // The hint covers the first changed block and an unchanged one.
+  DesktopRegion hint(DesktopRect::MakeXYWH(5, 5, kBlockSize, 10));
+  DesktopRegion dirty;
+  differ_->CalcDirtyRegionWithHint(prev_.get(), curr_.get(), hint, &dirty);
+  ASSERT_EQ(1, RegionRectCount(dirty));
+  EXPECT_TRUE(CheckDirtyRegionContainsRect(dirty, 0, 0, 1, 1));
+
+  // Unchanged blocks are not dirty even though they are hinted.
+  hint.SetRect(DesktopRect::MakeXYWH(kBlockSize, 0, kBlockSize, kBlockSize));
+  differ_->CalcDirtyRegionWithHint(prev_.get(), curr_.get(), hint, &dirty);
+  EXPECT_TRUE(dirty.is_empty());
+}
+
+TEST_F(DifferTest, Hint_MatchesFullDiff) {
+  InitDiffer(kPartialScreenWidth, kPartialScreenHeight);
+
+  WriteBlockPixel(curr_.get(), 0, 1, 10, 1, 0xff00ff);
+  WriteBlockPixel(curr_.get(), 2, 0, 1, 10, 0xff00ff);
+  WriteBlockPixel(curr_.get(), 2, 2, 0, 0, 0xff00ff);
+
+  DesktopRegion full;
+  differ_->CalcDirtyRegion(prev_.get(), curr_.get(), &full);
+
+  // A hint that extends past the screen is clipped.
+  DesktopRegion hint(DesktopRect::MakeXYWH(-10, -10, 1000, 1000));
+  DesktopRegion dirty;
+  differ_->CalcDirtyRegionWithHint(prev_.get(), curr_.get(), hint, &dirty);
+  EXPECT_TRUE(full.Equals(dirty));
+}
+
+// Measures CalcDirtyRegion() on synthetic frames of common screen sizes, where
+// the given share of the blocks has changed, on one band and on the default
+// number of bands, and CalcDirtyRegionWithHint() with the changed blocks as the
+// hint.
+TEST_F(DifferTest, DISABLED_CalcDirtyRegionPerformance) {
+  const struct {
+    const char* name;
+    int width;
+    int height;
+  } kScreens[] = {
+    {"1080p", 1920, 1080},
+    {"4K", 3840, 2160},
+    {"5K", 5120, 2880},
+  };
+  const int kChangedPercents[] = {0, 1, 10, 50, 100};
+  const int kNumRuns = 20;
+
+  for (size_t i = 0; i < sizeof(kScreens) / sizeof(kScreens[0]); i++) {
+    InitDiffer(kScreens[i].width, kScreens[i].height);
+    for (int n = 0; n < buffer_size_; n++)
+      prev_[n] = static_cast<uint8_t>(n * 7);
+    int default_bands = GetNumberOfBands();
+
+    for (size_t j = 0; j < sizeof(kChangedPercents) / sizeof(int); j++) {
+      // Change the last pixel of a spread out subset of blocks, so that every
+      // changed block is compared to the end.
+      memcpy(curr_.get(), prev_.get(), buffer_size_);
+      int blocks_x = width_ / kBlockSize;
+      int blocks_y = height_ / kBlockSize;
+      for (int y = 0; y < blocks_y; y++) {
+        for (int x = 0; x < blocks_x; x++) {
+          if ((y * blocks_x + x) * 37 % 100 < kChangedPercents[j]) {
+            WriteBlockPixel(curr_.get(), x, y, kBlockSize - 1, kBlockSize - 1,
+                            0xffffffff);
+          }
+        }
+      }
+
+      DesktopRegion dirty;
+      int64_t elapsed_us[3] = {0, 0, 0};
+      for (int run = 0; run < kNumRuns; run++) {
+        SetNumberOfBands(1);
+        TickTime start = TickTime::Now();
+        differ_->CalcDirtyRegion(prev_.get(), curr_.get(), &dirty);
+        elapsed_us[0] += (TickTime::Now() - start).Microseconds();
+
+        SetNumberOfBands(default_bands);
+        start = TickTime::Now();
+        differ_->CalcDirtyRegion(prev_.get(), curr_.get(), &dirty);
+        elapsed_us[1] += (TickTime::Now() - start).Microseconds();
+
+        DesktopRegion hint(dirty);
+        start = TickTime::Now();
+        differ_->CalcDirtyRegionWithHint(prev_.get(), curr_.get(), hint,
+                                         &dirty);
+        elapsed_us[2] += (TickTime::Now() - start).Microseconds();
+      }
+      printf("%s, %d%% changed: %.2f ms with 1 band, %.2f ms with %d "
+             "band(s), %.2f ms with hint\n", kScreens[i].name,
+             kChangedPercents[j],
+             static_cast<double>(elapsed_us[0]) / kNumRuns / 1000,
+             static_cast<double>(elapsed_us[1]) / kNumRuns / 1000,
+             default_bands,
+             static_cast<double>(elapsed_us[2]) / kNumRuns / 1000);
+    }
+  }
+}
+
 }  // namespace webrtc
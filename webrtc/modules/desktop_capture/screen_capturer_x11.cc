@@ -118,7 +118,8 @@ class ScreenCapturerLinux : public ScreenCapturer,
   // current with the last buffer used.
   DesktopRegion last_invalid_region_;
 
-  // |Differ| for use when polling for changes.
+  // |Differ| for use when polling for changes, and for trimming the XDamage
+  // region to the pixels that changed.
   rtc::scoped_ptr<Differ> differ_;
 
   DISALLOW_COPY_AND_ASSIGN(ScreenCapturerLinux);
@@ -267,11 +268,10 @@ void ScreenCapturerLinux::Capture(const DesktopRegion& region) {
 
   // Refresh the Differ helper used by CaptureFrame(), if needed.
   DesktopFrame* frame = queue_.current_frame();
-  if (!use_damage_ && (
-      !differ_.get() ||
+  if (!differ_.get() ||
       (differ_->width() != frame->size().width()) ||
       (differ_->height() != frame->size().height()) ||
-      (differ_->bytes_per_row() != frame->stride()))) {
+      (differ_->bytes_per_row() != frame->stride())) {
     differ_.reset(new Differ(frame->size().width(), frame->size().height(),
                              DesktopFrame::kBytesPerPixel,
                              frame->stride()));
@@ -358,6 +358,18 @@ DesktopFrame* ScreenCapturerLinux::CaptureScreen() {
          !it.IsAtEnd(); it.Advance()) {
       x_server_pixel_buffer_.CaptureRect(it.rect(), frame);
     }
+
+    // XDamage reports everything that was drawn, including redraws that did
+    // not change any pixels, so only keep the damaged blocks that really
+    // changed. The frame was synchronized with the previous one, so pixels
+    // outside of the damaged region are unchanged.
+    DCHECK(differ_.get() != NULL);
+    DesktopRegion damaged_region;
+    damaged_region.Swap(updated_region);
+    differ_->CalcDirtyRegionWithHint(queue_.previous_frame()->data(),
+                                     frame->data(), damaged_region,
+                                     updated_region);
+    updated_region->IntersectWith(damaged_region);
   } else {
     // Doing full-screen polling, or this is the first capture after a
     // screen-resolution change.  In either case, need a full-screen capture.
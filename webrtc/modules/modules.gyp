@@ -57,6 +57,7 @@
             'acm_receive_test',
             'acm_send_test',
             'audio_coding_module',
+            'audio_conference_mixer',
             'audio_device'  ,
             'audio_processing',
             'bitrate_controller',
@@ -153,7 +154,9 @@
             'audio_coding/neteq/mock/mock_packet_buffer.h',
             'audio_coding/neteq/mock/mock_payload_splitter.h',
             'audio_coding/neteq/tools/input_audio_file_unittest.cc',
+            'audio_coding/neteq/tools/neteq_simulation_unittest.cc',
             'audio_coding/neteq/tools/packet_unittest.cc',
+            'audio_conference_mixer/source/audio_mixing_unittest.cc',
             'audio_processing/aec/echo_cancellation_unittest.cc',
             'audio_processing/aec/system_delay_unittest.cc',
             # TODO(ajm): Fix to match new interface.
@@ -175,6 +178,7 @@
             'audio_processing/beamformer/pcm_utils.cc',
             'audio_processing/beamformer/pcm_utils.h',
             'audio_processing/echo_cancellation_impl_unittest.cc',
+            'audio_processing/render_queue_unittest.cc',
             'audio_processing/splitting_filter_unittest.cc',
             'audio_processing/transient/dyadic_decimator_unittest.cc',
             'audio_processing/transient/file_utils.cc',
@@ -236,6 +240,7 @@
             'rtp_rtcp/source/rtp_format_vp8_unittest.cc',
             'rtp_rtcp/source/rtp_format_vp8_test_helper.cc',
             'rtp_rtcp/source/rtp_format_vp8_test_helper.h',
+            'rtp_rtcp/source/rtp_header_parser_unittest.cc',
             'rtp_rtcp/source/rtp_packet_history_unittest.cc',
             'rtp_rtcp/source/rtp_payload_registry_unittest.cc',
             'rtp_rtcp/source/rtp_rtcp_impl_unittest.cc',
@@ -261,10 +266,12 @@
             'video_coding/codecs/vp8/simulcast_unittest.h',
             'video_coding/main/interface/mock/mock_vcm_callbacks.h',
             'video_coding/main/source/decoding_state_unittest.cc',
+            'video_coding/main/source/encoded_buffer_pool_unittest.cc',
             'video_coding/main/source/jitter_buffer_unittest.cc',
             'video_coding/main/source/jitter_estimator_tests.cc',
             'video_coding/main/source/media_optimization_unittest.cc',
             'video_coding/main/source/receiver_unittest.cc',
+            'video_coding/main/source/sequence_number_bitmap_unittest.cc',
             'video_coding/main/source/session_info_unittest.cc',
             'video_coding/main/source/timing_unittest.cc',
             'video_coding/main/source/video_coding_robustness_unittest.cc',
@@ -307,14 +314,19 @@
               'defines': [ 'WEBRTC_AUDIOPROC_FIXED_PROFILE' ],
             }, {
               'defines': [ 'WEBRTC_AUDIOPROC_FLOAT_PROFILE' ],
+              'sources': [
+                'audio_processing/ns/ns_core_unittest.cc',
+              ],
             }],
             ['enable_protobuf==1', {
               'defines': [ 'WEBRTC_AUDIOPROC_DEBUG_DUMP' ],
               'dependencies': [
+                'audioproc_debug_proto',
                 'audioproc_unittest_proto',
               ],
               'sources': [
                 'audio_processing/audio_processing_impl_unittest.cc',
+                'audio_processing/debug_dump_writer_unittest.cc',
                 'audio_processing/test/audio_processing_unittest.cc',
                 'audio_processing/test/test_utils.h',
               ],
@@ -84,7 +84,8 @@ ForwardErrorCorrection::RecoveredPacket::~RecoveredPacket() {}
 
 ForwardErrorCorrection::ForwardErrorCorrection()
     : generated_fec_packets_(kMaxMediaPackets),
-      fec_packet_received_(false) {}
+      fec_packet_received_(false),
+      xor_payloads_(internal::GetXorPayloadsFunction()) {}
 
 ForwardErrorCorrection::~ForwardErrorCorrection() {}
 
@@ -155,9 +156,9 @@ int32_t ForwardErrorCorrection::GenerateFEC(const PacketList& media_packet_list,
     return 0;
   }
 
-  // Prepare FEC packets by setting them to 0.
+  // Prepare FEC packets. Their contents are cleared in
+  // GenerateFecBitStrings(), once it is known how much of them is used.
   for (int i = 0; i < num_fec_packets; ++i) {
-    memset(generated_fec_packets_[i].data, 0, IP_PACKET_SIZE);
     generated_fec_packets_[i].length = 0;  // Use this as a marker for untouched
                                            // packets.
     fec_packet_list->push_back(&generated_fec_packets_[i]);
@@ -167,7 +168,9 @@ int32_t ForwardErrorCorrection::GenerateFEC(const PacketList& media_packet_list,
 
   // -- Generate packet masks --
   // Always allocate space for a large mask.
-  uint8_t* packet_mask = new uint8_t[num_fec_packets * kMaskSizeLBitSet];
+  assert(sizeof(packet_mask_) >=
+         static_cast<size_t>(num_fec_packets * kMaskSizeLBitSet));
+  uint8_t* packet_mask = packet_mask_;
   memset(packet_mask, 0, num_fec_packets * num_maskBytes);
   internal::GeneratePacketMasks(num_media_packets, num_fec_packets,
                                 num_important_packets, use_unequal_protection,
@@ -179,7 +182,6 @@ int32_t ForwardErrorCorrection::GenerateFEC(const PacketList& media_packet_list,
   l_bit = (num_maskBits > 8 * kMaskSizeLBitClear);
 
   if (num_maskBits < 0) {
-    delete[] packet_mask;
     return -1;
   }
   if (l_bit) {
@@ -189,7 +191,6 @@ int32_t ForwardErrorCorrection::GenerateFEC(const PacketList& media_packet_list,
   GenerateFecBitStrings(media_packet_list, packet_mask, num_fec_packets, l_bit);
   GenerateFecUlpHeaders(media_packet_list, packet_mask, l_bit, num_fec_packets);
 
-  delete[] packet_mask;
   return 0;
 }
 
@@ -211,89 +212,78 @@ void ForwardErrorCorrection::GenerateFecBitStrings(
   if (media_packet_list.empty()) {
     return;
   }
-  uint8_t media_payload_length[2];
   const int num_maskBytes = l_bit ? kMaskSizeLBitSet : kMaskSizeLBitClear;
   const uint16_t ulp_header_size =
       l_bit ? kUlpHeaderSizeLBitSet : kUlpHeaderSizeLBitClear;
   const uint16_t fec_rtp_offset =
       kFecHeaderSize + ulp_header_size - kRtpHeaderSize;
 
+  // Walk the media list once, recording each packet's column in the packet
+  // mask. Holes in the sequence have zero columns, see InsertZerosInBitMasks().
+  Packet* media_packets[kMaxMediaPackets];
+  int media_columns[kMaxMediaPackets];
+  int num_media_packets = 0;
+  const uint16_t first_seq_num =
+      ParseSequenceNumber(media_packet_list.front()->data);
+  for (PacketList::const_iterator it = media_packet_list.begin();
+       it != media_packet_list.end(); ++it) {
+    const int column =
+        static_cast<uint16_t>(ParseSequenceNumber((*it)->data) - first_seq_num);
+    if (column >= 8 * num_maskBytes)
+      break;
+    media_packets[num_media_packets] = *it;
+    media_columns[num_media_packets] = column;
+    ++num_media_packets;
+  }
+
+  const uint8_t* payloads[kMaxMediaPackets];
+  size_t payload_lengths[kMaxMediaPackets];
   for (int i = 0; i < num_fec_packets; ++i) {
-    PacketList::const_iterator media_list_it = media_packet_list.begin();
-    uint32_t pkt_mask_idx = i * num_maskBytes;
-    uint32_t media_pkt_idx = 0;
+    Packet* fec_packet = &generated_fec_packets_[i];
+    const uint8_t* row_mask = &packet_mask[i * num_maskBytes];
+    size_t num_payloads = 0;
     uint16_t fec_packet_length = 0;
-    uint16_t prev_seq_num = ParseSequenceNumber((*media_list_it)->data);
-    while (media_list_it != media_packet_list.end()) {
-      // Each FEC packet has a multiple byte mask.
-      if (packet_mask[pkt_mask_idx] & (1 << (7 - media_pkt_idx))) {
-        Packet* media_packet = *media_list_it;
-
-        // Assign network-ordered media payload length.
-        ByteWriter<uint16_t>::WriteBigEndian(
-            media_payload_length, media_packet->length - kRtpHeaderSize);
-
-        fec_packet_length = media_packet->length + fec_rtp_offset;
-        // On the first protected packet, we don't need to XOR.
-        if (generated_fec_packets_[i].length == 0) {
-          // Copy the first 2 bytes of the RTP header.
-          memcpy(generated_fec_packets_[i].data, media_packet->data, 2);
-          // Copy the 5th to 8th bytes of the RTP header.
-          memcpy(&generated_fec_packets_[i].data[4], &media_packet->data[4], 4);
-          // Copy network-ordered payload size.
-          memcpy(&generated_fec_packets_[i].data[8], media_payload_length, 2);
-
-          // Copy RTP payload, leaving room for the ULP header.
-          memcpy(
-              &generated_fec_packets_[i].data[kFecHeaderSize + ulp_header_size],
-              &media_packet->data[kRtpHeaderSize],
-              media_packet->length - kRtpHeaderSize);
-        } else {
-          // XOR with the first 2 bytes of the RTP header.
-          generated_fec_packets_[i].data[0] ^= media_packet->data[0];
-          generated_fec_packets_[i].data[1] ^= media_packet->data[1];
-
-          // XOR with the 5th to 8th bytes of the RTP header.
-          for (uint32_t j = 4; j < 8; ++j) {
-            generated_fec_packets_[i].data[j] ^= media_packet->data[j];
-          }
-
-          // XOR with the network-ordered payload size.
-          generated_fec_packets_[i].data[8] ^= media_payload_length[0];
-          generated_fec_packets_[i].data[9] ^= media_payload_length[1];
-
-          // XOR with RTP payload, leaving room for the ULP header.
-          for (int32_t j = kFecHeaderSize + ulp_header_size;
-               j < fec_packet_length; j++) {
-            generated_fec_packets_[i].data[j] ^=
-                media_packet->data[j - fec_rtp_offset];
-          }
-        }
-        if (fec_packet_length > generated_fec_packets_[i].length) {
-          generated_fec_packets_[i].length = fec_packet_length;
-        }
-      }
-      media_list_it++;
-      if (media_list_it != media_packet_list.end()) {
-        uint16_t seq_num = ParseSequenceNumber((*media_list_it)->data);
-        media_pkt_idx += static_cast<uint16_t>(seq_num - prev_seq_num);
-        prev_seq_num = seq_num;
-      }
-      if (media_pkt_idx == 8) {
-        // Switch to the next mask byte.
-        media_pkt_idx = 0;
-        pkt_mask_idx++;
+    for (int j = 0; j < num_media_packets; ++j) {
+      const int column = media_columns[j];
+      if (row_mask[column / 8] & (1 << (7 - column % 8))) {
+        Packet* media_packet = media_packets[j];
+        payloads[num_payloads] = &media_packet->data[kRtpHeaderSize];
+        payload_lengths[num_payloads] = media_packet->length - kRtpHeaderSize;
+        ++num_payloads;
+        fec_packet_length = std::max<uint16_t>(
+            fec_packet_length, media_packet->length + fec_rtp_offset);
       }
     }
-    assert(generated_fec_packets_[i].length);
     //Note: This shouldn't happen: means packet mask is wrong or poorly designed
+    assert(num_payloads > 0);
+
+    memset(fec_packet->data, 0, fec_packet_length);
+    for (size_t j = 0; j < num_payloads; ++j) {
+      const uint8_t* media_data = payloads[j] - kRtpHeaderSize;
+      // XOR with the first 2 bytes of the RTP header.
+      fec_packet->data[0] ^= media_data[0];
+      fec_packet->data[1] ^= media_data[1];
+      // XOR with the 5th to 8th bytes of the RTP header.
+      for (uint32_t k = 4; k < 8; ++k) {
+        fec_packet->data[k] ^= media_data[k];
+      }
+      // XOR with the network-ordered payload size.
+      uint8_t media_payload_length[2];
+      ByteWriter<uint16_t>::WriteBigEndian(media_payload_length,
+                                           payload_lengths[j]);
+      fec_packet->data[8] ^= media_payload_length[0];
+      fec_packet->data[9] ^= media_payload_length[1];
+    }
+    // XOR with the RTP payloads, leaving room for the ULP header.
+    xor_payloads_(&fec_packet->data[kFecHeaderSize + ulp_header_size],
+                  payloads, payload_lengths, num_payloads);
+    fec_packet->length = fec_packet_length;
   }
 }
 
 int ForwardErrorCorrection::InsertZerosInBitMasks(
     const PacketList& media_packets, uint8_t* packet_mask, int num_mask_bytes,
     int num_fec_packets) {
-  uint8_t* new_mask = NULL;
   if (media_packets.size() <= 1) {
     return media_packets.size();
   }
@@ -312,7 +302,7 @@ int ForwardErrorCorrection::InsertZerosInBitMasks(
   if (media_packets.size() + total_missing_seq_nums > 8 * kMaskSizeLBitClear) {
     new_mask_bytes = kMaskSizeLBitSet;
   }
-  new_mask = new uint8_t[num_fec_packets * kMaskSizeLBitSet];
+  uint8_t* new_mask = tmp_packet_mask_;
   memset(new_mask, 0, num_fec_packets * kMaskSizeLBitSet);
 
   PacketList::const_iterator it = media_packets.begin();
@@ -353,7 +343,6 @@ int ForwardErrorCorrection::InsertZerosInBitMasks(
   }
   // Replace the old mask with the new.
   memcpy(packet_mask, new_mask, kMaskSizeLBitSet * num_fec_packets);
-  delete[] new_mask;
   return new_bit_index;
 }
 
@@ -640,8 +629,8 @@ void ForwardErrorCorrection::InitRecovery(const FecPacket* fec_packet,
   const uint16_t ulp_header_size =
       fec_packet->pkt->data[0] & 0x40 ? kUlpHeaderSizeLBitSet
                                       : kUlpHeaderSizeLBitClear;  // L bit set?
+  // Packet's constructor zeroes the data.
   recovered->pkt = new Packet;
-  memset(recovered->pkt->data, 0, IP_PACKET_SIZE);
   recovered->returned = false;
   recovered->was_recovered = true;
   uint8_t protection_length[2];
@@ -676,7 +665,7 @@ void ForwardErrorCorrection::FinishRecovery(RecoveredPacket* recovered) {
       kRtpHeaderSize;
 }
 
-void ForwardErrorCorrection::XorPackets(const Packet* src_packet,
+void ForwardErrorCorrection::XorHeaders(const Packet* src_packet,
                                         RecoveredPacket* dst_packet) {
   // XOR with the first 2 bytes of the RTP header.
   for (uint32_t i = 0; i < 2; ++i) {
@@ -692,28 +681,38 @@ void ForwardErrorCorrection::XorPackets(const Packet* src_packet,
                                        src_packet->length - kRtpHeaderSize);
   dst_packet->length_recovery[0] ^= media_payload_length[0];
   dst_packet->length_recovery[1] ^= media_payload_length[1];
-
-  // XOR with RTP payload.
-  // TODO(marpan/ajm): Are we doing more XORs than required here?
-  for (size_t i = kRtpHeaderSize; i < src_packet->length; ++i) {
-    dst_packet->pkt->data[i] ^= src_packet->data[i];
-  }
 }
 
 void ForwardErrorCorrection::RecoverPacket(
     const FecPacket* fec_packet, RecoveredPacket* rec_packet_to_insert) {
   InitRecovery(fec_packet, rec_packet_to_insert);
+  // An FEC packet protects at most kMaxMediaPackets packets, one of which is
+  // the one being recovered.
+  const uint8_t* payloads[kMaxMediaPackets];
+  size_t payload_lengths[kMaxMediaPackets];
+  size_t num_payloads = 0;
   ProtectedPacketList::const_iterator protected_it =
       fec_packet->protected_pkt_list.begin();
   while (protected_it != fec_packet->protected_pkt_list.end()) {
-    if ((*protected_it)->pkt == NULL) {
+    const Packet* protected_packet = (*protected_it)->pkt;
+    if (protected_packet == NULL) {
       // This is the packet we're recovering.
       rec_packet_to_insert->seq_num = (*protected_it)->seq_num;
     } else {
-      XorPackets((*protected_it)->pkt, rec_packet_to_insert);
+      XorHeaders(protected_packet, rec_packet_to_insert);
+      if (protected_packet->length > kRtpHeaderSize) {
+        assert(num_payloads < kMaxMediaPackets);
+        payloads[num_payloads] = &protected_packet->data[kRtpHeaderSize];
+        payload_lengths[num_payloads] =
+            protected_packet->length - kRtpHeaderSize;
+        ++num_payloads;
+      }
     }
     ++protected_it;
   }
+  // TODO(marpan/ajm): Are we doing more XORs than required here?
+  xor_payloads_(&rec_packet_to_insert->pkt->data[kRtpHeaderSize], payloads,
+                payload_lengths, num_payloads);
   FinishRecovery(rec_packet_to_insert);
 }
 
@@ -282,9 +282,10 @@ class ForwardErrorCorrection {
   static void InitRecovery(const FecPacket* fec_packet,
                            RecoveredPacket* recovered);
 
-  // Performs XOR between |src_packet| and |dst_packet| and stores the result
-  // in |dst_packet|.
-  static void XorPackets(const Packet* src_packet, RecoveredPacket* dst_packet);
+  // XORs the RTP header fields covered by FEC and the payload length of
+  // |src_packet| into |dst_packet|. The payloads are combined separately, see
+  // RecoverPacket().
+  static void XorHeaders(const Packet* src_packet, RecoveredPacket* dst_packet);
 
   // Finish up the recovery of a packet.
   static void FinishRecovery(RecoveredPacket* recovered);
@@ -306,6 +307,17 @@ class ForwardErrorCorrection {
   std::vector<Packet> generated_fec_packets_;
   FecPacketList fec_packet_list_;
   bool fec_packet_received_;
+
+  // Payload XOR kernel, picked at construction based on the CPU features.
+  void (*xor_payloads_)(uint8_t* dst,
+                        const uint8_t* const* src,
+                        const size_t* src_length,
+                        size_t num_src);
+
+  // Scratch space for the packet masks built by GenerateFEC(); one row of up
+  // to kMaxMediaPackets bits per FEC packet.
+  uint8_t packet_mask_[kMaxMediaPackets * kMaxMediaPackets / 8];
+  uint8_t tmp_packet_mask_[kMaxMediaPackets * kMaxMediaPackets / 8];
 };
 }  // namespace webrtc
 #endif  // WEBRTC_MODULES_RTP_RTCP_SOURCE_FORWARD_ERROR_CORRECTION_H_
@@ -15,6 +15,7 @@
 
 #include "webrtc/modules/rtp_rtcp/source/fec_private_tables_bursty.h"
 #include "webrtc/modules/rtp_rtcp/source/fec_private_tables_random.h"
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
 
 namespace {
 
@@ -372,5 +373,26 @@ void GeneratePacketMasks(int num_media_packets, int num_fec_packets,
   }  // End of UEP modification
 }  //End of GetPacketMasks
 
+void XorPayloads_C(uint8_t* dst,
+                   const uint8_t* const* src,
+                   const size_t* src_length,
+                   size_t num_src) {
+  for (size_t k = 0; k < num_src; ++k) {
+    const uint8_t* src_k = src[k];
+    for (size_t i = 0; i < src_length[k]; ++i)
+      dst[i] ^= src_k[i];
+  }
+}
+
+XorPayloadsFunction GetXorPayloadsFunction() {
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (WebRtc_GetCPUInfo(kAVX2))
+    return &XorPayloads_AVX2;
+  if (WebRtc_GetCPUInfo(kSSE2))
+    return &XorPayloads_SSE2;
+#endif
+  return &XorPayloads_C;
+}
+
 }  // namespace internal
 }  // namespace webrtc
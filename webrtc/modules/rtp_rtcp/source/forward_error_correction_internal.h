@@ -65,6 +65,32 @@ void GeneratePacketMasks(int num_media_packets, int num_fec_packets,
                          const PacketMaskTable& mask_table,
                          uint8_t* packet_mask);
 
+// XORs each of the |num_src| buffers in |src| into |dst|: for every k,
+// dst[i] ^= src[k][i] for i < src_length[k]. All sources are combined in one
+// pass over |dst|, which must hold the longest source.
+typedef void (*XorPayloadsFunction)(uint8_t* dst,
+                                    const uint8_t* const* src,
+                                    const size_t* src_length,
+                                    size_t num_src);
+
+void XorPayloads_C(uint8_t* dst,
+                   const uint8_t* const* src,
+                   const size_t* src_length,
+                   size_t num_src);
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+void XorPayloads_SSE2(uint8_t* dst,
+                      const uint8_t* const* src,
+                      const size_t* src_length,
+                      size_t num_src);
+void XorPayloads_AVX2(uint8_t* dst,
+                      const uint8_t* const* src,
+                      const size_t* src_length,
+                      size_t num_src);
+#endif
+
+// Returns the fastest XorPayloads implementation supported by the CPU.
+XorPayloadsFunction GetXorPayloadsFunction();
+
 }  // namespace internal
 }  // namespace webrtc
 #endif  // WEBRTC_MODULES_RTP_RTCP_SOURCE_FORWARD_ERROR_CORRECTION_INTERNAL_H_
@@ -0,0 +1,51 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/rtp_rtcp/source/forward_error_correction_internal.h"
+
+#include <emmintrin.h>
+
+#include <algorithm>
+
+namespace webrtc {
+namespace internal {
+
+void XorPayloads_SSE2(uint8_t* dst,
+                      const uint8_t* const* src,
+                      const size_t* src_length,
+                      size_t num_src) {
+  size_t max_length = 0;
+  for (size_t k = 0; k < num_src; ++k)
+    max_length = std::max(max_length, src_length[k]);
+
+  // Accumulate every source that covers a full 16 byte block in a register,
+  // so that each block of |dst| is loaded and stored only once.
+  for (size_t i = 0; i + 16 <= max_length; i += 16) {
+    __m128i acc = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+    for (size_t k = 0; k < num_src; ++k) {
+      if (src_length[k] >= i + 16) {
+        acc = _mm_xor_si128(
+            acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(src[k] + i)));
+      }
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), acc);
+  }
+
+  // The trailing partial block of each source.
+  for (size_t k = 0; k < num_src; ++k) {
+    for (size_t i = src_length[k] & ~static_cast<size_t>(15);
+         i < src_length[k]; ++i) {
+      dst[i] ^= src[k][i];
+    }
+  }
+}
+
+}  // namespace internal
+}  // namespace webrtc
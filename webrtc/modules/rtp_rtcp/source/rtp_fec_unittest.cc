@@ -8,11 +8,17 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <stdio.h>
+
+#include <algorithm>
 #include <list>
 
 #include "testing/gtest/include/gtest/gtest.h"
 #include "webrtc/modules/rtp_rtcp/source/byte_io.h"
 #include "webrtc/modules/rtp_rtcp/source/forward_error_correction.h"
+#include "webrtc/modules/rtp_rtcp/source/forward_error_correction_internal.h"
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
 
 using webrtc::ForwardErrorCorrection;
 
@@ -793,6 +799,79 @@ TEST_F(RtpFecTest, FecRecoveryNonConsecutivePacketsWrap) {
   EXPECT_FALSE(IsRecoveryComplete());
 }
 
+namespace {
+void TestXorPayloads(webrtc::internal::XorPayloadsFunction xor_payloads) {
+  const size_t kNumSources = 20;
+  uint8_t sources[kNumSources][IP_PACKET_SIZE];
+  const uint8_t* source_ptrs[kNumSources];
+  size_t source_lengths[kNumSources];
+  for (size_t k = 0; k < kNumSources; ++k) {
+    for (size_t i = 0; i < IP_PACKET_SIZE; ++i)
+      sources[k][i] = static_cast<uint8_t>(rand());
+    source_ptrs[k] = sources[k];
+    // Cover empty sources and all tail sizes of the vector implementations.
+    source_lengths[k] = (k == 0) ? 0 : (rand() % IP_PACKET_SIZE);
+  }
+  source_lengths[1] = IP_PACKET_SIZE;
+
+  uint8_t expected[IP_PACKET_SIZE];
+  uint8_t actual[IP_PACKET_SIZE];
+  for (size_t i = 0; i < IP_PACKET_SIZE; ++i)
+    expected[i] = actual[i] = static_cast<uint8_t>(rand());
+
+  for (size_t num_sources = 0; num_sources <= kNumSources; ++num_sources) {
+    webrtc::internal::XorPayloads_C(expected, source_ptrs, source_lengths,
+                                    num_sources);
+    xor_payloads(actual, source_ptrs, source_lengths, num_sources);
+    ASSERT_EQ(0, memcmp(expected, actual, IP_PACKET_SIZE));
+  }
+}
+}  // namespace
+
+TEST(FecXorPayloadsTest, MatchesGenericImplementation) {
+  TestXorPayloads(webrtc::internal::GetXorPayloadsFunction());
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (WebRtc_GetCPUInfo(kSSE2))
+    TestXorPayloads(&webrtc::internal::XorPayloads_SSE2);
+#endif
+}
+
+// Encodes frames of 48 media packets of 1200 bytes into an increasing number
+// of FEC packets.
+TEST_F(RtpFecTest, DISABLED_GenerateFecPerf) {
+  const int kNumMediaPackets = kMaxNumberMediaPackets;
+  const size_t kPacketLength = 1200;
+  const int kNumIterations = 1000;
+
+  ConstructMediaPackets(kNumMediaPackets);
+  for (PacketList::iterator it = media_packet_list_.begin();
+       it != media_packet_list_.end(); ++it) {
+    for (size_t j = (*it)->length; j < kPacketLength; ++j)
+      (*it)->data[j] = static_cast<uint8_t>(rand());
+    (*it)->length = kPacketLength;
+  }
+
+  const int kNumFecPackets[] = {1, 6, 12, 24, 48};
+  for (size_t i = 0; i < sizeof(kNumFecPackets) / sizeof(kNumFecPackets[0]);
+       ++i) {
+    // Inverse of ForwardErrorCorrection::GetNumberOfFecPackets().
+    const uint8_t protection_factor = static_cast<uint8_t>(
+        std::min(255, (kNumFecPackets[i] * 256 - 128) / kNumMediaPackets + 1));
+    webrtc::TickTime start = webrtc::TickTime::Now();
+    for (int n = 0; n < kNumIterations; ++n) {
+      fec_packet_list_.clear();
+      ASSERT_EQ(0, fec_->GenerateFEC(media_packet_list_, protection_factor, 0,
+                                     false, webrtc::kFecMaskRandom,
+                                     &fec_packet_list_));
+    }
+    int64_t elapsed_us = (webrtc::TickTime::Now() - start).Microseconds();
+    ASSERT_EQ(kNumFecPackets[i], static_cast<int>(fec_packet_list_.size()));
+    printf("%d media -> %d FEC packets: %.1f us per frame\n", kNumMediaPackets,
+           kNumFecPackets[i], static_cast<double>(elapsed_us) / kNumIterations);
+  }
+  fec_packet_list_.clear();
+}
+
 void RtpFecTest::TearDown() {
   fec_->ResetState(&recovered_packet_list_);
   delete fec_;
@@ -52,17 +52,11 @@ bool RtpHeaderParserImpl::Parse(const uint8_t* packet,
   RtpUtility::RtpHeaderParser rtp_parser(packet, length);
   memset(header, 0, sizeof(*header));
 
-  RtpHeaderExtensionMap map;
-  {
-    CriticalSectionScoped cs(critical_section_.get());
-    rtp_header_extension_map_.GetCopy(&map);
-  }
-
-  const bool valid_rtpheader = rtp_parser.Parse(*header, &map);
-  if (!valid_rtpheader) {
-    return false;
-  }
-  return true;
+  // Parse against the registered extensions while holding the lock, rather
+  // than copying the map, which allocates for every extension and packet.
+  // Parsing is cheap compared to the copy, so the lock is held only briefly.
+  CriticalSectionScoped cs(critical_section_.get());
+  return rtp_parser.Parse(*header, &rtp_header_extension_map_);
 }
 
 bool RtpHeaderParserImpl::RegisterRtpHeaderExtension(RTPExtensionType type,
@@ -11,12 +11,9 @@
 #include "webrtc/modules/rtp_rtcp/source/rtp_packet_history.h"
 
 #include <assert.h>
-#include <stdlib.h>
-#include <string.h>   // memset
-#include <limits>
-#include <set>
+#include <string.h>   // memcpy
+#include <algorithm>
 
-#include "webrtc/modules/rtp_rtcp/source/rtp_utility.h"
 #include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
 #include "webrtc/system_wrappers/interface/logging.h"
 
@@ -24,12 +21,30 @@ namespace webrtc {
 
 static const int kMinPacketRequestBytes = 50;
 
+StoredRtpPacket::StoredRtpPacket(size_t capacity)
+    : data_(new uint8_t[capacity]),
+      capacity_(capacity),
+      length_(0) {
+}
+
+StoredRtpPacket::~StoredRtpPacket() {
+}
+
+RTPPacketHistory::StoredPacketInfo::StoredPacketInfo()
+    : sequence_number(-1),
+      capture_time_ms(0),
+      send_time_ms(0),
+      storage_type(kDontStore),
+      prev_same_length(-1),
+      next_same_length(-1) {
+}
+
 RTPPacketHistory::RTPPacketHistory(Clock* clock)
   : clock_(clock),
     critsect_(CriticalSectionWrapper::CreateCriticalSection()),
     store_(false),
-    prev_index_(0),
-    max_packet_length_(0) {
+    max_packet_length_(0),
+    last_sequence_number_(-1) {
 }
 
 RTPPacketHistory::~RTPPacketHistory() {
@@ -55,11 +70,6 @@ void RTPPacketHistory::Allocate(size_t number_to_store) {
   assert(number_to_store <= kMaxHistoryCapacity);
   store_ = true;
   stored_packets_.resize(number_to_store);
-  stored_seq_nums_.resize(number_to_store);
-  stored_lengths_.resize(number_to_store);
-  stored_times_.resize(number_to_store);
-  stored_send_times_.resize(number_to_store);
-  stored_types_.resize(number_to_store);
 }
 
 void RTPPacketHistory::Free() {
@@ -67,21 +77,66 @@ void RTPPacketHistory::Free() {
     return;
   }
 
-  std::vector<std::vector<uint8_t> >::iterator it;
-  for (it = stored_packets_.begin(); it != stored_packets_.end(); ++it) {
-    it->clear();
-  }
-
   stored_packets_.clear();
-  stored_seq_nums_.clear();
-  stored_lengths_.clear();
-  stored_times_.clear();
-  stored_send_times_.clear();
-  stored_types_.clear();
+  length_index_.clear();
 
   store_ = false;
-  prev_index_ = 0;
   max_packet_length_ = 0;
+  last_sequence_number_ = -1;
+}
+
+void RTPPacketHistory::Expand(size_t number_to_store,
+                              int64_t sequence_number) {
+  assert(number_to_store > stored_packets_.size());
+  // Unsent packets, and the one about to be stored, must keep distinct slots.
+  // Contiguous sequence numbers always do, but gaps left by packets that
+  // weren't stored or a sequence number jump can make them collide.
+  std::vector<int64_t> unsent(1, sequence_number);
+  for (size_t i = 0; i < stored_packets_.size(); ++i) {
+    const StoredPacketInfo& info = stored_packets_[i];
+    if (info.sequence_number >= 0 && info.send_time_ms == 0 &&
+        info.sequence_number != sequence_number) {
+      unsent.push_back(info.sequence_number);
+    }
+  }
+  for (; number_to_store < kMaxHistoryCapacity; ++number_to_store) {
+    std::vector<bool> used(number_to_store, false);
+    size_t i = 0;
+    for (; i < unsent.size(); ++i) {
+      size_t index = static_cast<size_t>(unsent[i] % number_to_store);
+      if (used[index])
+        break;
+      used[index] = true;
+    }
+    if (i == unsent.size())
+      break;
+  }
+
+  std::vector<StoredPacketInfo> old_packets(number_to_store);
+  old_packets.swap(stored_packets_);
+  std::fill(length_index_.begin(), length_index_.end(), -1);
+
+  // Move the unsent packets first, so that they win any collision with a sent
+  // one. Among sent packets the newest wins.
+  for (int pass = 0; pass < 2; ++pass) {
+    const bool move_sent = pass == 1;
+    for (size_t i = 0; i < old_packets.size(); ++i) {
+      const StoredPacketInfo& info = old_packets[i];
+      if (info.sequence_number < 0 || (info.send_time_ms != 0) != move_sent)
+        continue;
+      StoredPacketInfo& slot = stored_packets_[static_cast<size_t>(
+          info.sequence_number % number_to_store)];
+      if (slot.sequence_number < 0 ||
+          (move_sent && slot.send_time_ms != 0 &&
+           slot.sequence_number < info.sequence_number)) {
+        slot = info;
+      }
+    }
+  }
+  for (size_t i = 0; i < stored_packets_.size(); ++i) {
+    if (stored_packets_[i].sequence_number >= 0)
+      AddToLengthIndex(static_cast<int>(i));
+  }
 }
 
 bool RTPPacketHistory::StorePackets() const {
@@ -89,26 +144,48 @@ bool RTPPacketHistory::StorePackets() const {
   return store_;
 }
 
-void RTPPacketHistory::VerifyAndAllocatePacketLength(size_t packet_length,
-                                                     uint32_t start_index) {
-  assert(packet_length > 0);
-  if (!store_) {
-    return;
-  }
-
-  // If start_index > 0 this is a resize and we must check any new (empty)
-  // packets created during the resize.
-  if (start_index == 0 && packet_length <= max_packet_length_) {
-    return;
+int64_t RTPPacketHistory::Unwrap(uint16_t sequence_number) const {
+  if (last_sequence_number_ < 0) {
+    // Start one wrap in, so that packets reordered around the first one still
+    // unwrap to non-negative values.
+    return (1 << 16) + sequence_number;
   }
+  int16_t delta = static_cast<int16_t>(
+      sequence_number - static_cast<uint16_t>(last_sequence_number_));
+  return last_sequence_number_ + delta;
+}
 
-  max_packet_length_ = std::max(packet_length, max_packet_length_);
+void RTPPacketHistory::AddToLengthIndex(int index) {
+  StoredPacketInfo& info = stored_packets_[index];
+  int* head = &length_index_[info.packet->length()];
+  info.prev_same_length = -1;
+  info.next_same_length = *head;
+  if (*head >= 0)
+    stored_packets_[*head].prev_same_length = index;
+  *head = index;
+}
 
-  std::vector<std::vector<uint8_t> >::iterator it;
-  for (it = stored_packets_.begin() + start_index; it != stored_packets_.end();
-       ++it) {
-    it->resize(max_packet_length_);
+void RTPPacketHistory::RemoveFromLengthIndex(int index) {
+  StoredPacketInfo& info = stored_packets_[index];
+  if (info.prev_same_length >= 0) {
+    stored_packets_[info.prev_same_length].next_same_length =
+        info.next_same_length;
+  } else {
+    length_index_[info.packet->length()] = info.next_same_length;
   }
+  if (info.next_same_length >= 0) {
+    stored_packets_[info.next_same_length].prev_same_length =
+        info.prev_same_length;
+  }
+  info.prev_same_length = -1;
+  info.next_same_length = -1;
+}
+
+void RTPPacketHistory::ClearSlot(int index) {
+  if (stored_packets_[index].sequence_number < 0)
+    return;
+  RemoveFromLengthIndex(index);
+  stored_packets_[index].sequence_number = -1;
 }
 
 int32_t RTPPacketHistory::PutRTPPacket(const uint8_t* packet,
@@ -128,7 +205,10 @@ int32_t RTPPacketHistory::PutRTPPacket(const uint8_t* packet,
   assert(packet);
   assert(packet_length > 3);
 
-  VerifyAndAllocatePacketLength(max_packet_length, 0);
+  if (max_packet_length > max_packet_length_) {
+    max_packet_length_ = max_packet_length;
+    length_index_.resize(max_packet_length_ + 1, -1);
+  }
 
   if (packet_length > max_packet_length_) {
     LOG(LS_WARNING) << "Failed to store RTP packet with length: "
@@ -137,42 +217,46 @@ int32_t RTPPacketHistory::PutRTPPacket(const uint8_t* packet,
   }
 
   const uint16_t seq_num = (packet[2] << 8) + packet[3];
+  const int64_t sequence_number = Unwrap(seq_num);
+  int index = static_cast<int>(sequence_number % stored_packets_.size());
 
   // If index we're about to overwrite contains a packet that has not
   // yet been sent (probably pending in paced sender), we need to expand
-  // the buffer.
-  if (stored_lengths_[prev_index_] > 0 &&
-      stored_send_times_[prev_index_] == 0) {
-    size_t current_size = static_cast<uint16_t>(stored_packets_.size());
+  // the buffer. Packets stay in their slots until overwritten, however far
+  // the sequence number has moved on since, so this also keeps unsent packets
+  // across gaps and jumps in the sequence numbers.
+  const StoredPacketInfo& current = stored_packets_[index];
+  if (current.sequence_number >= 0 &&
+      current.sequence_number != sequence_number &&
+      current.send_time_ms == 0) {
+    size_t current_size = stored_packets_.size();
     if (current_size < kMaxHistoryCapacity) {
       size_t expanded_size = std::max(current_size * 3 / 2, current_size + 1);
       expanded_size = std::min(expanded_size, kMaxHistoryCapacity);
-      Allocate(expanded_size);
-      VerifyAndAllocatePacketLength(max_packet_length, current_size);
-      // Causes discontinuity, but that's OK-ish. FindSeqNum() will still work,
-      // but may be slower - at least until buffer has wrapped around once.
-      prev_index_ = current_size;
+      Expand(expanded_size, sequence_number);
+      index = static_cast<int>(sequence_number % stored_packets_.size());
     }
   }
 
-  // Store packet
-  std::vector<std::vector<uint8_t> >::iterator it =
-      stored_packets_.begin() + prev_index_;
-  // TODO(sprang): Overhaul this class and get rid of this copy step.
-  //               (Finally introduce the RtpPacket class?)
-  std::copy(packet, packet + packet_length, it->begin());
+  ClearSlot(index);
+  StoredPacketInfo& info = stored_packets_[index];
+  // Reuse the slot's memory unless a reader still holds on to it.
+  if (!info.packet || !info.packet->HasOneRef() ||
+      info.packet->capacity_ < packet_length) {
+    info.packet = new rtc::RefCountedObject<StoredRtpPacket>(
+        max_packet_length_);
+  }
+  memcpy(info.packet->data_.get(), packet, packet_length);
+  info.packet->length_ = packet_length;
 
-  stored_seq_nums_[prev_index_] = seq_num;
-  stored_lengths_[prev_index_] = packet_length;
-  stored_times_[prev_index_] = (capture_time_ms > 0) ? capture_time_ms :
+  info.sequence_number = sequence_number;
+  info.capture_time_ms = (capture_time_ms > 0) ? capture_time_ms :
       clock_->TimeInMilliseconds();
-  stored_send_times_[prev_index_] = 0;  // Packet not sent.
-  stored_types_[prev_index_] = type;
+  info.send_time_ms = 0;  // Packet not sent.
+  info.storage_type = type;
+  AddToLengthIndex(index);
 
-  ++prev_index_;
-  if (prev_index_ >= stored_seq_nums_.size()) {
-    prev_index_ = 0;
-  }
+  last_sequence_number_ = std::max(last_sequence_number_, sequence_number);
   return 0;
 }
 
@@ -181,19 +265,7 @@ bool RTPPacketHistory::HasRTPPacket(uint16_t sequence_number) const {
   if (!store_) {
     return false;
   }
-
-  int32_t index = 0;
-  bool found = FindSeqNum(sequence_number, &index);
-  if (!found) {
-    return false;
-  }
-
-  size_t length = stored_lengths_.at(index);
-  if (length == 0 || length > max_packet_length_) {
-    // Invalid length.
-    return false;
-  }
-  return true;
+  return FindSeqNum(sequence_number) >= 0;
 }
 
 bool RTPPacketHistory::SetSent(uint16_t sequence_number) {
@@ -202,18 +274,17 @@ bool RTPPacketHistory::SetSent(uint16_t sequence_number) {
     return false;
   }
 
-  int32_t index = 0;
-  bool found = FindSeqNum(sequence_number, &index);
-  if (!found) {
+  int index = FindSeqNum(sequence_number);
+  if (index < 0) {
     return false;
   }
 
   // Send time already set.
-  if (stored_send_times_[index] != 0) {
+  if (stored_packets_[index].send_time_ms != 0) {
     return false;
   }
 
-  stored_send_times_[index] = clock_->TimeInMilliseconds();
+  stored_packets_[index].send_time_ms = clock_->TimeInMilliseconds();
   return true;
 }
 
@@ -223,121 +294,99 @@ bool RTPPacketHistory::GetPacketAndSetSendTime(uint16_t sequence_number,
                                                uint8_t* packet,
                                                size_t* packet_length,
                                                int64_t* stored_time_ms) {
-  CriticalSectionScoped cs(critsect_.get());
-  assert(*packet_length >= max_packet_length_);
-  if (!store_) {
+  rtc::scoped_refptr<StoredRtpPacket> stored_packet = GetPacketAndSetSendTime(
+      sequence_number, min_elapsed_time_ms, retransmit, stored_time_ms);
+  if (!stored_packet) {
     return false;
   }
+  // The packet can no longer change, so copy it without holding the lock.
+  assert(*packet_length >= stored_packet->length());
+  memcpy(packet, stored_packet->data(), stored_packet->length());
+  *packet_length = stored_packet->length();
+  return true;
+}
 
-  int32_t index = 0;
-  bool found = FindSeqNum(sequence_number, &index);
-  if (!found) {
-    LOG(LS_WARNING) << "No match for getting seqNum " << sequence_number;
-    return false;
+rtc::scoped_refptr<StoredRtpPacket> RTPPacketHistory::GetPacketAndSetSendTime(
+    uint16_t sequence_number,
+    int64_t min_elapsed_time_ms,
+    bool retransmit,
+    int64_t* stored_time_ms) {
+  CriticalSectionScoped cs(critsect_.get());
+  if (!store_) {
+    return NULL;
   }
 
-  size_t length = stored_lengths_.at(index);
-  assert(length <= max_packet_length_);
-  if (length == 0) {
-    LOG(LS_WARNING) << "No match for getting seqNum " << sequence_number
-                    << ", len " << length;
-    return false;
+  int index = FindSeqNum(sequence_number);
+  if (index < 0) {
+    LOG(LS_WARNING) << "No match for getting seqNum " << sequence_number;
+    return NULL;
   }
+  StoredPacketInfo& info = stored_packets_[index];
 
   // Verify elapsed time since last retrieve.
   int64_t now = clock_->TimeInMilliseconds();
   if (min_elapsed_time_ms > 0 &&
-      ((now - stored_send_times_.at(index)) < min_elapsed_time_ms)) {
-    return false;
+      ((now - info.send_time_ms) < min_elapsed_time_ms)) {
+    return NULL;
   }
 
-  if (retransmit && stored_types_.at(index) == kDontRetransmit) {
+  if (retransmit && info.storage_type == kDontRetransmit) {
     // No bytes copied since this packet shouldn't be retransmitted or is
     // of zero size.
-    return false;
+    return NULL;
   }
-  stored_send_times_[index] = clock_->TimeInMilliseconds();
-  GetPacket(index, packet, packet_length, stored_time_ms);
-  return true;
-}
-
-void RTPPacketHistory::GetPacket(int index,
-                                 uint8_t* packet,
-                                 size_t* packet_length,
-                                 int64_t* stored_time_ms) const {
-  // Get packet.
-  size_t length = stored_lengths_.at(index);
-  std::vector<std::vector<uint8_t> >::const_iterator it_found_packet =
-      stored_packets_.begin() + index;
-  std::copy(it_found_packet->begin(), it_found_packet->begin() + length,
-            packet);
-  *packet_length = length;
-  *stored_time_ms = stored_times_.at(index);
+  info.send_time_ms = now;
+  *stored_time_ms = info.capture_time_ms;
+  return info.packet;
 }
 
 bool RTPPacketHistory::GetBestFittingPacket(uint8_t* packet,
                                             size_t* packet_length,
                                             int64_t* stored_time_ms) {
-  CriticalSectionScoped cs(critsect_.get());
-  if (!store_)
-    return false;
-  int index = FindBestFittingPacket(*packet_length);
-  if (index < 0)
-    return false;
-  GetPacket(index, packet, packet_length, stored_time_ms);
+  rtc::scoped_refptr<StoredRtpPacket> stored_packet;
+  {
+    CriticalSectionScoped cs(critsect_.get());
+    if (!store_)
+      return false;
+    int index = FindBestFittingPacket(*packet_length);
+    if (index < 0)
+      return false;
+    stored_packet = stored_packets_[index].packet;
+    *stored_time_ms = stored_packets_[index].capture_time_ms;
+  }
+  memcpy(packet, stored_packet->data(), stored_packet->length());
+  *packet_length = stored_packet->length();
   return true;
 }
 
 // private, lock should already be taken
-bool RTPPacketHistory::FindSeqNum(uint16_t sequence_number,
-                                  int32_t* index) const {
-  uint16_t temp_sequence_number = 0;
-  if (prev_index_ > 0) {
-    *index = prev_index_ - 1;
-    temp_sequence_number = stored_seq_nums_[*index];
-  } else {
-    *index = stored_seq_nums_.size() - 1;
-    temp_sequence_number = stored_seq_nums_[*index];  // wrap
-  }
-
-  int32_t idx = (prev_index_ - 1) - (temp_sequence_number - sequence_number);
-  if (idx >= 0 && idx < static_cast<int>(stored_seq_nums_.size())) {
-    *index = idx;
-    temp_sequence_number = stored_seq_nums_[*index];
-  }
-
-  if (temp_sequence_number != sequence_number) {
-    // We did not found a match, search all.
-    for (uint16_t m = 0; m < stored_seq_nums_.size(); m++) {
-      if (stored_seq_nums_[m] == sequence_number) {
-        *index = m;
-        temp_sequence_number = stored_seq_nums_[*index];
-        break;
-      }
-    }
-  }
-  if (temp_sequence_number == sequence_number) {
-    // We found a match.
-    return true;
-  }
-  return false;
+int RTPPacketHistory::FindSeqNum(uint16_t sequence_number) const {
+  if (last_sequence_number_ < 0)
+    return -1;
+  int64_t unwrapped = Unwrap(sequence_number);
+  if (unwrapped < 0)
+    return -1;
+  int index = static_cast<int>(unwrapped % stored_packets_.size());
+  if (stored_packets_[index].sequence_number != unwrapped)
+    return -1;
+  return index;
 }
 
 int RTPPacketHistory::FindBestFittingPacket(size_t size) const {
-  if (size < kMinPacketRequestBytes || stored_lengths_.empty())
+  if (size < kMinPacketRequestBytes || length_index_.empty())
     return -1;
-  size_t min_diff = std::numeric_limits<size_t>::max();
-  int best_index = -1;  // Returned unchanged if we don't find anything.
-  for (size_t i = 0; i < stored_lengths_.size(); ++i) {
-    if (stored_lengths_[i] == 0)
-      continue;
-    size_t diff = (stored_lengths_[i] > size) ?
-        (stored_lengths_[i] - size) : (size - stored_lengths_[i]);
-    if (diff < min_diff) {
-      min_diff = diff;
-      best_index = static_cast<int>(i);
+  // Search outwards from the requested size; the first packet found has the
+  // smallest size difference.
+  const size_t max_length = length_index_.size() - 1;
+  const size_t target = std::min(size, max_length);
+  for (size_t diff = 0; diff <= max_length; ++diff) {
+    if (diff <= target && length_index_[target - diff] >= 0)
+      return length_index_[target - diff];
+    if (diff > 0 && target + diff <= max_length &&
+        length_index_[target + diff] >= 0) {
+      return length_index_[target + diff];
     }
   }
-  return best_index;
+  return -1;
 }
 }  // namespace webrtc
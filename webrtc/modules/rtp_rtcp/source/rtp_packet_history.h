@@ -15,6 +15,9 @@
 
 #include <vector>
 
+#include "webrtc/base/refcount.h"
+#include "webrtc/base/scoped_ptr.h"
+#include "webrtc/base/scoped_ref_ptr.h"
 #include "webrtc/base/thread_annotations.h"
 #include "webrtc/modules/interface/module_common_types.h"
 #include "webrtc/modules/rtp_rtcp/interface/rtp_rtcp_defines.h"
@@ -27,6 +30,29 @@ class CriticalSectionWrapper;
 
 static const size_t kMaxHistoryCapacity = 9600;
 
+// A packet stored in RTPPacketHistory. Readers get a reference instead of a
+// copy; the history only reuses the memory for a new packet once it holds the
+// last reference, so the data never changes under a reader.
+class StoredRtpPacket : public rtc::RefCountInterface {
+ public:
+  const uint8_t* data() const { return data_.get(); }
+  size_t length() const { return length_; }
+
+  // Implemented by rtc::RefCountedObject.
+  virtual bool HasOneRef() const = 0;
+
+ protected:
+  explicit StoredRtpPacket(size_t capacity);
+  ~StoredRtpPacket() override;
+
+ private:
+  friend class RTPPacketHistory;
+
+  rtc::scoped_ptr<uint8_t[]> data_;
+  const size_t capacity_;
+  size_t length_;
+};
+
 class RTPPacketHistory {
  public:
   RTPPacketHistory(Clock* clock);
@@ -61,6 +87,14 @@ class RTPPacketHistory {
                                size_t* packet_length,
                                int64_t* stored_time_ms);
 
+  // Same as above, but returns a reference to the stored packet instead of
+  // copying it. Returns NULL in the cases where the above returns false.
+  rtc::scoped_refptr<StoredRtpPacket> GetPacketAndSetSendTime(
+      uint16_t sequence_number,
+      int64_t min_elapsed_time_ms,
+      bool retransmit,
+      int64_t* stored_time_ms);
+
   bool GetBestFittingPacket(uint8_t* packet, size_t* packet_length,
                             int64_t* stored_time_ms);
 
@@ -69,33 +103,53 @@ class RTPPacketHistory {
   bool SetSent(uint16_t sequence_number);
 
  private:
-  void GetPacket(int index,
-                 uint8_t* packet,
-                 size_t* packet_length,
-                 int64_t* stored_time_ms) const
-      EXCLUSIVE_LOCKS_REQUIRED(*critsect_);
+  // Bookkeeping for one slot of the ring. A packet with unwrapped sequence
+  // number N lives in slot N % capacity.
+  struct StoredPacketInfo {
+    StoredPacketInfo();
+
+    // Unwrapped sequence number, or -1 if the slot is empty.
+    int64_t sequence_number;
+    int64_t capture_time_ms;
+    int64_t send_time_ms;
+    StorageType storage_type;
+    rtc::scoped_refptr<StoredRtpPacket> packet;
+    // Neighbours in the list of slots holding packets of the same length,
+    // or -1.
+    int prev_same_length;
+    int next_same_length;
+  };
+
   void Allocate(size_t number_to_store) EXCLUSIVE_LOCKS_REQUIRED(*critsect_);
   void Free() EXCLUSIVE_LOCKS_REQUIRED(*critsect_);
-  void VerifyAndAllocatePacketLength(size_t packet_length, uint32_t start_index)
+  // Grows the ring to at least |number_to_store| slots, and further if needed
+  // to give every unsent packet and |sequence_number| a slot of its own. Moves
+  // the stored packets to their new slots, dropping sent packets that collide.
+  void Expand(size_t number_to_store, int64_t sequence_number)
       EXCLUSIVE_LOCKS_REQUIRED(*critsect_);
-  bool FindSeqNum(uint16_t sequence_number, int32_t* index) const
+  int64_t Unwrap(uint16_t sequence_number) const
+      EXCLUSIVE_LOCKS_REQUIRED(*critsect_);
+  // Returns the slot holding |sequence_number|, or -1.
+  int FindSeqNum(uint16_t sequence_number) const
       EXCLUSIVE_LOCKS_REQUIRED(*critsect_);
   int FindBestFittingPacket(size_t size) const
       EXCLUSIVE_LOCKS_REQUIRED(*critsect_);
+  void AddToLengthIndex(int index) EXCLUSIVE_LOCKS_REQUIRED(*critsect_);
+  void RemoveFromLengthIndex(int index) EXCLUSIVE_LOCKS_REQUIRED(*critsect_);
+  void ClearSlot(int index) EXCLUSIVE_LOCKS_REQUIRED(*critsect_);
 
- private:
   Clock* clock_;
   rtc::scoped_ptr<CriticalSectionWrapper> critsect_;
   bool store_ GUARDED_BY(critsect_);
-  uint32_t prev_index_ GUARDED_BY(critsect_);
   size_t max_packet_length_ GUARDED_BY(critsect_);
-
-  std::vector<std::vector<uint8_t> > stored_packets_ GUARDED_BY(critsect_);
-  std::vector<uint16_t> stored_seq_nums_ GUARDED_BY(critsect_);
-  std::vector<size_t> stored_lengths_ GUARDED_BY(critsect_);
-  std::vector<int64_t> stored_times_ GUARDED_BY(critsect_);
-  std::vector<int64_t> stored_send_times_ GUARDED_BY(critsect_);
-  std::vector<StorageType> stored_types_ GUARDED_BY(critsect_);
+  // Highest unwrapped sequence number stored so far, or -1.
+  int64_t last_sequence_number_ GUARDED_BY(critsect_);
+
+  std::vector<StoredPacketInfo> stored_packets_ GUARDED_BY(critsect_);
+  // For each packet length, the first slot holding a packet of that length,
+  // or -1. Lets GetBestFittingPacket() search outwards from the requested
+  // size instead of scanning the whole history.
+  std::vector<int> length_index_ GUARDED_BY(critsect_);
 };
 }  // namespace webrtc
 #endif  // WEBRTC_MODULES_RTP_RTCP_RTP_PACKET_HISTORY_H_
@@ -271,4 +271,178 @@ TEST_F(RtpPacketHistoryTest, FullExpansion) {
   }
 }
 
+TEST_F(RtpPacketHistoryTest, SequenceNumberWrap) {
+  hist_->SetStorePacketsStatus(true, 10);
+  size_t len;
+  int64_t capture_time_ms = fake_clock_.TimeInMilliseconds();
+  const uint16_t kStartSeqNum = 0xfffc;
+  for (uint16_t i = 0; i < 8; ++i) {
+    len = 0;
+    CreateRtpPacket(kStartSeqNum + i, kSsrc, kPayload, kTimestamp, packet_,
+                    &len);
+    EXPECT_EQ(0, hist_->PutRTPPacket(packet_, len, kMaxPacketLength,
+                                     capture_time_ms, kAllowRetransmission));
+  }
+  for (uint16_t i = 0; i < 8; ++i)
+    EXPECT_TRUE(hist_->HasRTPPacket(kStartSeqNum + i));
+  EXPECT_FALSE(hist_->HasRTPPacket(kStartSeqNum - 1));
+  EXPECT_FALSE(hist_->HasRTPPacket(kStartSeqNum + 8));
+}
+
+TEST_F(RtpPacketHistoryTest, OldPacketsDropOutOfWindow) {
+  hist_->SetStorePacketsStatus(true, 10);
+  size_t len;
+  int64_t capture_time_ms = fake_clock_.TimeInMilliseconds();
+  for (int i = 0; i < 25; ++i) {
+    len = 0;
+    CreateRtpPacket(kSeqNum + i, kSsrc, kPayload, kTimestamp, packet_, &len);
+    EXPECT_EQ(0, hist_->PutRTPPacket(packet_, len, kMaxPacketLength,
+                                     capture_time_ms, kAllowRetransmission));
+    EXPECT_TRUE(hist_->SetSent(kSeqNum + i));
+  }
+  // All packets were sent, so the history should not have expanded.
+  EXPECT_FALSE(hist_->HasRTPPacket(kSeqNum + 14));
+  for (int i = 15; i < 25; ++i)
+    EXPECT_TRUE(hist_->HasRTPPacket(kSeqNum + i));
+}
+
+TEST_F(RtpPacketHistoryTest, SequenceNumberJump) {
+  hist_->SetStorePacketsStatus(true, 10);
+  size_t len;
+  int64_t capture_time_ms = fake_clock_.TimeInMilliseconds();
+  // Jumps of more than half the sequence number space, both ways, would be
+  // read as going the other way.
+  const uint16_t kStartSeqNums[] = {kSeqNum, kSeqNum + 40000, kSeqNum};
+  for (size_t j = 0; j < sizeof(kStartSeqNums) / sizeof(kStartSeqNums[0]);
+       ++j) {
+    for (uint16_t i = 0; i < 5; ++i) {
+      len = 0;
+      CreateRtpPacket(kStartSeqNums[j] + i, kSsrc, kPayload, kTimestamp,
+                      packet_, &len);
+      EXPECT_EQ(0, hist_->PutRTPPacket(packet_, len, kMaxPacketLength,
+                                       capture_time_ms, kAllowRetransmission));
+    }
+    for (uint16_t i = 0; i < 5; ++i) {
+      len = kMaxPacketLength;
+      int64_t time;
+      EXPECT_TRUE(hist_->GetPacketAndSetSendTime(kStartSeqNums[j] + i, 0,
+                                                 true, packet_out_, &len,
+                                                 &time));
+    }
+  }
+}
+
+TEST_F(RtpPacketHistoryTest, KeepsUnsentPacketAcrossSequenceNumberGaps) {
+  hist_->SetStorePacketsStatus(true, 10);
+  size_t len = 0;
+  int64_t capture_time_ms = fake_clock_.TimeInMilliseconds();
+  // Stored for pacing, but not sent yet.
+  CreateRtpPacket(kSeqNum, kSsrc, kPayload, kTimestamp, packet_, &len);
+  EXPECT_EQ(0, hist_->PutRTPPacket(packet_, len, kMaxPacketLength,
+                                   capture_time_ms, kAllowRetransmission));
+  // Every other sequence number is used by a packet that isn't stored, e.g.
+  // padding, so these move the sequence number far past the window.
+  for (int i = 2; i < 100; i += 2) {
+    len = 0;
+    CreateRtpPacket(kSeqNum + i, kSsrc, kPayload, kTimestamp, packet_, &len);
+    EXPECT_EQ(0, hist_->PutRTPPacket(packet_, len, kMaxPacketLength,
+                                     capture_time_ms, kAllowRetransmission));
+    EXPECT_TRUE(hist_->SetSent(kSeqNum + i));
+  }
+  int64_t time;
+  len = kMaxPacketLength;
+  EXPECT_TRUE(hist_->GetPacketAndSetSendTime(kSeqNum, 0, false, packet_out_,
+                                             &len, &time));
+  EXPECT_EQ(capture_time_ms, time);
+}
+
+TEST_F(RtpPacketHistoryTest, KeepsUnsentPacketsAcrossSequenceNumberJump) {
+  hist_->SetStorePacketsStatus(true, 10);
+  size_t len;
+  int64_t capture_time_ms = fake_clock_.TimeInMilliseconds();
+  // Stored for pacing, but not sent yet.
+  for (int i = 0; i < 3; ++i) {
+    len = 0;
+    CreateRtpPacket(kSeqNum + i, kSsrc, kPayload, kTimestamp, packet_, &len);
+    EXPECT_EQ(0, hist_->PutRTPPacket(packet_, len, kMaxPacketLength,
+                                     capture_time_ms, kAllowRetransmission));
+  }
+  // The sequence number is set far ahead, as SetSequenceNumber() may do, and
+  // more packets than the window holds are sent from there.
+  const uint16_t kJumpedSeqNums[] = {kSeqNum + 1000, kSeqNum + 40000};
+  for (size_t j = 0; j < sizeof(kJumpedSeqNums) / sizeof(kJumpedSeqNums[0]);
+       ++j) {
+    for (uint16_t i = 0; i < 25; ++i) {
+      len = 0;
+      CreateRtpPacket(kJumpedSeqNums[j] + i, kSsrc, kPayload, kTimestamp,
+                      packet_, &len);
+      EXPECT_EQ(0, hist_->PutRTPPacket(packet_, len, kMaxPacketLength,
+                                       capture_time_ms, kAllowRetransmission));
+      EXPECT_TRUE(hist_->SetSent(kJumpedSeqNums[j] + i));
+    }
+  }
+  for (int i = 0; i < 3; ++i) {
+    int64_t time;
+    len = kMaxPacketLength;
+    EXPECT_TRUE(hist_->GetPacketAndSetSendTime(kSeqNum + i, 0, false,
+                                               packet_out_, &len, &time));
+  }
+}
+
+TEST_F(RtpPacketHistoryTest, ReferenceSurvivesSlotReuse) {
+  hist_->SetStorePacketsStatus(true, 10);
+  size_t len = 0;
+  int64_t capture_time_ms = fake_clock_.TimeInMilliseconds();
+  CreateRtpPacket(kSeqNum, kSsrc, kPayload, kTimestamp, packet_, &len);
+  EXPECT_EQ(0, hist_->PutRTPPacket(packet_, len, kMaxPacketLength,
+                                   capture_time_ms, kAllowRetransmission));
+
+  int64_t time;
+  rtc::scoped_refptr<StoredRtpPacket> stored =
+      hist_->GetPacketAndSetSendTime(kSeqNum, 0, false, &time);
+  ASSERT_TRUE(stored.get() != NULL);
+  EXPECT_EQ(len, stored->length());
+  EXPECT_EQ(capture_time_ms, time);
+
+  // Overwrite the slot holding |stored|.
+  for (int i = 1; i <= 10; ++i) {
+    size_t new_len = 0;
+    CreateRtpPacket(kSeqNum + i, kSsrc, kPayload, kTimestamp, packet_out_,
+                    &new_len);
+    EXPECT_EQ(0, hist_->PutRTPPacket(packet_out_, new_len, kMaxPacketLength,
+                                     capture_time_ms, kAllowRetransmission));
+    EXPECT_TRUE(hist_->SetSent(kSeqNum + i));
+  }
+  EXPECT_FALSE(hist_->HasRTPPacket(kSeqNum));
+  EXPECT_EQ(len, stored->length());
+  for (size_t i = 0; i < len; ++i)
+    EXPECT_EQ(packet_[i], stored->data()[i]);
+}
+
+TEST_F(RtpPacketHistoryTest, GetBestFittingPacket) {
+  hist_->SetStorePacketsStatus(true, 10);
+  const size_t kLengths[] = {200, 500, 300};
+  int64_t capture_time_ms = fake_clock_.TimeInMilliseconds();
+  for (size_t i = 0; i < sizeof(kLengths) / sizeof(kLengths[0]); ++i) {
+    size_t len = 0;
+    CreateRtpPacket(kSeqNum + i, kSsrc, kPayload, kTimestamp, packet_, &len);
+    EXPECT_EQ(0, hist_->PutRTPPacket(packet_, kLengths[i], kMaxPacketLength,
+                                     capture_time_ms, kAllowRetransmission));
+  }
+
+  int64_t time;
+  size_t len = 40;
+  // Requests below the minimum size are ignored.
+  EXPECT_FALSE(hist_->GetBestFittingPacket(packet_out_, &len, &time));
+  len = 260;
+  EXPECT_TRUE(hist_->GetBestFittingPacket(packet_out_, &len, &time));
+  EXPECT_EQ(300u, len);
+  len = 420;
+  EXPECT_TRUE(hist_->GetBestFittingPacket(packet_out_, &len, &time));
+  EXPECT_EQ(500u, len);
+  len = kMaxPacketLength * 2;
+  EXPECT_TRUE(hist_->GetBestFittingPacket(packet_out_, &len, &time));
+  EXPECT_EQ(500u, len);
+}
+
 }  // namespace webrtc
@@ -681,18 +681,18 @@ bool RTPSender::StorePackets() const {
 }
 
 int32_t RTPSender::ReSendPacket(uint16_t packet_id, int64_t min_resend_time) {
-  size_t length = IP_PACKET_SIZE;
-  uint8_t data_buffer[IP_PACKET_SIZE];
   int64_t capture_time_ms;
-  if (!packet_history_.GetPacketAndSetSendTime(packet_id, min_resend_time, true,
-                                               data_buffer, &length,
-                                               &capture_time_ms)) {
+  rtc::scoped_refptr<StoredRtpPacket> stored_packet =
+      packet_history_.GetPacketAndSetSendTime(packet_id, min_resend_time, true,
+                                              &capture_time_ms);
+  if (!stored_packet) {
     // Packet not found.
     return 0;
   }
+  size_t length = stored_packet->length();
 
   if (paced_sender_) {
-    RtpUtility::RtpHeaderParser rtp_parser(data_buffer, length);
+    RtpUtility::RtpHeaderParser rtp_parser(stored_packet->data(), length);
     RTPHeader header;
     if (!rtp_parser.Parse(header)) {
       assert(false);
@@ -714,6 +714,10 @@ int32_t RTPSender::ReSendPacket(uint16_t packet_id, int64_t min_resend_time) {
     CriticalSectionScoped lock(send_critsect_.get());
     rtx = rtx_;
   }
+  // PrepareAndSendPacket() rewrites header extensions in place, so it needs a
+  // private copy.
+  uint8_t data_buffer[IP_PACKET_SIZE];
+  memcpy(data_buffer, stored_packet->data(), length);
   return PrepareAndSendPacket(data_buffer, length, capture_time_ms,
                               (rtx & kRtxRetransmitted) > 0, true) ?
       static_cast<int32_t>(length) : -1;
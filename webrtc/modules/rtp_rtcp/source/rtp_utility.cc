@@ -247,7 +247,7 @@ bool RtpHeaderParser::ParseRtcp(RTPHeader* header) const {
 }
 
 bool RtpHeaderParser::Parse(RTPHeader& header,
-                            RtpHeaderExtensionMap* ptrExtensionMap) const {
+                            const RtpHeaderExtensionMap* ptrExtensionMap) const {
   const ptrdiff_t length = _ptrRTPDataEnd - _ptrRTPDataBegin;
   if (length < kRtpMinParseLength) {
     return false;
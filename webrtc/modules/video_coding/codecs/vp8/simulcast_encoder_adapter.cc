@@ -17,6 +17,10 @@
 
 #include "webrtc/common.h"
 #include "webrtc/modules/video_coding/codecs/vp8/screenshare_layers.h"
+#include "webrtc/modules/video_coding/codecs/vp8/vp8_factory.h"
+#include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
+#include "webrtc/system_wrappers/interface/event_wrapper.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
 
 namespace {
 
@@ -138,8 +142,79 @@ class AdapterEncodedImageCallback : public webrtc::EncodedImageCallback {
 
 namespace webrtc {
 
+// Scales and encodes one stream on its own thread. The stream's layer is
+// scaled from the next higher one, so the thread first waits for that layer
+// if another thread produces it.
+class SimulcastEncoderAdapter::StreamEncodeThread {
+ public:
+  StreamEncodeThread(SimulcastEncoderAdapter* adapter,
+                     size_t stream_idx,
+                     StreamEncodeThread* higher_stream_thread)
+      : adapter_(adapter),
+        stream_idx_(stream_idx),
+        higher_stream_thread_(higher_stream_thread),
+        start_event_(EventWrapper::Create()),
+        layer_ready_event_(EventWrapper::Create()),
+        done_event_(EventWrapper::Create()),
+        stopping_(false) {
+    thread_ = ThreadWrapper::CreateThread(&StreamEncodeThread::Run, this,
+                                          "SimulcastStreamEncoder");
+    thread_->Start();
+  }
+
+  ~StreamEncodeThread() {
+    stopping_ = true;
+    start_event_->Set();
+    thread_->Stop();
+  }
+
+  // Starts scaling and encoding the stream. Every call must be followed by
+  // WaitForEncode() before the next one.
+  void StartEncode() { start_event_->Set(); }
+
+  // Blocks until the encode started by StartEncode() is done.
+  void WaitForEncode() { done_event_->Wait(WEBRTC_EVENT_INFINITE); }
+
+ private:
+  static bool Run(void* obj) {
+    return static_cast<StreamEncodeThread*>(obj)->Process();
+  }
+
+  bool Process() {
+    if (start_event_->Wait(WEBRTC_EVENT_INFINITE) != kEventSignaled)
+      return true;
+    if (stopping_)
+      return false;
+    if (higher_stream_thread_)
+      higher_stream_thread_->layer_ready_event_->Wait(WEBRTC_EVENT_INFINITE);
+    adapter_->ScaleLayer(stream_idx_);
+    layer_ready_event_->Set();
+    adapter_->EncodeLayer(stream_idx_);
+    done_event_->Set();
+    return true;
+  }
+
+  SimulcastEncoderAdapter* const adapter_;
+  const size_t stream_idx_;
+  // NULL when the next higher stream is scaled before the threads start.
+  StreamEncodeThread* const higher_stream_thread_;
+  rtc::scoped_ptr<ThreadWrapper> thread_;
+  const rtc::scoped_ptr<EventWrapper> start_event_;
+  const rtc::scoped_ptr<EventWrapper> layer_ready_event_;
+  const rtc::scoped_ptr<EventWrapper> done_event_;
+  // Written by the owner before signaling |start_event_|, and read by the
+  // encode thread after waking up on it.
+  bool stopping_;
+
+  DISALLOW_COPY_AND_ASSIGN(StreamEncodeThread);
+};
+
 SimulcastEncoderAdapter::SimulcastEncoderAdapter(VideoEncoderFactory* factory)
-    : factory_(factory), encoded_complete_callback_(NULL) {
+    : factory_(factory),
+      encoded_complete_callback_(NULL),
+      callback_crit_(CriticalSectionWrapper::CreateCriticalSection()),
+      input_image_(NULL),
+      codec_specific_info_(NULL) {
   memset(&codec_, 0, sizeof(webrtc::VideoCodec));
 }
 
@@ -153,6 +228,12 @@ int SimulcastEncoderAdapter::Release() {
   // resolutions doesn't require reallocation of the first encoder, but only
   // reinitialization, which makes sense. Then Destroy this instance instead in
   // ~SimulcastEncoderAdapter().
+  // Stop the encode threads before destroying the encoders they use.
+  encode_threads_.clear();
+  for (int i = 0; i < kMaxSimulcastStreams; ++i)
+    buffer_pools_[i].Release();
+  layers_.clear();
+  stream_frame_types_.clear();
   while (!streaminfos_.empty()) {
     VideoEncoder* encoder = streaminfos_.back().encoder;
     EncodedImageCallback* callback = streaminfos_.back().callback;
@@ -228,6 +309,23 @@ int SimulcastEncoderAdapter::InitEncode(const VideoCodec* inst,
     streaminfos_.push_back(StreamInfo(encoder, callback, stream_codec.width,
                                       stream_codec.height, send_stream));
   }
+  layers_.resize(number_of_streams);
+  stream_frame_types_.resize(number_of_streams);
+
+  // Scale and encode the lower resolution streams on their own threads, if
+  // enabled. Threads are created from the highest stream downwards so that
+  // each one knows the thread producing the layer it scales from.
+  if (doing_simulcast &&
+      VP8EncoderFactoryConfig::use_parallel_simulcast_encode()) {
+    std::vector<StreamEncodeThread*> threads(number_of_streams - 1, NULL);
+    for (int i = number_of_streams - 2; i >= 0; --i) {
+      StreamEncodeThread* higher_stream_thread =
+          i + 1 < number_of_streams - 1 ? threads[i + 1] : NULL;
+      threads[i] = new StreamEncodeThread(this, i, higher_stream_thread);
+    }
+    for (size_t i = 0; i < threads.size(); ++i)
+      encode_threads_.push_back(threads[i]);
+  }
   return WEBRTC_VIDEO_CODEC_OK;
 }
 
@@ -261,62 +359,85 @@ int SimulcastEncoderAdapter::Encode(
     }
   }
 
-  int src_width = input_image.width();
-  int src_height = input_image.height();
   for (size_t stream_idx = 0; stream_idx < streaminfos_.size(); ++stream_idx) {
-    std::vector<VideoFrameType> stream_frame_types;
-    if (send_key_frame) {
-      stream_frame_types.push_back(kKeyFrame);
+    stream_frame_types_[stream_idx].assign(
+        1, send_key_frame ? kKeyFrame : kDeltaFrame);
+    if (send_key_frame)
       streaminfos_[stream_idx].key_frame_request = false;
-    } else {
-      stream_frame_types.push_back(kDeltaFrame);
-    }
+  }
 
-    int dst_width = streaminfos_[stream_idx].width;
-    int dst_height = streaminfos_[stream_idx].height;
-    // If scaling isn't required, because the input resolution
-    // matches the destination or the input image is empty (e.g.
-    // a keyframe request for encoders with internal camera
-    // sources), pass the image on directly. Otherwise, we'll
-    // scale it to match what the encoder expects (below).
-    if ((dst_width == src_width && dst_height == src_height) ||
-        input_image.IsZeroSize()) {
-      streaminfos_[stream_idx].encoder->Encode(input_image,
-                                               codec_specific_info,
-                                               &stream_frame_types);
-    } else {
-      I420VideoFrame dst_frame;
-      // Making sure that destination frame is of sufficient size.
-      // Aligning stride values based on width.
-      dst_frame.CreateEmptyFrame(dst_width, dst_height,
-                                 dst_width, (dst_width + 1) / 2,
-                                 (dst_width + 1) / 2);
-      libyuv::I420Scale(input_image.buffer(kYPlane),
-                        input_image.stride(kYPlane),
-                        input_image.buffer(kUPlane),
-                        input_image.stride(kUPlane),
-                        input_image.buffer(kVPlane),
-                        input_image.stride(kVPlane),
-                        src_width, src_height,
-                        dst_frame.buffer(kYPlane),
-                        dst_frame.stride(kYPlane),
-                        dst_frame.buffer(kUPlane),
-                        dst_frame.stride(kUPlane),
-                        dst_frame.buffer(kVPlane),
-                        dst_frame.stride(kVPlane),
-                        dst_width, dst_height,
-                        libyuv::kFilterBilinear);
-      dst_frame.set_timestamp(input_image.timestamp());
-      dst_frame.set_render_time_ms(input_image.render_time_ms());
-      streaminfos_[stream_idx].encoder->Encode(dst_frame,
-                                               codec_specific_info,
-                                               &stream_frame_types);
-    }
+  input_image_ = &input_image;
+  codec_specific_info_ = codec_specific_info;
+  const size_t highest_stream_idx = streaminfos_.size() - 1;
+  if (encode_threads_.empty()) {
+    // Build the whole pyramid first, so that the encoders are still called
+    // from the lowest to the highest resolution.
+    for (size_t i = highest_stream_idx + 1; i > 0; --i)
+      ScaleLayer(i - 1);
+    for (size_t stream_idx = 0; stream_idx < streaminfos_.size(); ++stream_idx)
+      EncodeLayer(stream_idx);
+  } else {
+    ScaleLayer(highest_stream_idx);
+    for (size_t i = 0; i < encode_threads_.size(); ++i)
+      encode_threads_[i]->StartEncode();
+    EncodeLayer(highest_stream_idx);
+    for (size_t i = 0; i < encode_threads_.size(); ++i)
+      encode_threads_[i]->WaitForEncode();
   }
 
+  // Return the scaled frames to the pools.
+  for (size_t i = 0; i < layers_.size(); ++i)
+    layers_[i].Reset();
+  input_image_ = NULL;
+  codec_specific_info_ = NULL;
+
   return WEBRTC_VIDEO_CODEC_OK;
 }
 
+void SimulcastEncoderAdapter::ScaleLayer(size_t stream_idx) {
+  const bool highest_stream = stream_idx + 1 == streaminfos_.size();
+  const I420VideoFrame& src_frame =
+      highest_stream ? *input_image_ : layers_[stream_idx + 1];
+  I420VideoFrame* dst_frame = &layers_[stream_idx];
+  int dst_width = streaminfos_[stream_idx].width;
+  int dst_height = streaminfos_[stream_idx].height;
+  // If scaling isn't required, because the source resolution matches the
+  // destination or the input image is empty (e.g. a keyframe request for
+  // encoders with internal camera sources), pass the source on directly.
+  // Otherwise, we'll scale it to match what the encoder expects (below).
+  if ((dst_width == src_frame.width() && dst_height == src_frame.height()) ||
+      input_image_->IsZeroSize()) {
+    dst_frame->ShallowCopy(src_frame);
+    return;
+  }
+  *dst_frame = I420VideoFrame(
+      buffer_pools_[stream_idx].CreateBuffer(dst_width, dst_height),
+      input_image_->timestamp(), input_image_->render_time_ms(),
+      kVideoRotation_0);
+  *dst_frame->mutable_timing() = input_image_->timing();
+  libyuv::I420Scale(src_frame.buffer(kYPlane),
+                    src_frame.stride(kYPlane),
+                    src_frame.buffer(kUPlane),
+                    src_frame.stride(kUPlane),
+                    src_frame.buffer(kVPlane),
+                    src_frame.stride(kVPlane),
+                    src_frame.width(), src_frame.height(),
+                    dst_frame->buffer(kYPlane),
+                    dst_frame->stride(kYPlane),
+                    dst_frame->buffer(kUPlane),
+                    dst_frame->stride(kUPlane),
+                    dst_frame->buffer(kVPlane),
+                    dst_frame->stride(kVPlane),
+                    dst_width, dst_height,
+                    libyuv::kFilterBilinear);
+}
+
+void SimulcastEncoderAdapter::EncodeLayer(size_t stream_idx) {
+  streaminfos_[stream_idx].encoder->Encode(layers_[stream_idx],
+                                           codec_specific_info_,
+                                           &stream_frame_types_[stream_idx]);
+}
+
 int SimulcastEncoderAdapter::RegisterEncodeCompleteCallback(
     EncodedImageCallback* callback) {
   encoded_complete_callback_ = callback;
@@ -389,6 +510,7 @@ int32_t SimulcastEncoderAdapter::Encoded(
     const EncodedImage& encodedImage,
     const CodecSpecificInfo* codecSpecificInfo,
     const RTPFragmentationHeader* fragmentation) {
+  CriticalSectionScoped cs(callback_crit_.get());
   CodecSpecificInfo stream_codec_specific = *codecSpecificInfo;
   CodecSpecificInfoVP8* vp8Info = &(stream_codec_specific.codecSpecific.VP8);
   vp8Info->simulcastIdx = stream_idx;
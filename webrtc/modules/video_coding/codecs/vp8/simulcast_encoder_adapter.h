@@ -15,10 +15,14 @@
 #include <vector>
 
 #include "webrtc/base/scoped_ptr.h"
+#include "webrtc/common_video/interface/i420_buffer_pool.h"
 #include "webrtc/modules/video_coding/codecs/vp8/include/vp8.h"
+#include "webrtc/system_wrappers/interface/scoped_vector.h"
 
 namespace webrtc {
 
+class CriticalSectionWrapper;
+
 class VideoEncoderFactory {
  public:
   virtual VideoEncoder* Create() = 0;
@@ -30,6 +34,10 @@ class VideoEncoderFactory {
 // webrtc::VideoEncoder instances with the given VideoEncoderFactory.
 // All the public interfaces are expected to be called from the same thread,
 // e.g the encoder thread.
+// Each lower resolution stream is scaled from the next higher one, into frames
+// taken from a per-stream buffer pool. When
+// VP8EncoderFactoryConfig::use_parallel_simulcast_encode() is set, the
+// streams are scaled and encoded concurrently, one thread per stream.
 class SimulcastEncoderAdapter : public VP8Encoder {
  public:
   explicit SimulcastEncoderAdapter(VideoEncoderFactory* factory);
@@ -56,6 +64,8 @@ class SimulcastEncoderAdapter : public VP8Encoder {
                   const RTPFragmentationHeader* fragmentation = NULL);
 
  private:
+  class StreamEncodeThread;
+
   struct StreamInfo {
     StreamInfo()
         : encoder(NULL),
@@ -100,11 +110,32 @@ class SimulcastEncoderAdapter : public VP8Encoder {
 
   bool Initialized() const;
 
+  // Fills |layers_[stream_idx]| from the input frame for the highest
+  // resolution stream, and from |layers_[stream_idx + 1]| otherwise.
+  void ScaleLayer(size_t stream_idx);
+
+  // Encodes |layers_[stream_idx]| with the encoder of that stream.
+  void EncodeLayer(size_t stream_idx);
+
   rtc::scoped_ptr<VideoEncoderFactory> factory_;
   rtc::scoped_ptr<Config> screensharing_extra_options_;
   VideoCodec codec_;
   std::vector<StreamInfo> streaminfos_;
   EncodedImageCallback* encoded_complete_callback_;
+
+  // Serializes the callbacks from the encode threads.
+  const rtc::scoped_ptr<CriticalSectionWrapper> callback_crit_;
+  // One thread per stream except the highest resolution one, which is
+  // encoded on the calling thread. Empty unless encoding in parallel.
+  ScopedVector<StreamEncodeThread> encode_threads_;
+  // Each pool is only used by the thread encoding its stream.
+  I420BufferPool buffer_pools_[kMaxSimulcastStreams];
+
+  // Valid during Encode().
+  const I420VideoFrame* input_image_;
+  const CodecSpecificInfo* codec_specific_info_;
+  std::vector<I420VideoFrame> layers_;
+  std::vector<std::vector<VideoFrameType> > stream_frame_types_;
 };
 
 }  // namespace webrtc
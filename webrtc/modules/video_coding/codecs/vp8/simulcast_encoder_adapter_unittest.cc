@@ -8,6 +8,9 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <stdio.h>
+#include <string.h>
+
 #include <vector>
 
 #include "testing/gmock/include/gmock/gmock.h"
@@ -15,6 +18,7 @@
 #include "webrtc/modules/video_coding/codecs/vp8/simulcast_encoder_adapter.h"
 #include "webrtc/modules/video_coding/codecs/vp8/simulcast_unittest.h"
 #include "webrtc/modules/video_coding/codecs/vp8/vp8_factory.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
 
 namespace webrtc {
 namespace testing {
@@ -108,6 +112,13 @@ TEST_F(TestSimulcastEncoderAdapter, DISABLED_TestRPSIEncoder) {
 
 class MockVideoEncoder : public VideoEncoder {
  public:
+  MockVideoEncoder()
+      : num_encoded_frames_(0),
+        last_frame_width_(0),
+        last_frame_height_(0),
+        last_frame_timestamp_(0),
+        last_frame_y_plane_(NULL) {}
+
   int32_t InitEncode(const VideoCodec* codecSettings,
                      int32_t numberOfCores,
                      size_t maxPayloadSize) {
@@ -117,7 +128,14 @@ class MockVideoEncoder : public VideoEncoder {
 
   int32_t Encode(const I420VideoFrame& inputImage,
                  const CodecSpecificInfo* codecSpecificInfo,
-                 const std::vector<VideoFrameType>* frame_types) { return 0; }
+                 const std::vector<VideoFrameType>* frame_types) {
+    ++num_encoded_frames_;
+    last_frame_width_ = inputImage.width();
+    last_frame_height_ = inputImage.height();
+    last_frame_timestamp_ = inputImage.timestamp();
+    last_frame_y_plane_ = inputImage.buffer(kYPlane);
+    return 0;
+  }
 
   int32_t RegisterEncodeCompleteCallback(EncodedImageCallback* callback) {
     callback_ = callback;
@@ -139,6 +157,11 @@ class MockVideoEncoder : public VideoEncoder {
   }
 
   const VideoCodec& codec() const { return codec_; }
+  int num_encoded_frames() const { return num_encoded_frames_; }
+  int last_frame_width() const { return last_frame_width_; }
+  int last_frame_height() const { return last_frame_height_; }
+  uint32_t last_frame_timestamp() const { return last_frame_timestamp_; }
+  const uint8_t* last_frame_y_plane() const { return last_frame_y_plane_; }
 
   void SendEncodedImage(int width, int height) {
     // Sends a fake image of the given width/height.
@@ -153,6 +176,11 @@ class MockVideoEncoder : public VideoEncoder {
  private:
   VideoCodec codec_;
   EncodedImageCallback* callback_;
+  int num_encoded_frames_;
+  int last_frame_width_;
+  int last_frame_height_;
+  uint32_t last_frame_timestamp_;
+  const uint8_t* last_frame_y_plane_;
 };
 
 class MockVideoEncoderFactory : public VideoEncoderFactory {
@@ -319,6 +347,53 @@ class TestSimulcastEncoderAdapterFake : public ::testing::Test,
     VerifyCodec(ref_codec, 2);
   }
 
+  // Encodes a frame of the full resolution, and checks that every encoder got
+  // it at the resolution of its stream.
+  void EncodeFrameAndVerifyLayers(uint32_t timestamp) {
+    const int width = codec_.width;
+    const int height = codec_.height;
+    const int half_width = (width + 1) / 2;
+    I420VideoFrame input_frame;
+    input_frame.CreateEmptyFrame(width, height, width, half_width, half_width);
+    memset(input_frame.buffer(kYPlane), 128,
+           input_frame.allocated_size(kYPlane));
+    memset(input_frame.buffer(kUPlane), 64,
+           input_frame.allocated_size(kUPlane));
+    memset(input_frame.buffer(kVPlane), 192,
+           input_frame.allocated_size(kVPlane));
+    input_frame.set_timestamp(timestamp);
+    EXPECT_EQ(0, adapter_->Encode(input_frame, NULL, NULL));
+
+    const std::vector<MockVideoEncoder*>& encoders =
+        helper_->factory()->encoders();
+    ASSERT_EQ(3u, encoders.size());
+    for (size_t i = 0; i < encoders.size(); ++i) {
+      EXPECT_EQ(codec_.simulcastStream[i].width,
+                encoders[i]->last_frame_width());
+      EXPECT_EQ(codec_.simulcastStream[i].height,
+                encoders[i]->last_frame_height());
+      EXPECT_EQ(timestamp, encoders[i]->last_frame_timestamp());
+    }
+    // The highest resolution stream encodes the input frame as is.
+    EXPECT_EQ(input_frame.buffer(kYPlane), encoders[2]->last_frame_y_plane());
+  }
+
+  void TestScaledFramesAreReused() {
+    SetupCodec();
+    const std::vector<MockVideoEncoder*>& encoders =
+        helper_->factory()->encoders();
+    EncodeFrameAndVerifyLayers(1000);
+    const uint8_t* y_plane_0 = encoders[0]->last_frame_y_plane();
+    const uint8_t* y_plane_1 = encoders[1]->last_frame_y_plane();
+    for (int i = 1; i < 10; ++i) {
+      EncodeFrameAndVerifyLayers(1000 + i * 3000);
+      EXPECT_EQ(y_plane_0, encoders[0]->last_frame_y_plane());
+      EXPECT_EQ(y_plane_1, encoders[1]->last_frame_y_plane());
+    }
+    for (size_t i = 0; i < encoders.size(); ++i)
+      EXPECT_EQ(10, encoders[i]->num_encoded_frames());
+  }
+
  protected:
   rtc::scoped_ptr<TestSimulcastEncoderAdapterFakeHelper> helper_;
   rtc::scoped_ptr<VP8Encoder> adapter_;
@@ -372,5 +447,102 @@ TEST_F(TestSimulcastEncoderAdapterFake, EncodedCallbackForDifferentEncoders) {
   EXPECT_EQ(2, simulcast_index);
 }
 
+TEST_F(TestSimulcastEncoderAdapterFake, ScaledFramesAreReused) {
+  TestScaledFramesAreReused();
+}
+
+class TestSimulcastEncoderAdapterFakeParallel
+    : public TestSimulcastEncoderAdapterFake {
+ public:
+  TestSimulcastEncoderAdapterFakeParallel() {
+    VP8EncoderFactoryConfig::set_use_parallel_simulcast_encode(true);
+  }
+  virtual ~TestSimulcastEncoderAdapterFakeParallel() {
+    VP8EncoderFactoryConfig::set_use_parallel_simulcast_encode(false);
+  }
+};
+
+TEST_F(TestSimulcastEncoderAdapterFakeParallel, ScaledFramesAreReused) {
+  TestScaledFramesAreReused();
+}
+
+class CountingEncodedImageCallback : public EncodedImageCallback {
+ public:
+  CountingEncodedImageCallback() : num_encoded_images_(0) {}
+
+  int32_t Encoded(const EncodedImage& encodedImage,
+                  const CodecSpecificInfo* codecSpecificInfo = NULL,
+                  const RTPFragmentationHeader* fragmentation = NULL) override {
+    ++num_encoded_images_;
+    return 0;
+  }
+
+  int num_encoded_images() const { return num_encoded_images_; }
+
+ private:
+  int num_encoded_images_;
+};
+
+// Encodes 1080p input into three VP8 streams, with the streams encoded one
+// after another and in parallel, and prints the wall time per frame.
+TEST(SimulcastEncoderAdapterTest, DISABLED_EncodeTime1080pThreeStreams) {
+  const int kWidth = 1920;
+  const int kHeight = 1080;
+  const int kHalfWidth = kWidth / 2;
+  const int kNumFrames = 300;
+  const int kTemporalLayers[3] = {1, 1, 1};
+
+  VideoCodec codec;
+  TestVp8Simulcast::DefaultSettings(&codec, kTemporalLayers);
+  codec.width = kWidth;
+  codec.height = kHeight;
+  const int kMinBitrates[] = {50, 150, 600};
+  const int kTargetBitrates[] = {150, 500, 2500};
+  const int kMaxBitrates[] = {200, 700, 2500};
+  for (int i = 0; i < 3; ++i) {
+    TestVp8Simulcast::ConfigureStream(kWidth >> (2 - i), kHeight >> (2 - i),
+                                      kMaxBitrates[i], kMinBitrates[i],
+                                      kTargetBitrates[i],
+                                      &codec.simulcastStream[i],
+                                      kTemporalLayers[i]);
+  }
+  codec.startBitrate =
+      kTargetBitrates[0] + kTargetBitrates[1] + kTargetBitrates[2];
+
+  I420VideoFrame input_frame;
+  input_frame.CreateEmptyFrame(kWidth, kHeight, kWidth, kHalfWidth,
+                               kHalfWidth);
+  memset(input_frame.buffer(kUPlane), 128, input_frame.allocated_size(kUPlane));
+  memset(input_frame.buffer(kVPlane), 128, input_frame.allocated_size(kVPlane));
+
+  for (int parallel = 0; parallel <= 1; ++parallel) {
+    VP8EncoderFactoryConfig::set_use_parallel_simulcast_encode(parallel != 0);
+    rtc::scoped_ptr<VP8Encoder> encoder(CreateTestEncoderAdapter());
+    CountingEncodedImageCallback callback;
+    ASSERT_EQ(0, encoder->InitEncode(&codec, 4, 1200));
+    encoder->RegisterEncodeCompleteCallback(&callback);
+    ASSERT_EQ(0, encoder->SetRates(codec.startBitrate, 30));
+
+    int64_t elapsed_us = 0;
+    for (int n = 0; n < kNumFrames; ++n) {
+      // A moving diagonal gradient, so that every frame has to be coded.
+      uint8_t* y_plane = input_frame.buffer(kYPlane);
+      for (int y = 0; y < kHeight; ++y) {
+        for (int x = 0; x < kWidth; ++x)
+          y_plane[y * kWidth + x] = static_cast<uint8_t>(x + y + 4 * n);
+      }
+      input_frame.set_timestamp(input_frame.timestamp() + 3000);
+      TickTime start = TickTime::Now();
+      ASSERT_EQ(0, encoder->Encode(input_frame, NULL, NULL));
+      elapsed_us += (TickTime::Now() - start).Microseconds();
+    }
+    EXPECT_GT(callback.num_encoded_images(), 0);
+    printf("%s: %.1f ms per frame\n", parallel ? "Parallel" : "Serial",
+           static_cast<double>(elapsed_us) / kNumFrames / 1000);
+  }
+  VP8EncoderFactoryConfig::set_use_parallel_simulcast_encode(false);
+  VP8EncoderFactoryConfig::set_use_simulcast_adapter(false);
+}
+
 }  // namespace testing
 }  // namespace webrtc
@@ -9,6 +9,8 @@
  */
 
 #include "webrtc/modules/video_coding/codecs/vp8/simulcast_unittest.h"
+#include "webrtc/modules/video_coding/codecs/vp8/vp8_factory.h"
+#include "webrtc/modules/video_coding/codecs/vp8/vp8_impl.h"
 
 namespace webrtc {
 namespace testing {
@@ -91,5 +93,60 @@ TEST_F(TestVp8Impl, TestSkipEncodingUnusedStreams) {
   TestVp8Simulcast::TestSkipEncodingUnusedStreams();
 }
 
+// Runs the simulcast tests with each stream encoded on its own thread.
+class TestVp8ImplParallelEncode
+    : public TestVp8Simulcast {
+ public:
+  TestVp8ImplParallelEncode()
+     : TestVp8Simulcast(VP8Encoder::Create(), VP8Decoder::Create()) {}
+ protected:
+  virtual void SetUp() {
+    VP8EncoderFactoryConfig::set_use_parallel_simulcast_encode(true);
+    TestVp8Simulcast::SetUp();
+  }
+  virtual void TearDown() {
+    TestVp8Simulcast::TearDown();
+    VP8EncoderFactoryConfig::set_use_parallel_simulcast_encode(false);
+  }
+};
+
+TEST_F(TestVp8ImplParallelEncode, TestKeyFrameRequestsOnAllStreams) {
+  TestVp8Simulcast::TestKeyFrameRequestsOnAllStreams();
+}
+
+TEST_F(TestVp8ImplParallelEncode, TestSendAllStreams) {
+  TestVp8Simulcast::TestSendAllStreams();
+}
+
+TEST_F(TestVp8ImplParallelEncode, TestDisablingStreams) {
+  TestVp8Simulcast::TestDisablingStreams();
+}
+
+TEST_F(TestVp8ImplParallelEncode, TestSwitchingToOneStream) {
+  TestVp8Simulcast::TestSwitchingToOneStream();
+}
+
+TEST_F(TestVp8ImplParallelEncode, TestSaptioTemporalLayers333PatternEncoder) {
+  TestVp8Simulcast::TestSaptioTemporalLayers333PatternEncoder();
+}
+
+TEST_F(TestVp8ImplParallelEncode, TestStrideEncodeDecode) {
+  TestVp8Simulcast::TestStrideEncodeDecode();
+}
+
+TEST_F(TestVp8ImplParallelEncode, ReportsEncodeTimePerStream) {
+  TestVp8Simulcast::TestSendAllStreams();
+  std::vector<VP8EncoderImpl::EncodeTimeStats> stream_stats =
+      static_cast<VP8EncoderImpl*>(encoder_.get())->GetStreamEncodeTimeStats();
+  ASSERT_EQ(static_cast<size_t>(kNumberOfSimulcastStreams),
+            stream_stats.size());
+  for (size_t i = 0; i < stream_stats.size(); ++i) {
+    EXPECT_EQ(2, stream_stats[i].num_frames);
+    EXPECT_LE(stream_stats[i].max_us, stream_stats[i].total_us);
+  }
+  EXPECT_EQ(2, static_cast<VP8EncoderImpl*>(encoder_.get())
+                   ->GetFrameEncodeTimeStats().num_frames);
+}
+
 }  // namespace testing
 }  // namespace webrtc
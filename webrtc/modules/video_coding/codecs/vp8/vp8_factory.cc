@@ -16,6 +16,7 @@
 namespace webrtc {
 
 bool VP8EncoderFactoryConfig::use_simulcast_adapter_ = false;
+bool VP8EncoderFactoryConfig::use_parallel_simulcast_encode_ = false;
 
 class VP8EncoderImplFactory : public VideoEncoderFactory {
  public:
@@ -25,8 +25,23 @@ class VP8EncoderFactoryConfig {
   }
   static bool use_simulcast_adapter() { return use_simulcast_adapter_; }
 
+  // When enabled, VP8EncoderImpl encodes simulcast streams with independent
+  // encoders running on their own threads, instead of a single libvpx
+  // multi-resolution encoder that encodes the streams one after another.
+  // Lowers encode latency on multi-core machines at the cost of the lower
+  // resolution streams no longer reusing motion search results from the
+  // higher ones. SimulcastEncoderAdapter likewise scales and encodes its
+  // streams on one thread each. Takes effect on the next InitEncode().
+  static void set_use_parallel_simulcast_encode(bool enable) {
+    use_parallel_simulcast_encode_ = enable;
+  }
+  static bool use_parallel_simulcast_encode() {
+    return use_parallel_simulcast_encode_;
+  }
+
  private:
   static bool use_simulcast_adapter_;
+  static bool use_parallel_simulcast_encode_;
 };
 
 }  // namespace webrtc
@@ -29,6 +29,9 @@
 #include "webrtc/modules/video_coding/codecs/vp8/include/vp8_common_types.h"
 #include "webrtc/modules/video_coding/codecs/vp8/screenshare_layers.h"
 #include "webrtc/modules/video_coding/codecs/vp8/temporal_layers.h"
+#include "webrtc/modules/video_coding/codecs/vp8/vp8_factory.h"
+#include "webrtc/system_wrappers/interface/event_wrapper.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
 #include "webrtc/system_wrappers/interface/tick_util.h"
 #include "webrtc/system_wrappers/interface/trace_event.h"
 
@@ -99,10 +102,96 @@ bool ValidSimulcastResolutions(const VideoCodec& codec, int num_streams) {
   }
   return true;
 }
+
+void AddEncodeTime(VP8EncoderImpl::EncodeTimeStats* stats,
+                   int64_t encode_time_us) {
+  ++stats->num_frames;
+  stats->total_us += encode_time_us;
+  stats->max_us = std::max(stats->max_us, encode_time_us);
+}
 }  // namespace
 
 const float kTl1MaxTimeToDropFrames = 20.0f;
 
+// Runs vpx_codec_encode() for one simulcast stream on a dedicated thread.
+class VP8EncoderImpl::StreamEncodeThread {
+ public:
+  StreamEncodeThread()
+      : start_event_(EventWrapper::Create()),
+        done_event_(EventWrapper::Create()),
+        stopping_(false),
+        encoder_(NULL),
+        image_(NULL),
+        pts_(0),
+        duration_(0),
+        error_(VPX_CODEC_OK),
+        encode_time_us_(0) {
+    thread_ = ThreadWrapper::CreateThread(&StreamEncodeThread::Run, this,
+                                          "VP8StreamEncoder");
+    thread_->Start();
+  }
+
+  ~StreamEncodeThread() {
+    stopping_ = true;
+    start_event_->Set();
+    thread_->Stop();
+  }
+
+  // Starts encoding |image| with |encoder|. Every call must be followed by
+  // WaitForEncode() before the next one.
+  void StartEncode(vpx_codec_ctx_t* encoder,
+                   vpx_image_t* image,
+                   vpx_codec_pts_t pts,
+                   unsigned long duration) {
+    encoder_ = encoder;
+    image_ = image;
+    pts_ = pts;
+    duration_ = duration;
+    start_event_->Set();
+  }
+
+  // Blocks until the encode started by StartEncode() is done, and returns its
+  // result.
+  vpx_codec_err_t WaitForEncode(int64_t* encode_time_us) {
+    done_event_->Wait(WEBRTC_EVENT_INFINITE);
+    *encode_time_us = encode_time_us_;
+    return error_;
+  }
+
+ private:
+  static bool Run(void* obj) {
+    return static_cast<StreamEncodeThread*>(obj)->Process();
+  }
+
+  bool Process() {
+    if (start_event_->Wait(WEBRTC_EVENT_INFINITE) != kEventSignaled)
+      return true;
+    if (stopping_)
+      return false;
+    const int64_t start_us = TickTime::MicrosecondTimestamp();
+    // Note we must pass 0 for |flags|, see VP8EncoderImpl::Encode().
+    error_ = vpx_codec_encode(encoder_, image_, pts_, duration_, 0,
+                              VPX_DL_REALTIME);
+    encode_time_us_ = TickTime::MicrosecondTimestamp() - start_us;
+    done_event_->Set();
+    return true;
+  }
+
+  rtc::scoped_ptr<ThreadWrapper> thread_;
+  const rtc::scoped_ptr<EventWrapper> start_event_;
+  const rtc::scoped_ptr<EventWrapper> done_event_;
+  // Written by the owner before signaling |start_event_|, and read by the
+  // encode thread after waking up on it.
+  bool stopping_;
+  vpx_codec_ctx_t* encoder_;
+  vpx_image_t* image_;
+  vpx_codec_pts_t pts_;
+  unsigned long duration_;
+  // Written by the encode thread before signaling |done_event_|.
+  vpx_codec_err_t error_;
+  int64_t encode_time_us_;
+};
+
 VP8EncoderImpl::VP8EncoderImpl()
     : encoded_complete_callback_(NULL),
       inited_(false),
@@ -144,6 +233,8 @@ int VP8EncoderImpl::Release() {
     delete [] image._buffer;
     encoded_images_.pop_back();
   }
+  // Stop the encode threads before destroying the encoders they use.
+  encode_threads_.clear();
   while (!encoders_.empty()) {
     vpx_codec_ctx_t& encoder = encoders_.back();
     if (vpx_codec_destroy(&encoder)) {
@@ -541,11 +632,21 @@ int VP8EncoderImpl::InitEncode(const VideoCodec* inst,
   configurations_[0].g_w = inst->width;
   configurations_[0].g_h = inst->height;
 
+  // Encode the streams in parallel with independent encoders, if enabled.
+  // Each lower resolution stream then keeps one core busy.
+  if (doing_simulcast &&
+      VP8EncoderFactoryConfig::use_parallel_simulcast_encode()) {
+    for (int i = 1; i < number_of_streams; ++i)
+      encode_threads_.push_back(new StreamEncodeThread());
+  }
+  stream_encode_time_stats_.assign(number_of_streams, EncodeTimeStats());
+  frame_encode_time_stats_ = EncodeTimeStats();
+
   // Determine number of threads based on the image size and #cores.
   // TODO(fbarchard): Consider number of Simulcast layers.
-  configurations_[0].g_threads = NumberOfThreads(configurations_[0].g_w,
-                                                 configurations_[0].g_h,
-                                                 number_of_cores);
+  configurations_[0].g_threads = NumberOfThreads(
+      configurations_[0].g_w, configurations_[0].g_h,
+      std::max(1, number_of_cores - static_cast<int>(encode_threads_.size())));
 
   // Creating a wrapper to the image - setting image data to NULL.
   // Actual pointer will be set in encode. Setting align to 1, as it
@@ -644,7 +745,7 @@ int VP8EncoderImpl::InitAndSetControlSettings() {
   vpx_codec_flags_t flags = 0;
   flags |= VPX_CODEC_USE_OUTPUT_PARTITION;
 
-  if (encoders_.size() > 1) {
+  if (encoders_.size() > 1 && encode_threads_.empty()) {
     int error = vpx_codec_enc_init_multi(&encoders_[0],
                                  vpx_codec_vp8_cx(),
                                  &configurations_[0],
@@ -655,11 +756,13 @@ int VP8EncoderImpl::InitAndSetControlSettings() {
       return WEBRTC_VIDEO_CODEC_UNINITIALIZED;
     }
   } else {
-    if (vpx_codec_enc_init(&encoders_[0],
-                           vpx_codec_vp8_cx(),
-                           &configurations_[0],
-                           flags)) {
-      return WEBRTC_VIDEO_CODEC_UNINITIALIZED;
+    for (size_t i = 0; i < encoders_.size(); ++i) {
+      if (vpx_codec_enc_init(&encoders_[i],
+                             vpx_codec_vp8_cx(),
+                             &configurations_[i],
+                             flags)) {
+        return WEBRTC_VIDEO_CODEC_UNINITIALIZED;
+      }
     }
   }
   // Enable denoising for the highest resolution stream, and for
@@ -887,8 +990,17 @@ int VP8EncoderImpl::Encode(
 
   // Note we must pass 0 for |flags| field in encode call below since they are
   // set above in |vpx_codec_control| function for each encoder/spatial layer.
-  int error = vpx_codec_encode(&encoders_[0], &raw_images_[0], timestamp_,
-                               duration, 0, VPX_DL_REALTIME);
+  const int64_t encode_start_us = TickTime::MicrosecondTimestamp();
+  int error = 0;
+  if (!encode_threads_.empty()) {
+    error = EncodeStreamsInParallel(duration);
+  } else {
+    // With multi-resolution encoding this encodes all streams.
+    error = vpx_codec_encode(&encoders_[0], &raw_images_[0], timestamp_,
+                             duration, 0, VPX_DL_REALTIME);
+  }
+  const int64_t encode_finish_us = TickTime::MicrosecondTimestamp();
+  AddEncodeTime(&frame_encode_time_stats_, encode_finish_us - encode_start_us);
   // Reset specific intra frame thresholds, following the key frame.
   if (send_key_frame) {
     vpx_codec_control(&(encoders_[0]), VP8E_SET_MAX_INTRA_BITRATE_PCT,
@@ -898,9 +1010,56 @@ int VP8EncoderImpl::Encode(
     return WEBRTC_VIDEO_CODEC_ERROR;
   }
   timestamp_ += duration;
+  for (size_t i = 0; i < encoded_images_.size(); ++i) {
+    encoded_images_[i].timing_ = frame.timing();
+    encoded_images_[i].timing_.encode_start_ms = encode_start_us / 1000;
+    encoded_images_[i].timing_.encode_finish_ms = encode_finish_us / 1000;
+  }
   return GetEncodedPartitions(input_image, only_predict_from_key_frame);
 }
 
+int VP8EncoderImpl::EncodeStreamsInParallel(uint32_t duration) {
+  // |encoders_| goes from highest to lowest resolution, while the stats are
+  // indexed from lowest to highest.
+  const size_t num_streams = encoders_.size();
+  for (size_t i = 1; i < num_streams; ++i) {
+    encode_threads_[i - 1]->StartEncode(&encoders_[i], &raw_images_[i],
+                                        timestamp_, duration);
+  }
+  const int64_t start_us = TickTime::MicrosecondTimestamp();
+  vpx_codec_err_t error = vpx_codec_encode(&encoders_[0], &raw_images_[0],
+                                           timestamp_, duration, 0,
+                                           VPX_DL_REALTIME);
+  int64_t encode_time_us = TickTime::MicrosecondTimestamp() - start_us;
+  AddEncodeTime(&stream_encode_time_stats_[num_streams - 1], encode_time_us);
+  TRACE_COUNTER_ID1("webrtc", "EncodeTimeUs", num_streams - 1, encode_time_us);
+
+  // Join every stream, even if one of them failed, before touching the
+  // encoders again.
+  for (size_t i = 1; i < num_streams; ++i) {
+    vpx_codec_err_t stream_error =
+        encode_threads_[i - 1]->WaitForEncode(&encode_time_us);
+    const size_t stream_idx = num_streams - 1 - i;
+    AddEncodeTime(&stream_encode_time_stats_[stream_idx], encode_time_us);
+    TRACE_COUNTER_ID1("webrtc", "EncodeTimeUs", stream_idx, encode_time_us);
+    if (stream_error && error == VPX_CODEC_OK)
+      error = stream_error;
+  }
+  return error;
+}
+
+std::vector<VP8EncoderImpl::EncodeTimeStats>
+VP8EncoderImpl::GetStreamEncodeTimeStats() const {
+  if (encode_threads_.empty())
+    return std::vector<EncodeTimeStats>();
+  return stream_encode_time_stats_;
+}
+
+VP8EncoderImpl::EncodeTimeStats VP8EncoderImpl::GetFrameEncodeTimeStats()
+    const {
+  return frame_encode_time_stats_;
+}
+
 // TODO(pbos): Make sure this works for properly for >1 encoders.
 int VP8EncoderImpl::UpdateCodecFrameSize(
     const I420VideoFrame& input_image) {
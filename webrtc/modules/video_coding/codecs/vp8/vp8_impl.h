@@ -28,6 +28,7 @@
 #include "webrtc/modules/video_coding/codecs/vp8/reference_picture_selection.h"
 #include "webrtc/modules/video_coding/utility/include/frame_dropper.h"
 #include "webrtc/modules/video_coding/utility/quality_scaler.h"
+#include "webrtc/system_wrappers/interface/scoped_vector.h"
 #include "webrtc/video_frame.h"
 
 namespace webrtc {
@@ -56,7 +57,27 @@ class VP8EncoderImpl : public VP8Encoder {
 
   virtual int SetRates(uint32_t new_bitrate_kbit, uint32_t frame_rate);
 
+  // Encode time statistics since the last InitEncode().
+  struct EncodeTimeStats {
+    EncodeTimeStats() : num_frames(0), total_us(0), max_us(0) {}
+
+    int num_frames;
+    int64_t total_us;
+    int64_t max_us;
+  };
+
+  // Time spent encoding each simulcast stream, indexed like
+  // VideoCodec::simulcastStream. Only available when the streams are encoded
+  // in parallel; multi-resolution encoding encodes all streams in one libvpx
+  // call and reports nothing here.
+  std::vector<EncodeTimeStats> GetStreamEncodeTimeStats() const;
+
+  // Wall-clock time of the complete encode call for all streams.
+  EncodeTimeStats GetFrameEncodeTimeStats() const;
+
  private:
+  class StreamEncodeThread;
+
   void SetupTemporalLayers(int num_streams, int num_temporal_layers,
                            const VideoCodec& codec);
 
@@ -69,6 +90,11 @@ class VP8EncoderImpl : public VP8Encoder {
   // Call encoder initialize function and set control settings.
   int InitAndSetControlSettings();
 
+  // Encodes |raw_images_| with all encoders, the highest resolution on the
+  // calling thread and the others on |encode_threads_|. Returns when all
+  // streams are done.
+  int EncodeStreamsInParallel(uint32_t duration);
+
   // Update frame size for codec.
   int UpdateCodecFrameSize(const I420VideoFrame& input_image);
 
@@ -118,6 +144,12 @@ class VP8EncoderImpl : public VP8Encoder {
   std::vector<vpx_codec_enc_cfg_t> configurations_;
   std::vector<vpx_rational_t> downsampling_factors_;
   QualityScaler quality_scaler_;
+  // One thread per stream except the highest resolution one, when encoding
+  // the streams in parallel with independent encoders. Empty when the streams
+  // are encoded by a single multi-resolution encoder.
+  ScopedVector<StreamEncodeThread> encode_threads_;
+  std::vector<EncodeTimeStats> stream_encode_time_stats_;
+  EncodeTimeStats frame_encode_time_stats_;
 };  // end of VP8EncoderImpl class
 
 class VP8DecoderImpl : public VP8Decoder {
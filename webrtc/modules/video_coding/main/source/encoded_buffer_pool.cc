@@ -0,0 +1,125 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/video_coding/main/source/encoded_buffer_pool.h"
+
+#include "webrtc/modules/video_coding/main/source/jitter_buffer_common.h"
+#include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
+
+namespace webrtc {
+namespace {
+
+// The smallest size class holds a few packets, and the largest one a frame of
+// kMaxJBFrameSizeBytes.
+const int kMinSizeClassLog2 = 13;
+const int kMaxSizeClassLog2 = 22;
+const int kNumSizeClasses = kMaxSizeClassLog2 - kMinSizeClassLog2 + 1;
+// Free buffers kept per size class. Most buffers stay with their frame while
+// it is recycled, so only buffers freed by growing frames end up here.
+const size_t kMaxFreeBuffersPerClass = 8;
+// Total size of the free buffers kept. A burst of large frames would
+// otherwise leave several buffers of the large classes idle in the pool.
+const size_t kMaxFreeBytes = 2 << kMaxSizeClassLog2;
+
+static_assert(kMaxJBFrameSizeBytes <= (1 << kMaxSizeClassLog2),
+              "largest buffer size class must hold the largest frame");
+
+int SizeClass(size_t min_size) {
+  int size_class = 0;
+  while ((static_cast<size_t>(1) << (kMinSizeClassLog2 + size_class)) <
+         min_size) {
+    ++size_class;
+  }
+  return size_class;
+}
+
+}  // namespace
+
+VCMEncodedBufferPool::VCMEncodedBufferPool()
+    : crit_sect_(CriticalSectionWrapper::CreateCriticalSection()),
+      free_buffers_(kNumSizeClasses),
+      free_bytes_(0) {}
+
+VCMEncodedBufferPool::~VCMEncodedBufferPool() {
+  for (size_t i = 0; i < free_buffers_.size(); ++i) {
+    for (size_t j = 0; j < free_buffers_[i].size(); ++j)
+      delete [] free_buffers_[i][j];
+  }
+}
+
+size_t VCMEncodedBufferPool::BufferSize(size_t min_size) {
+  return static_cast<size_t>(1) << (kMinSizeClassLog2 + SizeClass(min_size));
+}
+
+uint8_t* VCMEncodedBufferPool::Acquire(size_t min_size) {
+  const int size_class = SizeClass(min_size);
+  {
+    CriticalSectionScoped cs(crit_sect_.get());
+    if (size_class < kNumSizeClasses && !free_buffers_[size_class].empty()) {
+      uint8_t* buffer = free_buffers_[size_class].back();
+      free_buffers_[size_class].pop_back();
+      free_bytes_ -= BufferSize(min_size);
+      ++statistics_.pool_hits;
+      return buffer;
+    }
+    ++statistics_.pool_misses;
+  }
+  return new uint8_t[BufferSize(min_size)];
+}
+
+void VCMEncodedBufferPool::Release(uint8_t* buffer, size_t size) {
+  if (buffer == NULL)
+    return;
+  const int size_class = SizeClass(size);
+  std::vector<uint8_t*> evicted;
+  {
+    CriticalSectionScoped cs(crit_sect_.get());
+    if (size_class < kNumSizeClasses && BufferSize(size) == size &&
+        free_buffers_[size_class].size() < kMaxFreeBuffersPerClass &&
+        size <= kMaxFreeBytes) {
+      // Make room by dropping free buffers of larger classes, which are the
+      // most expensive to keep and the least likely to be needed again.
+      for (int i = kNumSizeClasses - 1;
+           i > size_class && free_bytes_ + size > kMaxFreeBytes; --i) {
+        while (!free_buffers_[i].empty() &&
+               free_bytes_ + size > kMaxFreeBytes) {
+          evicted.push_back(free_buffers_[i].back());
+          free_buffers_[i].pop_back();
+          free_bytes_ -= static_cast<size_t>(1) << (kMinSizeClassLog2 + i);
+        }
+      }
+      if (free_bytes_ + size <= kMaxFreeBytes) {
+        free_buffers_[size_class].push_back(buffer);
+        free_bytes_ += size;
+        buffer = NULL;
+      }
+    }
+  }
+  for (size_t i = 0; i < evicted.size(); ++i)
+    delete [] evicted[i];
+  delete [] buffer;
+}
+
+void VCMEncodedBufferPool::AddBytesCopied(size_t bytes) {
+  CriticalSectionScoped cs(crit_sect_.get());
+  statistics_.bytes_copied += bytes;
+}
+
+size_t VCMEncodedBufferPool::free_bytes() const {
+  CriticalSectionScoped cs(crit_sect_.get());
+  return free_bytes_;
+}
+
+VCMBufferPoolStatistics VCMEncodedBufferPool::statistics() const {
+  CriticalSectionScoped cs(crit_sect_.get());
+  return statistics_;
+}
+
+}  // namespace webrtc
@@ -0,0 +1,85 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_VIDEO_CODING_MAIN_SOURCE_ENCODED_BUFFER_POOL_H_
+#define WEBRTC_MODULES_VIDEO_CODING_MAIN_SOURCE_ENCODED_BUFFER_POOL_H_
+
+#include <stddef.h>
+
+#include <vector>
+
+#include "webrtc/base/constructormagic.h"
+#include "webrtc/base/scoped_ptr.h"
+#include "webrtc/base/thread_annotations.h"
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+
+class CriticalSectionWrapper;
+
+// Counters describing how the encoded frame buffers of a jitter buffer were
+// allocated and how much payload data was moved around after it was first
+// copied out of the packets.
+struct VCMBufferPoolStatistics {
+  VCMBufferPoolStatistics()
+      : pool_hits(0), pool_misses(0), bytes_copied(0) {}
+
+  // Buffers handed out from the pool and newly allocated buffers.
+  uint32_t pool_hits;
+  uint32_t pool_misses;
+  // Bytes copied when growing frame buffers and moved when reordering packets
+  // within a frame.
+  uint64_t bytes_copied;
+};
+
+// Pool of buffers for assembling encoded frames, in power of two size classes.
+// A frame buffer that runs out of space trades its buffer for one of the next
+// size class, so a frame grows in a logarithmic number of steps, and the
+// buffers of frames that grew large are reused by the next large frame
+// instead of being reallocated. Thread safe.
+class VCMEncodedBufferPool {
+ public:
+  VCMEncodedBufferPool();
+  ~VCMEncodedBufferPool();
+
+  // Returns the size of the buffers of the smallest size class holding
+  // |min_size| bytes.
+  static size_t BufferSize(size_t min_size);
+
+  // Returns a buffer of BufferSize(|min_size|) bytes, which is freed with
+  // Release() or delete[].
+  uint8_t* Acquire(size_t min_size);
+
+  // Returns |buffer| of |size| bytes to the pool, or deletes it if the pool
+  // doesn't keep buffers of that size or is full. The pool keeps at most a
+  // fixed number of bytes in free buffers, and drops free buffers of larger
+  // size classes first to stay within that.
+  void Release(uint8_t* buffer, size_t size);
+
+  void AddBytesCopied(size_t bytes);
+
+  // Total size of the buffers currently kept for reuse.
+  size_t free_bytes() const;
+
+  VCMBufferPoolStatistics statistics() const;
+
+ private:
+  const rtc::scoped_ptr<CriticalSectionWrapper> crit_sect_;
+  // Free buffers, by size class.
+  std::vector<std::vector<uint8_t*> > free_buffers_ GUARDED_BY(crit_sect_);
+  size_t free_bytes_ GUARDED_BY(crit_sect_);
+  VCMBufferPoolStatistics statistics_ GUARDED_BY(crit_sect_);
+
+  DISALLOW_COPY_AND_ASSIGN(VCMEncodedBufferPool);
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_VIDEO_CODING_MAIN_SOURCE_ENCODED_BUFFER_POOL_H_
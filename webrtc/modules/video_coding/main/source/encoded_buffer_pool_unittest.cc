@@ -0,0 +1,56 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/modules/video_coding/main/source/encoded_buffer_pool.h"
+
+namespace webrtc {
+
+TEST(EncodedBufferPoolTest, ReusesReleasedBuffers) {
+  VCMEncodedBufferPool pool;
+  const size_t size = VCMEncodedBufferPool::BufferSize(10000);
+  uint8_t* buffer = pool.Acquire(10000);
+  pool.Release(buffer, size);
+  EXPECT_EQ(size, pool.free_bytes());
+  EXPECT_EQ(buffer, pool.Acquire(10000));
+  EXPECT_EQ(0u, pool.free_bytes());
+  EXPECT_EQ(1u, pool.statistics().pool_hits);
+  EXPECT_EQ(1u, pool.statistics().pool_misses);
+  pool.Release(buffer, size);
+}
+
+TEST(EncodedBufferPoolTest, BoundsIdleMemoryAfterBurstOfLargeFrames) {
+  VCMEncodedBufferPool pool;
+  const size_t kLargeSize = 3 << 20;
+  const size_t large_size = VCMEncodedBufferPool::BufferSize(kLargeSize);
+  std::vector<uint8_t*> buffers;
+  for (int i = 0; i < 8; ++i)
+    buffers.push_back(pool.Acquire(kLargeSize));
+  for (size_t i = 0; i < buffers.size(); ++i)
+    pool.Release(buffers[i], large_size);
+  const size_t max_free_bytes = pool.free_bytes();
+  EXPECT_LT(max_free_bytes, buffers.size() * large_size);
+
+  // Small buffers released afterwards are kept in place of the large ones.
+  const size_t small_size = VCMEncodedBufferPool::BufferSize(1);
+  buffers.clear();
+  for (int i = 0; i < 8; ++i)
+    buffers.push_back(pool.Acquire(1));
+  for (size_t i = 0; i < buffers.size(); ++i)
+    pool.Release(buffers[i], small_size);
+  EXPECT_LE(pool.free_bytes(), max_free_bytes);
+  for (int i = 0; i < 8; ++i)
+    delete [] pool.Acquire(1);
+  EXPECT_EQ(8u, pool.statistics().pool_hits);
+}
+
+}  // namespace webrtc
@@ -74,6 +74,10 @@ public:
     */
     VideoRotation rotation() const { return _rotation; }
     /**
+    *   Get the times at which the frame passed the stages of the pipeline
+    */
+    const FrameTiming& timing() const { return timing_; }
+    /**
     *   True if this frame is complete, false otherwise
     */
     bool Complete() const { return _completeFrame; }
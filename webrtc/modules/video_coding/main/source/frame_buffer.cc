@@ -14,19 +14,26 @@
 #include <string.h>
 
 #include "webrtc/base/checks.h"
+#include "webrtc/modules/video_coding/main/source/encoded_buffer_pool.h"
 #include "webrtc/modules/video_coding/main/source/packet.h"
 #include "webrtc/system_wrappers/interface/logging.h"
 
 namespace webrtc {
 
-VCMFrameBuffer::VCMFrameBuffer()
+VCMFrameBuffer::VCMFrameBuffer(VCMEncodedBufferPool* buffer_pool)
   :
     _state(kStateEmpty),
     _nackCount(0),
-    _latestPacketTimeMs(-1) {
+    _latestPacketTimeMs(-1),
+    _bufferPool(buffer_pool) {
 }
 
 VCMFrameBuffer::~VCMFrameBuffer() {
+    if (_bufferPool != NULL) {
+        _bufferPool->Release(_buffer, _size);
+        _buffer = NULL;
+        _size = 0;
+    }
 }
 
 VCMFrameBuffer::VCMFrameBuffer(const VCMFrameBuffer& rhs)
@@ -35,7 +42,8 @@ VCMEncodedFrame(rhs),
 _state(rhs._state),
 _sessionInfo(),
 _nackCount(rhs._nackCount),
-_latestPacketTimeMs(rhs._latestPacketTimeMs) {
+_latestPacketTimeMs(rhs._latestPacketTimeMs),
+_bufferPool(NULL) {
     _sessionInfo = rhs._sessionInfo;
     _sessionInfo.UpdateDataPointers(rhs._buffer, _buffer);
 }
@@ -107,20 +115,12 @@ VCMFrameBuffer::InsertPacket(const VCMPacket& packet,
     uint32_t requiredSizeBytes = Length() + packet.sizeBytes +
                    (packet.insertStartCode ? kH264StartCodeLengthBytes : 0);
     if (requiredSizeBytes >= _size) {
-        const uint8_t* prevBuffer = _buffer;
-        const uint32_t increments = requiredSizeBytes /
-                                          kBufferIncStepSizeBytes +
-                                        (requiredSizeBytes %
-                                         kBufferIncStepSizeBytes > 0);
-        const uint32_t newSize = _size +
-                                       increments * kBufferIncStepSizeBytes;
-        if (newSize > kMaxJBFrameSizeBytes) {
+        if (requiredSizeBytes >= kMaxJBFrameSizeBytes) {
             LOG(LS_ERROR) << "Failed to insert packet due to frame being too "
                              "big.";
             return kSizeError;
         }
-        VerifyAndAllocate(newSize);
-        _sessionInfo.UpdateDataPointers(prevBuffer, _buffer);
+        IncreaseBufferSize(requiredSizeBytes + 1);
     }
 
     if (packet.width > 0 && packet.height > 0) {
@@ -132,9 +132,12 @@ VCMFrameBuffer::InsertPacket(const VCMPacket& packet,
     if (packet.sizeBytes > 0)
       CopyCodecSpecific(&packet.codecSpecificHeader);
 
+    const size_t bytesMoved = _sessionInfo.bytes_moved();
     int retVal = _sessionInfo.InsertPacket(packet, _buffer,
                                            decode_error_mode,
                                            frame_data);
+    if (_bufferPool != NULL && _sessionInfo.bytes_moved() != bytesMoved)
+        _bufferPool->AddBytesCopied(_sessionInfo.bytes_moved() - bytesMoved);
     if (retVal == -1) {
         return kSizeError;
     } else if (retVal == -2) {
@@ -160,6 +163,8 @@ VCMFrameBuffer::InsertPacket(const VCMPacket& packet,
     }
 
     if (_sessionInfo.complete()) {
+      if (_state != kStateComplete)
+        timing_.receive_ms = timeInMs;
       SetState(kStateComplete);
       return kCompleteSession;
     } else if (_sessionInfo.decodable()) {
@@ -169,6 +174,30 @@ VCMFrameBuffer::InsertPacket(const VCMPacket& packet,
     return kIncomplete;
 }
 
+void
+VCMFrameBuffer::IncreaseBufferSize(size_t min_size) {
+    const uint8_t* prevBuffer = _buffer;
+    uint8_t* newBuffer;
+    if (_bufferPool != NULL) {
+        newBuffer = _bufferPool->Acquire(min_size);
+    } else {
+        newBuffer = new uint8_t[VCMEncodedBufferPool::BufferSize(min_size)];
+    }
+    // Only the inserted packets need to be kept, not the whole buffer.
+    const size_t length = Length();
+    if (length > 0)
+        memcpy(newBuffer, _buffer, length);
+    if (_bufferPool != NULL) {
+        _bufferPool->AddBytesCopied(length);
+        _bufferPool->Release(_buffer, _size);
+    } else {
+        delete [] _buffer;
+    }
+    _buffer = newBuffer;
+    _size = VCMEncodedBufferPool::BufferSize(min_size);
+    _sessionInfo.UpdateDataPointers(prevBuffer, _buffer);
+}
+
 int64_t
 VCMFrameBuffer::LatestPacketTimeMs() const {
     return _latestPacketTimeMs;
@@ -265,6 +294,7 @@ VCMFrameBuffer::IsRetransmitted() const {
 
 void
 VCMFrameBuffer::PrepareForDecode(bool continuous) {
+    const size_t bytesMoved = _sessionInfo.bytes_moved();
 #ifdef INDEPENDENT_PARTITIONS
     if (_codec == kVideoCodecVP8) {
         _length =
@@ -278,6 +308,8 @@ VCMFrameBuffer::PrepareForDecode(bool continuous) {
     size_t bytes_removed = _sessionInfo.MakeDecodable();
     _length -= bytes_removed;
 #endif
+    if (_bufferPool != NULL && _sessionInfo.bytes_moved() != bytesMoved)
+        _bufferPool->AddBytesCopied(_sessionInfo.bytes_moved() - bytesMoved);
     // Transfer frame information to EncodedFrame and create any codec
     // specific information.
     _frameType = ConvertFrameType(_sessionInfo.FrameType());
@@ -20,9 +20,13 @@
 
 namespace webrtc {
 
+class VCMEncodedBufferPool;
+
 class VCMFrameBuffer : public VCMEncodedFrame {
  public:
-  VCMFrameBuffer();
+  // Frame buffers grow their buffer through |buffer_pool|, if given, which
+  // must outlive them.
+  explicit VCMFrameBuffer(VCMEncodedBufferPool* buffer_pool = NULL);
   virtual ~VCMFrameBuffer();
 
   VCMFrameBuffer(const VCMFrameBuffer& rhs);
@@ -79,11 +83,15 @@ class VCMFrameBuffer : public VCMEncodedFrame {
 
  private:
   void SetState(VCMFrameBufferStateEnum state);  // Set state of frame
+  // Replaces the buffer with one of at least |min_size| bytes, keeping the
+  // data of the inserted packets.
+  void IncreaseBufferSize(size_t min_size);
 
   VCMFrameBufferStateEnum    _state;         // Current state of the frame
   VCMSessionInfo             _sessionInfo;
   uint16_t             _nackCount;
   int64_t              _latestPacketTimeMs;
+  VCMEncodedBufferPool* _bufferPool;
 };
 
 }  // namespace webrtc
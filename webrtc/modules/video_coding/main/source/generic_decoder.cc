@@ -65,16 +65,19 @@ int32_t VCMDecodedFrameCallback::Decoded(I420VideoFrame& decodedImage)
       return WEBRTC_VIDEO_CODEC_OK;
     }
 
+    const int64_t now_ms = _clock->TimeInMilliseconds();
     _timing.StopDecodeTimer(
         decodedImage.timestamp(),
         frameInfo->decodeStartTimeMs,
-        _clock->TimeInMilliseconds(),
+        now_ms,
         frameInfo->renderTimeMs);
 
     if (callback != NULL)
     {
         decodedImage.set_render_time_ms(frameInfo->renderTimeMs);
         decodedImage.set_rotation(frameInfo->rotation);
+        *decodedImage.mutable_timing() = frameInfo->timing;
+        decodedImage.mutable_timing()->decode_finish_ms = now_ms;
         callback->FrameToRender(decodedImage);
     }
     return WEBRTC_VIDEO_CODEC_OK;
@@ -150,6 +153,8 @@ int32_t VCMGenericDecoder::Decode(const VCMEncodedFrame& frame,
     _frameInfos[_nextFrameInfoIdx].decodeStartTimeMs = nowMs;
     _frameInfos[_nextFrameInfoIdx].renderTimeMs = frame.RenderTimeMs();
     _frameInfos[_nextFrameInfoIdx].rotation = frame.rotation();
+    _frameInfos[_nextFrameInfoIdx].timing = frame.timing();
+    _frameInfos[_nextFrameInfoIdx].timing.decode_start_ms = nowMs;
     _callback->Map(frame.TimeStamp(), &_frameInfos[_nextFrameInfoIdx]);
 
     _nextFrameInfoIdx = (_nextFrameInfoIdx + 1) % kDecoderFrameMemoryLength;
@@ -30,6 +30,7 @@ struct VCMFrameInformation
     int64_t     decodeStartTimeMs;
     void*             userData;
     VideoRotation rotation;
+    FrameTiming timing;
 };
 
 class VCMDecodedFrameCallback : public DecodedImageCallback
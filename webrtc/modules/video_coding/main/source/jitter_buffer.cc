@@ -118,6 +118,7 @@ VCMJitterBuffer::VCMJitterBuffer(Clock* clock, EventFactory* event_factory)
       running_(false),
       crit_sect_(CriticalSectionWrapper::CreateCriticalSection()),
       frame_event_(event_factory->CreateEvent()),
+      buffer_pool_(),
       max_number_of_frames_(kStartNumberOfFrames),
       free_frames_(),
       decodable_frames_(),
@@ -141,7 +142,7 @@ VCMJitterBuffer::VCMJitterBuffer(Clock* clock, EventFactory* event_factory)
       nack_mode_(kNoNack),
       low_rtt_nack_threshold_ms_(-1),
       high_rtt_nack_threshold_ms_(-1),
-      missing_sequence_numbers_(SequenceNumberLessThan()),
+      missing_sequence_numbers_(),
       nack_seq_nums_(),
       max_nack_list_size_(0),
       max_packet_age_to_nack_(0),
@@ -150,7 +151,7 @@ VCMJitterBuffer::VCMJitterBuffer(Clock* clock, EventFactory* event_factory)
       average_packets_per_frame_(0.0f),
       frame_counter_(0) {
   for (int i = 0; i < kStartNumberOfFrames; i++)
-    free_frames_.push_back(new VCMFrameBuffer());
+    free_frames_.push_back(new VCMFrameBuffer(&buffer_pool_));
 }
 
 VCMJitterBuffer::~VCMJitterBuffer() {
@@ -265,7 +266,7 @@ void VCMJitterBuffer::Flush() {
   waiting_for_completion_.timestamp = 0;
   waiting_for_completion_.latest_packet_time = -1;
   first_packet_since_reset_ = true;
-  missing_sequence_numbers_.clear();
+  missing_sequence_numbers_.Clear();
 }
 
 // Get received key and delta frames
@@ -274,6 +275,10 @@ FrameCounts VCMJitterBuffer::FrameStatistics() const {
   return receive_statistics_;
 }
 
+VCMBufferPoolStatistics VCMJitterBuffer::BufferPoolStatistics() const {
+  return buffer_pool_.statistics();
+}
+
 int VCMJitterBuffer::num_packets() const {
   CriticalSectionScoped cs(crit_sect_);
   return num_packets_;
@@ -798,7 +803,7 @@ void VCMJitterBuffer::SetNackMode(VCMNackMode mode,
   CriticalSectionScoped cs(crit_sect_);
   nack_mode_ = mode;
   if (mode == kNoNack) {
-    missing_sequence_numbers_.clear();
+    missing_sequence_numbers_.Clear();
   }
   assert(low_rtt_nack_threshold_ms >= -1 && high_rtt_nack_threshold_ms >= -1);
   assert(high_rtt_nack_threshold_ms == -1 ||
@@ -912,12 +917,10 @@ uint16_t* VCMJitterBuffer::GetNackList(uint16_t* nack_list_size,
       }
     }
   }
-  unsigned int i = 0;
-  SequenceNumberSet::iterator it = missing_sequence_numbers_.begin();
-  for (; it != missing_sequence_numbers_.end(); ++it, ++i) {
-    nack_seq_nums_[i] = *it;
-  }
-  *nack_list_size = i;
+  if (nack_seq_nums_.size() < missing_sequence_numbers_.size())
+    nack_seq_nums_.resize(missing_sequence_numbers_.size());
+  *nack_list_size = static_cast<uint16_t>(
+      missing_sequence_numbers_.CopyTo(&nack_seq_nums_[0]));
   return &nack_seq_nums_[0];
 }
 
@@ -949,7 +952,7 @@ bool VCMJitterBuffer::UpdateNackList(uint16_t sequence_number) {
     // Push any missing sequence numbers to the NACK list.
     for (uint16_t i = latest_received_sequence_number_ + 1;
          IsNewerSequenceNumber(sequence_number, i); ++i) {
-      missing_sequence_numbers_.insert(missing_sequence_numbers_.end(), i);
+      missing_sequence_numbers_.Insert(i);
       TRACE_EVENT_INSTANT1(TRACE_DISABLED_BY_DEFAULT("webrtc_rtp"), "AddNack",
                            "seqnum", i);
     }
@@ -963,7 +966,7 @@ bool VCMJitterBuffer::UpdateNackList(uint16_t sequence_number) {
       return false;
     }
   } else {
-    missing_sequence_numbers_.erase(sequence_number);
+    missing_sequence_numbers_.Erase(sequence_number);
     TRACE_EVENT_INSTANT1(TRACE_DISABLED_BY_DEFAULT("webrtc_rtp"), "RemoveNack",
                          "seqnum", sequence_number);
   }
@@ -993,7 +996,7 @@ bool VCMJitterBuffer::MissingTooOldPacket(
     return false;
   }
   const uint16_t age_of_oldest_missing_packet = latest_sequence_number -
-      *missing_sequence_numbers_.begin();
+      missing_sequence_numbers_.Oldest();
   // Recycle frames if the NACK list contains too old sequence numbers as
   // the packets may have already been dropped by the sender.
   return age_of_oldest_missing_packet > max_packet_age_to_nack_;
@@ -1002,7 +1005,7 @@ bool VCMJitterBuffer::MissingTooOldPacket(
 bool VCMJitterBuffer::HandleTooOldPackets(uint16_t latest_sequence_number) {
   bool key_frame_found = false;
   const uint16_t age_of_oldest_missing_packet = latest_sequence_number -
-      *missing_sequence_numbers_.begin();
+      missing_sequence_numbers_.Oldest();
   LOG_F(LS_WARNING) << "NACK list contains too old sequence numbers: "
                     << age_of_oldest_missing_packet << " > "
                     << max_packet_age_to_nack_;
@@ -1016,9 +1019,7 @@ void VCMJitterBuffer::DropPacketsFromNackList(
     uint16_t last_decoded_sequence_number) {
   // Erase all sequence numbers from the NACK list which we won't need any
   // longer.
-  missing_sequence_numbers_.erase(missing_sequence_numbers_.begin(),
-                                  missing_sequence_numbers_.upper_bound(
-                                      last_decoded_sequence_number));
+  missing_sequence_numbers_.EraseUpTo(last_decoded_sequence_number);
 }
 
 int64_t VCMJitterBuffer::LastDecodedTimestamp() const {
@@ -1059,7 +1060,7 @@ VCMFrameBuffer* VCMJitterBuffer::GetEmptyFrame() {
 bool VCMJitterBuffer::TryToIncreaseJitterBufferSize() {
   if (max_number_of_frames_ >= kMaxNumberOfFrames)
     return false;
-  free_frames_.push_back(new VCMFrameBuffer());
+  free_frames_.push_back(new VCMFrameBuffer(&buffer_pool_));
   ++max_number_of_frames_;
   TRACE_COUNTER1("webrtc", "JBMaxFrames", max_number_of_frames_);
   return true;
@@ -1092,7 +1093,7 @@ bool VCMJitterBuffer::RecycleFramesUntilKeyFrame() {
     // All frames dropped. Reset the decoding state and clear missing sequence
     // numbers as we're starting fresh.
     last_decoded_state_.Reset();
-    missing_sequence_numbers_.clear();
+    missing_sequence_numbers_.Clear();
   }
   return key_frame_found;
 }
@@ -1151,8 +1152,7 @@ void VCMJitterBuffer::CleanUpOldOrEmptyFrames() {
 
 // Must be called from within |crit_sect_|.
 bool VCMJitterBuffer::IsPacketRetransmitted(const VCMPacket& packet) const {
-  return missing_sequence_numbers_.find(packet.seqNum) !=
-      missing_sequence_numbers_.end();
+  return missing_sequence_numbers_.Contains(packet.seqNum);
 }
 
 // Must be called under the critical section |crit_sect_|. Should never be
@@ -13,7 +13,6 @@
 
 #include <list>
 #include <map>
-#include <set>
 #include <vector>
 
 #include "webrtc/base/constructormagic.h"
@@ -22,9 +21,11 @@
 #include "webrtc/modules/video_coding/main/interface/video_coding.h"
 #include "webrtc/modules/video_coding/main/interface/video_coding_defines.h"
 #include "webrtc/modules/video_coding/main/source/decoding_state.h"
+#include "webrtc/modules/video_coding/main/source/encoded_buffer_pool.h"
 #include "webrtc/modules/video_coding/main/source/inter_frame_delay.h"
 #include "webrtc/modules/video_coding/main/source/jitter_buffer_common.h"
 #include "webrtc/modules/video_coding/main/source/jitter_estimator.h"
+#include "webrtc/modules/video_coding/main/source/sequence_number_bitmap.h"
 #include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
 #include "webrtc/typedefs.h"
 
@@ -96,6 +97,9 @@ class VCMJitterBuffer {
   // was started.
   FrameCounts FrameStatistics() const;
 
+  // Get the allocation and copy counters of the frame buffers' data.
+  VCMBufferPoolStatistics BufferPoolStatistics() const;
+
   // The number of packets discarded by the jitter buffer because the decoder
   // won't be able to decode them.
   int num_not_decodable_packets() const;
@@ -187,15 +191,6 @@ class VCMJitterBuffer {
   void RegisterStatsCallback(VCMReceiveStatisticsCallback* callback);
 
  private:
-  class SequenceNumberLessThan {
-   public:
-    bool operator() (const uint16_t& sequence_number1,
-                     const uint16_t& sequence_number2) const {
-      return IsNewerSequenceNumber(sequence_number2, sequence_number1);
-    }
-  };
-  typedef std::set<uint16_t, SequenceNumberLessThan> SequenceNumberSet;
-
   // Gets the frame assigned to the timestamp of the packet. May recycle
   // existing frames if no free frames are available. Returns an error code if
   // failing, or kNoError on success. |frame_list| contains which list the
@@ -294,6 +289,8 @@ class VCMJitterBuffer {
   CriticalSectionWrapper* crit_sect_;
   // Event to signal when we have a frame ready for decoder.
   rtc::scoped_ptr<EventWrapper> frame_event_;
+  // Buffers for the data of the frames.
+  VCMEncodedBufferPool buffer_pool_;
   // Number of allocated frames.
   int max_number_of_frames_;
   UnorderedFrameList free_frames_ GUARDED_BY(crit_sect_);
@@ -338,7 +335,7 @@ class VCMJitterBuffer {
   int64_t low_rtt_nack_threshold_ms_;
   int64_t high_rtt_nack_threshold_ms_;
   // Holds the internal NACK list (the missing sequence numbers).
-  SequenceNumberSet missing_sequence_numbers_;
+  SequenceNumberBitmap missing_sequence_numbers_;
   uint16_t latest_received_sequence_number_;
   std::vector<uint16_t> nack_seq_nums_;
   size_t max_nack_list_size_;
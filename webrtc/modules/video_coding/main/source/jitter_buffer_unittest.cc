@@ -448,6 +448,46 @@ TEST_F(TestBasicJitterBuffer, PacketReorderingReverseOrder) {
   jitter_buffer_->ReleaseFrame(frame_out);
 }
 
+TEST_F(TestBasicJitterBuffer, BufferPoolReusesBuffersOfGrownFrames) {
+  const int kPacketsPerFrame = 100;
+  bool retransmitted = false;
+  VCMBufferPoolStatistics first_frame_stats;
+  for (int frame = 0; frame < 2; ++frame) {
+    // Insert the packets of a key frame in reverse order, so each packet has
+    // to be moved in front of the ones already inserted.
+    seq_num_ += kPacketsPerFrame;
+    packet_->frameType = kVideoFrameKey;
+    packet_->timestamp = timestamp_;
+    for (int i = kPacketsPerFrame - 1; i >= 0; --i) {
+      packet_->seqNum = seq_num_ - (kPacketsPerFrame - 1 - i);
+      packet_->isFirstPacket = i == 0;
+      packet_->markerBit = i == kPacketsPerFrame - 1;
+      EXPECT_EQ(i == 0 ? kCompleteSession : kIncomplete,
+                jitter_buffer_->InsertPacket(*packet_, &retransmitted));
+    }
+    VCMEncodedFrame* frame_out = DecodeCompleteFrame();
+    CheckOutFrame(frame_out, kPacketsPerFrame * size_, false);
+    jitter_buffer_->ReleaseFrame(frame_out);
+    timestamp_ += 33 * 90;
+    ++seq_num_;
+    if (frame == 0)
+      first_frame_stats = jitter_buffer_->BufferPoolStatistics();
+  }
+
+  // The first frame grows through all size classes up to its size, and the
+  // second one reuses the buffers the first one grew out of.
+  VCMBufferPoolStatistics stats = jitter_buffer_->BufferPoolStatistics();
+  EXPECT_EQ(0u, first_frame_stats.pool_hits);
+  EXPECT_GT(first_frame_stats.pool_misses, 1u);
+  EXPECT_EQ(first_frame_stats.pool_misses - 1, stats.pool_hits);
+  EXPECT_EQ(first_frame_stats.pool_misses + 1, stats.pool_misses);
+  // Each packet but the first is moved once for every later packet.
+  const uint64_t kMovedBytesPerFrame = static_cast<uint64_t>(size_) *
+      kPacketsPerFrame * (kPacketsPerFrame - 1) / 2;
+  EXPECT_GT(first_frame_stats.bytes_copied, kMovedBytesPerFrame);
+  EXPECT_GT(stats.bytes_copied, 2 * kMovedBytesPerFrame);
+}
+
 TEST_F(TestBasicJitterBuffer, FrameReordering2Frames2PacketsEach) {
   packet_->frameType = kVideoFrameDelta;
   packet_->isFirstPacket = true;
@@ -0,0 +1,155 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/video_coding/main/source/sequence_number_bitmap.h"
+
+#include <assert.h>
+#include <string.h>
+
+#include "webrtc/modules/interface/module_common_types.h"
+
+namespace webrtc {
+namespace {
+
+const uint64_t kAllBits = ~static_cast<uint64_t>(0);
+
+int CountTrailingZeros(uint64_t word) {
+#if defined(__GNUC__)
+  return __builtin_ctzll(word);
+#else
+  int count = 0;
+  while ((word & 1) == 0) {
+    word >>= 1;
+    ++count;
+  }
+  return count;
+#endif
+}
+
+int CountBits(uint64_t word) {
+#if defined(__GNUC__)
+  return __builtin_popcountll(word);
+#else
+  int count = 0;
+  for (; word != 0; word &= word - 1)
+    ++count;
+  return count;
+#endif
+}
+
+int WordIndex(uint16_t sequence_number) {
+  return sequence_number >> 6;
+}
+
+uint64_t BitMask(uint16_t sequence_number) {
+  return static_cast<uint64_t>(1) << (sequence_number & 63);
+}
+
+}  // namespace
+
+SequenceNumberBitmap::SequenceNumberBitmap()
+    : size_(0), oldest_(0), newest_(0) {
+  memset(bits_, 0, sizeof(bits_));
+}
+
+bool SequenceNumberBitmap::Contains(uint16_t sequence_number) const {
+  return (bits_[WordIndex(sequence_number)] & BitMask(sequence_number)) != 0;
+}
+
+void SequenceNumberBitmap::Insert(uint16_t sequence_number) {
+  if (Contains(sequence_number))
+    return;
+  bits_[WordIndex(sequence_number)] |= BitMask(sequence_number);
+  if (++size_ == 1) {
+    oldest_ = sequence_number;
+    newest_ = sequence_number;
+  } else if (IsNewerSequenceNumber(sequence_number, newest_)) {
+    newest_ = sequence_number;
+  } else if (IsNewerSequenceNumber(oldest_, sequence_number)) {
+    oldest_ = sequence_number;
+  }
+}
+
+bool SequenceNumberBitmap::Erase(uint16_t sequence_number) {
+  if (!Contains(sequence_number))
+    return false;
+  bits_[WordIndex(sequence_number)] &= ~BitMask(sequence_number);
+  --size_;
+  // |newest_| is left as is; it only needs to bound the set from above.
+  if (size_ > 0 && sequence_number == oldest_)
+    oldest_ = NextSetBit(sequence_number + 1);
+  return true;
+}
+
+void SequenceNumberBitmap::EraseUpTo(uint16_t sequence_number) {
+  if (empty() || IsNewerSequenceNumber(oldest_, sequence_number))
+    return;
+  if (!IsNewerSequenceNumber(newest_, sequence_number)) {
+    Clear();
+    return;
+  }
+  ClearRange(oldest_, sequence_number);
+  if (size_ > 0)
+    oldest_ = NextSetBit(sequence_number + 1);
+}
+
+void SequenceNumberBitmap::Clear() {
+  if (size_ > 0)
+    ClearRange(oldest_, newest_);
+  assert(size_ == 0);
+}
+
+size_t SequenceNumberBitmap::CopyTo(uint16_t* sequence_numbers) const {
+  if (empty())
+    return 0;
+  int index = WordIndex(oldest_);
+  uint64_t word = bits_[index] & (kAllBits << (oldest_ & 63));
+  for (size_t i = 0; i < size_; ++i) {
+    while (word == 0) {
+      index = (index + 1) % kNumWords;
+      word = bits_[index];
+    }
+    sequence_numbers[i] =
+        static_cast<uint16_t>(index * 64 + CountTrailingZeros(word));
+    word &= word - 1;
+  }
+  return size_;
+}
+
+void SequenceNumberBitmap::ClearRange(uint16_t first, uint16_t last) {
+  uint16_t sequence_number = first;
+  while (true) {
+    const uint16_t word_end = sequence_number | 63;
+    const bool last_word = static_cast<uint16_t>(last - sequence_number) <=
+        static_cast<uint16_t>(word_end - sequence_number);
+    const int high_bit = last_word ? (last & 63) : 63;
+    const uint64_t mask = (kAllBits >> (63 - high_bit)) &
+        (kAllBits << (sequence_number & 63));
+    uint64_t& word = bits_[WordIndex(sequence_number)];
+    size_ -= CountBits(word & mask);
+    word &= ~mask;
+    if (last_word)
+      break;
+    sequence_number = word_end + 1;
+  }
+}
+
+uint16_t SequenceNumberBitmap::NextSetBit(uint16_t first) const {
+  assert(!empty());
+  int index = WordIndex(first);
+  uint64_t word = bits_[index] & (kAllBits << (first & 63));
+  while (word == 0) {
+    index = (index + 1) % kNumWords;
+    word = bits_[index];
+  }
+  return static_cast<uint16_t>(index * 64 + CountTrailingZeros(word));
+}
+
+}  // namespace webrtc
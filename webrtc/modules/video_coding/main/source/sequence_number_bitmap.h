@@ -0,0 +1,70 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_VIDEO_CODING_MAIN_SOURCE_SEQUENCE_NUMBER_BITMAP_H_
+#define WEBRTC_MODULES_VIDEO_CODING_MAIN_SOURCE_SEQUENCE_NUMBER_BITMAP_H_
+
+#include <stddef.h>
+
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+
+// Set of RTP sequence numbers, ordered with wrap-around like
+// IsNewerSequenceNumber(), with one bit for each of the 2^16 sequence numbers.
+// Lookups and updates don't allocate and take constant time, and the ordered
+// sequence numbers are read out a word at a time. All sequence numbers in the
+// set must be within half the sequence number range of each other.
+class SequenceNumberBitmap {
+ public:
+  SequenceNumberBitmap();
+
+  bool empty() const { return size_ == 0; }
+  size_t size() const { return size_; }
+
+  // The oldest sequence number in the set, which must not be empty.
+  uint16_t Oldest() const { return oldest_; }
+
+  bool Contains(uint16_t sequence_number) const;
+
+  void Insert(uint16_t sequence_number);
+
+  // Returns true if |sequence_number| was in the set.
+  bool Erase(uint16_t sequence_number);
+
+  // Erases |sequence_number| and all older sequence numbers.
+  void EraseUpTo(uint16_t sequence_number);
+
+  void Clear();
+
+  // Writes the sequence numbers from oldest to newest to |sequence_numbers|,
+  // which must have room for size() of them, and returns their number.
+  size_t CopyTo(uint16_t* sequence_numbers) const;
+
+ private:
+  static const int kNumWords = (1 << 16) / 64;
+
+  // Clears the bits of the sequence numbers from |first| through |last|, in
+  // wrap-around order.
+  void ClearRange(uint16_t first, uint16_t last);
+  // Returns the oldest sequence number in the set, starting the search at
+  // |first|.
+  uint16_t NextSetBit(uint16_t first) const;
+
+  uint64_t bits_[kNumWords];
+  size_t size_;
+  uint16_t oldest_;
+  // No older than any sequence number in the set; not updated by Erase().
+  uint16_t newest_;
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_VIDEO_CODING_MAIN_SOURCE_SEQUENCE_NUMBER_BITMAP_H_
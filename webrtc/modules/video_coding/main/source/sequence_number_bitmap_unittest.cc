@@ -0,0 +1,157 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/video_coding/main/source/sequence_number_bitmap.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/modules/interface/module_common_types.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+
+namespace webrtc {
+namespace {
+
+class SequenceNumberLessThan {
+ public:
+  bool operator()(uint16_t sequence_number1, uint16_t sequence_number2) const {
+    return IsNewerSequenceNumber(sequence_number2, sequence_number1);
+  }
+};
+typedef std::set<uint16_t, SequenceNumberLessThan> SequenceNumberSet;
+
+void ExpectEqual(const SequenceNumberSet& expected,
+                 const SequenceNumberBitmap& bitmap) {
+  ASSERT_EQ(expected.size(), bitmap.size());
+  if (expected.empty())
+    return;
+  EXPECT_EQ(*expected.begin(), bitmap.Oldest());
+  std::vector<uint16_t> sequence_numbers(bitmap.size());
+  EXPECT_EQ(expected.size(), bitmap.CopyTo(&sequence_numbers[0]));
+  EXPECT_TRUE(std::equal(expected.begin(), expected.end(),
+                         sequence_numbers.begin()));
+}
+
+}  // namespace
+
+TEST(SequenceNumberBitmapTest, InsertAndErase) {
+  SequenceNumberBitmap bitmap;
+  EXPECT_TRUE(bitmap.empty());
+  bitmap.Insert(10);
+  bitmap.Insert(12);
+  bitmap.Insert(12);
+  bitmap.Insert(8);
+  EXPECT_EQ(3u, bitmap.size());
+  EXPECT_EQ(8, bitmap.Oldest());
+  EXPECT_TRUE(bitmap.Contains(10));
+  EXPECT_FALSE(bitmap.Contains(11));
+
+  EXPECT_TRUE(bitmap.Erase(8));
+  EXPECT_FALSE(bitmap.Erase(8));
+  EXPECT_EQ(10, bitmap.Oldest());
+  bitmap.EraseUpTo(11);
+  EXPECT_EQ(1u, bitmap.size());
+  EXPECT_EQ(12, bitmap.Oldest());
+  bitmap.EraseUpTo(9);
+  EXPECT_EQ(1u, bitmap.size());
+  bitmap.Clear();
+  EXPECT_TRUE(bitmap.empty());
+  EXPECT_FALSE(bitmap.Contains(12));
+}
+
+TEST(SequenceNumberBitmapTest, OrdersAcrossWrapAround) {
+  SequenceNumberBitmap bitmap;
+  SequenceNumberSet expected;
+  for (uint16_t i = 65500; i != 100; ++i) {
+    if (i % 3 != 0) {
+      bitmap.Insert(i);
+      expected.insert(i);
+    }
+  }
+  ExpectEqual(expected, bitmap);
+
+  bitmap.EraseUpTo(2);
+  expected.erase(expected.begin(), expected.upper_bound(2));
+  ExpectEqual(expected, bitmap);
+  EXPECT_EQ(4, bitmap.Oldest());
+}
+
+TEST(SequenceNumberBitmapTest, MatchesOrderedSet) {
+  srand(17);
+  SequenceNumberBitmap bitmap;
+  SequenceNumberSet expected;
+  uint16_t latest = 65000;
+  for (int i = 0; i < 20000; ++i) {
+    // Move forward with losses, like the NACK list of a jitter buffer, and
+    // randomly recover packets or give up on old ones.
+    const uint16_t next = latest + 1 + rand() % 4;
+    for (uint16_t seq = latest + 1; seq != next; ++seq) {
+      bitmap.Insert(seq);
+      expected.insert(seq);
+    }
+    latest = next;
+    const uint16_t recovered = latest - rand() % 200;
+    EXPECT_EQ(expected.erase(recovered) == 1, bitmap.Erase(recovered));
+    if (rand() % 10 == 0) {
+      const uint16_t decoded = latest - 100 - rand() % 300;
+      bitmap.EraseUpTo(decoded);
+      expected.erase(expected.begin(), expected.upper_bound(decoded));
+    }
+    ASSERT_NO_FATAL_FAILURE(ExpectEqual(expected, bitmap));
+  }
+}
+
+// Compares building a NACK list of a few hundred sequence numbers from the
+// bitmap and from an ordered set, while packets arrive and are recovered.
+TEST(SequenceNumberBitmapTest, DISABLED_NackListPerf) {
+  const int kNumIterations = 100000;
+  const int kMissingPackets = 250;
+  std::vector<uint16_t> nack_list(kMissingPackets + 4);
+
+  SequenceNumberSet set;
+  SequenceNumberBitmap bitmap;
+  for (int i = 0; i < kMissingPackets; ++i) {
+    set.insert(static_cast<uint16_t>(i * 2));
+    bitmap.Insert(static_cast<uint16_t>(i * 2));
+  }
+
+  uint16_t next = kMissingPackets * 2;
+  int64_t start_us = TickTime::MicrosecondTimestamp();
+  for (int i = 0; i < kNumIterations; ++i) {
+    set.erase(set.begin());
+    set.insert(set.end(), next);
+    size_t n = 0;
+    for (SequenceNumberSet::iterator it = set.begin(); it != set.end(); ++it)
+      nack_list[n++] = *it;
+    next += 2;
+  }
+  const int64_t set_us = TickTime::MicrosecondTimestamp() - start_us;
+
+  next = kMissingPackets * 2;
+  start_us = TickTime::MicrosecondTimestamp();
+  for (int i = 0; i < kNumIterations; ++i) {
+    bitmap.Erase(bitmap.Oldest());
+    bitmap.Insert(next);
+    bitmap.CopyTo(&nack_list[0]);
+    next += 2;
+  }
+  const int64_t bitmap_us = TickTime::MicrosecondTimestamp() - start_us;
+
+  printf("Update and build a NACK list of %d: set %.2f us, bitmap %.2f us\n",
+         kMissingPackets, static_cast<double>(set_us) / kNumIterations,
+         static_cast<double>(bitmap_us) / kNumIterations);
+}
+
+}  // namespace webrtc
@@ -31,6 +31,7 @@ VCMSessionInfo::VCMSessionInfo()
       packets_(),
       empty_seq_num_low_(-1),
       empty_seq_num_high_(-1),
+      bytes_moved_(0),
       first_packet_seq_num_(-1),
       last_packet_seq_num_(-1) {
 }
@@ -101,6 +102,7 @@ void VCMSessionInfo::Reset() {
   packets_.clear();
   empty_seq_num_low_ = -1;
   empty_seq_num_high_ = -1;
+  bytes_moved_ = 0;
   first_packet_seq_num_ = -1;
   last_packet_seq_num_ = -1;
 }
@@ -202,6 +204,7 @@ void VCMSessionInfo::ShiftSubsequentPackets(PacketIterator it,
       (*it).dataPtr += steps_to_shift;
   }
   memmove(first_packet_ptr + steps_to_shift, first_packet_ptr, shift_length);
+  bytes_moved_ += shift_length;
 }
 
 void VCMSessionInfo::UpdateCompleteSession() {
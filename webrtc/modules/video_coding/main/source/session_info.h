@@ -92,6 +92,10 @@ class VCMSessionInfo {
   // them.
   int packets_not_decodable() const;
 
+  // The number of bytes moved within the frame buffer since the last Reset(),
+  // to make room for packets inserted out of order or to remove packets.
+  size_t bytes_moved() const { return bytes_moved_; }
+
  private:
   enum { kMaxVP8Partitions = 9 };
 
@@ -155,6 +159,7 @@ class VCMSessionInfo {
   PacketList packets_;
   int empty_seq_num_low_;
   int empty_seq_num_high_;
+  size_t bytes_moved_;
 
   // The following two variables correspond to the first and last media packets
   // in a session defined by the first packet flag and the marker bit.
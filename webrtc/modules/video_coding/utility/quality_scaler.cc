@@ -90,6 +90,7 @@ const I420VideoFrame& QualityScaler::GetScaledFrame(
   scaled_frame_.set_ntp_time_ms(frame.ntp_time_ms());
   scaled_frame_.set_timestamp(frame.timestamp());
   scaled_frame_.set_render_time_ms(frame.render_time_ms());
+  *scaled_frame_.mutable_timing() = frame.timing();
 
   return scaled_frame_;
 }
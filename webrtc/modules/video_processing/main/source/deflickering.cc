@@ -127,9 +127,12 @@ int32_t VPMDeflickering::ProcessFrame(I420VideoFrame* frame,
       kLog2OfDownsamplingFactor) + 1);
   uint8_t* y_sorted = new uint8_t[y_sub_size];
   uint32_t sort_row_idx = 0;
+  // Read through a const frame, so that a shared buffer is only copied if the
+  // frame is actually written to below.
+  const uint8_t* y_plane =
+      static_cast<const I420VideoFrame*>(frame)->buffer(kYPlane);
   for (int i = 0; i < height; i += kDownsamplingFactor) {
-    memcpy(y_sorted + sort_row_idx * width,
-        frame->buffer(kYPlane) + i * width, width);
+    memcpy(y_sorted + sort_row_idx * width, y_plane + i * width, width);
     sort_row_idx++;
   }
 
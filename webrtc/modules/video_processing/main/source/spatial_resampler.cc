@@ -71,6 +71,7 @@ int32_t VPMSimpleSpatialResampler::ResampleFrame(const I420VideoFrame& inFrame,
   // Timestamp will be reset in Scale call above, so we should set it after.
   outFrame->set_timestamp(inFrame.timestamp());
   outFrame->set_render_time_ms(inFrame.render_time_ms());
+  *outFrame->mutable_timing() = inFrame.timing();
 
   if (ret_val == 0)
     return VPM_OK;
@@ -10,6 +10,7 @@
 
 #include <string.h>
 
+#include <algorithm>
 #include <map>
 #include <vector>
 
@@ -29,6 +30,7 @@
 #include "webrtc/system_wrappers/interface/rw_lock_wrapper.h"
 #include "webrtc/system_wrappers/interface/trace.h"
 #include "webrtc/system_wrappers/interface/trace_event.h"
+#include "webrtc/video/ssrc_demuxer.h"
 #include "webrtc/video/video_receive_stream.h"
 #include "webrtc/video/video_send_stream.h"
 #include "webrtc/video_engine/include/vie_base.h"
@@ -131,6 +133,9 @@ class Call : public webrtc::Call, public PacketReceiver {
   DeliveryStatus DeliverRtcp(const uint8_t* packet, size_t length);
   DeliveryStatus DeliverRtp(const uint8_t* packet, size_t length);
 
+  // Publishes the current SSRC mappings to |demuxer_|.
+  void UpdateDemuxer();
+
   Call::Config config_;
 
   // Needs to be held while write-locking |receive_crit_| or |send_crit_|. This
@@ -148,6 +153,12 @@ class Call : public webrtc::Call, public PacketReceiver {
   std::map<uint32_t, VideoSendStream*> send_ssrcs_ GUARDED_BY(send_crit_);
   std::set<VideoSendStream*> send_streams_ GUARDED_BY(send_crit_);
 
+  // Serializes UpdateDemuxer(). Never taken by packet delivery.
+  rtc::scoped_ptr<CriticalSectionWrapper> demuxer_crit_;
+  // Copy of |receive_ssrcs_| and |send_ssrcs_| used for packet delivery,
+  // which doesn't take |receive_crit_| or |send_crit_|.
+  SsrcDemuxer demuxer_;
+
   rtc::scoped_ptr<CpuOveruseObserverProxy> overuse_observer_proxy_;
 
   VideoSendStream::RtpStateMap suspended_send_ssrcs_;
@@ -182,6 +193,7 @@ Call::Call(webrtc::VideoEngine* video_engine, const Call::Config& config)
       network_enabled_(true),
       receive_crit_(RWLockWrapper::CreateRWLock()),
       send_crit_(RWLockWrapper::CreateRWLock()),
+      demuxer_crit_(CriticalSectionWrapper::CreateCriticalSection()),
       video_engine_(video_engine),
       base_channel_id_(-1),
       external_render_(
@@ -262,17 +274,20 @@ VideoSendStream* Call::CreateVideoSendStream(
       config_.send_transport, overuse_observer_proxy_.get(), video_engine_,
       config, encoder_config, suspended_send_ssrcs_, base_channel_id_);
 
-  // This needs to be taken before send_crit_ as both locks need to be held
-  // while changing network state.
-  CriticalSectionScoped lock(network_enabled_crit_.get());
-  WriteLockScoped write_lock(*send_crit_);
-  send_streams_.insert(send_stream);
-  for (size_t i = 0; i < config.rtp.ssrcs.size(); ++i) {
-    DCHECK(send_ssrcs_.find(config.rtp.ssrcs[i]) == send_ssrcs_.end());
-    send_ssrcs_[config.rtp.ssrcs[i]] = send_stream;
+  {
+    // This needs to be taken before send_crit_ as both locks need to be held
+    // while changing network state.
+    CriticalSectionScoped lock(network_enabled_crit_.get());
+    WriteLockScoped write_lock(*send_crit_);
+    send_streams_.insert(send_stream);
+    for (size_t i = 0; i < config.rtp.ssrcs.size(); ++i) {
+      DCHECK(send_ssrcs_.find(config.rtp.ssrcs[i]) == send_ssrcs_.end());
+      send_ssrcs_[config.rtp.ssrcs[i]] = send_stream;
+    }
+    if (!network_enabled_)
+      send_stream->SignalNetworkState(kNetworkDown);
   }
-  if (!network_enabled_)
-    send_stream->SignalNetworkState(kNetworkDown);
+  UpdateDemuxer();
   return send_stream;
 }
 
@@ -297,6 +312,8 @@ void Call::DestroyVideoSendStream(webrtc::VideoSendStream* send_stream) {
     send_streams_.erase(send_stream_impl);
   }
   CHECK(send_stream_impl != nullptr);
+  // Make sure packet delivery no longer uses the stream before deleting it.
+  UpdateDemuxer();
 
   VideoSendStream::RtpStateMap rtp_state = send_stream_impl->GetRtpStates();
 
@@ -321,21 +338,25 @@ VideoReceiveStream* Call::CreateVideoReceiveStream(
                              config_.voice_engine,
                              base_channel_id_);
 
-  // This needs to be taken before receive_crit_ as both locks need to be held
-  // while changing network state.
-  CriticalSectionScoped lock(network_enabled_crit_.get());
-  WriteLockScoped write_lock(*receive_crit_);
-  DCHECK(receive_ssrcs_.find(config.rtp.remote_ssrc) == receive_ssrcs_.end());
-  receive_ssrcs_[config.rtp.remote_ssrc] = receive_stream;
-  // TODO(pbos): Configure different RTX payloads per receive payload.
-  VideoReceiveStream::Config::Rtp::RtxMap::const_iterator it =
-      config.rtp.rtx.begin();
-  if (it != config.rtp.rtx.end())
-    receive_ssrcs_[it->second.ssrc] = receive_stream;
-  receive_streams_.insert(receive_stream);
-
-  if (!network_enabled_)
-    receive_stream->SignalNetworkState(kNetworkDown);
+  {
+    // This needs to be taken before receive_crit_ as both locks need to be
+    // held while changing network state.
+    CriticalSectionScoped lock(network_enabled_crit_.get());
+    WriteLockScoped write_lock(*receive_crit_);
+    DCHECK(receive_ssrcs_.find(config.rtp.remote_ssrc) ==
+           receive_ssrcs_.end());
+    receive_ssrcs_[config.rtp.remote_ssrc] = receive_stream;
+    // TODO(pbos): Configure different RTX payloads per receive payload.
+    VideoReceiveStream::Config::Rtp::RtxMap::const_iterator it =
+        config.rtp.rtx.begin();
+    if (it != config.rtp.rtx.end())
+      receive_ssrcs_[it->second.ssrc] = receive_stream;
+    receive_streams_.insert(receive_stream);
+
+    if (!network_enabled_)
+      receive_stream->SignalNetworkState(kNetworkDown);
+  }
+  UpdateDemuxer();
   return receive_stream;
 }
 
@@ -364,6 +385,8 @@ void Call::DestroyVideoReceiveStream(
     receive_streams_.erase(receive_stream_impl);
   }
   CHECK(receive_stream_impl != nullptr);
+  // Make sure packet delivery no longer uses the stream before deleting it.
+  UpdateDemuxer();
   delete receive_stream_impl;
 }
 
@@ -439,27 +462,79 @@ void Call::SignalNetworkState(NetworkState state) {
   }
 }
 
-PacketReceiver::DeliveryStatus Call::DeliverRtcp(const uint8_t* packet,
-                                                       size_t length) {
-  // TODO(pbos): Figure out what channel needs it actually.
-  //             Do NOT broadcast! Also make sure it's a valid packet.
-  //             Return DELIVERY_UNKNOWN_SSRC if it can be determined that
-  //             there's no receiver of the packet.
-  bool rtcp_delivered = false;
+void Call::UpdateDemuxer() {
+  // SsrcDemuxer::Update() waits for delivery threads, so it is called without
+  // the stream locks. Holding |demuxer_crit_| across the snapshot and the
+  // update keeps concurrent updates from publishing an older snapshot last.
+  CriticalSectionScoped lock(demuxer_crit_.get());
+  std::map<uint32_t, VideoReceiveStream*> receive_ssrcs;
   {
-    ReadLockScoped read_lock(*receive_crit_);
-    for (VideoReceiveStream* stream : receive_streams_) {
-      if (stream->DeliverRtcp(packet, length))
-        rtcp_delivered = true;
-    }
+    ReadLockScoped receive_lock(*receive_crit_);
+    receive_ssrcs = receive_ssrcs_;
   }
+  std::map<uint32_t, VideoSendStream*> send_ssrcs;
   {
-    ReadLockScoped read_lock(*send_crit_);
-    for (VideoSendStream* stream : send_streams_) {
-      if (stream->DeliverRtcp(packet, length))
-        rtcp_delivered = true;
+    ReadLockScoped send_lock(*send_crit_);
+    send_ssrcs = send_ssrcs_;
+  }
+  demuxer_.Update(receive_ssrcs, send_ssrcs);
+}
+
+PacketReceiver::DeliveryStatus Call::DeliverRtcp(const uint8_t* packet,
+                                                       size_t length) {
+  SsrcDemuxer::ScopedTable table(&demuxer_);
+
+  // Route the packet to the streams owning the SSRCs it references.
+  uint32_t ssrcs[SsrcDemuxer::kMaxRtcpSsrcs];
+  size_t num_ssrcs = 0;
+  if (SsrcDemuxer::ParseRtcpSsrcs(packet, length, ssrcs, &num_ssrcs)) {
+    VideoReceiveStream* receive_streams[SsrcDemuxer::kMaxRtcpSsrcs];
+    size_t num_receive_streams = 0;
+    VideoSendStream* send_streams[SsrcDemuxer::kMaxRtcpSsrcs];
+    size_t num_send_streams = 0;
+    for (size_t i = 0; i < num_ssrcs; ++i) {
+      const SsrcDemuxer::Streams* streams = table->Find(ssrcs[i]);
+      if (streams == nullptr)
+        continue;
+      // Streams with several SSRCs may be referenced more than once.
+      VideoReceiveStream* receive_stream = streams->receive_stream;
+      if (receive_stream != nullptr &&
+          std::find(receive_streams, receive_streams + num_receive_streams,
+                    receive_stream) == receive_streams + num_receive_streams) {
+        receive_streams[num_receive_streams++] = receive_stream;
+      }
+      VideoSendStream* send_stream = streams->send_stream;
+      if (send_stream != nullptr &&
+          std::find(send_streams, send_streams + num_send_streams,
+                    send_stream) == send_streams + num_send_streams) {
+        send_streams[num_send_streams++] = send_stream;
+      }
+    }
+    if (num_receive_streams > 0 || num_send_streams > 0) {
+      bool rtcp_delivered = false;
+      for (size_t i = 0; i < num_receive_streams; ++i) {
+        if (receive_streams[i]->DeliverRtcp(packet, length))
+          rtcp_delivered = true;
+      }
+      for (size_t i = 0; i < num_send_streams; ++i) {
+        if (send_streams[i]->DeliverRtcp(packet, length))
+          rtcp_delivered = true;
+      }
+      return rtcp_delivered ? DELIVERY_OK : DELIVERY_PACKET_ERROR;
     }
   }
+
+  // Packets that can't be routed, e.g. XR packets or packets from unknown
+  // senders, are broadcast to all streams to let their RTCP receivers decide.
+  bool rtcp_delivered = false;
+  for (VideoReceiveStream* stream : table->receive_streams()) {
+    if (stream->DeliverRtcp(packet, length))
+      rtcp_delivered = true;
+  }
+  for (VideoSendStream* stream : table->send_streams()) {
+    if (stream->DeliverRtcp(packet, length))
+      rtcp_delivered = true;
+  }
   return rtcp_delivered ? DELIVERY_OK : DELIVERY_PACKET_ERROR;
 }
 
@@ -471,15 +546,14 @@ PacketReceiver::DeliveryStatus Call::DeliverRtp(const uint8_t* packet,
 
   uint32_t ssrc = ByteReader<uint32_t>::ReadBigEndian(&packet[8]);
 
-  ReadLockScoped read_lock(*receive_crit_);
-  std::map<uint32_t, VideoReceiveStream*>::iterator it =
-      receive_ssrcs_.find(ssrc);
-
-  if (it == receive_ssrcs_.end())
+  SsrcDemuxer::ScopedTable table(&demuxer_);
+  const SsrcDemuxer::Streams* streams = table->Find(ssrc);
+  if (streams == nullptr || streams->receive_stream == nullptr)
     return DELIVERY_UNKNOWN_SSRC;
 
-  return it->second->DeliverRtp(packet, length) ? DELIVERY_OK
-                                                : DELIVERY_PACKET_ERROR;
+  return streams->receive_stream->DeliverRtp(packet, length)
+             ? DELIVERY_OK
+             : DELIVERY_PACKET_ERROR;
 }
 
 PacketReceiver::DeliveryStatus Call::DeliverPacket(const uint8_t* packet,
@@ -797,7 +797,8 @@ TEST_F(EndToEndTest, UsesFrameCallbacks) {
 
       // Previous luma specified, observed luma should be fairly close.
       if (expected_luma_byte_ != -1) {
-        EXPECT_NEAR(expected_luma_byte_, *frame->buffer(kYPlane), 10);
+        const I420VideoFrame& const_frame = *frame;
+        EXPECT_NEAR(expected_luma_byte_, *const_frame.buffer(kYPlane), 10);
       }
 
       memset(frame->buffer(kYPlane),
@@ -108,14 +108,20 @@ void SendStatisticsProxy::OnSendEncodedImage(
   }
   uint32_t ssrc = config_.rtp.ssrcs[simulcast_idx];
 
-  CriticalSectionScoped lock(crit_.get());
-  VideoSendStream::StreamStats* stats = GetStatsEntry(ssrc);
-  if (stats == nullptr)
-    return;
+  {
+    CriticalSectionScoped lock(crit_.get());
+    VideoSendStream::StreamStats* stats = GetStatsEntry(ssrc);
+    if (stats == nullptr)
+      return;
+
+    stats->width = encoded_image._encodedWidth;
+    stats->height = encoded_image._encodedHeight;
+    update_times_[ssrc].resolution_update_ms = clock_->TimeInMilliseconds();
+  }
 
-  stats->width = encoded_image._encodedWidth;
-  stats->height = encoded_image._encodedHeight;
-  update_times_[ssrc].resolution_update_ms = clock_->TimeInMilliseconds();
+  if (config_.frame_timing_observer != nullptr)
+    config_.frame_timing_observer->FrameTimingUpdated(encoded_image.timing_,
+                                                      ssrc);
 }
 
 void SendStatisticsProxy::OnIncomingFrame() {
@@ -364,4 +364,32 @@ TEST_F(SendStatisticsProxyTest, EncodedResolutionTimesOut) {
   EXPECT_EQ(kEncodedHeight, stats.substreams[config_.rtp.ssrcs[1]].height);
 }
 
+TEST_F(SendStatisticsProxyTest, ForwardsFrameTimingPerSubstream) {
+  class TimingObserver : public FrameTimingObserver {
+   public:
+    void FrameTimingUpdated(const FrameTiming& timing,
+                            uint32_t ssrc) override {
+      timings[ssrc] = timing;
+    }
+    std::map<uint32_t, FrameTiming> timings;
+  } observer;
+  VideoSendStream::Config config = GetTestConfig();
+  config.frame_timing_observer = &observer;
+  statistics_proxy_.reset(new SendStatisticsProxy(&fake_clock_, config));
+
+  EncodedImage encoded_image;
+  encoded_image.timing_.capture_ms = 10;
+  encoded_image.timing_.encode_finish_ms = 20;
+  encoded_image.timing_.send_ms = 21;
+  RTPVideoHeader rtp_video_header;
+  rtp_video_header.simulcastIdx = 1;
+  statistics_proxy_->OnSendEncodedImage(encoded_image, &rtp_video_header);
+
+  ASSERT_EQ(1u, observer.timings.size());
+  const FrameTiming& timing = observer.timings[config_.rtp.ssrcs[1]];
+  EXPECT_EQ(10, timing.capture_ms);
+  EXPECT_EQ(20, timing.encode_finish_ms);
+  EXPECT_EQ(21, timing.send_ms);
+}
+
 }  // namespace webrtc
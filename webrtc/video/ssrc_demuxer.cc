@@ -0,0 +1,250 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/video/ssrc_demuxer.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "webrtc/base/checks.h"
+#include "webrtc/base/criticalsection.h"
+#include "webrtc/modules/rtp_rtcp/source/byte_io.h"
+#include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
+#include "webrtc/system_wrappers/interface/event_wrapper.h"
+
+namespace webrtc {
+namespace internal {
+namespace {
+
+const uint8_t kRtcpSr = 200;
+const uint8_t kRtcpRr = 201;
+const uint8_t kRtcpRtpfb = 205;
+const uint8_t kRtcpPsfb = 206;
+const uint8_t kPsfbFir = 4;
+const uint8_t kPsfbApplicationLayer = 15;
+
+const size_t kRtcpHeaderSize = 4;
+const size_t kReportBlockSize = 24;
+const size_t kFirEntrySize = 8;
+
+// Appends |ssrc| to |ssrcs| unless it's already there. Returns false if
+// |ssrcs| is full.
+bool AddSsrc(uint32_t ssrc, uint32_t* ssrcs, size_t* num_ssrcs) {
+  if (std::find(ssrcs, ssrcs + *num_ssrcs, ssrc) != ssrcs + *num_ssrcs)
+    return true;
+  if (*num_ssrcs == SsrcDemuxer::kMaxRtcpSsrcs)
+    return false;
+  ssrcs[(*num_ssrcs)++] = ssrc;
+  return true;
+}
+
+}  // namespace
+
+SsrcDemuxer::Table::Table(
+    const std::map<uint32_t, VideoReceiveStream*>& receive_ssrcs,
+    const std::map<uint32_t, VideoSendStream*>& send_ssrcs) {
+  // Keep the load factor at or below 1/2 to keep probe sequences short.
+  size_t num_ssrcs = receive_ssrcs.size() + send_ssrcs.size();
+  int bits = 3;
+  while ((static_cast<size_t>(1) << bits) < 2 * num_ssrcs)
+    ++bits;
+  shift_ = 32 - bits;
+  mask_ = (static_cast<size_t>(1) << bits) - 1;
+  slots_.reset(new Slot[mask_ + 1]);
+
+  for (const auto& kv : receive_ssrcs) {
+    FindOrInsert(kv.first)->streams.receive_stream = kv.second;
+    if (std::find(receive_streams_.begin(), receive_streams_.end(),
+                  kv.second) == receive_streams_.end()) {
+      receive_streams_.push_back(kv.second);
+    }
+  }
+  for (const auto& kv : send_ssrcs) {
+    FindOrInsert(kv.first)->streams.send_stream = kv.second;
+    if (std::find(send_streams_.begin(), send_streams_.end(), kv.second) ==
+        send_streams_.end()) {
+      send_streams_.push_back(kv.second);
+    }
+  }
+}
+
+SsrcDemuxer::Table::~Table() {}
+
+size_t SsrcDemuxer::Table::SlotIndex(uint32_t ssrc) const {
+  // Fibonacci hashing, taking the well-mixed high bits.
+  return static_cast<size_t>((ssrc * 2654435761u) >> shift_);
+}
+
+SsrcDemuxer::Table::Slot* SsrcDemuxer::Table::FindOrInsert(uint32_t ssrc) {
+  size_t index = SlotIndex(ssrc);
+  while (slots_[index].used && slots_[index].ssrc != ssrc)
+    index = (index + 1) & mask_;
+  slots_[index].used = true;
+  slots_[index].ssrc = ssrc;
+  return &slots_[index];
+}
+
+const SsrcDemuxer::Streams* SsrcDemuxer::Table::Find(uint32_t ssrc) const {
+  // The table is never full, so there is always an unused slot to stop at.
+  for (size_t index = SlotIndex(ssrc); slots_[index].used;
+       index = (index + 1) & mask_) {
+    if (slots_[index].ssrc == ssrc)
+      return &slots_[index].streams;
+  }
+  return nullptr;
+}
+
+SsrcDemuxer::ScopedTable::ScopedTable(SsrcDemuxer* demuxer)
+    : demuxer_(demuxer) {
+  // Register as a reader of the current table, and retry if it was replaced
+  // in the meantime. Once registered on the published table, Update() can't
+  // rebuild it until this scope is gone.
+  while (true) {
+    slot_ = rtc::AtomicOps::Load(&demuxer_->current_);
+    rtc::AtomicOps::Increment(&demuxer_->readers_[slot_]);
+    if (rtc::AtomicOps::Load(&demuxer_->current_) == slot_)
+      break;
+    demuxer_->ReleaseReader(slot_);
+  }
+  table_ = demuxer_->tables_[slot_].get();
+}
+
+SsrcDemuxer::ScopedTable::~ScopedTable() {
+  demuxer_->ReleaseReader(slot_);
+}
+
+SsrcDemuxer::SsrcDemuxer()
+    : update_crit_(CriticalSectionWrapper::CreateCriticalSection()),
+      readers_done_(EventWrapper::Create()),
+      current_(0) {
+  tables_[0].reset(new Table(std::map<uint32_t, VideoReceiveStream*>(),
+                             std::map<uint32_t, VideoSendStream*>()));
+  readers_[0] = 0;
+  readers_[1] = 0;
+}
+
+SsrcDemuxer::~SsrcDemuxer() {
+  DCHECK_EQ(0, readers_[0]);
+  DCHECK_EQ(0, readers_[1]);
+}
+
+void SsrcDemuxer::Update(
+    const std::map<uint32_t, VideoReceiveStream*>& receive_ssrcs,
+    const std::map<uint32_t, VideoSendStream*>& send_ssrcs) {
+  CriticalSectionScoped lock(update_crit_.get());
+  const int current = rtc::AtomicOps::Load(&current_);
+  const int next = 1 - current;
+  // Readers may still be backing off from |next| after it was replaced by the
+  // previous update; they don't touch the table, but wait them out anyway.
+  WaitForReaders(next);
+  tables_[next].reset(new Table(receive_ssrcs, send_ssrcs));
+  // Publish with a full barrier, so that the reader counts loaded below can't
+  // be read before the new table is visible. A reader that registered on the
+  // old table either is counted or sees the new table and backs off.
+  const int replaced =
+      rtc::AtomicOps::CompareAndSwap(&current_, current, next);
+  DCHECK_EQ(current, replaced);
+  WaitForReaders(current);
+}
+
+void SsrcDemuxer::ReleaseReader(int slot) {
+  // The decrement is a full barrier, so |current_| is loaded after it.
+  if (rtc::AtomicOps::Decrement(&readers_[slot]) == 0 &&
+      rtc::AtomicOps::Load(&current_) != slot) {
+    readers_done_->Set();
+  }
+}
+
+void SsrcDemuxer::WaitForReaders(int slot) {
+  // |readers_done_| may still be signaled from an earlier update, so the
+  // count is checked again after every wakeup.
+  while (rtc::AtomicOps::Load(&readers_[slot]) != 0)
+    readers_done_->Wait(WEBRTC_EVENT_INFINITE);
+}
+
+bool SsrcDemuxer::ParseRtcpSsrcs(const uint8_t* packet,
+                                 size_t length,
+                                 uint32_t* ssrcs,
+                                 size_t* num_ssrcs) {
+  *num_ssrcs = 0;
+  if (length < kRtcpHeaderSize)
+    return false;
+  size_t offset = 0;
+  while (offset + kRtcpHeaderSize <= length) {
+    const uint8_t* header = packet + offset;
+    if ((header[0] >> 6) != 2)
+      return false;
+    const uint8_t count_or_format = header[0] & 0x1f;
+    const uint8_t packet_type = header[1];
+    const size_t packet_size =
+        (ByteReader<uint16_t>::ReadBigEndian(&header[2]) + 1) * 4;
+    if (offset + packet_size > length)
+      return false;
+    const uint8_t* payload = header + kRtcpHeaderSize;
+    const size_t payload_size = packet_size - kRtcpHeaderSize;
+
+    if (payload_size >= 4 &&
+        !AddSsrc(ByteReader<uint32_t>::ReadBigEndian(payload), ssrcs,
+                 num_ssrcs)) {
+      return false;
+    }
+
+    if (packet_type == kRtcpSr || packet_type == kRtcpRr) {
+      // Report blocks follow the sender SSRC, and the sender info for SRs.
+      size_t blocks_offset = packet_type == kRtcpSr ? 24 : 4;
+      if (blocks_offset + count_or_format * kReportBlockSize > payload_size)
+        return false;
+      for (uint8_t i = 0; i < count_or_format; ++i) {
+        if (!AddSsrc(ByteReader<uint32_t>::ReadBigEndian(
+                         payload + blocks_offset + i * kReportBlockSize),
+                     ssrcs, num_ssrcs)) {
+          return false;
+        }
+      }
+    } else if (packet_type == kRtcpRtpfb || packet_type == kRtcpPsfb) {
+      if (payload_size < 8)
+        return false;
+      uint32_t media_ssrc = ByteReader<uint32_t>::ReadBigEndian(payload + 4);
+      if (media_ssrc != 0 && !AddSsrc(media_ssrc, ssrcs, num_ssrcs))
+        return false;
+      const uint8_t* fci = payload + 8;
+      const size_t fci_size = payload_size - 8;
+      if (packet_type == kRtcpPsfb && count_or_format == kPsfbFir) {
+        // FIR carries the media SSRCs in its FCI entries.
+        for (size_t i = 0; i + kFirEntrySize <= fci_size;
+             i += kFirEntrySize) {
+          if (!AddSsrc(ByteReader<uint32_t>::ReadBigEndian(fci + i), ssrcs,
+                       num_ssrcs)) {
+            return false;
+          }
+        }
+      } else if (packet_type == kRtcpPsfb &&
+                 count_or_format == kPsfbApplicationLayer && fci_size >= 8 &&
+                 memcmp(fci, "REMB", 4) == 0) {
+        // REMB lists the SSRCs the estimate applies to.
+        const size_t num_remb_ssrcs = fci[4];
+        if (8 + num_remb_ssrcs * 4 > fci_size)
+          return false;
+        for (size_t i = 0; i < num_remb_ssrcs; ++i) {
+          if (!AddSsrc(ByteReader<uint32_t>::ReadBigEndian(fci + 8 + i * 4),
+                       ssrcs, num_ssrcs)) {
+            return false;
+          }
+        }
+      }
+    }
+    offset += packet_size;
+  }
+  return offset == length;
+}
+
+}  // namespace internal
+}  // namespace webrtc
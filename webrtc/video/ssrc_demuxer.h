@@ -0,0 +1,148 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_VIDEO_SSRC_DEMUXER_H_
+#define WEBRTC_VIDEO_SSRC_DEMUXER_H_
+
+#include <map>
+#include <vector>
+
+#include "webrtc/base/constructormagic.h"
+#include "webrtc/base/scoped_ptr.h"
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+
+class CriticalSectionWrapper;
+class EventWrapper;
+
+namespace internal {
+
+class VideoReceiveStream;
+class VideoSendStream;
+
+// Maps SSRCs to the streams of a Call for packet delivery. Delivery threads
+// look up streams without taking any lock: the lookup table is immutable and
+// is rebuilt and republished every time streams are added or removed, and
+// Update() doesn't return until no delivery thread can reach the previous
+// table anymore. Streams removed by Update() can therefore be deleted as soon
+// as it returns. Update() must not be called while holding locks that delivery
+// threads may take, since it waits for them.
+class SsrcDemuxer {
+ public:
+  // Upper bound on the number of SSRCs ParseRtcpSsrcs() extracts.
+  static const size_t kMaxRtcpSsrcs = 32;
+
+  struct Streams {
+    Streams() : receive_stream(nullptr), send_stream(nullptr) {}
+
+    VideoReceiveStream* receive_stream;
+    VideoSendStream* send_stream;
+  };
+
+  // Open-addressing hash table from SSRC to streams.
+  class Table {
+   public:
+    Table(const std::map<uint32_t, VideoReceiveStream*>& receive_ssrcs,
+          const std::map<uint32_t, VideoSendStream*>& send_ssrcs);
+    ~Table();
+
+    // Returns the streams using |ssrc|, or null if there are none.
+    const Streams* Find(uint32_t ssrc) const;
+
+    // All streams, each listed once.
+    const std::vector<VideoReceiveStream*>& receive_streams() const {
+      return receive_streams_;
+    }
+    const std::vector<VideoSendStream*>& send_streams() const {
+      return send_streams_;
+    }
+
+   private:
+    struct Slot {
+      Slot() : used(false), ssrc(0) {}
+
+      bool used;
+      uint32_t ssrc;
+      Streams streams;
+    };
+
+    size_t SlotIndex(uint32_t ssrc) const;
+    Slot* FindOrInsert(uint32_t ssrc);
+
+    int shift_;
+    size_t mask_;
+    rtc::scoped_ptr<Slot[]> slots_;
+    std::vector<VideoReceiveStream*> receive_streams_;
+    std::vector<VideoSendStream*> send_streams_;
+
+    DISALLOW_COPY_AND_ASSIGN(Table);
+  };
+
+  // Gives access to the current table for as long as the scope is alive.
+  // Should be short lived, since it blocks SsrcDemuxer::Update().
+  class ScopedTable {
+   public:
+    explicit ScopedTable(SsrcDemuxer* demuxer);
+    ~ScopedTable();
+
+    const Table* operator->() const { return table_; }
+
+   private:
+    SsrcDemuxer* const demuxer_;
+    int slot_;
+    const Table* table_;
+
+    DISALLOW_COPY_AND_ASSIGN(ScopedTable);
+  };
+
+  SsrcDemuxer();
+  ~SsrcDemuxer();
+
+  // Replaces the table with one built from |receive_ssrcs| and |send_ssrcs|.
+  // Thread safe, but blocks until all ScopedTables using the previous table
+  // are gone.
+  void Update(const std::map<uint32_t, VideoReceiveStream*>& receive_ssrcs,
+              const std::map<uint32_t, VideoSendStream*>& send_ssrcs);
+
+  // Extracts the SSRCs identifying the streams a compound RTCP packet is
+  // meant for: the sender SSRC and the SSRCs of report blocks and feedback
+  // messages, including REMB and FIR. Returns false if the packet couldn't be
+  // parsed or referenced more than kMaxRtcpSsrcs SSRCs.
+  static bool ParseRtcpSsrcs(const uint8_t* packet,
+                             size_t length,
+                             uint32_t* ssrcs,
+                             size_t* num_ssrcs);
+
+ private:
+  // Drops a ScopedTable's registration on |slot|, and wakes up Update() if it
+  // was the last reader of a table that is no longer published.
+  void ReleaseReader(int slot);
+  // Blocks until no ScopedTable is registered on |slot|.
+  void WaitForReaders(int slot);
+
+  // Serializes Update().
+  const rtc::scoped_ptr<CriticalSectionWrapper> update_crit_;
+  // Signaled when the last reader of an unpublished table is gone.
+  const rtc::scoped_ptr<EventWrapper> readers_done_;
+  // Double-buffered tables; |current_| is the index of the published one.
+  // |readers_| counts the ScopedTables using each of them, and a table is
+  // only rebuilt when there are none.
+  rtc::scoped_ptr<Table> tables_[2];
+  volatile int current_;
+  volatile int readers_[2];
+
+  DISALLOW_COPY_AND_ASSIGN(SsrcDemuxer);
+};
+
+}  // namespace internal
+}  // namespace webrtc
+
+#endif  // WEBRTC_VIDEO_SSRC_DEMUXER_H_
@@ -0,0 +1,247 @@
+/*
+ *  Copyright (c) 2015 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/video/ssrc_demuxer.h"
+
+#include <string.h>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/modules/rtp_rtcp/source/byte_io.h"
+#include "webrtc/system_wrappers/interface/event_wrapper.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
+
+namespace webrtc {
+namespace internal {
+namespace {
+
+// The demuxer never dereferences streams, so tests use fake pointers.
+VideoReceiveStream* FakeReceiveStream(int id) {
+  return reinterpret_cast<VideoReceiveStream*>(0x1000 + id * 8);
+}
+
+VideoSendStream* FakeSendStream(int id) {
+  return reinterpret_cast<VideoSendStream*>(0x2000 + id * 8);
+}
+
+// Writes an RTCP header and |sender_ssrc| for a packet of |size| bytes, and
+// returns the size.
+size_t WriteRtcpHeader(uint8_t* buffer,
+                       uint8_t count_or_format,
+                       uint8_t packet_type,
+                       size_t size,
+                       uint32_t sender_ssrc) {
+  buffer[0] = 0x80 | count_or_format;
+  buffer[1] = packet_type;
+  ByteWriter<uint16_t>::WriteBigEndian(&buffer[2],
+                                       static_cast<uint16_t>(size / 4 - 1));
+  ByteWriter<uint32_t>::WriteBigEndian(&buffer[4], sender_ssrc);
+  return size;
+}
+
+}  // namespace
+
+TEST(SsrcDemuxerTest, FindsStreamsBySsrc) {
+  SsrcDemuxer demuxer;
+  std::map<uint32_t, VideoReceiveStream*> receive_ssrcs;
+  std::map<uint32_t, VideoSendStream*> send_ssrcs;
+  for (int i = 0; i < 500; ++i) {
+    receive_ssrcs[1000 + i * 4096] = FakeReceiveStream(i);
+    send_ssrcs[2000 + i] = FakeSendStream(i / 3);
+  }
+  send_ssrcs[1000] = FakeSendStream(1000);
+  demuxer.Update(receive_ssrcs, send_ssrcs);
+
+  SsrcDemuxer::ScopedTable table(&demuxer);
+  for (int i = 0; i < 500; ++i) {
+    const SsrcDemuxer::Streams* streams = table->Find(1000 + i * 4096);
+    ASSERT_TRUE(streams != nullptr);
+    EXPECT_EQ(FakeReceiveStream(i), streams->receive_stream);
+    streams = table->Find(2000 + i);
+    ASSERT_TRUE(streams != nullptr);
+    EXPECT_EQ(FakeSendStream(i / 3), streams->send_stream);
+    EXPECT_TRUE(streams->receive_stream == nullptr);
+  }
+  const SsrcDemuxer::Streams* streams = table->Find(1000);
+  ASSERT_TRUE(streams != nullptr);
+  EXPECT_EQ(FakeReceiveStream(0), streams->receive_stream);
+  EXPECT_EQ(FakeSendStream(1000), streams->send_stream);
+  EXPECT_TRUE(table->Find(3) == nullptr);
+
+  EXPECT_EQ(500u, table->receive_streams().size());
+  EXPECT_EQ(168u, table->send_streams().size());
+}
+
+TEST(SsrcDemuxerTest, UpdateReplacesTable) {
+  SsrcDemuxer demuxer;
+  {
+    SsrcDemuxer::ScopedTable table(&demuxer);
+    EXPECT_TRUE(table->Find(1) == nullptr);
+    EXPECT_TRUE(table->receive_streams().empty());
+  }
+  std::map<uint32_t, VideoReceiveStream*> receive_ssrcs;
+  std::map<uint32_t, VideoSendStream*> send_ssrcs;
+  receive_ssrcs[1] = FakeReceiveStream(1);
+  for (int i = 0; i < 3; ++i) {
+    demuxer.Update(receive_ssrcs, send_ssrcs);
+    SsrcDemuxer::ScopedTable table(&demuxer);
+    ASSERT_TRUE(table->Find(1) != nullptr);
+    EXPECT_EQ(FakeReceiveStream(1), table->Find(1)->receive_stream);
+  }
+  receive_ssrcs.clear();
+  demuxer.Update(receive_ssrcs, send_ssrcs);
+  SsrcDemuxer::ScopedTable table(&demuxer);
+  EXPECT_TRUE(table->Find(1) == nullptr);
+}
+
+namespace {
+
+// Calls SsrcDemuxer::Update() once on its own thread.
+class UpdateThread {
+ public:
+  explicit UpdateThread(SsrcDemuxer* demuxer)
+      : demuxer_(demuxer),
+        done_(EventWrapper::Create()),
+        thread_(ThreadWrapper::CreateThread(Run, this, "update")) {
+    receive_ssrcs_[2] = FakeReceiveStream(2);
+    EXPECT_TRUE(thread_->Start());
+  }
+  ~UpdateThread() { EXPECT_TRUE(thread_->Stop()); }
+
+  EventWrapper* done() { return done_.get(); }
+
+ private:
+  static bool Run(void* obj) {
+    UpdateThread* self = static_cast<UpdateThread*>(obj);
+    self->demuxer_->Update(self->receive_ssrcs_,
+                           std::map<uint32_t, VideoSendStream*>());
+    self->done_->Set();
+    return false;
+  }
+
+  SsrcDemuxer* const demuxer_;
+  std::map<uint32_t, VideoReceiveStream*> receive_ssrcs_;
+  const rtc::scoped_ptr<EventWrapper> done_;
+  const rtc::scoped_ptr<ThreadWrapper> thread_;
+};
+
+// Keeps looking up an SSRC until destroyed.
+class LookupThread {
+ public:
+  explicit LookupThread(SsrcDemuxer* demuxer)
+      : demuxer_(demuxer),
+        thread_(ThreadWrapper::CreateThread(Run, this, "lookup")) {
+    EXPECT_TRUE(thread_->Start());
+  }
+  ~LookupThread() { EXPECT_TRUE(thread_->Stop()); }
+
+ private:
+  static bool Run(void* obj) {
+    LookupThread* self = static_cast<LookupThread*>(obj);
+    SsrcDemuxer::ScopedTable table(self->demuxer_);
+    const SsrcDemuxer::Streams* streams = table->Find(1);
+    EXPECT_TRUE(streams == nullptr ||
+                streams->receive_stream == FakeReceiveStream(1));
+    return true;
+  }
+
+  SsrcDemuxer* const demuxer_;
+  const rtc::scoped_ptr<ThreadWrapper> thread_;
+};
+
+}  // namespace
+
+TEST(SsrcDemuxerTest, UpdateWaitsForReadersOfReplacedTable) {
+  SsrcDemuxer demuxer;
+  rtc::scoped_ptr<SsrcDemuxer::ScopedTable> table(
+      new SsrcDemuxer::ScopedTable(&demuxer));
+  UpdateThread update(&demuxer);
+  EXPECT_EQ(kEventTimeout, update.done()->Wait(100));
+  EXPECT_TRUE((*table)->Find(2) == nullptr);
+  table.reset();
+  EXPECT_EQ(kEventSignaled, update.done()->Wait(10000));
+  SsrcDemuxer::ScopedTable new_table(&demuxer);
+  ASSERT_TRUE(new_table->Find(2) != nullptr);
+}
+
+TEST(SsrcDemuxerTest, UpdatesWhileLookingUp) {
+  SsrcDemuxer demuxer;
+  std::map<uint32_t, VideoReceiveStream*> receive_ssrcs;
+  std::map<uint32_t, VideoSendStream*> send_ssrcs;
+  LookupThread lookup1(&demuxer);
+  LookupThread lookup2(&demuxer);
+  for (int i = 0; i < 1000; ++i) {
+    if (i % 2 == 0)
+      receive_ssrcs[1] = FakeReceiveStream(1);
+    else
+      receive_ssrcs.clear();
+    demuxer.Update(receive_ssrcs, send_ssrcs);
+  }
+}
+
+TEST(SsrcDemuxerTest, ParsesCompoundRtcp) {
+  uint8_t packet[200];
+  memset(packet, 0, sizeof(packet));
+  size_t length = 0;
+
+  // RR with two report blocks.
+  length += WriteRtcpHeader(&packet[length], 2, 201, 8 + 2 * 24, 1);
+  ByteWriter<uint32_t>::WriteBigEndian(&packet[8], 2);
+  ByteWriter<uint32_t>::WriteBigEndian(&packet[8 + 24], 3);
+  // Generic NACK.
+  ByteWriter<uint32_t>::WriteBigEndian(&packet[length + 8], 4);
+  length += WriteRtcpHeader(&packet[length], 1, 205, 16, 1);
+  // REMB for two SSRCs.
+  uint8_t* remb = &packet[length];
+  length += WriteRtcpHeader(remb, 15, 206, 28, 1);
+  memcpy(&remb[12], "REMB", 4);
+  remb[16] = 2;
+  ByteWriter<uint32_t>::WriteBigEndian(&remb[20], 5);
+  ByteWriter<uint32_t>::WriteBigEndian(&remb[24], 2);
+  // FIR.
+  uint8_t* fir = &packet[length];
+  length += WriteRtcpHeader(fir, 4, 206, 20, 1);
+  ByteWriter<uint32_t>::WriteBigEndian(&fir[12], 6);
+
+  uint32_t ssrcs[SsrcDemuxer::kMaxRtcpSsrcs];
+  size_t num_ssrcs = 0;
+  ASSERT_TRUE(SsrcDemuxer::ParseRtcpSsrcs(packet, length, ssrcs, &num_ssrcs));
+  ASSERT_EQ(6u, num_ssrcs);
+  for (size_t i = 0; i < num_ssrcs; ++i)
+    EXPECT_EQ(i + 1, ssrcs[i]);
+
+  // Truncated packets and packets with a bad version are rejected.
+  EXPECT_FALSE(
+      SsrcDemuxer::ParseRtcpSsrcs(packet, length - 4, ssrcs, &num_ssrcs));
+  packet[0] = 0x40;
+  EXPECT_FALSE(SsrcDemuxer::ParseRtcpSsrcs(packet, length, ssrcs, &num_ssrcs));
+}
+
+TEST(SsrcDemuxerTest, RejectsPacketsWithTooManySsrcs) {
+  uint8_t packet[8 + 31 * 24 + 8 + 31 * 24];
+  memset(packet, 0, sizeof(packet));
+  size_t length = 0;
+  for (uint32_t ssrc = 1; length < sizeof(packet); ssrc += 32) {
+    uint8_t* rr = &packet[length];
+    length += WriteRtcpHeader(rr, 31, 201, 8 + 31 * 24, ssrc);
+    for (uint32_t i = 0; i < 31; ++i)
+      ByteWriter<uint32_t>::WriteBigEndian(&rr[8 + i * 24], ssrc + 1 + i);
+  }
+
+  uint32_t ssrcs[SsrcDemuxer::kMaxRtcpSsrcs];
+  size_t num_ssrcs = 0;
+  EXPECT_TRUE(SsrcDemuxer::ParseRtcpSsrcs(packet, sizeof(packet) / 2, ssrcs,
+                                          &num_ssrcs));
+  EXPECT_EQ(32u, num_ssrcs);
+  EXPECT_FALSE(
+      SsrcDemuxer::ParseRtcpSsrcs(packet, sizeof(packet), ssrcs, &num_ssrcs));
+}
+
+}  // namespace internal
+}  // namespace webrtc
@@ -18,6 +18,7 @@
 #include "webrtc/common_video/libyuv/include/webrtc_libyuv.h"
 #include "webrtc/system_wrappers/interface/clock.h"
 #include "webrtc/system_wrappers/interface/logging.h"
+#include "webrtc/system_wrappers/interface/trace_event.h"
 #include "webrtc/video/receive_statistics_proxy.h"
 #include "webrtc/video_encoder.h"
 #include "webrtc/video_engine/include/vie_base.h"
@@ -60,6 +61,9 @@ std::string VideoReceiveStream::Config::ToString() const {
      << (pre_decode_callback != nullptr ? "(EncodedFrameObserver)" : "nullptr");
   ss << ", pre_render_callback: "
      << (pre_render_callback != nullptr ? "(I420FrameCallback)" : "nullptr");
+  ss << ", frame_timing_observer: "
+     << (frame_timing_observer != nullptr ? "(FrameTimingObserver)"
+                                          : "nullptr");
   ss << ", target_delay_ms: " << target_delay_ms;
   ss << '}';
 
@@ -331,13 +335,24 @@ int VideoReceiveStream::DeliverFrame(unsigned char* buffer,
 }
 
 int VideoReceiveStream::DeliverI420Frame(const I420VideoFrame& video_frame) {
+  int64_t now_ms = clock_->TimeInMilliseconds();
   if (config_.renderer != nullptr)
-    config_.renderer->RenderFrame(
-        video_frame,
-        video_frame.render_time_ms() - clock_->TimeInMilliseconds());
+    config_.renderer->RenderFrame(video_frame,
+                                  video_frame.render_time_ms() - now_ms);
 
   stats_proxy_->OnRenderedFrame();
 
+  FrameTiming timing = video_frame.timing();
+  timing.render_ms = now_ms;
+  TRACE_EVENT_INSTANT2("webrtc", "VideoReceiveStream::RenderFrame",
+                       "timestamp", video_frame.timestamp(),
+                       "receive_to_render_ms",
+                       timing.render_ms - timing.receive_ms);
+  if (config_.frame_timing_observer != nullptr) {
+    config_.frame_timing_observer->FrameTimingUpdated(timing,
+                                                      config_.rtp.remote_ssrc);
+  }
+
   return 0;
 }
 
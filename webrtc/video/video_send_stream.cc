@@ -91,6 +91,9 @@ std::string VideoSendStream::Config::ToString() const {
   ss << ", post_encode_callback: " << (post_encode_callback != nullptr
                                            ? "(EncodedFrameObserver)"
                                            : "nullptr");
+  ss << ", frame_timing_observer: "
+     << (frame_timing_observer != nullptr ? "(FrameTimingObserver)"
+                                          : "nullptr");
   ss << "local_renderer: " << (local_renderer != nullptr ? "(VideoRenderer)"
                                                          : "nullptr");
   ss << ", render_delay_ms: " << render_delay_ms;
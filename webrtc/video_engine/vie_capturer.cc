@@ -284,6 +284,11 @@ void ViECapturer::GetCpuOveruseMetrics(CpuOveruseMetrics* metrics) const {
   *metrics = cpu_overuse_metrics_observer_->GetCpuOveruseMetrics();
 }
 
+FrameCopyStats ViECapturer::GetFrameCopyStats() const {
+  CriticalSectionScoped cs(effects_and_stats_cs_.get());
+  return frame_copy_stats_;
+}
+
 int32_t ViECapturer::SetCaptureDelay(int32_t delay_ms) {
   if (use_external_capture_)
     return -1;
@@ -305,6 +310,8 @@ void ViECapturer::OnIncomingCapturedFrame(const int32_t capture_id,
                                           const I420VideoFrame& video_frame) {
   CriticalSectionScoped cs(capture_cs_.get());
   captured_frame_.ShallowCopy(video_frame);
+  captured_frame_.mutable_timing()->capture_ms =
+      TickTime::MillisecondTimestamp();
 
   if (captured_frame_.ntp_time_ms() != 0) {
     // If a ntp time stamp is set, this is the time stamp we will use.
@@ -454,6 +461,7 @@ bool ViECapturer::ViECaptureProcess() {
     if (!deliver_frame.IsZeroSize()) {
       capture_time = deliver_frame.render_time_ms();
       encode_start_time = Clock::GetRealTimeClock()->TimeInMilliseconds();
+      deliver_frame.mutable_timing()->deliver_ms = encode_start_time;
       DeliverI420Frame(&deliver_frame);
     }
     if (current_brightness_level_ != reported_brightness_level_) {
@@ -485,10 +493,19 @@ void ViECapturer::DeliverI420Frame(I420VideoFrame* video_frame) {
   // Apply image enhancement and effect filter.
   {
     CriticalSectionScoped cs(effects_and_stats_cs_.get());
+    ++frame_copy_stats_.frames;
     if (deflicker_frame_stats_) {
       if (image_proc_module_->GetFrameStats(deflicker_frame_stats_,
                                             *video_frame) == 0) {
+        // The capture module may still share the buffer, in which case the
+        // frame gets its own copy when it is written to.
+        const VideoFrameBuffer* buffer =
+            video_frame->video_frame_buffer().get();
         image_proc_module_->Deflickering(video_frame, deflicker_frame_stats_);
+        if (video_frame->video_frame_buffer().get() != buffer) {
+          frame_copy_stats_.bytes_copied += CalcBufferSize(
+              kI420, video_frame->width(), video_frame->height());
+        }
       } else {
         LOG_F(LS_ERROR) << "Could not get frame stats.";
       }
@@ -519,6 +536,7 @@ void ViECapturer::DeliverI420Frame(I420VideoFrame* video_frame) {
           CalcBufferSize(kI420, video_frame->width(), video_frame->height());
       rtc::scoped_ptr<uint8_t[]> video_buffer(new uint8_t[length]);
       ExtractBuffer(*video_frame, length, video_buffer.get());
+      frame_copy_stats_.bytes_copied += length;
       effect_filter_->Transform(length,
                                 video_buffer.get(),
                                 video_frame->ntp_time_ms(),
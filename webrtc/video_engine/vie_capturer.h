@@ -101,6 +101,10 @@ class ViECapturer
   void RegisterCpuOveruseMetricsObserver(CpuOveruseMetricsObserver* observer);
   void GetCpuOveruseMetrics(CpuOveruseMetrics* metrics) const;
 
+  // I420 frames delivered to the frame callbacks and the bytes copied by
+  // deflickering and the effect filter on their way.
+  FrameCopyStats GetFrameCopyStats() const;
+
  protected:
   ViECapturer(int capture_id,
               int engine_id,
@@ -173,6 +177,7 @@ class ViECapturer
       GUARDED_BY(effects_and_stats_cs_.get());
   VideoProcessingModule::FrameStats* brightness_frame_stats_
       GUARDED_BY(effects_and_stats_cs_.get());
+  FrameCopyStats frame_copy_stats_ GUARDED_BY(effects_and_stats_cs_.get());
   Brightness current_brightness_level_;
   Brightness reported_brightness_level_;
 
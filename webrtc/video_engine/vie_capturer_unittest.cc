@@ -18,12 +18,14 @@
 #include "testing/gtest/include/gtest/gtest.h"
 #include "webrtc/base/scoped_ptr.h"
 #include "webrtc/common.h"
+#include "webrtc/common_video/libyuv/include/webrtc_libyuv.h"
 #include "webrtc/modules/utility/interface/mock/mock_process_thread.h"
 #include "webrtc/modules/video_capture/include/mock/mock_video_capture.h"
 #include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
 #include "webrtc/system_wrappers/interface/event_wrapper.h"
 #include "webrtc/system_wrappers/interface/ref_count.h"
 #include "webrtc/system_wrappers/interface/scoped_vector.h"
+#include "webrtc/video_engine/include/vie_image_process.h"
 #include "webrtc/video_engine/mock/mock_vie_frame_provider_base.h"
 
 using ::testing::_;
@@ -234,6 +236,44 @@ TEST_F(ViECapturerTest, TestTextureFrameAfterI420Frame) {
   EXPECT_TRUE(EqualFramesVector(input_frames_, output_frames_));
 }
 
+TEST_F(ViECapturerTest, CountsBytesCopiedPerFrame) {
+  class NullEffectFilter : public ViEEffectFilter {
+   public:
+    int Transform(size_t size,
+                  unsigned char* frame_buffer,
+                  int64_t ntp_time_ms,
+                  unsigned int timestamp,
+                  unsigned int width,
+                  unsigned int height) override {
+      return 0;
+    }
+  } effect_filter;
+
+  // Frames are passed on without being copied.
+  input_frames_.push_back(CreateI420VideoFrame(1));
+  AddInputFrame(input_frames_[0]);
+  WaitOutputFrame();
+  FrameCopyStats stats = vie_capturer_->GetFrameCopyStats();
+  EXPECT_EQ(1u, stats.frames);
+  EXPECT_EQ(0u, stats.bytes_copied);
+
+  // The effect filter gets a packed copy of every frame.
+  EXPECT_EQ(0, vie_capturer_->RegisterEffectFilter(&effect_filter));
+  input_frames_.push_back(CreateI420VideoFrame(2));
+  AddInputFrame(input_frames_[1]);
+  WaitOutputFrame();
+  stats = vie_capturer_->GetFrameCopyStats();
+  EXPECT_EQ(2u, stats.frames);
+  EXPECT_EQ(CalcBufferSize(kI420, input_frames_[1]->width(),
+                           input_frames_[1]->height()),
+            stats.bytes_copied);
+  EXPECT_EQ(0, vie_capturer_->RegisterEffectFilter(NULL));
+
+  // The delivered frames still share the buffers of the input frames.
+  const I420VideoFrame* const_input_frame = input_frames_[1];
+  EXPECT_EQ(const_input_frame->buffer(kYPlane), output_frame_ybuffers_[1]);
+}
+
 bool EqualFrames(const I420VideoFrame& frame1,
                  const I420VideoFrame& frame2) {
   if (frame1.native_handle() != NULL || frame2.native_handle() != NULL)
@@ -523,11 +523,13 @@ void ViEEncoder::DeliverFrame(int id,
   if (video_frame.native_handle() == NULL) {
     {
       CriticalSectionScoped cs(callback_cs_.get());
+      ++frame_copy_stats_.frames;
       if (effect_filter_) {
         size_t length =
             CalcBufferSize(kI420, video_frame.width(), video_frame.height());
         rtc::scoped_ptr<uint8_t[]> video_buffer(new uint8_t[length]);
         ExtractBuffer(video_frame, length, video_buffer.get());
+        frame_copy_stats_.bytes_copied += length;
         effect_filter_->Transform(length,
                                   video_buffer.get(),
                                   video_frame.ntp_time_ms(),
@@ -548,18 +550,27 @@ void ViEEncoder::DeliverFrame(int id,
     }
   }
 
-  // If we haven't resampled the frame and we have a FrameCallback, we need to
-  // make a deep copy of |video_frame|.
+  // If we haven't resampled the frame and we have a FrameCallback, it gets a
+  // frame sharing the buffer of |video_frame|. The buffer is only copied if
+  // the callback asks for write access through the non-const buffer().
   I420VideoFrame copied_frame;
   {
     CriticalSectionScoped cs(callback_cs_.get());
     if (pre_encode_callback_) {
       // If the frame was not resampled or scaled => use copy of original.
       if (decimated_frame == NULL) {
-        copied_frame.CopyFrame(video_frame);
+        copied_frame.ShallowCopy(video_frame);
         decimated_frame = &copied_frame;
       }
+      // Not holding a reference, which would itself make a write copy.
+      const VideoFrameBuffer* buffer =
+          decimated_frame->video_frame_buffer().get();
       pre_encode_callback_->FrameCallback(decimated_frame);
+      if (decimated_frame->video_frame_buffer().get() != buffer &&
+          decimated_frame->native_handle() == NULL) {
+        frame_copy_stats_.bytes_copied += CalcBufferSize(
+            kI420, decimated_frame->width(), decimated_frame->height());
+      }
     }
   }
 
@@ -637,6 +648,11 @@ uint32_t ViEEncoder::LastObservedBitrateBps() const {
   return last_observed_bitrate_bps_;
 }
 
+FrameCopyStats ViEEncoder::GetFrameCopyStats() const {
+  CriticalSectionScoped cs(callback_cs_.get());
+  return frame_copy_stats_;
+}
+
 int ViEEncoder::CodecTargetBitrate(uint32_t* bitrate) const {
   if (vcm_->Bitrate(bitrate) != 0)
     return -1;
@@ -712,15 +728,24 @@ int32_t ViEEncoder::SendData(
     const RTPVideoHeader* rtp_video_hdr) {
   DCHECK(send_payload_router_ != NULL);
 
+  int64_t now_ms = TickTime::MillisecondTimestamp();
   {
     CriticalSectionScoped cs(data_cs_.get());
-    time_of_last_frame_activity_ms_ = TickTime::MillisecondTimestamp();
+    time_of_last_frame_activity_ms_ = now_ms;
   }
 
+  // Only the metadata is copied, to stamp the last stage of the send side.
+  EncodedImage timed_image(encoded_image);
+  timed_image.timing_.send_ms = now_ms;
+  TRACE_EVENT_ASYNC_STEP1(
+      "webrtc", "Video", encoded_image.capture_time_ms_, "SendData",
+      "encode_ms", encoded_image.timing_.encode_finish_ms -
+                       encoded_image.timing_.encode_start_ms);
+
   {
     CriticalSectionScoped cs(callback_cs_.get());
     if (send_statistics_proxy_ != NULL)
-      send_statistics_proxy_->OnSendEncodedImage(encoded_image, rtp_video_hdr);
+      send_statistics_proxy_->OnSendEncodedImage(timed_image, rtp_video_hdr);
   }
 
   return send_payload_router_->RoutePayload(
@@ -119,6 +119,8 @@ class ViEEncoder
                               uint32_t* num_delta_frames);
 
   uint32_t LastObservedBitrateBps() const;
+  // Frames delivered for encoding and the bytes copied preparing them.
+  FrameCopyStats GetFrameCopyStats() const;
   int CodecTargetBitrate(uint32_t* bitrate) const;
   // Loss protection.
   int32_t UpdateProtectionMethod(bool nack, bool fec);
@@ -239,6 +241,7 @@ class ViEEncoder
 
   bool video_suspended_ GUARDED_BY(data_cs_);
   I420FrameCallback* pre_encode_callback_ GUARDED_BY(callback_cs_);
+  FrameCopyStats frame_copy_stats_ GUARDED_BY(callback_cs_);
   const int64_t start_ms_;
 
   SendStatisticsProxy* send_statistics_proxy_ GUARDED_BY(callback_cs_);
@@ -24,6 +24,15 @@ class CriticalSectionWrapper;
 class VideoEncoder;
 class I420VideoFrame;
 
+// Frames handled by a stage of the frame fan-out and the bytes of pixel data
+// it copied while doing so. Frames are shared between the consumers, and only
+// copied when one of them has to modify the pixels.
+struct FrameCopyStats {
+  FrameCopyStats() : frames(0), bytes_copied(0) {}
+  uint32_t frames;
+  uint64_t bytes_copied;
+};
+
 // ViEFrameCallback shall be implemented by all classes receiving frames from a
 // frame provider.
 class ViEFrameCallback {
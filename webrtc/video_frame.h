@@ -12,6 +12,7 @@
 #define WEBRTC_VIDEO_FRAME_H_
 
 #include "webrtc/base/scoped_ref_ptr.h"
+#include "webrtc/common_types.h"
 #include "webrtc/common_video/interface/video_frame_buffer.h"
 #include "webrtc/common_video/rotation.h"
 #include "webrtc/typedefs.h"
@@ -91,7 +92,11 @@ class I420VideoFrame {
   // Release frame buffer and reset time stamps.
   void Reset();
 
-  // Get pointer to buffer per plane.
+  // Get pointer to buffer per plane for writing. If the buffer is shared with
+  // other frames, e.g. after ShallowCopy(), it is first copied so that writes
+  // to this frame are not seen by the others. Callers that only read must use
+  // the const version, even when they hold a non-const frame, or they pay for
+  // a copy of the whole frame.
   uint8_t* buffer(PlaneType type);
   // Overloading with const.
   const uint8_t* buffer(PlaneType type) const;
@@ -145,6 +150,12 @@ class I420VideoFrame {
   // Get render time in miliseconds.
   int64_t render_time_ms() const { return render_time_ms_; }
 
+  // Get the times at which the frame passed the stages of the pipeline.
+  const FrameTiming& timing() const { return timing_; }
+
+  // Get the stage times for stamping.
+  FrameTiming* mutable_timing() { return &timing_; }
+
   // Return true if underlying plane buffers are of zero size, false if not.
   bool IsZeroSize() const;
 
@@ -167,6 +178,7 @@ class I420VideoFrame {
   int64_t ntp_time_ms_;
   int64_t render_time_ms_;
   VideoRotation rotation_;
+  FrameTiming timing_;
 };
 
 enum VideoFrameType {
@@ -190,6 +202,8 @@ class EncodedImage {
   // NTP time of the capture time in local timebase in milliseconds.
   int64_t ntp_time_ms_ = 0;
   int64_t capture_time_ms_ = 0;
+  // Times at which the frame passed the stages of the pipeline.
+  FrameTiming timing_;
   // TODO(pbos): Use webrtc::FrameType directly (and remove VideoFrameType).
   VideoFrameType _frameType = kDeltaFrame;
   uint8_t* _buffer;
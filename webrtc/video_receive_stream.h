@@ -96,6 +96,7 @@ class VideoReceiveStream {
           audio_channel_id(-1),
           pre_decode_callback(NULL),
           pre_render_callback(NULL),
+          frame_timing_observer(NULL),
           target_delay_ms(0) {}
     std::string ToString() const;
 
@@ -181,6 +182,10 @@ class VideoReceiveStream {
     // stream. 'NULL' disables the callback.
     I420FrameCallback* pre_render_callback;
 
+    // Called with the stage times of each decoded frame when it is handed to
+    // the renderer. 'NULL' disables the callback.
+    FrameTimingObserver* frame_timing_observer;
+
     // Target delay in milliseconds. A positive value indicates this stream is
     // used for streaming instead of a real-time call.
     int target_delay_ms;
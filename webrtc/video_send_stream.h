@@ -74,6 +74,7 @@ class VideoSendStream {
     Config()
         : pre_encode_callback(NULL),
           post_encode_callback(NULL),
+          frame_timing_observer(NULL),
           local_renderer(NULL),
           render_delay_ms(0),
           target_delay_ms(0),
@@ -136,6 +137,10 @@ class VideoSendStream {
     // disables the callback.
     EncodedFrameObserver* post_encode_callback;
 
+    // Called with the stage times of each encoded frame when it is handed to
+    // the RTP modules. 'NULL' disables the callback.
+    FrameTimingObserver* frame_timing_observer;
+
     // Renderer for local preview. The local renderer will be called even if
     // sending hasn't started. 'NULL' disables local rendering.
     VideoRenderer* local_renderer;
@@ -42,6 +42,30 @@
 namespace webrtc {
 namespace voe {
 
+namespace {
+
+// The RTP timestamp rate of the send codec, which for G.722 differs from its
+// sample rate for historical reasons.
+int RtpTimestampRateHz(const CodecInst& codec) {
+  return STR_CASE_CMP(codec.plname, "G722") == 0 ? 8000 : codec.plfreq;
+}
+
+// Returns true if the payloads of |codec| depend only on the audio it is
+// given, so that one encoder can serve several channels. Excluded are codecs
+// whose encoder adapts to its channel: iSAC, which carries the bandwidth
+// estimate of the channel's own decoder in-band and adapts its rate to it,
+// and Opus, which adapts to the channel's packet loss rate.
+bool EncoderIsIndependentOfChannel(const CodecInst& codec) {
+  const char* const kCodecs[] = {"PCMU", "PCMA", "L16", "G722", "ILBC"};
+  for (size_t i = 0; i < sizeof(kCodecs) / sizeof(kCodecs[0]); ++i) {
+    if (STR_CASE_CMP(codec.plname, kCodecs[i]) == 0)
+      return true;
+  }
+  return false;
+}
+
+}  // namespace
+
 // Extend the default RTCP statistics struct with max_jitter, defined as the
 // maximum jitter value seen in an RTCP report block.
 struct ChannelStatistics : public RtcpStatistics {
@@ -185,23 +209,62 @@ Channel::SendData(FrameType frameType,
         _engineStatisticsPtr->SetLastError(
             VE_RTP_RTCP_MODULE_ERROR, kTraceWarning,
             "Channel::SendData() failed to send data to RTP/RTCP module");
+        // A failure on this channel must not stop the channels sharing its
+        // encoder.
+        SendToSharedEncoderFollowers(frameType, payloadType, timeStamp,
+                                     payloadData, payloadSize, fragmentation);
         return -1;
     }
 
     _lastLocalTimeStamp = timeStamp;
     _lastPayloadType = payloadType;
 
+    SendToSharedEncoderFollowers(frameType, payloadType, timeStamp,
+                                 payloadData, payloadSize, fragmentation);
     return 0;
 }
 
+void
+Channel::SendToSharedEncoderFollowers(
+    FrameType frameType,
+    uint8_t payloadType,
+    uint32_t timeStamp,
+    const uint8_t* payloadData,
+    size_t payloadSize,
+    const RTPFragmentationHeader* fragmentation)
+{
+    if (shared_encoder_followers_ == NULL)
+    {
+        return;
+    }
+    for (size_t i = 0; i < shared_encoder_followers_->size(); ++i)
+    {
+        Channel* follower = (*shared_encoder_followers_)[i];
+        const uint32_t follower_time_stamp =
+            timeStamp + follower->shared_encoder_timestamp_offset_;
+        follower->SendData(frameType, payloadType, follower_time_stamp,
+                           payloadData, payloadSize, fragmentation);
+    }
+}
+
 int32_t
 Channel::InFrameType(FrameType frame_type)
 {
     WEBRTC_TRACE(kTraceInfo, kTraceVoice, VoEId(_instanceId,_channelId),
                  "Channel::InFrameType(frame_type=%d)", frame_type);
 
-    CriticalSectionScoped cs(&_callbackCritSect);
-    _sendFrameType = (frame_type == kAudioFrameSpeech);
+    {
+        CriticalSectionScoped cs(&_callbackCritSect);
+        _sendFrameType = (frame_type == kAudioFrameSpeech);
+    }
+
+    if (shared_encoder_followers_ != NULL)
+    {
+        for (size_t i = 0; i < shared_encoder_followers_->size(); ++i)
+        {
+            (*shared_encoder_followers_)[i]->InFrameType(frame_type);
+        }
+    }
     return 0;
 }
 
@@ -778,6 +841,10 @@ Channel::Channel(int32_t channelId,
     _inputExternalMediaCallbackPtr(NULL),
     _outputExternalMediaCallbackPtr(NULL),
     _timeStamp(0), // This is just an offset, RTP module will add it's own random offset
+    audio_frame_is_shareable_(false),
+    shared_encoder_followers_(NULL),
+    shared_encoder_timestamp_offset_(0),
+    shared_encoder_idle_(false),
     _sendTelephoneEventPayloadType(106),
     ntp_estimator_(Clock::GetRealTimeClock()),
     jitter_buffer_playout_timestamp_(0),
@@ -3511,7 +3578,8 @@ Channel::PrepareEncodeAndSend(int mixingFrequency)
         return 0xFFFFFFFF;
     }
 
-    if (channel_state_.Get().input_file_playing)
+    ChannelState::State state = channel_state_.Get();
+    if (state.input_file_playing)
     {
         MixOrReplaceAudioWithFile(mixingFrequency);
     }
@@ -3521,7 +3589,7 @@ Channel::PrepareEncodeAndSend(int mixingFrequency)
       AudioFrameOperations::Mute(_audioFrame);
     }
 
-    if (channel_state_.Get().input_external_media)
+    if (state.input_external_media)
     {
         CriticalSectionScoped cs(&_callbackCritSect);
         const bool isStereo = (_audioFrame.num_channels_ == 2);
@@ -3537,7 +3605,16 @@ Channel::PrepareEncodeAndSend(int mixingFrequency)
         }
     }
 
+    // The last segment of a tone leaves the generator idle, so look for tones
+    // both before and after inserting them.
+    bool dtmf_active = _inbandDtmfGenerator.IsAddingTone() ||
+        _inbandDtmfQueue.PendingDtmf();
     InsertInbandDtmfTone();
+    dtmf_active = dtmf_active || _inbandDtmfGenerator.IsAddingTone() ||
+        _inbandDtmfQueue.PendingDtmf();
+
+    audio_frame_is_shareable_ = !state.input_file_playing && !is_muted &&
+        !state.input_external_media && !dtmf_active;
 
     if (_includeAudioLevelIndication) {
       int length = _audioFrame.samples_per_channel_ * _audioFrame.num_channels_;
@@ -3553,9 +3630,76 @@ Channel::PrepareEncodeAndSend(int mixingFrequency)
 
 uint32_t
 Channel::EncodeAndSend()
+{
+    return EncodeAndSend(std::vector<Channel*>());
+}
+
+Channel::EncoderSettings::EncoderSettings()
+    : codec(),
+      sample_rate_hz(0),
+      num_channels(0),
+      vad_enabled(false),
+      vad_mode(VADNormal),
+      dtx_enabled(false),
+      red_enabled(false),
+      red_payload_type(-1) {}
+
+bool Channel::EncoderSettings::operator==(const EncoderSettings& other) const
+{
+    return codec == other.codec &&
+        sample_rate_hz == other.sample_rate_hz &&
+        num_channels == other.num_channels &&
+        vad_enabled == other.vad_enabled &&
+        vad_mode == other.vad_mode &&
+        dtx_enabled == other.dtx_enabled &&
+        red_enabled == other.red_enabled &&
+        red_payload_type == other.red_payload_type;
+}
+
+bool
+Channel::GetSharedEncoderSettings(EncoderSettings* settings)
+{
+    if (!audio_frame_is_shareable_ || _audioFrame.samples_per_channel_ == 0)
+    {
+        return false;
+    }
+    // Codec FEC adapts the encoder to the packet loss seen by this channel.
+    if (audio_coding_->CodecFEC())
+    {
+        return false;
+    }
+    if (audio_coding_->SendCodec(&settings->codec) != 0 ||
+        !EncoderIsIndependentOfChannel(settings->codec))
+    {
+        return false;
+    }
+    settings->sample_rate_hz = _audioFrame.sample_rate_hz_;
+    settings->num_channels = _audioFrame.num_channels_;
+    if (audio_coding_->VAD(&settings->dtx_enabled, &settings->vad_enabled,
+                           &settings->vad_mode) != 0)
+    {
+        return false;
+    }
+    settings->red_enabled = audio_coding_->REDStatus();
+    settings->red_payload_type = -1;
+    if (settings->red_enabled)
+    {
+        int8_t red_payload_type(0);
+        if (_rtpRtcpModule->SendREDPayloadType(red_payload_type) != 0)
+        {
+            return false;
+        }
+        settings->red_payload_type = red_payload_type;
+    }
+    return true;
+}
+
+uint32_t
+Channel::EncodeAndSend(const std::vector<Channel*>& followers)
 {
     WEBRTC_TRACE(kTraceStream, kTraceVoice, VoEId(_instanceId,_channelId),
-                 "Channel::EncodeAndSend()");
+                 "Channel::EncodeAndSend(followers=%" PRIuS ")",
+                 followers.size());
 
     assert(_audioFrame.num_channels_ <= 2);
     if (_audioFrame.samples_per_channel_ == 0)
@@ -3569,12 +3713,48 @@ Channel::EncodeAndSend()
 
     // --- Add 10ms of raw (PCM) audio data to the encoder @ 32kHz.
 
+    // The encoder was left idle while another channel encoded for this one,
+    // and holds the partial packet from before. Start it over, so that the
+    // first packets after leaving the group don't mix in stale audio.
+    if (shared_encoder_idle_)
+    {
+        audio_coding_->ResetEncoder();
+        shared_encoder_idle_ = false;
+    }
+
     // The ACM resamples internally.
     _audioFrame.timestamp_ = _timeStamp;
+
+    // The followers keep counting input samples from where they are, and the
+    // difference is added to the encoder's timestamps, so that each stream
+    // stays continuous when its channel joins or leaves the group.
+    if (!followers.empty())
+    {
+        CodecInst codec;
+        if (audio_coding_->SendCodec(&codec) != 0 ||
+            _audioFrame.sample_rate_hz_ <= 0)
+        {
+            return 0xFFFFFFFF;
+        }
+        const int64_t rtp_rate_hz = RtpTimestampRateHz(codec);
+        for (size_t i = 0; i < followers.size(); ++i)
+        {
+            const int32_t diff =
+                static_cast<int32_t>(followers[i]->_timeStamp - _timeStamp);
+            followers[i]->shared_encoder_timestamp_offset_ =
+                static_cast<uint32_t>(diff * rtp_rate_hz /
+                                      _audioFrame.sample_rate_hz_);
+        }
+    }
+
     // This call will trigger AudioPacketizationCallback::SendData if encoding
     // is done and payload is ready for packetization and transmission.
-    // Otherwise, it will return without invoking the callback.
-    if (audio_coding_->Add10MsData((AudioFrame&)_audioFrame) < 0)
+    // Otherwise, it will return without invoking the callback. The payloads
+    // are passed on to |followers| from SendData.
+    shared_encoder_followers_ = &followers;
+    const int result = audio_coding_->Add10MsData((AudioFrame&)_audioFrame);
+    shared_encoder_followers_ = NULL;
+    if (result < 0)
     {
         WEBRTC_TRACE(kTraceError, kTraceVoice, VoEId(_instanceId,_channelId),
                      "Channel::EncodeAndSend() ACM encoding failed");
@@ -3582,6 +3762,12 @@ Channel::EncodeAndSend()
     }
 
     _timeStamp += _audioFrame.samples_per_channel_;
+    for (size_t i = 0; i < followers.size(); ++i)
+    {
+        Channel* follower = followers[i];
+        follower->_timeStamp += follower->_audioFrame.samples_per_channel_;
+        follower->shared_encoder_idle_ = true;
+    }
     return 0;
 }
 
@@ -11,6 +11,8 @@
 #ifndef WEBRTC_VOICE_ENGINE_CHANNEL_H_
 #define WEBRTC_VOICE_ENGINE_CHANNEL_H_
 
+#include <vector>
+
 #include "webrtc/base/scoped_ptr.h"
 #include "webrtc/common_audio/resampler/include/push_resampler.h"
 #include "webrtc/common_types.h"
@@ -444,6 +446,36 @@ public:
     uint32_t PrepareEncodeAndSend(int mixingFrequency);
     uint32_t EncodeAndSend();
 
+    // Everything that decides the encoded output for a given input frame.
+    // Channels with equal settings that were prepared with the same audio
+    // produce the same payloads, and can share one encoder.
+    struct EncoderSettings
+    {
+        EncoderSettings();
+        bool operator==(const EncoderSettings& other) const;
+
+        CodecInst codec;
+        int sample_rate_hz;
+        int num_channels;
+        bool vad_enabled;
+        ACMVADMode vad_mode;
+        bool dtx_enabled;
+        bool red_enabled;
+        int red_payload_type;
+    };
+    // Must be called after PrepareEncodeAndSend(). Returns false if the
+    // prepared audio or the encoder state is specific to this channel (mute,
+    // file mixing, external media, in-band DTMF, codec FEC, or a codec that
+    // adapts to its channel such as iSAC or Opus), in which case the channel
+    // must encode on its own.
+    bool GetSharedEncoderSettings(EncoderSettings* settings);
+    // Encodes the prepared audio once and sends the payloads on this channel
+    // and on each of |followers|, each with its own SSRC, sequence numbers and
+    // timestamps. The followers' own encoders are left idle, and are reset
+    // before they encode again. All |followers| must have the same
+    // EncoderSettings as this channel.
+    uint32_t EncodeAndSend(const std::vector<Channel*>& followers);
+
 protected:
     void OnIncomingFractionLoss(int fraction_lost);
 
@@ -457,6 +489,13 @@ private:
     bool IsPacketRetransmitted(const RTPHeader& header, bool in_order) const;
     int ResendPackets(const uint16_t* sequence_numbers, int length);
     int InsertInbandDtmfTone();
+    void SendToSharedEncoderFollowers(
+        FrameType frameType,
+        uint8_t payloadType,
+        uint32_t timeStamp,
+        const uint8_t* payloadData,
+        size_t payloadSize,
+        const RTPFragmentationHeader* fragmentation);
     int32_t MixOrReplaceAudioWithFile(int mixingFrequency);
     int32_t MixAudioWithFile(AudioFrame& audioFrame, int mixingFrequency);
     int32_t SendPacketRaw(const void *data, size_t len, bool RTCP);
@@ -508,6 +547,17 @@ private:
     VoEMediaProcess* _inputExternalMediaCallbackPtr;
     VoEMediaProcess* _outputExternalMediaCallbackPtr;
     uint32_t _timeStamp;
+    // True if PrepareEncodeAndSend() left |_audioFrame| as it came from the
+    // transmit mixer.
+    bool audio_frame_is_shareable_;
+    // Set by EncodeAndSend() while the encoder runs on behalf of other
+    // channels.
+    const std::vector<Channel*>* shared_encoder_followers_;
+    // Added to the timestamps of payloads encoded by another channel.
+    uint32_t shared_encoder_timestamp_offset_;
+    // True while the encoder has been idle because another channel encoded
+    // for this one. The encoder is reset before it is used again.
+    bool shared_encoder_idle_;
     uint8_t _sendTelephoneEventPayloadType;
 
     RemoteNtpTimeEstimator ntp_estimator_ GUARDED_BY(ts_stats_lock_);
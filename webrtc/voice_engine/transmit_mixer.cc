@@ -27,6 +27,44 @@
 namespace webrtc {
 namespace voe {
 
+namespace {
+
+// Encodes and sends the prepared audio on |channels|, which must all be
+// sending. The audio and the encoder settings are the same for most channels,
+// so channels with equal settings are grouped and each group is encoded once,
+// by its first channel. That covers the ACM's resampling to the codec rate,
+// but not the down-conversion to each channel's codec format done by
+// Channel::Demultiplex() for the per-channel capture path, which still runs
+// once per channel. Channels that cannot share an encoder encode on their
+// own.
+void EncodeAndSendGrouped(const std::vector<Channel*>& channels) {
+  std::vector<Channel::EncoderSettings> group_settings;
+  std::vector<Channel*> leaders;
+  std::vector<std::vector<Channel*> > followers;
+  for (size_t i = 0; i < channels.size(); ++i) {
+    Channel* channel = channels[i];
+    Channel::EncoderSettings settings;
+    if (!channel->GetSharedEncoderSettings(&settings)) {
+      channel->EncodeAndSend();
+      continue;
+    }
+    size_t group = 0;
+    while (group < leaders.size() && !(group_settings[group] == settings))
+      ++group;
+    if (group == leaders.size()) {
+      group_settings.push_back(settings);
+      leaders.push_back(channel);
+      followers.push_back(std::vector<Channel*>());
+    } else {
+      followers[group].push_back(channel);
+    }
+  }
+  for (size_t group = 0; group < leaders.size(); ++group)
+    leaders[group]->EncodeAndSend(followers[group]);
+}
+
+}  // namespace
+
 // TODO(ajm): The thread safety of this is dubious...
 void
 TransmitMixer::OnPeriodicProcess()
@@ -445,26 +483,34 @@ TransmitMixer::EncodeAndSend()
     WEBRTC_TRACE(kTraceStream, kTraceVoice, VoEId(_instanceId, -1),
                  "TransmitMixer::EncodeAndSend()");
 
-    for (ChannelManager::Iterator it(_channelManagerPtr); it.IsValid();
-         it.Increment())
+    // The iterator keeps the channels alive until they are all encoded.
+    ChannelManager::Iterator it(_channelManagerPtr);
+    std::vector<Channel*> sending_channels;
+    for (; it.IsValid(); it.Increment())
     {
         Channel* channelPtr = it.GetChannel();
         if (channelPtr->Sending())
         {
-            channelPtr->EncodeAndSend();
+            sending_channels.push_back(channelPtr);
         }
     }
+    EncodeAndSendGrouped(sending_channels);
     return 0;
 }
 
 void TransmitMixer::EncodeAndSend(const int voe_channels[],
                                   int number_of_voe_channels) {
+  std::vector<voe::ChannelOwner> owners;
+  std::vector<Channel*> sending_channels;
   for (int i = 0; i < number_of_voe_channels; ++i) {
     voe::ChannelOwner ch = _channelManagerPtr->GetChannel(voe_channels[i]);
     voe::Channel* channel_ptr = ch.channel();
-    if (channel_ptr && channel_ptr->Sending())
-      channel_ptr->EncodeAndSend();
+    if (channel_ptr && channel_ptr->Sending()) {
+      owners.push_back(ch);
+      sending_channels.push_back(channel_ptr);
+    }
   }
+  EncodeAndSendGrouped(sending_channels);
 }
 
 uint32_t TransmitMixer::CaptureLevel() const
@@ -10,8 +10,20 @@
 
 #include "webrtc/voice_engine/transmit_mixer.h"
 
+#include <math.h>
+#include <stdio.h>
+
+#include <vector>
+
 #include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/base/scoped_ptr.h"
+#include "webrtc/modules/audio_device/include/fake_audio_device.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+#include "webrtc/voice_engine/include/voe_base.h"
+#include "webrtc/voice_engine/include/voe_codec.h"
 #include "webrtc/voice_engine/include/voe_external_media.h"
+#include "webrtc/voice_engine/include/voe_network.h"
+#include "webrtc/voice_engine/include/voe_volume_control.h"
 
 namespace webrtc {
 namespace voe {
@@ -54,6 +66,273 @@ TEST(TransmitMixerTest, RegisterExternalMediaCallback) {
   TransmitMixer::Destroy(tm);
 }
 
+const int kSampleRateHz = 16000;
+const int kSamplesPer10Ms = kSampleRateHz / 100;
+
+struct RtpPacket {
+  uint16_t sequence_number;
+  uint32_t timestamp;
+  uint32_t ssrc;
+  std::vector<uint8_t> payload;
+};
+
+// Parses and stores the RTP packets sent on a channel.
+class RecordingTransport : public Transport {
+ public:
+  int SendPacket(int channel, const void* data, size_t len) override {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    if (len < 12)
+      return -1;
+    RtpPacket packet;
+    packet.sequence_number = (bytes[2] << 8) | bytes[3];
+    packet.timestamp = (bytes[4] << 24) | (bytes[5] << 16) |
+        (bytes[6] << 8) | bytes[7];
+    packet.ssrc = (bytes[8] << 24) | (bytes[9] << 16) |
+        (bytes[10] << 8) | bytes[11];
+    packet.payload.assign(bytes + 12, bytes + len);
+    packets_.push_back(packet);
+    return static_cast<int>(len);
+  }
+
+  int SendRTCPPacket(int channel, const void* data, size_t len) override {
+    return static_cast<int>(len);
+  }
+
+  const std::vector<RtpPacket>& packets() const { return packets_; }
+
+ private:
+  std::vector<RtpPacket> packets_;
+};
+
+// Runs a VoiceEngine on a fake audio device and feeds it recorded audio by
+// hand, to test how the transmit mixer encodes for many sending channels.
+class SendingVoiceEngine {
+ public:
+  SendingVoiceEngine()
+      : voe_(VoiceEngine::Create()),
+        base_(VoEBase::GetInterface(voe_)),
+        codec_(VoECodec::GetInterface(voe_)),
+        network_(VoENetwork::GetInterface(voe_)),
+        volume_(VoEVolumeControl::GetInterface(voe_)),
+        adm_(new FakeAudioDeviceModule),
+        time_(0) {
+    EXPECT_EQ(0, base_->Init(adm_.get()));
+  }
+
+  ~SendingVoiceEngine() {
+    for (size_t i = 0; i < channels_.size(); ++i) {
+      base_->StopSend(channels_[i]);
+      network_->DeRegisterExternalTransport(channels_[i]);
+      base_->DeleteChannel(channels_[i]);
+    }
+    for (size_t i = 0; i < transports_.size(); ++i)
+      delete transports_[i];
+    base_->Terminate();
+    base_->Release();
+    codec_->Release();
+    network_->Release();
+    volume_->Release();
+    VoiceEngine::Delete(voe_);
+  }
+
+  bool FindCodec(const char* name, int sample_rate_hz, CodecInst* codec) {
+    for (int i = 0; i < codec_->NumOfCodecs(); ++i) {
+      if (codec_->GetCodec(i, *codec) == 0 &&
+          STR_CASE_CMP(codec->plname, name) == 0 &&
+          codec->plfreq == sample_rate_hz) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Creates a channel that sends with |codec| to its own RecordingTransport.
+  void CreateSendingChannel(const CodecInst& codec) {
+    int channel = base_->CreateChannel();
+    ASSERT_NE(-1, channel);
+    channels_.push_back(channel);
+    transports_.push_back(new RecordingTransport);
+    ASSERT_EQ(0, network_->RegisterExternalTransport(channel,
+                                                     *transports_.back()));
+    ASSERT_EQ(0, codec_->SetSendCodec(channel, codec));
+    ASSERT_EQ(0, base_->StartSend(channel));
+  }
+
+  void SetInputMute(size_t index, bool mute) {
+    EXPECT_EQ(0, volume_->SetInputMute(channels_[index], mute));
+  }
+
+  // Feeds |num_frames| 10 ms frames of a two-tone signal to the engine.
+  void RecordAudio(int num_frames) {
+    int16_t audio[kSamplesPer10Ms];
+    for (int n = 0; n < num_frames; ++n) {
+      for (int i = 0; i < kSamplesPer10Ms; ++i, ++time_) {
+        const double t = static_cast<double>(time_) / kSampleRateHz;
+        audio[i] = static_cast<int16_t>(6000 * sin(2 * M_PI * 440 * t) +
+                                        3000 * sin(2 * M_PI * 1250 * t));
+      }
+      uint32_t new_mic_level = 0;
+      ASSERT_EQ(0, base_->audio_transport()->RecordedDataIsAvailable(
+          audio, kSamplesPer10Ms, 2, 1, kSampleRateHz, 0, 0, 0, false,
+          new_mic_level));
+    }
+  }
+
+  const std::vector<RtpPacket>& packets(size_t index) const {
+    return transports_[index]->packets();
+  }
+
+ private:
+  VoiceEngine* voe_;
+  VoEBase* base_;
+  VoECodec* codec_;
+  VoENetwork* network_;
+  VoEVolumeControl* volume_;
+  rtc::scoped_ptr<FakeAudioDeviceModule> adm_;
+  std::vector<int> channels_;
+  std::vector<RecordingTransport*> transports_;
+  int time_;
+};
+
+// Expects each packet in |packets| to follow the previous one, with
+// |timestamp_step| between their timestamps.
+void ExpectContinuousStream(const std::vector<RtpPacket>& packets,
+                            uint32_t timestamp_step) {
+  ASSERT_FALSE(packets.empty());
+  for (size_t i = 1; i < packets.size(); ++i) {
+    SCOPED_TRACE(i);
+    EXPECT_EQ(packets[0].ssrc, packets[i].ssrc);
+    EXPECT_EQ(static_cast<uint16_t>(packets[i - 1].sequence_number + 1),
+              packets[i].sequence_number);
+    EXPECT_EQ(packets[i - 1].timestamp + timestamp_step, packets[i].timestamp);
+  }
+}
+
+// Channels with the same send codec share one encoder, but each sends its own
+// RTP stream with the same payloads.
+TEST(TransmitMixerEncodingTest, ChannelsWithSameCodecSendSamePayloads) {
+  SendingVoiceEngine engine;
+  CodecInst codec;
+  ASSERT_TRUE(engine.FindCodec("iLBC", 8000, &codec));
+  const size_t kNumChannels = 4;
+  for (size_t i = 0; i < kNumChannels; ++i)
+    engine.CreateSendingChannel(codec);
+  const int kNumFrames = 60;
+  engine.RecordAudio(kNumFrames);
+
+  const std::vector<RtpPacket>& reference = engine.packets(0);
+  // The codec counts 80 samples per 10 ms.
+  ASSERT_EQ(static_cast<size_t>(kNumFrames * 80 / codec.pacsize),
+            reference.size());
+  for (size_t i = 0; i < kNumChannels; ++i) {
+    SCOPED_TRACE(i);
+    const std::vector<RtpPacket>& packets = engine.packets(i);
+    ExpectContinuousStream(packets, codec.pacsize);
+    ASSERT_EQ(reference.size(), packets.size());
+    for (size_t j = 0; j < packets.size(); ++j)
+      EXPECT_TRUE(reference[j].payload == packets[j].payload);
+    for (size_t k = 0; k < i; ++k)
+      EXPECT_NE(engine.packets(k)[0].ssrc, packets[0].ssrc);
+  }
+}
+
+// A muted channel can not share the encoder of the others. Its stream, and the
+// streams of the channels that shared its encoder, must stay continuous when
+// it leaves the group and joins it again. The last channel starts late, so
+// that it counts its timestamps from a different point than the others.
+TEST(TransmitMixerEncodingTest, MuteKeepsStreamsContinuous) {
+  SendingVoiceEngine engine;
+  CodecInst codec;
+  ASSERT_TRUE(engine.FindCodec("PCMU", 8000, &codec));
+  const int kFramesPerPacket = codec.pacsize / 80;
+  engine.CreateSendingChannel(codec);
+  engine.CreateSendingChannel(codec);
+  engine.RecordAudio(10 * kFramesPerPacket);
+  engine.CreateSendingChannel(codec);
+  engine.RecordAudio(10 * kFramesPerPacket);
+
+  // Mute the channel that encodes for the others, and then the late one.
+  for (size_t muted = 0; muted < 3; muted += 2) {
+    engine.SetInputMute(muted, true);
+    engine.RecordAudio(5 * kFramesPerPacket);
+    engine.SetInputMute(muted, false);
+    engine.RecordAudio(5 * kFramesPerPacket);
+  }
+
+  for (size_t i = 0; i < 3; ++i) {
+    SCOPED_TRACE(i);
+    ExpectContinuousStream(engine.packets(i), codec.pacsize);
+  }
+  const std::vector<RtpPacket>& first = engine.packets(0);
+  const std::vector<RtpPacket>& second = engine.packets(1);
+  const std::vector<RtpPacket>& late = engine.packets(2);
+  ASSERT_EQ(40u, first.size());
+  ASSERT_EQ(40u, second.size());
+  ASSERT_EQ(30u, late.size());
+  for (size_t i = 0; i < second.size(); ++i) {
+    SCOPED_TRACE(i);
+    EXPECT_EQ(i < 20 || i >= 25, first[i].payload == second[i].payload);
+    if (i >= 10)
+      EXPECT_EQ(i < 30 || i >= 35, late[i - 10].payload == second[i].payload);
+  }
+}
+
+// A channel that shares the encoder of another leaves its own encoder idle,
+// holding whatever it had buffered before joining. That audio must not end up
+// in its stream when it encodes on its own again.
+TEST(TransmitMixerEncodingTest, LeavingGroupResetsIdleEncoder) {
+  SendingVoiceEngine engine;
+  CodecInst codec;
+  ASSERT_TRUE(engine.FindCodec("PCMU", 8000, &codec));
+  const int kFramesPerPacket = codec.pacsize / 80;
+  ASSERT_GT(kFramesPerPacket, 1);
+  engine.CreateSendingChannel(codec);
+  engine.CreateSendingChannel(codec);
+
+  // The second channel encodes one frame on its own, which leaves part of a
+  // packet in its encoder, and then shares the encoder of the first.
+  engine.SetInputMute(0, true);
+  engine.RecordAudio(1);
+  engine.SetInputMute(0, false);
+  engine.RecordAudio(5 * kFramesPerPacket - 1);
+  // Muting the first channel makes the second encode on its own again.
+  engine.SetInputMute(0, true);
+  engine.RecordAudio(5 * kFramesPerPacket);
+
+  const std::vector<RtpPacket>& packets = engine.packets(1);
+  ASSERT_EQ(10u, packets.size());
+  ExpectContinuousStream(packets, codec.pacsize);
+}
+
+// Measures the time it takes to process 10 ms of recorded audio for a growing
+// number of sending channels, with and without a shared encoder. Each channel
+// gets its own dynamic payload type in the former case, which keeps the
+// encoders apart without changing the work they do.
+TEST(TransmitMixerEncodingTest, DISABLED_CpuVersusNumberOfChannels) {
+  const int kNumFrames = 1000;
+  printf("%8s %16s %16s\n", "channels", "separate [us]", "shared [us]");
+  for (int num_channels = 1; num_channels <= 32; num_channels *= 2) {
+    double time_per_frame_us[2];
+    for (int shared = 0; shared < 2; ++shared) {
+      SendingVoiceEngine engine;
+      CodecInst codec;
+      ASSERT_TRUE(engine.FindCodec("iLBC", 8000, &codec));
+      for (int i = 0; i < num_channels; ++i) {
+        if (!shared)
+          codec.pltype = 96 + i;
+        engine.CreateSendingChannel(codec);
+      }
+      engine.RecordAudio(10);  // Warm up.
+      const int64_t start_us = TickTime::MicrosecondTimestamp();
+      engine.RecordAudio(kNumFrames);
+      time_per_frame_us[shared] = static_cast<double>(
+          TickTime::MicrosecondTimestamp() - start_us) / kNumFrames;
+    }
+    printf("%8d %16.1f %16.1f\n", num_channels, time_per_frame_us[0],
+           time_per_frame_us[1]);
+  }
+}
+
 }  // namespace
 }  // namespace voe
 }  // namespace webrtc